@@ -1,5 +1,5 @@
 function(add_external_dependency)
-  set(oneValueArgs GITHUB_AUTHOR GITHUB_REPO GITHUB_COMMIT)
+  set(oneValueArgs GITHUB_AUTHOR GITHUB_REPO GITHUB_COMMIT SOURCE_SUBDIR)
   set(multiValueArgs TARGET_NAMES OPTIONS)
   cmake_parse_arguments(DEPENDENCY "${options}" "${oneValueArgs}"
                         "${multiValueArgs}" ${ARGN})
@@ -8,6 +8,11 @@ function(add_external_dependency)
     message(FATAL_ERROR "External dependency added with wrong arguments")
   endif()
 
+  # Some repositories keep their cmake project away from their root
+  if(DEFINED DEPENDENCY_SOURCE_SUBDIR)
+    set(DEPENDENCY_SUBDIR_ARGS SOURCE_SUBDIR ${DEPENDENCY_SOURCE_SUBDIR})
+  endif()
+
   cpmaddpackage(
     NAME
     ${DEPENDENCY_GITHUB_REPO}
@@ -18,7 +23,8 @@ function(add_external_dependency)
     GIT_REPOSITORY
     https://github.com/${DEPENDENCY_GITHUB_AUTHOR}/${DEPENDENCY_GITHUB_REPO}
     GIT_TAG
-    ${DEPENDENCY_GITHUB_COMMIT})
+    ${DEPENDENCY_GITHUB_COMMIT}
+    ${DEPENDENCY_SUBDIR_ARGS})
 
   # Manually disabling linting on external dependencies
   foreach(TARGET ${DEPENDENCY_TARGET_NAMES})
@@ -28,7 +34,8 @@ endfunction()
 
 function(add_new_library)
   set(oneValueArgs NAME)
-  set(multiValueArgs SOURCE_LIST INCLUDE_LIST LINK_LIST TEST_LIST)
+  set(multiValueArgs SOURCE_LIST INCLUDE_LIST LINK_LIST TEST_LIST
+                     BENCHMARK_LIST)
   set(options HEADER_ONLY)
   cmake_parse_arguments(LIBRARY "${options}" "${oneValueArgs}"
                         "${multiValueArgs}" ${ARGN})
@@ -92,6 +99,47 @@ function(add_new_library)
     include(GoogleTest)
     gtest_discover_tests(${TEST_NAME})
   endif()
+
+  if(${GROW_BUILD_BENCHMARKS} AND DEFINED LIBRARY_BENCHMARK_LIST)
+    add_new_benchmark(NAME ${FINAL_LIBRARY_NAME}_benchmark SOURCE_LIST
+                      ${LIBRARY_BENCHMARK_LIST} LINK_LIST ${FINAL_LIBRARY_NAME})
+  endif()
+endfunction()
+
+function(add_new_benchmark)
+  set(oneValueArgs NAME)
+  set(multiValueArgs SOURCE_LIST INCLUDE_LIST LINK_LIST)
+  cmake_parse_arguments(BENCHMARK "${options}" "${oneValueArgs}"
+                        "${multiValueArgs}" ${ARGN})
+
+  if(DEFINED BENCHMARK_KEYWORDS_MISSING_VALUES)
+    message(FATAL_ERROR "New benchmark added with wrong arguments")
+  endif()
+
+  add_external_dependency(
+    GITHUB_AUTHOR
+    google
+    GITHUB_REPO
+    benchmark
+    GITHUB_COMMIT
+    v1.6.1
+    TARGET_NAMES
+    benchmark
+    benchmark_main
+    OPTIONS
+    "BENCHMARK_ENABLE_TESTING OFF"
+    "BENCHMARK_ENABLE_INSTALL OFF")
+  add_executable(${BENCHMARK_NAME} ${BENCHMARK_SOURCE_LIST})
+
+  # Disable linting on benchmarks
+  set_target_properties(${BENCHMARK_NAME} PROPERTIES CXX_CLANG_TIDY "")
+
+  if(DEFINED BENCHMARK_INCLUDE_LIST)
+    target_include_directories(${BENCHMARK_NAME}
+                               PRIVATE ${BENCHMARK_INCLUDE_LIST})
+  endif()
+
+  target_link_libraries(${BENCHMARK_NAME} benchmark_main ${BENCHMARK_LINK_LIST})
 endfunction()
 
 function(add_new_component)
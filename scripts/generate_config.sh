@@ -1,9 +1,26 @@
 #!/bin/bash
+# Writes a configuration for the components asked for:
+#   -o <path>     where to write it (grow.cfg)
+#   -v <version>  project version it is meant for
+#   -t -s -r -g   Temperature, Storage, Rules and Gateway
+#   -l            the load harness along with its recorder and replayer
+#   -e            the load generator examples
+#   -i <id>       a sensor polled by Temperature, once for each of them
+#   -f            the optional Temperature features: publish outbox, lz4 compression, quantile
+#                 sketches, replay buffer (ReplayPublisher port) and requests (Responder port)
 OUTPUT_PATH="grow.cfg"
 THERMOMETER_ENABLED=false
+STORAGE_ENABLED=false
+RULES_ENABLED=false
+GATEWAY_ENABLED=false
+LOAD_HARNESS_ENABLED=false
+EXAMPLES_ENABLED=false
+FEATURES_ENABLED=false
 PROJECT_VERSION="invalid"
+# Ids of the sensors polled by Temperature, a single device without any
+SENSORS=()
 
-while getopts ":o:tv:" opt; do
+while getopts ":o:tsrglev:i:f" opt; do
   case $opt in
     o)
       OUTPUT_PATH="$OPTARG"
@@ -11,9 +28,30 @@ while getopts ":o:tv:" opt; do
     t)
       THERMOMETER_ENABLED=true
       ;;
+    s)
+      STORAGE_ENABLED=true
+      ;;
+    r)
+      RULES_ENABLED=true
+      ;;
+    g)
+      GATEWAY_ENABLED=true
+      ;;
+    l)
+      LOAD_HARNESS_ENABLED=true
+      ;;
+    e)
+      EXAMPLES_ENABLED=true
+      ;;
     v)
       PROJECT_VERSION="$OPTARG"
       ;;
+    i)
+      SENSORS+=("$OPTARG")
+      ;;
+    f)
+      FEATURES_ENABLED=true
+      ;;
     \?)
       echo "Invalid option: -$OPTARG" >&2
       exit 1
@@ -27,14 +65,97 @@ done
 
 echo -e "project_version = \"${PROJECT_VERSION}\";\n" > "${OUTPUT_PATH}"
 if [ "$THERMOMETER_ENABLED" = true ] ; then
-    echo -e "Temperature =\n{\n\tpoll_time = 1000;\n};" >> "${OUTPUT_PATH}"
+    echo -e "Temperature =\n{\n\tpoll_time = 1000;" >> "${OUTPUT_PATH}"
+    if [ "$FEATURES_ENABLED" = true ] ; then
+        echo -e "\toutbox = { memory = 1048576; disk = 0; path = \"/tmp/grow/Temperature.outbox\"; };\n\tcompression = { algorithm = \"lz4\"; threshold = 1024; };\n\tsketch = { period = 3600000; compression = 100; };\n\treplay = { frames = 4096; bytes = 4194304; };" >> "${OUTPUT_PATH}"
+    fi
+    if [ ${#SENSORS[@]} -gt 0 ] ; then
+        SENSOR_ENTRIES=()
+        for sensor in "${SENSORS[@]}" ; do
+            SENSOR_ENTRIES+=("\t\t{ id = \"${sensor}\"; period = 1000; }")
+        done
+        SENSOR_LIST=$(IFS=,; echo "${SENSOR_ENTRIES[*]}" | sed 's/,/,\\n/g')
+        echo -e "\tsensors =\n\t(\n${SENSOR_LIST}\n\t);" >> "${OUTPUT_PATH}"
+    fi
+    echo -e "};" >> "${OUTPUT_PATH}"
+fi
+if [ "$STORAGE_ENABLED" = true ] ; then
+    echo -e "Storage =\n{\n\tpath = \"/tmp/grow\";\n\tflush_period = 1000;\n\trollups = ( 60000, 3600000 );\n\tseries =\n\t(" >> "${OUTPUT_PATH}"
+    if [ "$THERMOMETER_ENABLED" = true ] ; then
+        # Polled sensors share their batches, each of them gets a series of its own
+        SERIES_ENTRIES=("\t\t{ component = \"Temperature\"; topic = \"TEMPERATURE\"; field = \"temperature\"; }")
+        for sensor in "${SENSORS[@]}" ; do
+            SERIES_ENTRIES+=("\t\t{ component = \"Temperature\"; topic = \"TEMPERATURE_BATCH\"; field = \"temperature\"; sensor = \"${sensor}\"; }")
+        done
+        SERIES_LIST=$(IFS=,; echo "${SERIES_ENTRIES[*]}" | sed 's/,/,\\n/g')
+        echo -e "${SERIES_LIST}" >> "${OUTPUT_PATH}"
+    fi
+    echo -e "\t);\n};" >> "${OUTPUT_PATH}"
+fi
+if [ "$RULES_ENABLED" = true ] ; then
+    echo -e "Rules =\n{\n\trules =\n\t(" >> "${OUTPUT_PATH}"
+    if [ "$THERMOMETER_ENABLED" = true ] ; then
+        echo -e "\t\t{ name = \"fan\"; component = \"Temperature\"; topic = \"TEMPERATURE\"; field = \"temperature\"; condition = \">\"; threshold = 28.0; hysteresis = 1.0; duration = 60000; action = \"FAN\"; }" >> "${OUTPUT_PATH}"
+    fi
+    echo -e "\t);\n};" >> "${OUTPUT_PATH}"
+fi
+if [ "$GATEWAY_ENABLED" = true ] ; then
+    GATEWAY_COMPONENTS=()
+    [ "$THERMOMETER_ENABLED" = true ] && GATEWAY_COMPONENTS+=("\"Temperature\"")
+    [ "$STORAGE_ENABLED" = true ] && GATEWAY_COMPONENTS+=("\"Storage\"")
+    [ "$RULES_ENABLED" = true ] && GATEWAY_COMPONENTS+=("\"Rules\"")
+    GATEWAY_LIST=$(IFS=,; echo "${GATEWAY_COMPONENTS[*]}" | sed 's/,/, /g')
+    echo -e "Gateway =\n{\n\tport = 7500;\n\tcomponents = ( ${GATEWAY_LIST} );\n};" >> "${OUTPUT_PATH}"
+fi
+if [ "$LOAD_HARNESS_ENABLED" = true ] ; then
+    echo -e "LoadHarness =\n{\n\tsensors = 1000;\n\trate = 1;\n\tduration = 10;\n\tseed = 42;\n\tcontrol_rate = 10;\n};" >> "${OUTPUT_PATH}"
+    echo -e "Recorder =\n{\n\tpath = \"/tmp/grow/capture.rec\";\n\tcomponents = ( \"Temperature\" );\n};" >> "${OUTPUT_PATH}"
+    echo -e "Replayer =\n{\n\tpath = \"/tmp/grow/capture.rec\";\n\tspeed = 1;\n\trepeat = 1;\n};" >> "${OUTPUT_PATH}"
+fi
+if [ "$EXAMPLES_ENABLED" = true ] ; then
+    echo -e "LoadGen =\n{\n\trate = 1000;\n\tpayload_size = 64;\n\ttopics = 1;\n\tduration = 10;\n};" >> "${OUTPUT_PATH}"
+    echo -e "LoadSink =\n{\n\tsource = \"LoadGen\";\n\treport_period = 1000;\n};" >> "${OUTPUT_PATH}"
 fi
 
 echo -e "Publisher =\n{" >> "${OUTPUT_PATH}"
 if [ "$THERMOMETER_ENABLED" = true ] ; then
     echo -e "\tTemperature = 7000;" >> "${OUTPUT_PATH}"
 fi
+if [ "$STORAGE_ENABLED" = true ] ; then
+    echo -e "\tStorage = 7200;" >> "${OUTPUT_PATH}"
+fi
+if [ "$RULES_ENABLED" = true ] ; then
+    echo -e "\tRules = 7300;" >> "${OUTPUT_PATH}"
+fi
+if [ "$LOAD_HARNESS_ENABLED" = true ] ; then
+    echo -e "\tLoadHarness = 7100;" >> "${OUTPUT_PATH}"
+fi
+if [ "$EXAMPLES_ENABLED" = true ] ; then
+    echo -e "\tLoadGen = 7600;" >> "${OUTPUT_PATH}"
+fi
 
 echo -e "};" >> "${OUTPUT_PATH}"
 
+# Control traffic (rule actions, control probes) gets a channel of its own on these ports
+if [ "$RULES_ENABLED" = true ] || [ "$LOAD_HARNESS_ENABLED" = true ] ; then
+    echo -e "ControlPublisher =\n{" >> "${OUTPUT_PATH}"
+    if [ "$RULES_ENABLED" = true ] ; then
+        echo -e "\tRules = 7301;" >> "${OUTPUT_PATH}"
+    fi
+    if [ "$LOAD_HARNESS_ENABLED" = true ] ; then
+        echo -e "\tLoadHarness = 7101;" >> "${OUTPUT_PATH}"
+    fi
+    echo -e "};" >> "${OUTPUT_PATH}"
+fi
+
+# Subscribers that missed frames get them back from these ports
+if [ "$THERMOMETER_ENABLED" = true ] && [ "$FEATURES_ENABLED" = true ] ; then
+    echo -e "ReplayPublisher =\n{\n\tTemperature = 7002;\n};" >> "${OUTPUT_PATH}"
+fi
+
+# Components answer requests from other components on these ports
+if [ "$THERMOMETER_ENABLED" = true ] && [ "$FEATURES_ENABLED" = true ] ; then
+    echo -e "Responder =\n{\n\tTemperature = 7003;\n};" >> "${OUTPUT_PATH}"
+fi
+
 exit 0
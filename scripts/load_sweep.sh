@@ -0,0 +1,100 @@
+#!/bin/bash
+# Runs LoadGen against LoadSink for every combination of the given rates, payload sizes and topic
+# counts, printing a results table. The point where throughput stops following the rate, or loss
+# and latency start growing, is where the box saturates
+BUILD_DIR="build"
+PROJECT_VERSION="invalid"
+RATES="1000 10000 50000 100000"
+PAYLOAD_SIZES="64 1024"
+TOPIC_COUNTS="1 8"
+DURATION=10
+SETTLE_TIME=2
+OUTPUT_PATH=""
+
+while getopts ":b:v:r:p:t:d:o:" opt; do
+  case $opt in
+    b)
+      BUILD_DIR="$OPTARG"
+      ;;
+    v)
+      PROJECT_VERSION="$OPTARG"
+      ;;
+    r)
+      RATES="$OPTARG"
+      ;;
+    p)
+      PAYLOAD_SIZES="$OPTARG"
+      ;;
+    t)
+      TOPIC_COUNTS="$OPTARG"
+      ;;
+    d)
+      DURATION="$OPTARG"
+      ;;
+    o)
+      OUTPUT_PATH="$OPTARG"
+      ;;
+    \?)
+      echo "Invalid option: -$OPTARG" >&2
+      exit 1
+      ;;
+    :)
+      echo "Option -$OPTARG requires an argument." >&2
+      exit 1
+      ;;
+  esac
+done
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "${WORK_DIR}"' EXIT
+
+LOAD_GEN="$(find "${BUILD_DIR}" -type f -perm -u+x -name LoadGen | head -n1)"
+LOAD_SINK="$(find "${BUILD_DIR}" -type f -perm -u+x -name LoadSink | head -n1)"
+if [ -z "${LOAD_GEN}" ] || [ -z "${LOAD_SINK}" ] ; then
+    echo "LoadGen and LoadSink not found in ${BUILD_DIR}, build with GROW_BUILD_EXAMPLES" >&2
+    exit 1
+fi
+
+RESULTS_PATH="${WORK_DIR}/results.csv"
+TABLE_PATH="${WORK_DIR}/table.csv"
+echo "rate,payload_size,topics,received,msg_per_s,loss_percent,p50_us,p95_us,p99_us,max_us" > "${TABLE_PATH}"
+
+for rate in ${RATES} ; do
+    for payload_size in ${PAYLOAD_SIZES} ; do
+        for topics in ${TOPIC_COUNTS} ; do
+            CONFIG_PATH="${WORK_DIR}/grow.cfg"
+            "${SCRIPT_DIR}/generate_config.sh" -e -v "${PROJECT_VERSION}" -o "${CONFIG_PATH}" || exit 1
+            sed -i -e "s|rate = [0-9]*;|rate = ${rate};|" \
+                   -e "s|payload_size = [0-9]*;|payload_size = ${payload_size};|" \
+                   -e "s|topics = [0-9]*;|topics = ${topics};|" \
+                   -e "s|duration = [0-9]*;|duration = ${DURATION};|" \
+                   -e "s|report_period = [0-9]*;|report_period = 1000;\n\tresults = \"${RESULTS_PATH}\";|" \
+                   "${CONFIG_PATH}"
+            rm -f "${RESULTS_PATH}"
+
+            # The sink goes first, so that it is there from the very first message
+            "${LOAD_SINK}" -c "${CONFIG_PATH}" -l warn > /dev/null 2>&1 &
+            SINK_PID=$!
+            sleep "${SETTLE_TIME}"
+            "${LOAD_GEN}" -c "${CONFIG_PATH}" -l warn > /dev/null 2>&1
+            sleep "${SETTLE_TIME}"
+            kill -INT "${SINK_PID}"
+            wait "${SINK_PID}" 2> /dev/null
+
+            if [ -s "${RESULTS_PATH}" ] ; then
+                echo "${rate},${payload_size},${topics},$(tail -n1 "${RESULTS_PATH}")" >> "${TABLE_PATH}"
+            else
+                echo "${rate},${payload_size},${topics},,,,,,," >> "${TABLE_PATH}"
+                echo "No results for rate ${rate}, payload ${payload_size}, ${topics} topics" >&2
+            fi
+        done
+    done
+done
+
+if [ -n "${OUTPUT_PATH}" ] ; then
+    cp "${TABLE_PATH}" "${OUTPUT_PATH}"
+fi
+column -s, -t < "${TABLE_PATH}"
+
+exit 0
@@ -0,0 +1,86 @@
+#!/bin/bash
+# Measures the resident and virtual memory and thread count of every component built in BUILD_DIR,
+# once with the default profile and once with --low-memory, printing a csv line for each run.
+# Components are started from the same generated configuration and sampled after the same settle
+# time, so that runs on the same board can be compared with one another. Thread stacks are only
+# committed as they are touched, smaller ones show up in the virtual size rather than the resident
+# one.
+# Socket buffers belong to the kernel rather than to the components, on constrained boards they
+# are shrunk system wide through the net.ipv4.tcp_rmem and net.ipv4.tcp_wmem sysctls
+BUILD_DIR="build"
+PROJECT_VERSION="invalid"
+SETTLE_TIME=5
+OUTPUT_PATH="/dev/stdout"
+COMPONENTS=("Temperature" "Storage" "Rules" "Gateway")
+
+while getopts ":b:v:d:o:" opt; do
+  case $opt in
+    b)
+      BUILD_DIR="$OPTARG"
+      ;;
+    v)
+      PROJECT_VERSION="$OPTARG"
+      ;;
+    d)
+      SETTLE_TIME="$OPTARG"
+      ;;
+    o)
+      OUTPUT_PATH="$OPTARG"
+      ;;
+    \?)
+      echo "Invalid option: -$OPTARG" >&2
+      exit 1
+      ;;
+    :)
+      echo "Option -$OPTARG requires an argument." >&2
+      exit 1
+      ;;
+  esac
+done
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+WORK_DIR="$(mktemp -d)"
+trap 'rm -rf "${WORK_DIR}"' EXIT
+
+CONFIG_PATH="${WORK_DIR}/grow.cfg"
+"${SCRIPT_DIR}/generate_config.sh" -t -s -r -g -v "${PROJECT_VERSION}" -o "${CONFIG_PATH}" || exit 1
+# Storage writes its series below its path, keeping them out of the way
+sed -i "s|path = \"/tmp/grow\";|path = \"${WORK_DIR}/storage\";|" "${CONFIG_PATH}"
+
+status_field() {
+    awk -v field="$2:" '$1 == field { print $2 }' "/proc/$1/status"
+}
+
+measure() {
+    local component="$1"
+    local profile="$2"
+    local executable="$3"
+    shift 3
+
+    "${executable}" -c "${CONFIG_PATH}" -l off "$@" > /dev/null 2>&1 &
+    local pid=$!
+    sleep "${SETTLE_TIME}"
+
+    if ! kill -0 "${pid}" 2> /dev/null ; then
+        echo "${component} exited before being measured" >&2
+        return
+    fi
+
+    echo "${component},${profile},$(status_field ${pid} VmRSS),$(status_field ${pid} VmHWM),$(status_field ${pid} VmSize),$(status_field ${pid} Threads)" >> "${OUTPUT_PATH}"
+    kill -INT "${pid}"
+    wait "${pid}" 2> /dev/null
+}
+
+echo "component,profile,rss_kib,peak_rss_kib,virtual_kib,threads" >> "${OUTPUT_PATH}"
+for component in "${COMPONENTS[@]}" ; do
+    executable="$(find "${BUILD_DIR}" -type f -perm -u+x -name "${component}" | head -n1)"
+    if [ -z "${executable}" ] ; then
+        echo "${component} not found in ${BUILD_DIR}, skipping it" >&2
+        continue
+    fi
+
+    measure "${component}" default "${executable}"
+    measure "${component}" low_memory "${executable}" --low-memory
+done
+
+exit 0
@@ -0,0 +1,64 @@
+#ifndef LOADHARNESS_HPP
+#define LOADHARNESS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+#include "LatencyHistogram.hpp"
+#include "LoadHarnessBase.hpp"
+#include "ProcessStats.hpp"
+#include "SimulatedFleet.hpp"
+
+class LoadHarness : public LoadHarnessBase
+{
+private:
+   using Clock = std::chrono::steady_clock;
+
+   static constexpr unsigned int SENSORS_DEFAULT = 1000;
+   static constexpr unsigned int RATE_DEFAULT = 1;
+   static constexpr unsigned int DURATION_DEFAULT = 10;
+   static constexpr unsigned int SEED_DEFAULT = 42;
+   static constexpr unsigned int CONTROL_RATE_DEFAULT = 0;
+   static constexpr const char* SENSORS_CFG = "sensors";
+   static constexpr const char* RATE_CFG = "rate";
+   static constexpr const char* DURATION_CFG = "duration";
+   static constexpr const char* SEED_CFG = "seed";
+   static constexpr const char* CONTROL_RATE_CFG = "control_rate";
+   static constexpr const char* TEMPERATURE_TOPIC = "TEMPERATURE";
+   // Stands for an actuator command, sent on the control channel while the fleet floods the bulk
+   // one
+   static constexpr const char* CONTROL_TOPIC = "CONTROL_PROBE";
+   static constexpr std::chrono::seconds SETTLE_TIME{1};
+
+   std::unique_ptr<SimulatedFleet> mFleet;
+   nlohmann::json mMessage;
+   Clock::duration mTickPeriod{};
+   Clock::time_point mStart;
+   Clock::time_point mEnd;
+   Clock::time_point mNextTick;
+   Clock::duration mControlPeriod{};
+   Clock::time_point mNextControl = Clock::time_point::max();
+   nlohmann::json mControlMessage;
+   ProcessStats mStartStats;
+   std::uint64_t mPublished = 0;
+   std::uint64_t mFailed = 0;
+   std::atomic<std::uint64_t> mReceived = 0;
+   std::atomic<std::uint64_t> mInvalid = 0;
+   LatencyHistogram mLatency;
+   std::uint64_t mControlPublished = 0;
+   std::atomic<std::uint64_t> mControlReceived = 0;
+   LatencyHistogram mControlLatency;
+
+   [[nodiscard]] bool onStarted() override;
+   void onStopped() override;
+   void mainLoop() override;
+
+   void onTemperature(const Result<void, SubscriberError>& error, const std::string& topic,
+                      const nlohmann::json& message);
+   // Sends the control probes due by now
+   void publishControl(Clock::time_point now);
+   void report();
+};
+
+#endif // LOADHARNESS_HPP
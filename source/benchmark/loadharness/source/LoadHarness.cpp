@@ -0,0 +1,206 @@
+#include "LoadHarness.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+bool LoadHarness::onStarted()
+{
+   const auto sensors = settingValue<unsigned int>(SENSORS_CFG).value_or(SENSORS_DEFAULT);
+   const auto rate = std::max(settingValue<unsigned int>(RATE_CFG).value_or(RATE_DEFAULT), 1U);
+   const auto duration = settingValue<unsigned int>(DURATION_CFG).value_or(DURATION_DEFAULT);
+   const auto seed = settingValue<unsigned int>(SEED_CFG).value_or(SEED_DEFAULT);
+   const auto controlRate =
+       settingValue<unsigned int>(CONTROL_RATE_CFG).value_or(CONTROL_RATE_DEFAULT);
+
+   logger().info("Simulating {} thermometers at {}Hz for {}s (seed {})", sensors, rate, duration,
+                 seed);
+   mFleet = std::make_unique<SimulatedFleet>(sensors, seed);
+   mTickPeriod = std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) / rate;
+   if (controlRate > 0)
+   {
+      // Whether it gets a channel of its own depends on a ControlPublisher port being configured,
+      // running with and without one compares the two
+      logger().info("Sending control probes at {}Hz", controlRate);
+      setTopicPriority(CONTROL_TOPIC, Priority::CONTROL);
+      mControlPeriod =
+          std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) / controlRate;
+   }
+
+   // Listening to ourselves through the real pub/sub stack to measure end to end latency
+   auto subscribed = subscribe(std::string(name()),
+                               [this](const Result<void, SubscriberError>& error,
+                                      const std::string& topic, const nlohmann::json& message) {
+                                  onTemperature(error, topic, message);
+                               });
+   if (!subscribed)
+   {
+      logger().err("Unable to subscribe to the simulated fleet: {}",
+                   subscribed.error().asString());
+      return false;
+   }
+
+   // The first publish opens the publisher, giving the subscriber some time to connect to it
+   mMessage["sensor"] = 0;
+   mMessage["temperature"] = 0.0F;
+   mMessage["sent"] = 0;
+   [[maybe_unused]] auto opened = publish(TEMPERATURE_TOPIC, mMessage);
+   mControlMessage["sent"] = 0;
+   if (mControlPeriod != Clock::duration::zero())
+   {
+      [[maybe_unused]] auto openedControl = publish(CONTROL_TOPIC, mControlMessage);
+   }
+   std::this_thread::sleep_for(SETTLE_TIME);
+   mReceived = 0;
+   mLatency.reset();
+   mControlReceived = 0;
+   mControlLatency.reset();
+
+   mStartStats = ProcessStats::current();
+   mStart = Clock::now();
+   mEnd = mStart + std::chrono::seconds(duration);
+   mNextTick = mStart;
+   if (mControlPeriod != Clock::duration::zero())
+   {
+      mNextControl = mStart;
+   }
+
+   return true;
+}
+
+void LoadHarness::mainLoop()
+{
+   if (Clock::now() >= mEnd)
+   {
+      stop();
+      return;
+   }
+
+   mFleet->step();
+   const auto temperatures = mFleet->temperatures();
+   for (std::size_t sensor = 0; sensor < temperatures.size(); sensor++)
+   {
+      mMessage["sensor"] = sensor;
+      mMessage["temperature"] = temperatures[sensor];
+      const auto now = Clock::now();
+      mMessage["sent"] = now.time_since_epoch().count();
+
+      if (publish(TEMPERATURE_TOPIC, mMessage))
+      {
+         mPublished++;
+      }
+      else
+      {
+         mFailed++;
+      }
+
+      // Probes are sent in the middle of the burst, which is when they would queue behind it
+      publishControl(now);
+   }
+
+   // Keeping the configured rate, if we are late we just go on as fast as we can
+   mNextTick += mTickPeriod;
+   while (mNextControl < mNextTick)
+   {
+      std::this_thread::sleep_until(mNextControl);
+      publishControl(Clock::now());
+   }
+   std::this_thread::sleep_until(mNextTick);
+}
+
+void LoadHarness::publishControl(const Clock::time_point now)
+{
+   if (now < mNextControl)
+   {
+      return;
+   }
+
+   mControlMessage["sent"] = now.time_since_epoch().count();
+   if (publish(CONTROL_TOPIC, mControlMessage))
+   {
+      mControlPublished++;
+   }
+   else
+   {
+      mFailed++;
+   }
+
+   // Like the fleet, probes missed while falling behind are not sent in a burst
+   mNextControl += mControlPeriod;
+   if (mNextControl <= now)
+   {
+      mNextControl = now + mControlPeriod;
+   }
+}
+
+void LoadHarness::onTemperature(const Result<void, SubscriberError>& error,
+                                const std::string& topic, const nlohmann::json& message)
+{
+   if (!error || (topic != TEMPERATURE_TOPIC && topic != CONTROL_TOPIC))
+   {
+      mInvalid++;
+      return;
+   }
+
+   const auto sent = Clock::time_point(Clock::duration(message["sent"].get<Clock::rep>()));
+   if (topic == CONTROL_TOPIC)
+   {
+      mControlLatency.record(Clock::now() - sent);
+      mControlReceived++;
+      return;
+   }
+
+   mLatency.record(Clock::now() - sent);
+   mReceived++;
+}
+
+void LoadHarness::onStopped()
+{
+   // Giving in flight messages the chance to be delivered before reporting
+   std::this_thread::sleep_for(SETTLE_TIME);
+   report();
+}
+
+void LoadHarness::report()
+{
+   using std::chrono::duration_cast;
+   using std::chrono::microseconds;
+   using std::chrono::milliseconds;
+
+   constexpr double PERCENT = 100;
+   constexpr std::size_t KIBIBYTE = 1024;
+
+   const auto elapsed = std::chrono::duration<double>(std::min(Clock::now(), mEnd) - mStart);
+   const auto seconds = std::max(elapsed.count(), std::numeric_limits<double>::epsilon());
+   const auto target = static_cast<double>(mFleet->size()) *
+                       (std::chrono::duration<double>(std::chrono::seconds(1)) / mTickPeriod);
+   const auto stats = ProcessStats::current();
+   const auto cpu =
+       (stats.userCpu - mStartStats.userCpu) + (stats.systemCpu - mStartStats.systemCpu);
+
+   logger().info("Published {} messages in {:.2f}s ({:.0f} msg/s, target {:.0f} msg/s), {} failed",
+                 mPublished, seconds, static_cast<double>(mPublished) / seconds, target, mFailed);
+   logger().info("Received {} messages ({:.0f} msg/s, {:.2f}% loss), {} invalid", mReceived.load(),
+                 static_cast<double>(mReceived) / seconds,
+                 mPublished == 0 ? 0.0
+                                 : PERCENT * (1.0 - static_cast<double>(mReceived) /
+                                                        static_cast<double>(mPublished)),
+                 mInvalid.load());
+   logger().info("Latency p50 {}us, p95 {}us, p99 {}us, max {}us",
+                 duration_cast<microseconds>(mLatency.percentile(0.5)).count(),
+                 duration_cast<microseconds>(mLatency.percentile(0.95)).count(),
+                 duration_cast<microseconds>(mLatency.percentile(0.99)).count(),
+                 duration_cast<microseconds>(mLatency.max()).count());
+   if (mControlPeriod != Clock::duration::zero())
+   {
+      logger().info("Control {} sent, {} received, latency p50 {}us, p99 {}us, max {}us",
+                    mControlPublished, mControlReceived.load(),
+                    duration_cast<microseconds>(mControlLatency.percentile(0.5)).count(),
+                    duration_cast<microseconds>(mControlLatency.percentile(0.99)).count(),
+                    duration_cast<microseconds>(mControlLatency.max()).count());
+   }
+   logger().info("CPU {}ms ({:.1f}% of a core), RSS {}KiB (peak {}KiB), {} threads",
+                 duration_cast<milliseconds>(cpu).count(),
+                 PERCENT * std::chrono::duration<double>(cpu).count() / seconds,
+                 stats.residentBytes / KIBIBYTE, stats.peakResidentBytes / KIBIBYTE, stats.threads);
+}
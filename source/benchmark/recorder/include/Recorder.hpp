@@ -0,0 +1,31 @@
+#ifndef RECORDER_HPP
+#define RECORDER_HPP
+
+#include <mutex>
+
+#include "RecorderBase.hpp"
+#include "Recording.hpp"
+
+class Recorder : public RecorderBase
+{
+private:
+   static constexpr const char* PATH_DEFAULT = "capture.rec";
+   static constexpr const char* PATH_CFG = "path";
+   static constexpr const char* COMPONENTS_CFG = "components";
+   static constexpr unsigned int FLUSH_PERIOD_DEFAULT = 1000;
+   static constexpr const char* FLUSH_PERIOD_CFG = "flush_period";
+   static constexpr unsigned int ERROR_LOG_RATE = 1;
+
+   std::mutex mWriterMutex;
+   RecordWriter mWriter;
+   RecordWriter::Clock::time_point mStart;
+   std::chrono::milliseconds mFlushPeriod{FLUSH_PERIOD_DEFAULT};
+
+   [[nodiscard]] bool onStarted() override;
+   void onStopped() override;
+   void mainLoop() override;
+
+   void onFrame(std::size_t source, std::string_view frame);
+};
+
+#endif // RECORDER_HPP
@@ -0,0 +1,91 @@
+#include "Recorder.hpp"
+
+#include <thread>
+
+bool Recorder::onStarted()
+{
+   // Recorded components are configured as components = ( "<component>", ... )
+   std::vector<std::string> components;
+   for (unsigned int index = 0;; index++)
+   {
+      auto component = settingValue<std::string>(std::string(COMPONENTS_CFG) + ".[" +
+                                                  std::to_string(index) + "]");
+      if (!component.has_value())
+      {
+         break;
+      }
+      components.push_back(component.value());
+   }
+
+   if (components.empty())
+   {
+      logger().err("No component to record");
+      return false;
+   }
+
+   const auto path =
+       std::filesystem::path(settingValue<std::string>(PATH_CFG).value_or(PATH_DEFAULT));
+   std::error_code error;
+   std::filesystem::create_directories(path.parent_path(), error);
+   auto opened = mWriter.open(path, components);
+   if (!opened)
+   {
+      logger().err("Unable to create capture {}: {}", path.string(), opened.error().asString());
+      return false;
+   }
+
+   for (std::size_t source = 0; source < components.size(); source++)
+   {
+      auto subscribed = subscribeFrames(
+          components[source], [this, source](std::string_view frame) { onFrame(source, frame); });
+      if (!subscribed)
+      {
+         logger().err("Unable to record {}: {}", components[source],
+                      subscribed.error().asString());
+         return false;
+      }
+      logger().info("Recording {} into {}", components[source], path.string());
+   }
+
+   mFlushPeriod = std::chrono::milliseconds(
+       settingValue<unsigned int>(FLUSH_PERIOD_CFG).value_or(FLUSH_PERIOD_DEFAULT));
+   mStart = RecordWriter::Clock::now();
+
+   return true;
+}
+
+void Recorder::onFrame(const std::size_t source, const std::string_view frame)
+{
+   // Taking the timestamp under the lock keeps them in the same order as the frames
+   std::lock_guard lock(mWriterMutex);
+   auto appended = mWriter.append(source, RecordWriter::Clock::now(), frame);
+   if (!appended)
+   {
+      GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                            "Unable to record frame: {}", appended.error().asString());
+   }
+}
+
+void Recorder::mainLoop()
+{
+   std::this_thread::sleep_for(mFlushPeriod);
+
+   std::lock_guard lock(mWriterMutex);
+   auto flushed = mWriter.flush();
+   if (!flushed)
+   {
+      GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                            "Unable to write capture: {}", flushed.error().asString());
+   }
+   logger().debug("Recorded {} frames so far", mWriter.frames());
+}
+
+void Recorder::onStopped()
+{
+   std::lock_guard lock(mWriterMutex);
+   mWriter.close();
+
+   const auto elapsed = std::chrono::duration<double>(RecordWriter::Clock::now() - mStart).count();
+   logger().info("Recorded {} frames ({} bytes) in {:.1f}s", mWriter.frames(), mWriter.bytes(),
+                 elapsed);
+}
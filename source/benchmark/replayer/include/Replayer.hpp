@@ -0,0 +1,42 @@
+#ifndef REPLAYER_HPP
+#define REPLAYER_HPP
+
+#include <chrono>
+#include <vector>
+
+#include "Recording.hpp"
+#include "ReplayerBase.hpp"
+
+// Publishes a capture again on the ports of the components it was recorded from, so their
+// subscribers receive it unchanged. Those components must not be running at the same time
+class Replayer : public ReplayerBase
+{
+private:
+   using Clock = std::chrono::steady_clock;
+
+   static constexpr const char* PATH_DEFAULT = "capture.rec";
+   static constexpr const char* PATH_CFG = "path";
+   // Multiple of the recorded pace, 0 replays as fast as possible
+   static constexpr unsigned int SPEED_DEFAULT = 1;
+   static constexpr const char* SPEED_CFG = "speed";
+   static constexpr unsigned int REPEAT_DEFAULT = 1;
+   static constexpr const char* REPEAT_CFG = "repeat";
+   static constexpr std::chrono::seconds SETTLE_TIME{1};
+   static constexpr unsigned int ERROR_LOG_RATE = 1;
+
+   RecordReader mReader;
+   std::vector<unsigned int> mPorts;
+   unsigned int mSpeed = SPEED_DEFAULT;
+   unsigned int mRepeat = REPEAT_DEFAULT;
+   unsigned int mPass = 0;
+   Clock::time_point mStart;
+   Clock::time_point mPassStart;
+   std::uint64_t mPublished = 0;
+   std::uint64_t mFailed = 0;
+
+   [[nodiscard]] bool onStarted() override;
+   void onStopped() override;
+   void mainLoop() override;
+};
+
+#endif // REPLAYER_HPP
@@ -0,0 +1,85 @@
+#include "Replayer.hpp"
+
+#include <thread>
+
+bool Replayer::onStarted()
+{
+   const auto path = settingValue<std::string>(PATH_CFG).value_or(PATH_DEFAULT);
+   auto opened = mReader.open(path);
+   if (!opened)
+   {
+      logger().err("Unable to open capture {}: {}", path, opened.error().asString());
+      return false;
+   }
+
+   mPorts.clear();
+   for (const auto& source : mReader.sources())
+   {
+      auto port = publishPort(source);
+      if (!port.has_value())
+      {
+         logger().err("Network configuration is missing for the recorded {} component", source);
+         return false;
+      }
+      mPorts.push_back(port.value());
+      openPublisher(port.value());
+   }
+
+   mSpeed = settingValue<unsigned int>(SPEED_CFG).value_or(SPEED_DEFAULT);
+   mRepeat = std::max(settingValue<unsigned int>(REPEAT_CFG).value_or(REPEAT_DEFAULT), 1U);
+   logger().info("Replaying {} {} times at {}", path, mRepeat,
+                 mSpeed == 0 ? std::string("maximum speed") : std::to_string(mSpeed) + "x");
+
+   // Giving subscribers some time to connect before the first frame
+   std::this_thread::sleep_for(SETTLE_TIME);
+
+   mPass = 0;
+   mPublished = 0;
+   mFailed = 0;
+   mStart = Clock::now();
+   mPassStart = mStart;
+
+   return true;
+}
+
+void Replayer::mainLoop()
+{
+   Frame frame;
+   if (!mReader.next(frame))
+   {
+      if (++mPass == mRepeat)
+      {
+         stop();
+         return;
+      }
+
+      mReader.rewind();
+      mPassStart = Clock::now();
+      return;
+   }
+
+   if (mSpeed != 0)
+   {
+      std::this_thread::sleep_until(
+          mPassStart + std::chrono::duration_cast<Clock::duration>(frame.timestamp / mSpeed));
+   }
+
+   auto published = publish(mPorts[frame.source], frame.data);
+   if (published)
+   {
+      mPublished++;
+   }
+   else
+   {
+      mFailed++;
+      GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                            "Unable to replay frame: {}", published.error().asString());
+   }
+}
+
+void Replayer::onStopped()
+{
+   const auto elapsed = std::chrono::duration<double>(Clock::now() - mStart).count();
+   logger().info("Replayed {} frames in {:.2f}s ({:.0f} frames/s), {} failed", mPublished, elapsed,
+                 static_cast<double>(mPublished) / std::max(elapsed, 1e-9), mFailed);
+}
@@ -0,0 +1,26 @@
+#ifndef GATEWAY_HPP
+#define GATEWAY_HPP
+
+#include <chrono>
+
+#include "GatewayBase.hpp"
+#include "GatewayServer.hpp"
+
+// Subscribes once to every configured component and serves their traffic on a single port. Clients
+// send "<component> <topic>" lines, "*" matching anything, and only get the frames they asked for
+class Gateway : public GatewayBase
+{
+private:
+   static constexpr unsigned int PORT_DEFAULT = 7500;
+   static constexpr const char* PORT_CFG = "port";
+   static constexpr const char* COMPONENTS_CFG = "components";
+   static constexpr std::chrono::milliseconds POLL_TIMEOUT{100};
+
+   GatewayServer mServer;
+
+   [[nodiscard]] bool onStarted() override;
+   void onStopped() override;
+   void mainLoop() override;
+};
+
+#endif // GATEWAY_HPP
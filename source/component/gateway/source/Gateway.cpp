@@ -0,0 +1,52 @@
+#include "Gateway.hpp"
+
+bool Gateway::onStarted()
+{
+   const auto port = settingValue<unsigned int>(PORT_CFG).value_or(PORT_DEFAULT);
+   auto listening = mServer.listen(port);
+   if (!listening)
+   {
+      logger().err("Unable to serve on port {}: {}", port, listening.error().asString());
+      return false;
+   }
+
+   // Served components are configured as components = ( "<component>", ... )
+   for (unsigned int index = 0;; index++)
+   {
+      auto component = settingValue<std::string>(std::string(COMPONENTS_CFG) + ".[" +
+                                                  std::to_string(index) + "]");
+      if (!component.has_value())
+      {
+         if (index == 0)
+         {
+            logger().warn("No component to serve");
+         }
+         break;
+      }
+
+      auto subscribed = subscribeFrames(
+          component.value(), [this, name = component.value()](std::string_view frame) {
+             mServer.dispatch(name, frame);
+          });
+      if (!subscribed)
+      {
+         logger().err("Unable to serve {}: {}", component.value(), subscribed.error().asString());
+         return false;
+      }
+      logger().info("Serving {} on port {}", component.value(), port);
+   }
+
+   return true;
+}
+
+void Gateway::mainLoop()
+{
+   mServer.poll(POLL_TIMEOUT);
+}
+
+void Gateway::onStopped()
+{
+   logger().info("Stopped serving {} clients, {} frames dropped for slow clients",
+                 mServer.sessions(), mServer.dropped());
+   mServer.close();
+}
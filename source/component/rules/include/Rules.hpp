@@ -0,0 +1,32 @@
+#ifndef RULES_HPP
+#define RULES_HPP
+
+#include <chrono>
+#include <mutex>
+
+#include "RuleEngine.hpp"
+#include "RulesBase.hpp"
+
+// Evaluates the configured rules on the messages of the components they watch. Every time a rule
+// changes state {"rule": "<name>", "active": true/false, "value": <value>} is published on its
+// action topic
+class Rules : public RulesBase
+{
+private:
+   static constexpr const char* RULES_CFG = "rules";
+   static constexpr std::chrono::milliseconds IDLE_PERIOD{100};
+   static constexpr unsigned int ERROR_LOG_RATE = 1;
+
+   std::mutex mEngineMutex;
+   RuleEngine mEngine;
+
+   [[nodiscard]] bool onStarted() override;
+   void onStopped() override;
+   void mainLoop() override;
+
+   [[nodiscard]] bool loadRules();
+   void onMessage(RuleEngine::ComponentPlan& plan, const Result<void, SubscriberError>& error,
+                  const std::string& topic, const nlohmann::json& message);
+};
+
+#endif // RULES_HPP
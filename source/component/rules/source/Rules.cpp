@@ -0,0 +1,135 @@
+#include "Rules.hpp"
+
+#include <thread>
+
+bool Rules::onStarted()
+{
+   if (!loadRules())
+   {
+      return false;
+   }
+
+   for (const auto& component : mEngine.components())
+   {
+      auto* plan = mEngine.plan(component);
+      auto subscribed =
+          subscribe(component, [this, plan](const Result<void, SubscriberError>& error,
+                                            const std::string& topic,
+                                            const nlohmann::json& message) {
+             onMessage(*plan, error, topic, message);
+          });
+      if (!subscribed)
+      {
+         logger().err("Unable to subscribe to {}: {}", component, subscribed.error().asString());
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool Rules::loadRules()
+{
+   // Rules are configured as rules = ( { name = ""; component = ""; topic = ""; field = "";
+   // sensor = ""; condition = ">"; threshold = 28.0; hysteresis = 1.0; duration = <ms>;
+   // action = ""; }, ... ), the sensor being optional
+   for (unsigned int index = 0;; index++)
+   {
+      const auto entry = std::string(RULES_CFG) + ".[" + std::to_string(index) + "].";
+      auto name = settingValue<std::string>(entry + "name");
+      if (!name.has_value())
+      {
+         break;
+      }
+
+      const auto symbol = settingValue<std::string>(entry + "condition").value_or("");
+      auto condition = Rule::parseCondition(symbol);
+      auto threshold = settingNumber(entry + "threshold");
+      if (!condition.has_value() || !threshold.has_value())
+      {
+         logger().err("Rule {} has an invalid condition or threshold", name.value());
+         return false;
+      }
+
+      auto added = mEngine.add(Rule{
+          .name = name.value(),
+          .component = settingValue<std::string>(entry + "component").value_or(""),
+          .topic = settingValue<std::string>(entry + "topic").value_or(""),
+          .field = settingValue<std::string>(entry + "field").value_or(""),
+          .sensor = settingValue<std::string>(entry + "sensor").value_or(""),
+          .condition = condition.value(),
+          .threshold = threshold.value(),
+          .hysteresis = settingNumber(entry + "hysteresis").value_or(0),
+          .duration =
+              std::chrono::milliseconds(settingValue<unsigned int>(entry + "duration").value_or(0)),
+          .action = settingValue<std::string>(entry + "action").value_or("")});
+      if (!added)
+      {
+         logger().err("Unable to load rule {}: {}", name.value(),
+                      added.error().furtherInfo().value_or(added.error().asString()));
+         return false;
+      }
+
+      // Actions drive actuators, they must not wait behind whatever else we publish
+      setTopicPriority(mEngine.rules().back().action, Priority::CONTROL);
+   }
+
+   mEngine.compile();
+   if (mEngine.rules().empty())
+   {
+      logger().warn("No rules configured, nothing will be evaluated");
+   }
+   else
+   {
+      logger().info("Evaluating {} rules on {} components", mEngine.rules().size(),
+                    mEngine.components().size());
+   }
+
+   return true;
+}
+
+void Rules::onMessage(RuleEngine::ComponentPlan& plan, const Result<void, SubscriberError>& error,
+                      const std::string& topic, const nlohmann::json& message)
+{
+   if (!error)
+   {
+      GROW_LOG_RATE_LIMITED(logger(), Logger::Level::warn, ERROR_LOG_RATE, "Invalid message: {}",
+                            error.error().asString());
+      return;
+   }
+
+   // Transitions are rare, so this only allocates when a rule fires
+   std::vector<RuleEngine::Transition> transitions;
+   {
+      std::lock_guard lock(mEngineMutex);
+      mEngine.evaluate(plan, topic, message, RuleEngine::Clock::now(), transitions);
+   }
+
+   for (const auto& transition : transitions)
+   {
+      logger().info("Rule {} is now {} ({})", transition.rule->name,
+                    transition.active ? "active" : "inactive", transition.value);
+
+      nlohmann::json action;
+      action["rule"] = transition.rule->name;
+      action["active"] = transition.active;
+      action["value"] = transition.value;
+      auto published = publish(transition.rule->action, action);
+      if (!published)
+      {
+         GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                               "Unable to publish {} action: {}", transition.rule->action,
+                               published.error().asString());
+      }
+   }
+}
+
+void Rules::mainLoop()
+{
+   // Everything happens as messages arrive
+   std::this_thread::sleep_for(IDLE_PERIOD);
+}
+
+void Rules::onStopped()
+{
+}
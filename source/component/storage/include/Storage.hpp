@@ -0,0 +1,81 @@
+#ifndef STORAGE_HPP
+#define STORAGE_HPP
+
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <set>
+
+#include "Query.hpp"
+#include "Rollup.hpp"
+#include "Series.hpp"
+#include "StorageBase.hpp"
+
+// Stores the configured series and answers range queries over them. Components listed as clients
+// publish {"id": ..., "series": "<component>.<topic>.<field>[.<sensor>]", "from": ms, "to": ms,
+// "width": ms}
+// on QUERY and get {"id": ..., "client": "<component>", "buckets": [...]} or {..., "error": ""}
+// back on QUERY_RESULT
+class Storage : public StorageBase
+{
+private:
+   static constexpr const char* PATH_DEFAULT = "/var/lib/grow";
+   static constexpr const char* PATH_CFG = "path";
+   static constexpr unsigned int FLUSH_PERIOD_DEFAULT = 1000;
+   static constexpr const char* FLUSH_PERIOD_CFG = "flush_period";
+   static constexpr const char* SERIES_CFG = "series";
+   static constexpr const char* ROLLUPS_CFG = "rollups";
+   static constexpr const char* CLIENTS_CFG = "clients";
+   static constexpr const char* SAMPLES_FIELD = "samples";
+   static constexpr const char* TIMESTAMP_FIELD = "timestamp";
+   static constexpr const char* SENSOR_FIELD = "sensor";
+   static constexpr const char* SERIES_EXTENSION = ".series";
+   static constexpr const char* ROLLUP_EXTENSION = ".rollup";
+   static constexpr const char* QUERY_TOPIC = "QUERY";
+   static constexpr const char* QUERY_RESULT_TOPIC = "QUERY_RESULT";
+   static constexpr unsigned int ERROR_LOG_RATE = 1;
+
+   // A numeric field of the messages published by a component on a topic, stored as one file
+   // along with a file per rollup tier. Keyed by sensor it only keeps the samples of that sensor,
+   // whose timestamps would otherwise interleave with the ones of the others
+   struct Series
+   {
+      std::string component;
+      std::string topic;
+      std::string field;
+      std::string sensor;
+      std::filesystem::path path;
+      SeriesWriter writer;
+      std::deque<RollupWriter> rollups;
+
+      [[nodiscard]] inline std::string name() const
+      {
+         return component + "." + topic + "." + field + (sensor.empty() ? "" : "." + sensor);
+      }
+   };
+
+   std::filesystem::path mPath;
+   std::chrono::milliseconds mFlushPeriod{FLUSH_PERIOD_DEFAULT};
+   std::mutex mSeriesMutex;
+   std::deque<Series> mSeries;
+   std::vector<std::int64_t> mRollupWidths;
+   std::set<std::string> mClients;
+   QueryEngine mQueryEngine;
+
+   [[nodiscard]] bool onStarted() override;
+   void onStopped() override;
+   void mainLoop() override;
+
+   [[nodiscard]] bool loadSeries();
+   void loadQueryConfiguration();
+   void onMessage(const std::string& component, const Result<void, SubscriberError>& error,
+                  const std::string& topic, const nlohmann::json& message);
+   void store(Series& series, const nlohmann::json& sample, std::int64_t receivedAt);
+   void flush();
+   void flush(Series& series);
+   void onQuery(const std::string& client, const nlohmann::json& request);
+   [[nodiscard]] Result<std::vector<Bucket>, StorageError> query(const nlohmann::json& request);
+   [[nodiscard]] std::filesystem::path rollupPath(const Series& series, std::int64_t width) const;
+};
+
+#endif // STORAGE_HPP
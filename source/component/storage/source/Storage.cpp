@@ -0,0 +1,366 @@
+#include "Storage.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+bool Storage::onStarted()
+{
+   mPath = settingValue<std::string>(PATH_CFG).value_or(PATH_DEFAULT);
+   mFlushPeriod = std::chrono::milliseconds(
+       settingValue<unsigned int>(FLUSH_PERIOD_CFG).value_or(FLUSH_PERIOD_DEFAULT));
+   std::error_code error;
+   std::filesystem::create_directories(mPath, error);
+   if (error)
+   {
+      logger().err("Unable to create storage folder {}: {}", mPath.string(), error.message());
+      return false;
+   }
+
+   loadQueryConfiguration();
+   if (!loadSeries())
+   {
+      return false;
+   }
+
+   // Every component publishes on a single port, so all of its series and queries share a
+   // subscription
+   std::set<std::string> components = mClients;
+   for (const auto& series : mSeries)
+   {
+      components.insert(series.component);
+   }
+
+   for (const auto& component : components)
+   {
+      auto subscribed = subscribe(component, [this, component](
+                                                 const Result<void, SubscriberError>& error,
+                                                 const std::string& topic,
+                                                 const nlohmann::json& message) {
+         onMessage(component, error, topic, message);
+      });
+      if (!subscribed)
+      {
+         logger().warn("Unable to subscribe to {}, its series will not be stored: {}", component,
+                       subscribed.error().asString());
+      }
+   }
+
+   return true;
+}
+
+bool Storage::loadSeries()
+{
+   // Series are configured as series = ( { component = ""; topic = ""; field = ""; sensor = ""; },
+   // ... ), the sensor being optional
+   for (unsigned int index = 0;; index++)
+   {
+      const auto entry = std::string(SERIES_CFG) + ".[" + std::to_string(index) + "].";
+      auto component = settingValue<std::string>(entry + "component");
+      auto topic = settingValue<std::string>(entry + "topic");
+      auto field = settingValue<std::string>(entry + "field");
+      if (!component.has_value() || !topic.has_value() || !field.has_value())
+      {
+         break;
+      }
+
+      auto& series = mSeries.emplace_back();
+      series.component = component.value();
+      series.topic = topic.value();
+      series.field = field.value();
+      series.sensor = settingValue<std::string>(entry + "sensor").value_or("");
+
+      series.path = mPath / (series.name() + SERIES_EXTENSION);
+      auto opened = series.writer.open(series.path);
+      if (!opened)
+      {
+         logger().err("Unable to open series {}: {} ({})", series.path.string(),
+                      opened.error().asString(), opened.error().furtherInfo().value_or(""));
+         return false;
+      }
+
+      for (const auto width : mRollupWidths)
+      {
+         auto rollupOpened = series.rollups.emplace_back().open(rollupPath(series, width), width);
+         if (!rollupOpened)
+         {
+            logger().err("Unable to open {}ms rollup of {}: {}", width, series.name(),
+                         rollupOpened.error().asString());
+            return false;
+         }
+      }
+
+      logger().info("Storing {} into {} ({} samples already stored)", series.name(),
+                    series.path.string(), series.writer.count());
+   }
+
+   if (mSeries.empty())
+   {
+      logger().warn("No series configured, nothing will be stored");
+   }
+
+   return true;
+}
+
+void Storage::loadQueryConfiguration()
+{
+   // Rollup tiers are configured as rollups = ( <width in ms>, ... )
+   mRollupWidths.clear();
+   for (unsigned int index = 0;; index++)
+   {
+      auto width =
+          settingValue<unsigned int>(std::string(ROLLUPS_CFG) + ".[" + std::to_string(index) + "]");
+      if (!width.has_value())
+      {
+         break;
+      }
+      if (width.value() > 0)
+      {
+         mRollupWidths.push_back(width.value());
+      }
+   }
+
+   // Components allowed to query are configured as clients = ( "<component>", ... )
+   mClients.clear();
+   for (unsigned int index = 0;; index++)
+   {
+      auto client =
+          settingValue<std::string>(std::string(CLIENTS_CFG) + ".[" + std::to_string(index) + "]");
+      if (!client.has_value())
+      {
+         break;
+      }
+      mClients.insert(client.value());
+   }
+}
+
+std::filesystem::path Storage::rollupPath(const Series& series, const std::int64_t width) const
+{
+   return mPath / (series.name() + "." + std::to_string(width) + ROLLUP_EXTENSION);
+}
+
+void Storage::onMessage(const std::string& component, const Result<void, SubscriberError>& error,
+                        const std::string& topic, const nlohmann::json& message)
+{
+   if (!error)
+   {
+      GROW_LOG_RATE_LIMITED(logger(), Logger::Level::warn, ERROR_LOG_RATE,
+                            "Invalid message from {}: {}", component, error.error().asString());
+      return;
+   }
+
+   if (topic == QUERY_TOPIC && mClients.contains(component))
+   {
+      onQuery(component, message);
+      return;
+   }
+
+   // Messages without their own timestamp are stored as received
+   const auto receivedAt = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               std::chrono::system_clock::now().time_since_epoch())
+                               .count();
+
+   std::lock_guard lock(mSeriesMutex);
+   for (auto& series : mSeries)
+   {
+      if (series.component != component || series.topic != topic)
+      {
+         continue;
+      }
+
+      // Batches carry their samples in an array, each with its own timestamp
+      const auto samples = message.find(SAMPLES_FIELD);
+      if (samples != message.end() && samples->is_array())
+      {
+         for (const auto& sample : *samples)
+         {
+            store(series, sample, receivedAt);
+         }
+      }
+      else
+      {
+         store(series, message, receivedAt);
+      }
+   }
+}
+
+void Storage::store(Series& series, const nlohmann::json& sample, const std::int64_t receivedAt)
+{
+   if (!series.sensor.empty())
+   {
+      const auto sensor = sample.find(SENSOR_FIELD);
+      if (sensor == sample.end() || !sensor->is_string() ||
+          sensor->get<std::string>() != series.sensor)
+      {
+         return;
+      }
+   }
+
+   const auto value = sample.find(series.field);
+   if (value == sample.end() || !value->is_number())
+   {
+      return;
+   }
+
+   const auto timestamp = sample.find(TIMESTAMP_FIELD);
+   const auto sampledAt = (timestamp != sample.end() && timestamp->is_number_integer())
+                              ? timestamp->get<std::int64_t>()
+                              : receivedAt;
+   auto appended = series.writer.append(sampledAt, value->get<float>());
+   if (!appended)
+   {
+      GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                            "Unable to store {}.{} sample: {}", series.topic, series.field,
+                            appended.error().asString());
+      return;
+   }
+
+   for (auto& rollup : series.rollups)
+   {
+      auto added = rollup.add(sampledAt, value->get<float>());
+      if (!added)
+      {
+         GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                               "Unable to update {}ms rollup of {}: {}", rollup.width(),
+                               series.name(), added.error().asString());
+      }
+   }
+}
+
+void Storage::mainLoop()
+{
+   std::this_thread::sleep_for(mFlushPeriod);
+
+   flush();
+}
+
+void Storage::flush()
+{
+   std::lock_guard lock(mSeriesMutex);
+   for (auto& series : mSeries)
+   {
+      flush(series);
+   }
+}
+
+void Storage::flush(Series& series)
+{
+   auto flushed = series.writer.flush();
+   for (auto& rollup : series.rollups)
+   {
+      if (flushed)
+      {
+         flushed = rollup.flush();
+      }
+   }
+
+   if (!flushed)
+   {
+      GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                            "Unable to flush {}: {}", series.name(), flushed.error().asString());
+   }
+}
+
+void Storage::onStopped()
+{
+   flush();
+
+   std::lock_guard lock(mSeriesMutex);
+   for (auto& series : mSeries)
+   {
+      series.writer.close();
+      for (auto& rollup : series.rollups)
+      {
+         rollup.close();
+      }
+   }
+}
+
+void Storage::onQuery(const std::string& client, const nlohmann::json& request)
+{
+   nlohmann::json response;
+   response["client"] = client;
+   response["id"] = request.value("id", nlohmann::json());
+
+   auto buckets = query(request);
+   if (buckets)
+   {
+      auto& results = response["buckets"] = nlohmann::json::array();
+      for (const auto& bucket : buckets.value())
+      {
+         results.push_back({{"start", bucket.start},
+                            {"min", bucket.min},
+                            {"max", bucket.max},
+                            {"mean", bucket.mean()},
+                            {"last", bucket.last},
+                            {"count", bucket.count}});
+      }
+      logger().debug("Answered {} query with {} buckets", client, buckets.value().size());
+   }
+   else
+   {
+      response["error"] = std::string(buckets.error().furtherInfo().value_or(
+          buckets.error().asString()));
+      logger().debug("Rejected {} query: {}", client, response["error"].get<std::string>());
+   }
+
+   auto published = publish(QUERY_RESULT_TOPIC, response);
+   if (!published)
+   {
+      GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                            "Unable to publish query result: {}", published.error().asString());
+   }
+}
+
+Result<std::vector<Bucket>, StorageError> Storage::query(const nlohmann::json& request)
+{
+   const auto name = request.find("series");
+   const auto from = request.find("from");
+   const auto to = request.find("to");
+   const auto width = request.find("width");
+   if (name == request.end() || !name->is_string() || from == request.end() ||
+       !from->is_number_integer() || to == request.end() || !to->is_number_integer() ||
+       width == request.end() || !width->is_number_integer())
+   {
+      return Error(StorageError::INVALID_QUERY, "Query needs series, from, to and width");
+   }
+
+   const auto series =
+       std::find_if(mSeries.begin(), mSeries.end(), [&name](const Series& candidate) {
+          return candidate.name() == name->get<std::string>();
+       });
+   if (series == mSeries.end())
+   {
+      return Error(StorageError::INVALID_QUERY, "Unknown series");
+   }
+
+   // Flushing first so that the query sees everything received so far, then reading without
+   // holding back ingestion: readers only trust the headers they mapped
+   {
+      std::lock_guard lock(mSeriesMutex);
+      flush(*series);
+   }
+
+   SeriesReader reader;
+   auto opened = reader.open(series->path);
+   if (!opened)
+   {
+      return opened.error();
+   }
+
+   std::deque<RollupReader> rollups;
+   std::vector<const RollupReader*> tiers;
+   for (const auto rollupWidth : mRollupWidths)
+   {
+      auto& rollup = rollups.emplace_back();
+      if (rollup.open(rollupPath(*series, rollupWidth), rollupWidth))
+      {
+         tiers.push_back(&rollup);
+      }
+   }
+
+   return mQueryEngine.run({.from = from->get<std::int64_t>(),
+                            .to = to->get<std::int64_t>(),
+                            .width = width->get<std::int64_t>()},
+                           reader, tiers);
+}
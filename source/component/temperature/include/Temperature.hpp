@@ -1,29 +1,92 @@
 #ifndef TEMPERATURE_HPP
 #define TEMPERATURE_HPP
 
+#include <chrono>
 #include <memory>
+#include <span>
+#include <vector>
 
+#include "QuantileSketch.hpp"
 #include "TemperatureBase.hpp"
+#include "TemperatureTopics.hpp"
 #include "Thermometer.hpp"
+#include "ThermometerPool.hpp"
 
 class Temperature : public TemperatureBase
 {
 public:
-   Temperature();
+   Temperature() = default;
 
 private:
    static constexpr unsigned int POLL_TIME_DEFAULT = 1000;
    static constexpr const char* POLL_TIME_CFG = "poll_time";
-   static constexpr const char* TEMPERATURE_TOPIC = "TEMPERATURE";
+   // Answered with the polling period in milliseconds, as text
+   static constexpr const char* POLL_TIME_METHOD = "poll_time";
+   static constexpr unsigned int READ_TIMEOUT_DEFAULT = 2000;
+   static constexpr const char* READ_TIMEOUT_CFG = "read_timeout";
+   static constexpr std::chrono::milliseconds STOP_CHECK_PERIOD{100};
+   static constexpr const char* SAMPLE_RATE_CFG = "sample_rate";
+   static constexpr const char* SIMULATED_LATENCY_CFG = "simulated_latency";
+   static constexpr const char* SIMULATED_FAILURE_RATE_CFG = "simulated_failure_rate";
+   static constexpr const char* BATCH_SIZE_CFG = "batch_size";
+   static constexpr const char* SENSORS_CFG = "sensors";
+   static constexpr const char* SENSOR_ID_CFG = "id";
+   static constexpr const char* SENSOR_PERIOD_CFG = "period";
+   static constexpr const char* WORKERS_CFG = "workers";
+   static constexpr unsigned int WORKERS_DEFAULT = 4;
+   static constexpr const char* AGGREGATION_CFG = "aggregation";
+   static constexpr const char* PUBLISH_RAW_CFG = "publish_raw";
+   static constexpr const char* DEADBAND_CFG = "deadband";
+   static constexpr const char* SKETCH_CFG = "sketch";
+   static constexpr const char* SKETCH_PERIOD_CFG = "period";
+   static constexpr unsigned int SKETCH_PERIOD_DEFAULT = 3600000;
+   static constexpr const char* SKETCH_COMPRESSION_CFG = "compression";
+   static constexpr unsigned int ERROR_LOG_RATE = 1;
+
+   using TemperatureSample = Thermometer::TemperatureSample;
 
    std::unique_ptr<Thermometer> mThermometer;
+   // Polls the configured sensors instead of mThermometer when there is a list of them
+   std::unique_ptr<ThermometerPool> mPool;
+   // Batches read from the device FIFO, when configured with a batch size
+   std::shared_ptr<Thermometer::TemperatureBuffer> mSamples;
+   // Kept across publishes so that its samples do not have to be allocated again
+   TemperatureBatch mBatch;
+   // One per sensor when aggregating, so that each window only ever sees a single sensor
+   std::vector<Aggregator> mAggregators;
+   bool mPublishRaw = true;
+   // One per sensor when reporting by exception, every sample is published otherwise
+   std::vector<Deadband> mDeadbands;
+   // One per sensor, the distribution of the temperatures seen since mSketchStart
+   std::vector<QuantileSketch> mSketches;
+   Deadband::Clock::time_point mSketchStart;
+   TemperatureSketch mSketch;
+   TimerWheel::TimerId mSketchTimer = 0;
+   // Read once started instead of looked up on every iteration
+   std::chrono::milliseconds mPollTime{POLL_TIME_DEFAULT};
+   std::chrono::milliseconds mReadTimeout{READ_TIMEOUT_DEFAULT};
+
+   // Creates the build time device, its settings read at <component>.<path><setting>
+   [[nodiscard]] std::unique_ptr<Thermometer> makeThermometer(const std::string& path = "");
+   [[nodiscard]] std::unique_ptr<ThermometerPool> makePool();
 
    [[nodiscard]] unsigned int pollTime();
+   [[nodiscard]] unsigned int readTimeout();
    [[nodiscard]] bool onStarted() override;
    void onStopped() override;
    void mainLoop() override;
+   void measureTemperature();
+   void measureTemperatures();
+   void measureSensors();
+   void aggregate(std::size_t sensor, float temperature);
+   [[nodiscard]] bool startSketches();
+   void publishSketches();
+   [[nodiscard]] Deadband::Report report(std::size_t sensor, const TemperatureSample& sample);
 
-   [[nodiscard]] std::optional<Error<PublishError>> publishTemperature(float temperature);
+   [[nodiscard]] Result<void, PublishError> publishTemperature(float temperature,
+                                                               bool heartbeat = false);
+   [[nodiscard]] Result<void, PublishError>
+   publishTemperatures(std::span<const TemperatureSample> samples);
 };
 
 #endif // TEMPERATURE_HPP
@@ -4,53 +4,295 @@
 
 #include "SimulatedThermometer.hpp"
 
-Temperature::Temperature()
+std::unique_ptr<Thermometer> Temperature::makeThermometer(const std::string& path)
 {
 #ifndef THERMOMETER_DEVICE
    static_assert(false, "The thermometer device was not set for this build");
 #else
-   if (std::string(THERMOMETER_DEVICE) == "SimulatedThermometer")
-   {
-      mThermometer = std::make_unique<SimulatedThermometer>();
-   }
-   else
+   if (std::string(THERMOMETER_DEVICE) != "SimulatedThermometer")
    {
       logger().warn(
           "No valid thermometer device specified at build time, going with simulated hardware");
-      mThermometer = std::make_unique<SimulatedThermometer>();
    }
+
+   constexpr float PERCENT = 100;
+   auto thermometer = std::make_unique<SimulatedThermometer>(
+       settingValue<unsigned int>(path + SAMPLE_RATE_CFG).value_or(0));
+   thermometer->setLatency(std::chrono::milliseconds(
+       settingValue<unsigned int>(path + SIMULATED_LATENCY_CFG).value_or(0)));
+   thermometer->setFailureRate(
+       static_cast<float>(
+           settingValue<unsigned int>(path + SIMULATED_FAILURE_RATE_CFG).value_or(0)) /
+       PERCENT);
+
+   return thermometer;
 #endif
 }
 
+std::unique_ptr<ThermometerPool> Temperature::makePool()
+{
+   // Sensors are configured as sensors = ( { id = ""; period = <ms>; simulated_latency = <ms>;
+   // simulated_failure_rate = <percent>; }, ... ), all of them being the build time device
+   std::vector<std::pair<std::string, unsigned int>> sensors;
+   for (unsigned int index = 0;; index++)
+   {
+      const auto entry = std::string(SENSORS_CFG) + ".[" + std::to_string(index) + "].";
+      auto id = settingValue<std::string>(entry + SENSOR_ID_CFG);
+      if (!id.has_value())
+      {
+         break;
+      }
+
+      const auto period = settingValue<unsigned int>(entry + SENSOR_PERIOD_CFG);
+      sensors.emplace_back(id.value(), period.value_or(mPollTime.count()));
+   }
+
+   if (sensors.empty())
+   {
+      return nullptr;
+   }
+
+   // Workers mostly wait on their device, with little memory to spare a single one does
+   const auto workers = std::min<std::size_t>(
+       settingValue<unsigned int>(WORKERS_CFG).value_or(lowMemory() ? 1 : WORKERS_DEFAULT),
+       sensors.size());
+   auto pool = std::make_unique<ThermometerPool>(workers);
+   for (std::size_t index = 0; index < sensors.size(); index++)
+   {
+      const auto& [id, period] = sensors[index];
+      const auto entry = std::string(SENSORS_CFG) + ".[" + std::to_string(index) + "].";
+      pool->add(id, makeThermometer(entry), std::chrono::milliseconds(period));
+      logger().info("Polling sensor {} every {}ms", id, period);
+   }
+
+   logger().info("Polling {} sensors on {} workers", pool->size(), pool->workers());
+   return pool;
+}
+
 void Temperature::mainLoop()
 {
-   // Registering and publishing temperature
-   auto measured = mThermometer->temperature();
+   if (mPool)
+   {
+      measureSensors();
+
+      // Waking up every now and then until the next sensor is due, so that we never keep from
+      // stopping for longer than a check period
+      const auto due = mPool->nextDue();
+      while (running() && ThermometerPool::Clock::now() < due)
+      {
+         std::this_thread::sleep_until(
+             std::min(due, ThermometerPool::Clock::now() + STOP_CHECK_PERIOD));
+      }
+      return;
+   }
 
-   if (measured.has_value())
+   if (!mSamples)
    {
-      logger().debug("Registered temperature {}C", measured.value());
-      auto publishError = publishTemperature(measured.value());
-      if (publishError.has_value())
+      measureTemperature();
+   }
+   else
+   {
+      measureTemperatures();
+   }
+
+   std::this_thread::sleep_for(mPollTime);
+}
+
+void Temperature::measureTemperature()
+{
+   // Reading asynchronously so that a slow or hung device does not keep us from stopping
+   std::optional<TraceSpan> reading;
+   reading.emplace("temperature.read");
+   auto read = mThermometer->readTemperature(mReadTimeout);
+   while (read.wait_for(STOP_CHECK_PERIOD) != std::future_status::ready)
+   {
+      if (!running())
       {
-         logger().err("Unable to publish temperature value: {}", publishError.value().asString());
+         return;
       }
-      else
+   }
+   reading.reset();
+
+   // Registering and publishing temperature
+   auto measured = read.get();
+
+   if (measured)
+   {
+      const auto temperature = measured.value().value;
+      logger().debug("Registered temperature {}C", temperature);
+      const auto reported = report(0, measured.value());
+      if (mPublishRaw && reported != Deadband::Report::NONE)
       {
-         logger().trace("Temperature value published ({}C)", measured.value());
+         auto published =
+             publishTemperature(temperature, reported == Deadband::Report::HEARTBEAT);
+         if (!published)
+         {
+            GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                                  "Unable to publish temperature value: {}",
+                                  published.error().asString());
+         }
+         else
+         {
+            logger().trace("Temperature value published ({}C)", temperature);
+         }
       }
+
+      aggregate(0, temperature);
    }
    else
    {
-      logger().err("Unable to get temperature from {}", mThermometer->name());
+      GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                            "Unable to get temperature from {}: {}", mThermometer->name(),
+                            measured.error().asString());
    }
+}
+
+void Temperature::measureTemperatures()
+{
+   // Draining whatever the device buffered since the last iteration, one batch at a time. As for
+   // single readings the device is read asynchronously, and a device filling up as fast as it is
+   // drained is left alone once we are asked to stop
+   std::size_t measured = 0;
+   do
+   {
+      std::optional<TraceSpan> reading;
+      reading.emplace("temperature.read");
+      auto read = mThermometer->readTemperatures(mSamples, mReadTimeout);
+      while (read.wait_for(STOP_CHECK_PERIOD) != std::future_status::ready)
+      {
+         if (!running())
+         {
+            return;
+         }
+      }
+      reading.reset();
+
+      auto batch = read.get();
+      if (!batch)
+      {
+         GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                               "Unable to get temperature samples from {}: {}",
+                               mThermometer->name(), batch.error().asString());
+         break;
+      }
+
+      measured = batch.value();
+      if (measured == 0)
+      {
+         break;
+      }
+
+      logger().debug("Registered {} temperature samples", measured);
+      const auto samples = std::span<const TemperatureSample>(mSamples->data(), measured);
+      if (mPublishRaw)
+      {
+         auto published = publishTemperatures(samples);
+         if (!published)
+         {
+            GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                                  "Unable to publish temperature samples: {}",
+                                  published.error().asString());
+         }
+      }
 
-   std::this_thread::sleep_for(std::chrono::milliseconds(pollTime()));
+      for (const auto& sample : samples)
+      {
+         aggregate(0, sample.value);
+      }
+   } while (measured == mSamples->size() && running());
+}
+
+void Temperature::measureSensors()
+{
+   std::span<const ThermometerPool::Reading> readings;
+   {
+      TraceSpan span("temperature.read");
+      readings = mPool->poll(ThermometerPool::Clock::now(), mReadTimeout);
+   }
+
+   // Whatever the sensors due on this tick read goes out in a single batch
+   mBatch.samples.clear();
+   for (const auto& reading : readings)
+   {
+      if (!reading.sample)
+      {
+         GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                               "Unable to get temperature from sensor {}: {}",
+                               mPool->id(reading.sensor), reading.sample.error().asString());
+         continue;
+      }
+
+      const auto& sample = reading.sample.value();
+      aggregate(reading.sensor, sample.value);
+      const auto reported = report(reading.sensor, sample);
+      if (reported == Deadband::Report::NONE)
+      {
+         continue;
+      }
+
+      mBatch.samples.push_back({std::chrono::duration_cast<std::chrono::milliseconds>(
+                                    sample.timestamp.time_since_epoch())
+                                    .count(),
+                                sample.value, mPool->id(reading.sensor),
+                                reported == Deadband::Report::HEARTBEAT});
+   }
+
+   logger().debug("Reporting {} temperature samples read from {} sensors", mBatch.samples.size(),
+                  readings.size());
+   if (mPublishRaw && !mBatch.samples.empty())
+   {
+      auto published = publish(mBatch);
+      if (!published)
+      {
+         GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                               "Unable to publish temperature samples: {}",
+                               published.error().asString());
+      }
+   }
 }
 
 bool Temperature::onStarted()
 {
-   logger().info("Using {} as measuring hardware", mThermometer->name());
+   mPollTime = std::chrono::milliseconds(pollTime());
+   mReadTimeout = std::chrono::milliseconds(readTimeout());
+
+   // The devices are created again now that their configuration is available
+   mPool = makePool();
+   if (mPool)
+   {
+      logger().info("Using {} as measuring hardware", mPool->thermometer(0).name());
+   }
+   else
+   {
+      mThermometer = makeThermometer();
+      logger().info("Using {} as measuring hardware", mThermometer->name());
+   }
+
+   mAggregators.clear();
+   if (auto aggregator = makeAggregator(AGGREGATION_CFG); aggregator.has_value())
+   {
+      mAggregators.assign(mPool ? mPool->size() : 1, aggregator.value());
+   }
+   const auto publishRawPath = std::string(AGGREGATION_CFG) + "." + PUBLISH_RAW_CFG;
+   mPublishRaw = mAggregators.empty() || settingValue<bool>(publishRawPath).value_or(true);
+
+   mDeadbands.clear();
+   if (auto deadband = makeDeadband(DEADBAND_CFG); deadband.has_value())
+   {
+      mDeadbands.assign(mPool ? mPool->size() : 1, deadband.value());
+   }
+
+   if (!startSketches())
+   {
+      return false;
+   }
+
+   auto batchSize = settingValue<unsigned int>(BATCH_SIZE_CFG);
+   if (batchSize.has_value() && batchSize.value() > 1)
+   {
+      logger().info("Publishing temperature samples in batches of {}", batchSize.value());
+      mSamples = std::make_shared<Thermometer::TemperatureBuffer>(batchSize.value());
+   }
 
    // Checking if the polling period has a valid configuration value, emit a warning otherwise
    if (!settingValue<unsigned int>(POLL_TIME_CFG).has_value())
@@ -59,6 +301,11 @@ bool Temperature::onStarted()
                     POLL_TIME_DEFAULT);
    }
 
+   // Set once above, it can be read from the thread serving requests from now on
+   handle(POLL_TIME_METHOD, [this](std::string_view) -> Result<std::string, RequestError> {
+      return std::to_string(mPollTime.count());
+   });
+
    return true;
 }
 
@@ -77,14 +324,156 @@ unsigned int Temperature::pollTime()
    return result.value();
 }
 
+void Temperature::aggregate(const std::size_t sensor, const float temperature)
+{
+   if (!mSketches.empty())
+   {
+      mSketches[sensor].add(temperature);
+   }
+
+   if (mAggregators.empty())
+   {
+      return;
+   }
+
+   auto statistics = mAggregators[sensor].add(temperature);
+   if (statistics.has_value())
+   {
+      const auto& value = statistics.value();
+      auto published =
+          publish(TemperatureAggregate{mPool ? mPool->id(sensor) : "", value.min, value.max,
+                                       value.mean, value.stddev, value.count});
+      if (!published)
+      {
+         GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                               "Unable to publish aggregated temperature: {}",
+                               published.error().asString());
+      }
+   }
+}
+
+unsigned int Temperature::readTimeout()
+{
+   return settingValue<unsigned int>(READ_TIMEOUT_CFG).value_or(READ_TIMEOUT_DEFAULT);
+}
+
+Deadband::Report Temperature::report(const std::size_t sensor, const TemperatureSample& sample)
+{
+   if (mDeadbands.empty())
+   {
+      return Deadband::Report::CHANGE;
+   }
+
+   return mDeadbands[sensor].check(sample.value, sample.timestamp);
+}
+
+bool Temperature::startSketches()
+{
+   // Configured as sketch = { period = <ms>; compression = <centroids>; }
+   mSketches.clear();
+   timers().cancel(mSketchTimer);
+   const auto period =
+       settingValue<unsigned int>(std::string(SKETCH_CFG) + "." + SKETCH_PERIOD_CFG);
+   const auto compression =
+       settingValue<unsigned int>(std::string(SKETCH_CFG) + "." + SKETCH_COMPRESSION_CFG);
+   if (!period.has_value() && !compression.has_value())
+   {
+      return true;
+   }
+
+   if (period.has_value() && period.value() == 0)
+   {
+      logger().err("Invalid sketch period, it has to be greater than zero");
+      return false;
+   }
+
+   const auto sketchPeriod = std::chrono::milliseconds(period.value_or(SKETCH_PERIOD_DEFAULT));
+   mSketches.assign(mPool ? mPool->size() : 1,
+                    QuantileSketch(compression.value_or(QuantileSketch::COMPRESSION_DEFAULT)));
+   mSketchStart = Deadband::Clock::now();
+   mSketchTimer = timers().schedule(
+       TimerWheel::Clock::now() + sketchPeriod, [this]() { publishSketches(); }, sketchPeriod);
+   logger().info("Publishing temperature sketches every {}ms", sketchPeriod.count());
+
+   return true;
+}
+
+void Temperature::publishSketches()
+{
+   const auto milliseconds = [](const Deadband::Clock::time_point time) {
+      return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch())
+          .count();
+   };
+
+   const auto end = Deadband::Clock::now();
+   for (std::size_t sensor = 0; sensor < mSketches.size(); sensor++)
+   {
+      auto& sketch = mSketches[sensor];
+      if (sketch.count() == 0)
+      {
+         continue;
+      }
+
+      const auto centroids = sketch.centroids();
+      mSketch.start = milliseconds(mSketchStart);
+      mSketch.end = milliseconds(end);
+      mSketch.sensor = mPool ? mPool->id(sensor) : "";
+      mSketch.count = sketch.count();
+      mSketch.min = sketch.min();
+      mSketch.max = sketch.max();
+      mSketch.centroids.assign(centroids.begin(), centroids.end());
+      sketch.clear();
+
+      auto published = publish(mSketch);
+      if (!published)
+      {
+         GROW_LOG_RATE_LIMITED(logger(), Logger::Level::err, ERROR_LOG_RATE,
+                               "Unable to publish temperature sketch: {}",
+                               published.error().asString());
+      }
+   }
+
+   mSketchStart = end;
+}
+
 void Temperature::onStopped()
 {
+   // The period in progress is not lost, only shorter
+   publishSketches();
+
+   // Waits for the reads in progress, the pool being the only one touching its devices
+   mPool.reset();
+}
+
+Result<void, Temperature::PublishError> Temperature::publishTemperature(const float temperature,
+                                                                         const bool heartbeat)
+{
+   return publish(TemperatureReading{temperature, heartbeat});
 }
 
-std::optional<Error<Temperature::PublishError>>
-Temperature::publishTemperature(const float temperature)
+Result<void, Temperature::PublishError>
+Temperature::publishTemperatures(std::span<const TemperatureSample> samples)
 {
-   nlohmann::json message;
-   message["temperature"] = temperature;
-   return publish(TEMPERATURE_TOPIC, message);
+   mBatch.samples.clear();
+   for (const auto& sample : samples)
+   {
+      const auto reported = report(0, sample);
+      if (reported == Deadband::Report::NONE)
+      {
+         continue;
+      }
+
+      mBatch.samples.push_back({std::chrono::duration_cast<std::chrono::milliseconds>(
+                                    sample.timestamp.time_since_epoch())
+                                    .count(),
+                                sample.value, "", reported == Deadband::Report::HEARTBEAT});
+   }
+
+   // Nothing moved in the whole batch
+   if (mBatch.samples.empty())
+   {
+      return {};
+   }
+
+   return publish(mBatch);
 }
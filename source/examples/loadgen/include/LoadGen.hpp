@@ -0,0 +1,45 @@
+#ifndef LOADGEN_HPP
+#define LOADGEN_HPP
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "LoadGenBase.hpp"
+
+// Publishes {"sequence": n, "sent": <steady clock ns>, "payload": "..."} on LOAD_0 ... LOAD_<n>
+// in turn, at rate messages per second overall. Sequences are counted per topic, so that LoadSink
+// can tell lost messages apart from the ones it was not there for
+class LoadGen : public LoadGenBase
+{
+private:
+   using Clock = std::chrono::steady_clock;
+
+   static constexpr unsigned int RATE_DEFAULT = 1000;
+   static constexpr unsigned int PAYLOAD_SIZE_DEFAULT = 64;
+   static constexpr unsigned int TOPICS_DEFAULT = 1;
+   static constexpr unsigned int DURATION_DEFAULT = 10;
+   static constexpr const char* RATE_CFG = "rate";
+   static constexpr const char* PAYLOAD_SIZE_CFG = "payload_size";
+   static constexpr const char* TOPICS_CFG = "topics";
+   static constexpr const char* DURATION_CFG = "duration";
+   static constexpr const char* TOPIC_PREFIX = "LOAD_";
+   // Messages due are sent in bursts this often, sleeping in between
+   static constexpr std::chrono::milliseconds TICK_PERIOD{1};
+   static constexpr std::chrono::seconds SETTLE_TIME{1};
+
+   unsigned int mRate = RATE_DEFAULT;
+   std::vector<std::string> mTopics;
+   std::vector<std::uint64_t> mSequences;
+   nlohmann::json mMessage;
+   Clock::time_point mStart;
+   Clock::time_point mEnd;
+   std::uint64_t mPublished = 0;
+   std::uint64_t mFailed = 0;
+
+   [[nodiscard]] bool onStarted() override;
+   void onStopped() override;
+   void mainLoop() override;
+};
+
+#endif // LOADGEN_HPP
@@ -0,0 +1,82 @@
+#include "LoadGen.hpp"
+
+#include <limits>
+#include <thread>
+
+bool LoadGen::onStarted()
+{
+   mRate = std::max(settingValue<unsigned int>(RATE_CFG).value_or(RATE_DEFAULT), 1U);
+   const auto payloadSize =
+       settingValue<unsigned int>(PAYLOAD_SIZE_CFG).value_or(PAYLOAD_SIZE_DEFAULT);
+   const auto topics =
+       std::max(settingValue<unsigned int>(TOPICS_CFG).value_or(TOPICS_DEFAULT), 1U);
+   const auto duration = settingValue<unsigned int>(DURATION_CFG).value_or(DURATION_DEFAULT);
+
+   logger().info("Publishing {} msg/s of {} bytes on {} topics for {}s", mRate, payloadSize, topics,
+                 duration);
+
+   for (unsigned int topic = 0; topic < topics; topic++)
+   {
+      mTopics.push_back(TOPIC_PREFIX + std::to_string(topic));
+   }
+   mSequences.assign(topics, 0);
+
+   mMessage["sequence"] = 0;
+   mMessage["sent"] = 0;
+   mMessage["payload"] = std::string(payloadSize, 'x');
+
+   // Opening the publisher ahead, giving sinks some time to connect before the first message
+   const auto port = publishPort(std::string(name()));
+   if (!port.has_value())
+   {
+      logger().err("No publisher port configured for {}", name());
+      return false;
+   }
+   openPublisher(port.value());
+   std::this_thread::sleep_for(SETTLE_TIME);
+
+   mStart = Clock::now();
+   mEnd = mStart + std::chrono::seconds(duration);
+
+   return true;
+}
+
+void LoadGen::mainLoop()
+{
+   const auto now = Clock::now();
+   if (now >= mEnd)
+   {
+      stop();
+      return;
+   }
+
+   // Catching up with however many messages were due by now, if we are late we go on as fast as
+   // we can rather than dropping them
+   const auto due = static_cast<std::uint64_t>(std::chrono::duration<double>(now - mStart).count() *
+                                               static_cast<double>(mRate));
+   while (mPublished + mFailed < due)
+   {
+      const auto topic = (mPublished + mFailed) % mTopics.size();
+      mMessage["sequence"] = mSequences[topic]++;
+      mMessage["sent"] = Clock::now().time_since_epoch().count();
+
+      if (publish(mTopics[topic], mMessage))
+      {
+         mPublished++;
+      }
+      else
+      {
+         mFailed++;
+      }
+   }
+
+   std::this_thread::sleep_for(TICK_PERIOD);
+}
+
+void LoadGen::onStopped()
+{
+   const auto elapsed = std::chrono::duration<double>(std::min(Clock::now(), mEnd) - mStart);
+   const auto seconds = std::max(elapsed.count(), std::numeric_limits<double>::epsilon());
+   logger().info("Published {} messages in {:.2f}s ({:.0f} msg/s, target {} msg/s), {} failed",
+                 mPublished, seconds, static_cast<double>(mPublished) / seconds, mRate, mFailed);
+}
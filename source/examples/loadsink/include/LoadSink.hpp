@@ -0,0 +1,58 @@
+#ifndef LOADSINK_HPP
+#define LOADSINK_HPP
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "LatencyHistogram.hpp"
+#include "LoadSinkBase.hpp"
+
+// Subscribes to a LoadGen and reports the throughput, loss and latency it sees, periodically and
+// once stopped. With results = "<path>" the final figures are also appended to that file as a csv
+// line (received, msg/s, loss %, p50, p95, p99 and max latency in us), for scripts to collect
+class LoadSink : public LoadSinkBase
+{
+private:
+   using Clock = std::chrono::steady_clock;
+
+   static constexpr const char* SOURCE_DEFAULT = "LoadGen";
+   static constexpr unsigned int REPORT_PERIOD_DEFAULT = 1000;
+   static constexpr const char* SOURCE_CFG = "source";
+   static constexpr const char* REPORT_PERIOD_CFG = "report_period";
+   static constexpr const char* RESULTS_CFG = "results";
+   static constexpr std::string_view TOPIC_PREFIX = "LOAD_";
+
+   // Sequences seen on a topic, counting from the first one received
+   struct Stream
+   {
+      std::uint64_t first = 0;
+      std::uint64_t last = 0;
+      std::uint64_t received = 0;
+   };
+
+   std::chrono::milliseconds mReportPeriod{REPORT_PERIOD_DEFAULT};
+   std::optional<std::string> mResultsPath;
+   std::mutex mStreamsMutex;
+   std::map<std::string, Stream, std::less<>> mStreams;
+   Clock::time_point mFirstReceived;
+   Clock::time_point mLastReceived;
+   std::atomic<std::uint64_t> mReceived = 0;
+   std::atomic<std::uint64_t> mInvalid = 0;
+   std::uint64_t mReported = 0;
+   LatencyHistogram mLatency;
+
+   [[nodiscard]] bool onStarted() override;
+   void onStopped() override;
+   void mainLoop() override;
+
+   void onMessage(const Result<void, SubscriberError>& error, const std::string& topic,
+                  const nlohmann::json& message);
+   // Messages the source sent that never made it here
+   [[nodiscard]] std::uint64_t lost();
+};
+
+#endif // LOADSINK_HPP
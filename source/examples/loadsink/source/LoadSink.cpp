@@ -0,0 +1,130 @@
+#include "LoadSink.hpp"
+
+#include <fstream>
+#include <limits>
+#include <thread>
+
+bool LoadSink::onStarted()
+{
+   const auto source = settingValue<std::string>(SOURCE_CFG).value_or(SOURCE_DEFAULT);
+   mReportPeriod = std::chrono::milliseconds(
+       settingValue<unsigned int>(REPORT_PERIOD_CFG).value_or(REPORT_PERIOD_DEFAULT));
+   mResultsPath = settingValue<std::string>(RESULTS_CFG);
+
+   auto subscribed = subscribe(source, [this](const Result<void, SubscriberError>& error,
+                                              const std::string& topic,
+                                              const nlohmann::json& message) {
+      onMessage(error, topic, message);
+   });
+   if (!subscribed)
+   {
+      logger().err("Unable to subscribe to {}: {}", source, subscribed.error().asString());
+      return false;
+   }
+
+   logger().info("Receiving from {}", source);
+   return true;
+}
+
+void LoadSink::onMessage(const Result<void, SubscriberError>& error, const std::string& topic,
+                         const nlohmann::json& message)
+{
+   const auto now = Clock::now();
+   // Anything else on the topic would throw once read, it is not a load generator message
+   if (!error || !topic.starts_with(TOPIC_PREFIX) || !message.contains("sequence") ||
+       !message.contains("sent") || !message["sequence"].is_number_integer() ||
+       !message["sent"].is_number_integer())
+   {
+      mInvalid++;
+      return;
+   }
+
+   const auto sent = Clock::time_point(Clock::duration(message["sent"].get<Clock::rep>()));
+   mLatency.record(now - sent);
+
+   const auto sequence = message["sequence"].get<std::uint64_t>();
+   {
+      std::lock_guard lock(mStreamsMutex);
+      auto [stream, added] = mStreams.try_emplace(topic);
+      if (added)
+      {
+         stream->second.first = sequence;
+      }
+      stream->second.last = std::max(stream->second.last, sequence);
+      stream->second.received++;
+
+      if (mReceived == 0)
+      {
+         mFirstReceived = now;
+      }
+      mLastReceived = now;
+      mReceived++;
+   }
+}
+
+std::uint64_t LoadSink::lost()
+{
+   std::lock_guard lock(mStreamsMutex);
+   std::uint64_t lost = 0;
+   for (const auto& [topic, stream] : mStreams)
+   {
+      const auto expected = stream.last - stream.first + 1;
+      lost += expected > stream.received ? expected - stream.received : 0;
+   }
+
+   return lost;
+}
+
+void LoadSink::mainLoop()
+{
+   std::this_thread::sleep_for(mReportPeriod);
+
+   const auto received = mReceived.load();
+   const auto interval = std::chrono::duration<double>(mReportPeriod).count();
+   logger().info("{:.0f} msg/s, {} received, {} lost, p99 {}us",
+                 static_cast<double>(received - mReported) / interval, received, lost(),
+                 std::chrono::duration_cast<std::chrono::microseconds>(mLatency.percentile(0.99))
+                     .count());
+   mReported = received;
+}
+
+void LoadSink::onStopped()
+{
+   using std::chrono::duration_cast;
+   using std::chrono::microseconds;
+
+   constexpr double PERCENT = 100;
+
+   const auto received = mReceived.load();
+   const auto lostMessages = lost();
+   double seconds = 0;
+   {
+      std::lock_guard lock(mStreamsMutex);
+      seconds = std::chrono::duration<double>(mLastReceived - mFirstReceived).count();
+   }
+   const auto throughput =
+       static_cast<double>(received) / std::max(seconds, std::numeric_limits<double>::epsilon());
+   const auto loss = received + lostMessages == 0
+                         ? 0.0
+                         : PERCENT * static_cast<double>(lostMessages) /
+                               static_cast<double>(received + lostMessages);
+   const auto p50 = duration_cast<microseconds>(mLatency.percentile(0.5)).count();
+   const auto p95 = duration_cast<microseconds>(mLatency.percentile(0.95)).count();
+   const auto p99 = duration_cast<microseconds>(mLatency.percentile(0.99)).count();
+   const auto max = duration_cast<microseconds>(mLatency.max()).count();
+
+   logger().info("Received {} messages ({:.0f} msg/s, {:.2f}% loss), {} invalid", received,
+                 throughput, loss, mInvalid.load());
+   logger().info("Latency p50 {}us, p95 {}us, p99 {}us, max {}us", p50, p95, p99, max);
+
+   if (mResultsPath.has_value())
+   {
+      std::ofstream results(mResultsPath.value(), std::ios::app);
+      results << received << "," << static_cast<std::uint64_t>(throughput) << "," << loss << ","
+              << p50 << "," << p95 << "," << p99 << "," << max << "\n";
+      if (!results)
+      {
+         logger().err("Unable to write results to {}", mResultsPath.value());
+      }
+   }
+}
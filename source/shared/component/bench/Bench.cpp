@@ -0,0 +1,618 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Aggregator.hpp"
+#include "Frame.hpp"
+#include "QuantileSketch.hpp"
+#include "ReplayServer.hpp"
+#include "RequestClient.hpp"
+#include "RequestServer.hpp"
+#include "TimerWheel.hpp"
+
+namespace {
+std::vector<float> samples(const std::size_t size)
+{
+   std::mt19937 rng(42);
+   std::normal_distribution<float> dist(20, 2);
+   std::vector<float> result(size);
+   std::generate(result.begin(), result.end(), [&]() { return dist(rng); });
+   return result;
+}
+} // namespace
+
+// What every subscriber does today on the raw stream, one statistic at a time
+static void BM_ScalarReduce(benchmark::State& state)
+{
+   const auto values = samples(static_cast<std::size_t>(state.range(0)));
+   for (auto _ : state)
+   {
+      const auto [min, max] = std::minmax_element(values.begin(), values.end());
+      const auto count = static_cast<float>(values.size());
+      const auto mean = std::accumulate(values.begin(), values.end(), 0.0F) / count;
+      const auto squares = std::accumulate(values.begin(), values.end(), 0.0F,
+                                           [mean](float sum, float value) {
+                                              return sum + (value - mean) * (value - mean);
+                                           });
+      benchmark::DoNotOptimize(*min + *max + mean + std::sqrt(squares / count));
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ScalarReduce)->Range(64, 1 << 16);
+
+static void BM_AggregatorReduce(benchmark::State& state)
+{
+   const auto values = samples(static_cast<std::size_t>(state.range(0)));
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(Aggregator::reduce(values));
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AggregatorReduce)->Range(64, 1 << 16);
+
+// Feeding a sliding window of state.range(0) samples that emits every 10 samples
+static void BM_SlidingWindow(benchmark::State& state)
+{
+   constexpr std::size_t step = 10;
+   const auto values = samples(static_cast<std::size_t>(state.range(0)) * 4);
+   Aggregator aggregator(Aggregator::Window::SLIDING, static_cast<std::size_t>(state.range(0)),
+                         step);
+   std::size_t next = 0;
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(aggregator.add(values[next]));
+      next = (next + 1) % values.size();
+   }
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SlidingWindow)->Range(64, 1 << 12);
+
+namespace {
+constexpr std::array<double, 3> QUANTILES{0.05, 0.5, 0.95};
+} // namespace
+
+// What a consumer keeping every sample goes through for p5/p50/p95 of state.range(0) of them
+static void BM_ExactQuantiles(benchmark::State& state)
+{
+   const auto values = samples(static_cast<std::size_t>(state.range(0)));
+   std::vector<float> kept;
+   for (auto _ : state)
+   {
+      kept.assign(values.begin(), values.end());
+      for (const auto fraction : QUANTILES)
+      {
+         const auto nth = kept.begin() + static_cast<std::ptrdiff_t>(
+                                             fraction * static_cast<double>(kept.size() - 1));
+         std::nth_element(kept.begin(), nth, kept.end());
+         benchmark::DoNotOptimize(*nth);
+      }
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+   state.counters["bytes"] = static_cast<double>(kept.capacity() * sizeof(float));
+}
+BENCHMARK(BM_ExactQuantiles)->Range(1 << 10, 1 << 20);
+
+static void BM_QuantileSketch(benchmark::State& state)
+{
+   const auto values = samples(static_cast<std::size_t>(state.range(0)));
+   QuantileSketch sketch;
+   for (auto _ : state)
+   {
+      sketch.clear();
+      for (const auto value : values)
+      {
+         sketch.add(value);
+      }
+      for (const auto fraction : QUANTILES)
+      {
+         benchmark::DoNotOptimize(sketch.quantile(fraction));
+      }
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+   state.counters["bytes"] =
+       static_cast<double>(sketch.centroids().size() * sizeof(QuantileSketch::Centroid));
+}
+BENCHMARK(BM_QuantileSketch)->Range(1 << 10, 1 << 20);
+
+// A zone of state.range(0) sensors, each having sketched an hour of samples taken every second
+static void BM_QuantileSketchMerge(benchmark::State& state)
+{
+   constexpr std::size_t hour = 3600;
+   const auto values = samples(hour * 4);
+   std::vector<QuantileSketch> sensors(static_cast<std::size_t>(state.range(0)));
+   for (std::size_t sensor = 0; sensor < sensors.size(); sensor++)
+   {
+      for (std::size_t i = 0; i < hour; i++)
+      {
+         const auto value = values[(sensor * 7 + i) % values.size()];
+         sensors[sensor].add(value + static_cast<float>(sensor));
+      }
+   }
+
+   QuantileSketch zone;
+   for (auto _ : state)
+   {
+      zone.clear();
+      for (auto& sensor : sensors)
+      {
+         zone.merge(sensor);
+      }
+      for (const auto fraction : QUANTILES)
+      {
+         benchmark::DoNotOptimize(zone.quantile(fraction));
+      }
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_QuantileSketchMerge)->Range(8, 1 << 10);
+
+// How far the estimates are from the exact quantiles, as the largest rank error in percent over
+// shapes a sensor could produce. Time is irrelevant here
+static void BM_QuantileSketchAccuracy(benchmark::State& state)
+{
+   const auto count = static_cast<std::size_t>(state.range(0));
+   std::mt19937 rng(42);
+   std::normal_distribution<float> normal(20, 2);
+   std::exponential_distribution<float> exponential(0.5);
+   std::uniform_real_distribution<float> uniform(10, 30);
+   std::vector<std::vector<float>> shapes(4, std::vector<float>(count));
+   for (std::size_t i = 0; i < count; i++)
+   {
+      shapes[0][i] = normal(rng);
+      shapes[1][i] = 15 + exponential(rng);
+      shapes[2][i] = uniform(rng);
+      // Two modes, day and night
+      shapes[3][i] = normal(rng) + (i % 2 == 0 ? 0.0F : 8.0F);
+   }
+
+   std::array<double, QUANTILES.size()> worst{};
+   for (auto _ : state)
+   {
+      for (auto& shape : shapes)
+      {
+         QuantileSketch sketch;
+         for (const auto value : shape)
+         {
+            sketch.add(value);
+         }
+
+         std::sort(shape.begin(), shape.end());
+         for (std::size_t index = 0; index < QUANTILES.size(); index++)
+         {
+            const auto estimate = sketch.quantile(QUANTILES[index]);
+            const auto rank =
+                std::lower_bound(shape.begin(), shape.end(), estimate) - shape.begin();
+            const auto error = std::fabs(static_cast<double>(rank) / static_cast<double>(count) -
+                                         QUANTILES[index]);
+            worst[index] = std::max(worst[index], error);
+         }
+      }
+   }
+
+   constexpr double PERCENT = 100;
+   state.counters["p5_error%"] = worst[0] * PERCENT;
+   state.counters["p50_error%"] = worst[1] * PERCENT;
+   state.counters["p95_error%"] = worst[2] * PERCENT;
+}
+BENCHMARK(BM_QuantileSketchAccuracy)->Range(1 << 10, 1 << 20)->Iterations(1);
+
+namespace {
+const nlohmann::json& message()
+{
+   static const nlohmann::json MESSAGE = {{"temperature", 21.5}, {"sensor", "greenhouse-north-01"}};
+   return MESSAGE;
+}
+} // namespace
+
+// How every publish used to build its frame: copying the payload to add the version to it
+static void BM_LegacyEncode(benchmark::State& state)
+{
+   const std::string topic = "TEMPERATURE";
+   for (auto _ : state)
+   {
+      nlohmann::json modified = message();
+      modified["version"] = "1.0.0";
+      benchmark::DoNotOptimize(topic + '#' + modified.dump());
+   }
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LegacyEncode);
+
+static void BM_FrameEncode(benchmark::State& state)
+{
+   FrameEncoder encoder;
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(encoder.encode("TEMPERATURE", message(), "1.0.0"));
+   }
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FrameEncode);
+
+static void BM_FrameDecode(benchmark::State& state)
+{
+   FrameEncoder encoder;
+   const std::string frame(encoder.encode("TEMPERATURE", message(), "1.0.0").value());
+   FrameDecoder decoder;
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(decoder.decode(frame, "1.0.0"));
+   }
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FrameDecode);
+
+namespace {
+// A batch of readings and the aggregated state of a greenhouse, both as they go on the wire
+enum class Payload
+{
+   BATCH,
+   STATE
+};
+
+const std::string& payloadFrame(const Payload payload)
+{
+   static const std::string BATCH = []() {
+      constexpr int SAMPLES = 64;
+      nlohmann::json samples = nlohmann::json::array();
+      std::mt19937 rng(42);
+      std::normal_distribution<float> dist(20, 2);
+      for (int i = 0; i < SAMPLES; i++)
+      {
+         samples.push_back({{"timestamp", 1700000000000 + i * 100}, {"temperature", dist(rng)}});
+      }
+      FrameEncoder encoder;
+      return std::string(
+          encoder.encode("TEMPERATURE_BATCH", {{"samples", samples}}, "1.0.0").value());
+   }();
+   static const std::string STATE = []() {
+      constexpr int SENSORS = 400;
+      nlohmann::json sensors = nlohmann::json::array();
+      std::mt19937 rng(42);
+      std::normal_distribution<float> dist(20, 2);
+      for (int i = 0; i < SENSORS; i++)
+      {
+         sensors.push_back({{"sensor", "greenhouse-" + std::to_string(i)},
+                            {"min", dist(rng)},
+                            {"max", dist(rng)},
+                            {"mean", dist(rng)},
+                            {"count", 600}});
+      }
+      FrameEncoder encoder;
+      return std::string(
+          encoder.encode("GREENHOUSE_STATE", {{"sensors", sensors}}, "1.0.0").value());
+   }();
+
+   return payload == Payload::BATCH ? BATCH : STATE;
+}
+
+FrameCompressor::Settings compressionSettings(const benchmark::State& state)
+{
+   FrameCompressor::Settings settings;
+   settings.algorithm = static_cast<FrameCompressor::Algorithm>(state.range(1));
+   settings.level = static_cast<int>(state.range(2));
+   settings.threshold = 0;
+   return settings;
+}
+
+// Payload, algorithm and level (zstd level or lz4 acceleration)
+void compressionArguments(benchmark::internal::Benchmark* benchmark)
+{
+   for (const auto payload : {Payload::BATCH, Payload::STATE})
+   {
+      const auto index = static_cast<std::int64_t>(payload);
+      constexpr auto LZ4 = static_cast<std::int64_t>(FrameCompressor::Algorithm::LZ4);
+      constexpr auto ZSTD = static_cast<std::int64_t>(FrameCompressor::Algorithm::ZSTD);
+      benchmark->Args({index, LZ4, 1});
+      for (const auto level : {1, 3, 9})
+      {
+         benchmark->Args({index, ZSTD, level});
+      }
+   }
+   benchmark->ArgNames({"payload", "algorithm", "level"});
+}
+} // namespace
+
+// Compression ratio against the time it takes, the one to look at when picking an algorithm
+static void BM_FrameCompress(benchmark::State& state)
+{
+   const auto& frame = payloadFrame(static_cast<Payload>(state.range(0)));
+   const auto settings = compressionSettings(state);
+   FrameCompressor compressor;
+   std::size_t compressed = 0;
+   for (auto _ : state)
+   {
+      compressed = compressor.compress(frame, settings).size();
+      benchmark::DoNotOptimize(compressed);
+   }
+   state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(frame.size()));
+   state.counters["ratio"] = static_cast<double>(frame.size()) / static_cast<double>(compressed);
+}
+BENCHMARK(BM_FrameCompress)->Apply(compressionArguments);
+
+static void BM_FrameDecompress(benchmark::State& state)
+{
+   const auto& frame = payloadFrame(static_cast<Payload>(state.range(0)));
+   FrameCompressor compressor;
+   const std::string compressed(compressor.compress(frame, compressionSettings(state)));
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(compressor.decompress(compressed));
+   }
+   state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(frame.size()));
+}
+BENCHMARK(BM_FrameDecompress)->Apply(compressionArguments);
+
+namespace {
+// Delays of a component polling, flushing and timing out requests: mostly short, some long
+std::vector<std::chrono::milliseconds> timerDelays(const std::size_t count)
+{
+   std::mt19937 rng(42);
+   std::uniform_int_distribution<int> shortDelay(1, 1000);
+   std::uniform_int_distribution<int> longDelay(1000, 600000);
+   std::vector<std::chrono::milliseconds> delays(count);
+   std::generate(delays.begin(), delays.end(), [&]() {
+      return std::chrono::milliseconds(rng() % 4 == 0 ? longDelay(rng) : shortDelay(rng));
+   });
+   return delays;
+}
+
+// What a component would use without the wheel, timers ordered by their time
+using TimerMap = std::multimap<TimerWheel::Clock::time_point, std::function<void()>>;
+} // namespace
+
+// Scheduling state.range(0) timers into a wheel holding as many
+static void BM_TimerWheelSchedule(benchmark::State& state)
+{
+   const auto count = static_cast<std::size_t>(state.range(0));
+   const auto delays = timerDelays(count * 2);
+   const auto origin = TimerWheel::Clock::now();
+   for (auto _ : state)
+   {
+      state.PauseTiming();
+      TimerWheel wheel(std::chrono::milliseconds(1), origin);
+      for (std::size_t timer = 0; timer < count; timer++)
+      {
+         wheel.schedule(origin + delays[timer], []() {});
+      }
+      state.ResumeTiming();
+
+      for (std::size_t timer = count; timer < count * 2; timer++)
+      {
+         benchmark::DoNotOptimize(wheel.schedule(origin + delays[timer], []() {}));
+      }
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TimerWheelSchedule)->Range(1 << 10, 1 << 16);
+
+static void BM_TimerMapSchedule(benchmark::State& state)
+{
+   const auto count = static_cast<std::size_t>(state.range(0));
+   const auto delays = timerDelays(count * 2);
+   const auto origin = TimerWheel::Clock::now();
+   for (auto _ : state)
+   {
+      state.PauseTiming();
+      TimerMap timers;
+      for (std::size_t timer = 0; timer < count; timer++)
+      {
+         timers.emplace(origin + delays[timer], []() {});
+      }
+      state.ResumeTiming();
+
+      for (std::size_t timer = count; timer < count * 2; timer++)
+      {
+         benchmark::DoNotOptimize(timers.emplace(origin + delays[timer], []() {}));
+      }
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TimerMapSchedule)->Range(1 << 10, 1 << 16);
+
+// Cancelling every one of state.range(0) timers, in no particular order
+static void BM_TimerWheelCancel(benchmark::State& state)
+{
+   const auto count = static_cast<std::size_t>(state.range(0));
+   const auto delays = timerDelays(count);
+   const auto origin = TimerWheel::Clock::now();
+   std::vector<TimerWheel::TimerId> ids(count);
+   for (auto _ : state)
+   {
+      state.PauseTiming();
+      TimerWheel wheel(std::chrono::milliseconds(1), origin);
+      for (std::size_t timer = 0; timer < count; timer++)
+      {
+         ids[timer] = wheel.schedule(origin + delays[timer], []() {});
+      }
+      std::shuffle(ids.begin(), ids.end(), std::mt19937(42));
+      state.ResumeTiming();
+
+      for (const auto id : ids)
+      {
+         benchmark::DoNotOptimize(wheel.cancel(id));
+      }
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TimerWheelCancel)->Range(1 << 10, 1 << 16);
+
+static void BM_TimerMapCancel(benchmark::State& state)
+{
+   const auto count = static_cast<std::size_t>(state.range(0));
+   const auto delays = timerDelays(count);
+   const auto origin = TimerWheel::Clock::now();
+   std::vector<TimerMap::iterator> ids(count);
+   for (auto _ : state)
+   {
+      state.PauseTiming();
+      TimerMap timers;
+      for (std::size_t timer = 0; timer < count; timer++)
+      {
+         ids[timer] = timers.emplace(origin + delays[timer], []() {});
+      }
+      std::shuffle(ids.begin(), ids.end(), std::mt19937(42));
+      state.ResumeTiming();
+
+      for (const auto id : ids)
+      {
+         timers.erase(id);
+      }
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TimerMapCancel)->Range(1 << 10, 1 << 16);
+
+// Expiring state.range(0) timers by advancing a millisecond at a time past the last of them
+static void BM_TimerWheelExpire(benchmark::State& state)
+{
+   const auto count = static_cast<std::size_t>(state.range(0));
+   const auto delays = timerDelays(count);
+   const auto end = *std::max_element(delays.begin(), delays.end());
+   const auto origin = TimerWheel::Clock::now();
+   std::size_t expired = 0;
+   for (auto _ : state)
+   {
+      state.PauseTiming();
+      TimerWheel wheel(std::chrono::milliseconds(1), origin);
+      for (std::size_t timer = 0; timer < count; timer++)
+      {
+         wheel.schedule(origin + delays[timer], [&expired]() { expired++; });
+      }
+      state.ResumeTiming();
+
+      for (auto now = origin; now <= origin + end; now += std::chrono::milliseconds(1))
+      {
+         wheel.advance(now);
+      }
+   }
+   benchmark::DoNotOptimize(expired);
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TimerWheelExpire)->Range(1 << 10, 1 << 16);
+
+static void BM_TimerMapExpire(benchmark::State& state)
+{
+   const auto count = static_cast<std::size_t>(state.range(0));
+   const auto delays = timerDelays(count);
+   const auto end = *std::max_element(delays.begin(), delays.end());
+   const auto origin = TimerWheel::Clock::now();
+   std::size_t expired = 0;
+   for (auto _ : state)
+   {
+      state.PauseTiming();
+      TimerMap timers;
+      for (std::size_t timer = 0; timer < count; timer++)
+      {
+         timers.emplace(origin + delays[timer], [&expired]() { expired++; });
+      }
+      state.ResumeTiming();
+
+      for (auto now = origin; now <= origin + end; now += std::chrono::milliseconds(1))
+      {
+         while (!timers.empty() && timers.begin()->first <= now)
+         {
+            timers.begin()->second();
+            timers.erase(timers.begin());
+         }
+      }
+   }
+   benchmark::DoNotOptimize(expired);
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TimerMapExpire)->Range(1 << 10, 1 << 16);
+
+namespace {
+constexpr unsigned int REQUEST_BENCH_PORT = 7360;
+constexpr std::chrono::milliseconds REQUEST_BENCH_TIMEOUT{1000};
+
+void echoServer(RequestServer& server)
+{
+   if (!server.listen(REQUEST_BENCH_PORT))
+   {
+      return;
+   }
+
+   server.handle("echo", [](const std::string_view payload) -> Result<std::string, RequestError> {
+      return std::string(payload);
+   });
+}
+} // namespace
+
+// One request of state.range(0) bytes at a time, waiting for its reply before the next
+static void BM_RequestRoundTrip(benchmark::State& state)
+{
+   RequestServer server;
+   echoServer(server);
+   RequestClient client(REQUEST_BENCH_PORT);
+   const std::string payload(static_cast<std::size_t>(state.range(0)), 'x');
+   for (auto _ : state)
+   {
+      auto reply = client.request("echo", payload, REQUEST_BENCH_TIMEOUT).get();
+      if (!reply)
+      {
+         state.SkipWithError("The request failed");
+         break;
+      }
+      benchmark::DoNotOptimize(reply.value().data());
+   }
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RequestRoundTrip)->Range(16, 4096)->UseRealTime();
+
+// state.range(0) requests in flight at once over the same connection
+static void BM_RequestPipelined(benchmark::State& state)
+{
+   RequestServer server;
+   echoServer(server);
+   RequestClient client(REQUEST_BENCH_PORT);
+   const auto inFlight = static_cast<std::size_t>(state.range(0));
+   std::vector<RequestClient::Reply> replies(inFlight);
+   for (auto _ : state)
+   {
+      for (auto& reply : replies)
+      {
+         reply = client.request("echo", "payload", REQUEST_BENCH_TIMEOUT);
+      }
+      for (auto& reply : replies)
+      {
+         benchmark::DoNotOptimize(reply.get());
+      }
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RequestPipelined)->Range(1, 64)->UseRealTime();
+
+// What an ad hoc query costs when it opens a connection of its own, as replays do
+static void BM_ConnectPerRequest(benchmark::State& state)
+{
+   ReplayServer server;
+   const std::string frame(static_cast<std::size_t>(state.range(0)), 'x');
+   if (!server.listen(REQUEST_BENCH_PORT,
+                      [&frame](unsigned int, std::uint64_t, std::uint64_t first, std::uint64_t,
+                               const ReplayBuffer::Callback& callback) { callback(first, frame); }))
+   {
+      state.SkipWithError("Unable to listen");
+      return;
+   }
+
+   for (auto _ : state)
+   {
+      auto fetched = ReplayServer::fetch(REQUEST_BENCH_PORT, 0, 1, 1, 1, [](auto, auto) {});
+      if (!fetched)
+      {
+         state.SkipWithError("The request failed");
+         break;
+      }
+   }
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConnectPerRequest)->Range(16, 4096)->UseRealTime();
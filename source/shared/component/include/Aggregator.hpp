@@ -0,0 +1,48 @@
+#ifndef AGGREGATOR_HPP
+#define AGGREGATOR_HPP
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+// Reduces a stream of samples to their statistics over a window of the last size samples, emitted
+// every step samples. A tumbling window is a sliding one whose step equals its size. Samples live
+// in a contiguous ring so that every window is reduced in a single vectorized pass
+class Aggregator final
+{
+public:
+   enum class Window
+   {
+      TUMBLING,
+      SLIDING
+   };
+
+   struct Statistics
+   {
+      float min = 0;
+      float max = 0;
+      float mean = 0;
+      float stddev = 0;
+      std::size_t count = 0;
+   };
+
+   Aggregator() = delete;
+   Aggregator(Window window, std::size_t size, std::size_t step = 0);
+
+   // Returns the statistics of the current window when this sample closes it
+   [[nodiscard]] std::optional<Statistics> add(float sample);
+
+   [[nodiscard]] static Statistics reduce(std::span<const float> samples) noexcept;
+
+   [[nodiscard]] static std::optional<Window> window(const std::string& name) noexcept;
+
+private:
+   std::vector<float> mSamples;
+   std::size_t mStep;
+   std::size_t mNext = 0;
+   std::size_t mFilled = 0;
+   std::size_t mSinceLast = 0;
+};
+
+#endif // AGGREGATOR_HPP
@@ -3,18 +3,33 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <deque>
 #include <map>
 #include <mutex>
 #include <nlohmann/json.hpp>
+#include <set>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
 #include <tcp_pubsub/executor.h>
 #include <tcp_pubsub/publisher.h>
 #include <tcp_pubsub/subscriber.h>
 #include <thread>
 
+#include "Aggregator.hpp"
 #include "Configuration.hpp"
-#include "Error.hpp"
+#include "Deadband.hpp"
+#include "Frame.hpp"
 #include "Logger.hpp"
+#include "Outbox.hpp"
+#include "ReplayBuffer.hpp"
+#include "ReplayServer.hpp"
+#include "RequestClient.hpp"
+#include "RequestServer.hpp"
+#include "Result.hpp"
+#include "Thread.hpp"
+#include "TimerWheel.hpp"
+#include "Tracer.hpp"
 
 class Component
 {
@@ -35,31 +50,49 @@ public:
       ALREADY_SUBSCRIBED
    };
 
-   using SubscriberCallback = std::function<void(const std::optional<Error<SubscriberError>>&,
+   using SubscriberCallback = std::function<void(const Result<void, SubscriberError>&,
                                                  const std::string&, const nlohmann::json&)>;
 
+   // Receives every frame exactly as it went on the wire (topic, delimiter and payload), less the
+   // sequence it was sent with
+   using FrameCallback = std::function<void(std::string_view frame)>;
+
+   // Control traffic such as actuator commands can go apart from bulk telemetry, through a
+   // publisher of its own on the ControlPublisher.<name> port, so that it never waits behind it
+   enum class Priority
+   {
+      BULK,
+      CONTROL
+   };
+
+   template <TypedTopic T>
+   using TopicCallback = std::function<void(const Result<void, SubscriberError>&, const T&)>;
+
    Component();
    Component(const Component& component) = delete;
    Component(const Component&& component) = delete;
    auto operator=(const Component& component) = delete;
    auto operator=(const Component&& component) = delete;
 
-   [[nodiscard]] virtual inline std::string name() const noexcept
+   // Metadata is known at compile time and handed out as views, since version() is looked at for
+   // every message published or received
+   [[nodiscard]] virtual inline std::string_view name() const noexcept
    {
       return DEFAULT_NAME;
    }
-   [[nodiscard]] virtual inline std::string description() const noexcept
+   [[nodiscard]] virtual inline std::string_view description() const noexcept
    {
       return DEFAULT_DESCRIPTION;
    }
-   [[nodiscard]] virtual inline std::string version() const noexcept
+   [[nodiscard]] virtual inline std::string_view version() const noexcept
    {
       return DEFAULT_VERSION;
    }
 
-   [[nodiscard]] virtual inline std::string signature() const noexcept
+   // Overridden along with name() and version(), so that it never has to be built at runtime
+   [[nodiscard]] virtual inline std::string_view signature() const noexcept
    {
-      return name() + " v" + version();
+      return DEFAULT_SIGNATURE;
    }
 
    void inline setLogLevel(const Logger::Level& level)
@@ -82,11 +115,28 @@ public:
       mConfigFilePath = filePath;
    }
 
+   // Traces the component into filePath, written once it stops
+   virtual inline void setTracePath(const std::filesystem::path& filePath) noexcept final
+   {
+      mTracePath = filePath;
+   }
+
+   // Runs the component with as small a footprint as it can, for boards shared with other services:
+   // a single pub/sub thread and smaller stacks for the threads it starts. Also enabled by
+   // <component>.low_memory
+   virtual inline void setLowMemory(const bool lowMemory) noexcept final
+   {
+      mLowMemory = lowMemory;
+   }
+
    template <class T>[[nodiscard]] inline auto settingValue(const std::string& path) const noexcept
    {
-      return mConfiguration.settingValue<T>(name() + "." + path);
+      return mConfiguration.settingValue<T>(std::string(name()) + "." + path);
    }
 
+   // A numeric setting written either as 28 or as 28.0, libconfig keeps integers and floats apart
+   [[nodiscard]] std::optional<float> settingNumber(const std::string& path) const noexcept;
+
    [[nodiscard]] virtual bool start() final;
    virtual bool stop() final;
    [[nodiscard]] virtual bool startBlocking() final;
@@ -94,12 +144,68 @@ public:
 
    [[nodiscard]] virtual bool parseCmdArguments(int argc, char** argv) final;
 
-   [[nodiscard]] std::optional<Error<PublishError>> publish(const std::string& topic,
-                                                            const nlohmann::json& payload);
+   [[nodiscard]] Result<void, PublishError> publish(const std::string& topic,
+                                                    const nlohmann::json& payload);
 
-   [[nodiscard]] std::optional<Error<SubscriberError>>
+   [[nodiscard]] Result<void, PublishError> publish(const std::string& topic,
+                                                    const Aggregator::Statistics& statistics);
+
+   // Publishes a typed topic, serialized straight from its schema into the very frames the json
+   // overload sends, so that json subscribers read it as any other message
+   template <TypedTopic T>[[nodiscard]] Result<void, PublishError> publish(const T& value)
+   {
+      const auto traceId = outgoingTraceId();
+      std::optional<TraceSpan> serializing;
+      serializing.emplace("publish.serialize", traceId);
+      auto encoded = encoder().encode(value, version(), traceId);
+      serializing.reset();
+      return publishEncoded(encoded, traceId);
+   }
+
+   [[nodiscard]] Result<void, SubscriberError>
    subscribe(const std::string& componentName, const SubscriberCallback& callback);
 
+   // Typed topics of a component share its ports: any number of them can be subscribed, but not
+   // along with a json or frame subscription to the same component. Subscriptions cover both the
+   // bulk and the control channel of the component
+   template <TypedTopic T>
+   [[nodiscard]] Result<void, SubscriberError> subscribe(const std::string& componentName,
+                                                         const TopicCallback<T>& callback)
+   {
+      return subscribeTopic(componentName, Schema<T>::NAME,
+                            [this, callback](const std::string_view frame) {
+                               // Missing fields keep their defaults rather than the previous value
+                               T value{};
+                               Result<void, FrameError> decoded;
+                               {
+                                  TraceSpan span("subscribe.parse");
+                                  decoded = decoder().decode(frame, version(), value);
+                               }
+                               if (!decoded)
+                               {
+                                  callback(subscriberError(decoded.error()), value);
+                                  return;
+                               }
+
+                               const auto traceId = decoder().traceId();
+                               TraceSpan span("subscribe.callback", traceId);
+                               Tracer::flow(TraceEvent::Kind::FLOW_END, traceId);
+                               Tracer::setCurrent(traceId);
+                               callback({}, value);
+                               Tracer::setCurrent(0);
+                            });
+   }
+
+   [[nodiscard]] Result<void, SubscriberError>
+   subscribeFrames(const std::string& componentName, const FrameCallback& callback);
+
+   // Asks a component to run the handler of a method on payload, through its Responder.<name>
+   // port. The connection is opened along with the first request and kept for the next ones, which
+   // can be sent from any thread
+   [[nodiscard]] RequestClient::Reply
+   request(const std::string& componentName, std::string_view method, std::string_view payload,
+           std::chrono::milliseconds timeout = REQUEST_TIMEOUT_DEFAULT);
+
    ~Component();
 
 protected:
@@ -107,57 +213,296 @@ protected:
    {
       if (!mLogger)
       {
-         mLogger = std::make_unique<Logger>(name());
+         mLogger = std::make_unique<Logger>(std::string(name()));
       }
 
       return *mLogger;
    }
 
+   // Creates the aggregation stage configured at <component>.<path> = { window = "tumbling" or
+   // "sliding"; size = <samples>; step = <samples>; }, if there is one
+   [[nodiscard]] std::optional<Aggregator> makeAggregator(const std::string& path);
+
+   // Creates the report by exception filter configured at <component>.<path> = { absolute =
+   // <value>; relative = <percent>; heartbeat = <ms>; }, if there is one
+   [[nodiscard]] std::optional<Deadband> makeDeadband(const std::string& path);
+
+   // Sends a complete frame on a port, publishing on behalf of whichever component it belongs to
+   [[nodiscard]] Result<void, PublishError> publish(unsigned int port, std::string_view frame);
+
+   // Starts listening on a port ahead of the first publish, so that subscribers can connect
+   void openPublisher(unsigned int port);
+
+   [[nodiscard]] inline auto publishPort(const std::string& componentName) const
+   {
+      return mConfiguration.settingValue<unsigned int>(std::string("Publisher") + "." +
+                                                       componentName);
+   }
+
+   [[nodiscard]] inline auto controlPort(const std::string& componentName) const
+   {
+      return mConfiguration.settingValue<unsigned int>(std::string("ControlPublisher") + "." +
+                                                       componentName);
+   }
+
+   [[nodiscard]] inline auto replayPort(const std::string& componentName) const
+   {
+      return mConfiguration.settingValue<unsigned int>(std::string("ReplayPublisher") + "." +
+                                                       componentName);
+   }
+
+   // Where a channel of a component is at: the epoch of its publisher and the last sequence
+   // received from it, both zero before any
+   struct SequencePosition
+   {
+      std::uint64_t epoch = 0;
+      std::uint64_t sequence = 0;
+   };
+
+   // A subscriber that keeps it across restarts resumes from there through resumeFrom(). Can be
+   // called from the subscriber callback, which is handed the frame at the position returned
+   [[nodiscard]] SequencePosition lastSequence(const std::string& componentName,
+                                               Priority priority = Priority::BULK);
+
+   // Has what a subscribed component published after position replayed ahead of its next frame,
+   // as long as its publisher did not start over since
+   void resumeFrom(const std::string& componentName, const SequencePosition& position,
+                   Priority priority = Priority::BULK);
+
+   // Called from the pub/sub or the recovery threads for the frames of a component that could not
+   // be replayed, from first to last (included), without holding on to the channel. Logs them by
+   // default
+   virtual void onFramesLost(const std::string& componentName, std::uint64_t first,
+                             std::uint64_t last);
+
+   [[nodiscard]] inline bool lowMemory() const noexcept
+   {
+      return mLowMemory;
+   }
+
+   [[nodiscard]] inline auto responderPort(const std::string& componentName) const
+   {
+      return mConfiguration.settingValue<unsigned int>(std::string("Responder") + "." +
+                                                       componentName);
+   }
+
+   // Answers the requests for a method from the thread serving them, an empty handler removes it.
+   // Handlers must not block, the requests of every client wait behind them. Requests are only
+   // served with a Responder.<name> port configured
+   void handle(const std::string& method, RequestServer::Handler handler);
+
+   // Timers run on the component thread in between mainLoop() calls, so their callbacks need no
+   // locking against it. A mainLoop() with nothing else to do can just waitForTimers()
+   [[nodiscard]] inline TimerWheel& timers() noexcept
+   {
+      return mTimers;
+   }
+
+   // Sleeps until the next timer is due, waking up every now and then to notice a stop
+   void waitForTimers();
+
+   // Topics are bulk unless declared otherwise, here or in the configuration as control_topics =
+   // ( "<topic>", ... ). They are declared once started, before publishing them. Without a control
+   // port every topic goes through the publisher port
+   void setTopicPriority(const std::string& topic, Priority priority);
+
 private:
-   const std::string DEFAULT_NAME = "Generic";
-   const std::string DEFAULT_DESCRIPTION = "This is a generic component";
-   const std::string DEFAULT_VERSION = "UNKNOWN_VERSION";
+   static constexpr std::string_view DEFAULT_NAME = "Generic";
+   static constexpr std::string_view DEFAULT_DESCRIPTION = "This is a generic component";
+   static constexpr std::string_view DEFAULT_VERSION = "UNKNOWN_VERSION";
+   static constexpr std::string_view DEFAULT_SIGNATURE = "Generic vUNKNOWN_VERSION";
    static constexpr unsigned int MAXIMUM_PUBSUB_THREADS = 6;
-   static constexpr char PUBSUB_TOPIC_DELIMITER = '#';
-   static constexpr const char* JSON_COMPONENT_VERSION_FIELD = "version";
+   static constexpr unsigned int LOW_MEMORY_PUBSUB_THREADS = 1;
+   // Replaces the 8MiB glibc default for the threads the component starts afterwards
+   static constexpr std::size_t LOW_MEMORY_STACK_SIZE = 256 * 1024;
+   static constexpr const char* LOW_MEMORY_CFG = "low_memory";
+   // Control traffic is light, what matters is that it never queues behind bulk work
+   static constexpr unsigned int CONTROL_PUBSUB_THREADS = 1;
+   static constexpr const char* CONTROL_TOPICS_CFG = "control_topics";
+   static constexpr const char* CONTROL_OUTBOX_SUFFIX = ".control";
+   static constexpr const char* OUTBOX_CFG = "outbox";
+   static constexpr const char* COMPRESSION_CFG = "compression";
+   static constexpr const char* REPLAY_CFG = "replay";
+   static constexpr std::chrono::milliseconds TIMER_WAIT_MAX{100};
+   // How often rate limited messages that stopped coming get their suppressed count reported
+   static constexpr std::chrono::seconds SUPPRESSED_REPORT_PERIOD{1};
+   static constexpr std::chrono::milliseconds REQUEST_TIMEOUT_DEFAULT{1000};
 
    std::unique_ptr<Logger> mLogger;
    static Component* mInstance;
    std::mutex mMutex;
    std::condition_variable mConditionVariable;
 
-   std::unique_ptr<std::thread> mThread;
+   std::unique_ptr<Thread> mThread;
    std::atomic_bool mShouldRun = false;
    std::atomic_bool mGracefulStop = true;
    bool mFinished = false;
    std::optional<std::filesystem::path> mConfigFilePath;
+   std::optional<std::filesystem::path> mTracePath;
+   bool mLowMemory = false;
    Configuration mConfiguration;
+   // Resolved once the configuration is loaded instead of looked up for every publish
+   std::optional<unsigned int> mPublishPort;
+   std::optional<unsigned int> mControlPort;
+   std::set<std::string, std::less<>> mControlTopics;
+   // Guards the control ports, executors and publishers, created on first use from whichever
+   // thread publishes or subscribes first
+   mutable std::shared_mutex mChannelsMutex;
+   // Ports of control channels, ours and those subscribed to, served by their own executor
+   std::set<unsigned int> mControlPorts;
+   FrameCompressor::Settings mCompression;
+   TimerWheel mTimers;
+   TimerWheel::TimerId mSuppressedTimer = 0;
    std::shared_ptr<tcp_pubsub::Executor> mPubSubExecutor;
+   std::shared_ptr<tcp_pubsub::Executor> mControlExecutor;
    std::map<const unsigned int, tcp_pubsub::Publisher> mPublisherMap;
+
+   // Hands the frames received on a port to the callback of their typed topic
+   struct TopicDispatch
+   {
+      std::shared_mutex mutex;
+      std::map<std::string, FrameCallback, std::less<>> callbacks;
+   };
+
+   // Shared with the subscribers dispatching into it, every channel of a component has one
+   std::map<const unsigned int, std::shared_ptr<TopicDispatch>> mTopicDispatchMap;
    std::map<const unsigned int, tcp_pubsub::Subscriber> mSubscriberMap;
+   // Declared after the publishers it sends through, so that it stops retrying before they go
+   std::map<const unsigned int, Outbox> mOutboxMap;
+
+   // The frames last published on a port, stamped and sent under its lock so that sequences go
+   // out in order
+   struct ReplayChannel
+   {
+      std::mutex mutex;
+      ReplayBuffer buffer;
+      std::string stamped;
+
+      explicit ReplayChannel(const ReplayBuffer::Settings& settings) : buffer{settings}
+      {
+      }
+   };
+
+   std::map<const unsigned int, std::unique_ptr<ReplayChannel>> mReplayMap;
+   // Declared after the channels it reads from
+   ReplayServer mReplayServer;
+
+   // Where a subscribed channel is at, shared with the subscriber receiving from it
+   struct Sequencing
+   {
+      std::mutex mutex;
+      std::string component;
+      Priority priority = Priority::BULK;
+      unsigned int channel = 0;
+      std::optional<unsigned int> replayPort;
+      // What last counts in, zero until the first frame
+      std::uint64_t epoch = 0;
+      std::uint64_t last = 0;
+      // Frames fetched again are waited for by a thread of their own, whatever comes meanwhile
+      // is held back and handed over after them
+      bool recovering = false;
+      // Set once the component stops, nothing is handed over anymore
+      bool stopping = false;
+      std::deque<std::pair<std::uint64_t, std::string>> held;
+      Thread recovery;
+
+      Sequencing() = default;
+      Sequencing(const Sequencing& sequencing) = delete;
+      Sequencing(Sequencing&& sequencing) = delete;
+      auto operator=(const Sequencing& sequencing) = delete;
+      auto operator=(Sequencing&& sequencing) = delete;
+
+      ~Sequencing()
+      {
+         if (recovery.joinable())
+         {
+            recovery.join();
+         }
+      }
+   };
+
+   std::map<const unsigned int, std::shared_ptr<Sequencing>> mSequencingMap;
+
+   // What the recovery thread hands over once it let go of the lock, in order
+   struct Handover
+   {
+      // Frames that could not be replayed, reported before the frame
+      std::optional<std::pair<std::uint64_t, std::uint64_t>> lost;
+      std::optional<std::string> frame;
+   };
+
+   RequestServer mRequestServer;
+   // One client for every component requested so far, each with its connection
+   std::mutex mRequestMutex;
+   // Resolved at start instead of looked up for every request
+   std::map<std::string, unsigned int, std::less<>> mResponderPorts;
+   std::map<std::string, std::unique_ptr<RequestClient>, std::less<>> mRequestClients;
 
    static void stopSignalHandler(int signal);
+   [[nodiscard]] bool openOutbox();
+   [[nodiscard]] bool openOutbox(unsigned int port, const Outbox::Settings& settings);
+   [[nodiscard]] bool openReplay();
+   [[nodiscard]] bool openResponder();
+   void applyLowMemoryProfile();
+   // Logs how much memory and how many threads the component started with
+   void reportFootprint();
+   void loadControlTopics();
+   void loadCompression();
+   // Undoes what start() did so far, returning false for it to return
+   [[nodiscard]] bool abortStart();
+   void closeOutboxes();
+   void writeTrace();
    [[nodiscard]] virtual bool onStarted() = 0;
    virtual void onStopped() = 0;
    virtual void mainLoop() = 0;
 
-   [[nodiscard]] std::optional<Error<PublishError>> publish(unsigned int port,
-                                                            const std::string& payload);
+   // Wraps a json callback into one receiving the frames it is decoded from
+   [[nodiscard]] FrameCallback decoding(const SubscriberCallback& callback);
 
-   [[nodiscard]] std::optional<Error<PublishError>>
-   publish(unsigned int port, const std::string& topic, const std::string& payload);
+   [[nodiscard]] Result<void, SubscriberError> subscribeFrames(unsigned int port,
+                                                               const FrameCallback& callback);
 
-   [[nodiscard]] std::optional<Error<PublishError>> publish(const std::string& topic,
-                                                            const std::string& payload);
+   // Subscribes to a channel of a component, replaying whatever it is found to have missed
+   [[nodiscard]] Result<void, SubscriberError> subscribeSequenced(const std::string& componentName,
+                                                                  Priority priority,
+                                                                  unsigned int port,
+                                                                  const FrameCallback& callback);
+   void receiveSequenced(Sequencing& sequencing, std::string_view frame,
+                         const FrameCallback& callback);
+   // Replays what came after the last frame handed over up to the first one held back, from the
+   // recovery thread of the channel and until no gap is left before the frames held back
+   void recover(Sequencing& sequencing, const FrameCallback& callback);
+   // Stops handing frames over and waits for the recovery threads, so that none calls back once
+   // the component stopped
+   void joinRecoveries();
+   [[nodiscard]] std::shared_ptr<Sequencing> sequencing(const std::string& componentName,
+                                                        Priority priority) const;
 
-   [[nodiscard]] std::optional<Error<SubscriberError>>
-   subscribe(unsigned int port, const SubscriberCallback& callback);
+   // Sends a frame as it is, through the outbox of its port if there is one
+   [[nodiscard]] Result<void, PublishError> deliver(unsigned int port, std::string_view frame);
 
-   [[nodiscard]] inline auto publishPort(const std::string& componentName) const
-   {
-      return mConfiguration.settingValue<unsigned int>(std::string("Publisher") + "." +
-                                                       componentName);
-   }
+   [[nodiscard]] Result<void, SubscriberError> subscribeTopic(const std::string& componentName,
+                                                              std::string_view topic,
+                                                              const FrameCallback& callback);
+
+   // Components publish from their loop and subscriber callbacks from the pub/sub threads, each
+   // thread keeps its own encoder, decoder and compressor around
+   [[nodiscard]] static FrameEncoder& encoder();
+   [[nodiscard]] static FrameDecoder& decoder();
+   [[nodiscard]] static FrameCompressor& compressor();
+
+   // The trace a published message belongs to, zero while not tracing
+   [[nodiscard]] static std::uint64_t outgoingTraceId();
+   [[nodiscard]] static Error<SubscriberError> subscriberError(const Error<FrameError>& error);
+   [[nodiscard]] Result<void, PublishError>
+   publishEncoded(const Result<std::string_view, FrameError>& encoded, std::uint64_t traceId);
+
+   tcp_pubsub::Publisher& publisher(unsigned int port);
+   [[nodiscard]] std::shared_ptr<tcp_pubsub::Executor> executor(unsigned int port);
+
+   // The port of the channel a frame of ours goes out on
+   [[nodiscard]] unsigned int channelPort(std::string_view frame) const;
+   [[nodiscard]] static bool send(const tcp_pubsub::Publisher& target, std::string_view frame);
 };
 
 #endif // COMPONENT_HPP
@@ -0,0 +1,49 @@
+#ifndef DEADBAND_HPP
+#define DEADBAND_HPP
+
+#include <chrono>
+#include <optional>
+
+// Report by exception for slowly changing values: a sample is worth reporting when it moves away
+// from the last one reported by more than the absolute or the relative threshold. While it does
+// not, one is reported every heartbeat anyway, so that subscribers can tell a steady value from a
+// silent source. Runs on the time samples were taken at
+class Deadband final
+{
+public:
+   using Clock = std::chrono::system_clock;
+
+   enum class Report
+   {
+      NONE,
+      CHANGE,
+      HEARTBEAT
+   };
+
+   struct Settings
+   {
+      float absolute = 0;
+      // A fraction of the last value reported
+      float relative = 0;
+      // Zero for no heartbeat at all
+      Clock::duration heartbeat = Clock::duration::zero();
+   };
+
+   Deadband() = delete;
+   explicit Deadband(const Settings& settings) noexcept;
+
+   // Whether the sample is to be reported and why. Without thresholds any change is reported
+   [[nodiscard]] Report check(float value, Clock::time_point timestamp) noexcept;
+
+   [[nodiscard]] inline const Settings& settings() const noexcept
+   {
+      return mSettings;
+   }
+
+private:
+   Settings mSettings;
+   std::optional<float> mReported;
+   Clock::time_point mReportedAt;
+};
+
+#endif // DEADBAND_HPP
@@ -0,0 +1,225 @@
+#ifndef FRAME_HPP
+#define FRAME_HPP
+
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Result.hpp"
+#include "Topic.hpp"
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
+enum class FrameError
+{
+   INVALID_TOPIC,
+   INVALID_PAYLOAD,
+   VERSION_MISMATCH
+};
+
+// Frames travel as "<topic>#<json>", the json carrying the version of the component that sent it
+// and, while tracing, the id the message is traced with. A compressed frame keeps its topic, the
+// json being replaced by a marker naming the algorithm, the size of the json (little endian) and
+// the compressed json. Json payloads are objects, so the marker is never mistaken for one
+struct FrameFormat
+{
+   static constexpr char TOPIC_DELIMITER = '#';
+   static constexpr const char* VERSION_FIELD = "version";
+   static constexpr const char* TRACE_FIELD = "trace";
+   static constexpr char LZ4_MARKER = '\x01';
+   static constexpr char ZSTD_MARKER = '\x02';
+   static constexpr std::size_t SIZE_BYTES = 4;
+};
+
+// Compresses and decompresses frames reusing its buffer and its compression contexts, so that
+// neither allocates once they have grown to the largest frame
+class FrameCompressor final
+{
+public:
+   enum class Algorithm
+   {
+      NONE,
+      LZ4,
+      ZSTD
+   };
+
+   static constexpr std::size_t DEFAULT_THRESHOLD = 1024;
+   // Larger payloads are refused when decompressing, whatever size their frame claims
+   static constexpr std::size_t MAX_PAYLOAD = 64 * 1024 * 1024;
+
+   struct Settings
+   {
+      Algorithm algorithm = Algorithm::NONE;
+      // Payloads smaller than this are not worth compressing
+      std::size_t threshold = DEFAULT_THRESHOLD;
+      // The zstd level or the lz4 acceleration, zero picking the default of the algorithm
+      int level = 0;
+   };
+
+   FrameCompressor();
+   FrameCompressor(const FrameCompressor& compressor) = delete;
+   FrameCompressor(FrameCompressor&& compressor) = delete;
+   auto operator=(const FrameCompressor& compressor) = delete;
+   auto operator=(FrameCompressor&& compressor) = delete;
+
+   // The returned frame is valid until the next call. It is frame itself when it is below the
+   // threshold or would not get any smaller
+   [[nodiscard]] std::string_view compress(std::string_view frame, const Settings& settings);
+
+   // Frames that are not compressed are handed back as they are
+   [[nodiscard]] Result<std::string_view, FrameError> decompress(std::string_view frame);
+
+   [[nodiscard]] static bool compressed(std::string_view frame) noexcept;
+
+   [[nodiscard]] static std::optional<Algorithm> algorithm(const std::string& name) noexcept;
+
+   ~FrameCompressor();
+
+private:
+   struct ContextDeleter
+   {
+      void operator()(ZSTD_CCtx_s* context) const noexcept;
+      void operator()(ZSTD_DCtx_s* context) const noexcept;
+   };
+
+   std::string mBuffer;
+   // Created on first use, a thread only ever needing one of them
+   std::vector<std::uint64_t> mLz4State;
+   std::unique_ptr<ZSTD_CCtx_s, ContextDeleter> mZstdCompression;
+   std::unique_ptr<ZSTD_DCtx_s, ContextDeleter> mZstdDecompression;
+};
+
+// Builds frames into a buffer and through a serializer that are both kept across calls, so that
+// once the buffer has grown to the largest frame encoding does not allocate anymore
+class FrameEncoder final
+{
+public:
+   FrameEncoder();
+   FrameEncoder(const FrameEncoder& encoder) = delete;
+   FrameEncoder(FrameEncoder&& encoder) = delete;
+   auto operator=(const FrameEncoder& encoder) = delete;
+   auto operator=(FrameEncoder&& encoder) = delete;
+
+   // The returned frame is valid until the next call. Payloads must be objects (or null). A zero
+   // trace id leaves the frame untraced
+   [[nodiscard]] Result<std::string_view, FrameError> encode(std::string_view topic,
+                                                             const nlohmann::json& payload,
+                                                             std::string_view version,
+                                                             std::uint64_t traceId = 0);
+
+   // Same as above for typed topics, going from the value to the wire without a json document
+   template <TypedTopic T>
+   [[nodiscard]] Result<std::string_view, FrameError>
+   encode(const T& value, const std::string_view version, const std::uint64_t traceId = 0)
+   {
+      mBuffer.assign(Schema<T>::NAME);
+      mBuffer.push_back(FrameFormat::TOPIC_DELIMITER);
+      TopicWriter::writeOpen(mBuffer, value);
+      mBuffer.push_back(',');
+      close(version, traceId);
+      return std::string_view(mBuffer);
+   }
+
+   ~FrameEncoder() = default;
+
+private:
+   using Output = nlohmann::detail::output_string_adapter<char>;
+   using Serializer = nlohmann::detail::serializer<nlohmann::json>;
+
+   std::string mBuffer;
+   Output mOutput;
+   Serializer mSerializer;
+
+   // Adds the frame members to an open object and closes it
+   void close(std::string_view version, std::uint64_t traceId);
+};
+
+// Splits and parses frames, keeping the topic storage across calls. Parsing the payload allocates
+// whatever its json needs and nothing more. Compressed frames are decompressed transparently
+class FrameDecoder final
+{
+public:
+   [[nodiscard]] Result<void, FrameError> decode(std::string_view frame, std::string_view version);
+
+   // Reads a frame of a typed topic straight into value, only the topic is kept in the decoder
+   template <TypedTopic T>
+   [[nodiscard]] Result<void, FrameError> decode(const std::string_view received,
+                                                 const std::string_view version, T& value)
+   {
+      auto decompressed = mCompressor.decompress(received);
+      if (!decompressed)
+      {
+         return decompressed.error();
+      }
+
+      const auto frame = decompressed.value();
+      const auto delimiter = frame.find(FrameFormat::TOPIC_DELIMITER);
+      if (delimiter == std::string_view::npos || frame.substr(0, delimiter) != Schema<T>::NAME)
+      {
+         return Error(FrameError::INVALID_TOPIC, "Message received on an unexpected topic");
+      }
+
+      bool matching = false;
+      mTraceId = 0;
+      TopicReader reader(frame.substr(delimiter + 1));
+      const auto parsed =
+          reader.readObject(value,
+                            [this, &version, &matching](const std::string_view key,
+                                                        TopicReader& member) {
+                               if (key == FrameFormat::VERSION_FIELD)
+                               {
+                                  const auto valid = member.readString(mVersion);
+                                  matching = mVersion == version;
+                                  return valid;
+                               }
+                               if (key == FrameFormat::TRACE_FIELD)
+                               {
+                                  return member.read(mTraceId);
+                               }
+                               return member.skip();
+                            }) &&
+          reader.finished();
+      if (!parsed)
+      {
+         return Error(FrameError::INVALID_PAYLOAD, "Failed to parse payload");
+      }
+      if (!matching)
+      {
+         return Error(FrameError::VERSION_MISMATCH,
+                      "Sender and receiver were on different software version");
+      }
+
+      mTopic.assign(Schema<T>::NAME);
+      return {};
+   }
+
+   [[nodiscard]] inline const std::string& topic() const noexcept
+   {
+      return mTopic;
+   }
+
+   [[nodiscard]] inline const nlohmann::json& payload() const noexcept
+   {
+      return mPayload;
+   }
+
+   // Zero when the frame was not traced
+   [[nodiscard]] inline std::uint64_t traceId() const noexcept
+   {
+      return mTraceId;
+   }
+
+private:
+   std::string mTopic;
+   nlohmann::json mPayload;
+   std::uint64_t mTraceId = 0;
+   // The version of typed frames, kept across calls
+   std::string mVersion;
+   FrameCompressor mCompressor;
+};
+
+#endif // FRAME_HPP
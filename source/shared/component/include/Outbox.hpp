@@ -0,0 +1,152 @@
+#ifndef OUTBOX_HPP
+#define OUTBOX_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Result.hpp"
+#include "Thread.hpp"
+
+enum class OutboxError
+{
+   UNABLE_TO_OPEN,
+   FULL
+};
+
+// Keeps the frames a publisher failed to send and retries them in order from a background thread,
+// backing off while delivery keeps failing. Frames wait in a bounded in-memory ring and, once that
+// is full, in a size capped spill file. Whatever fits in neither is dropped and accounted for
+class Outbox final
+{
+public:
+   // Returns whether the frame went out
+   using Sender = std::function<bool(std::string_view frame)>;
+
+   struct Settings
+   {
+      std::size_t memory = 0;
+      // No spill file when zero
+      std::size_t disk = 0;
+      std::filesystem::path path;
+      std::chrono::milliseconds backoff{100};
+      std::chrono::milliseconds maxBackoff{10000};
+   };
+
+   struct Statistics
+   {
+      std::size_t memoryFrames = 0;
+      std::size_t diskFrames = 0;
+      std::uint64_t retried = 0;
+      std::uint64_t spilled = 0;
+      std::uint64_t dropped = 0;
+   };
+
+   Outbox() = default;
+   Outbox(const Outbox& outbox) = delete;
+   Outbox(Outbox&& outbox) = delete;
+   auto operator=(const Outbox& outbox) = delete;
+   auto operator=(Outbox&& outbox) = delete;
+
+   [[nodiscard]] Result<void, OutboxError> open(const Settings& settings, const Sender& sender);
+
+   // Sends the frame right away when nothing is waiting before it, queues it otherwise
+   [[nodiscard]] Result<void, OutboxError> send(std::string_view frame);
+
+   // Stops retrying, frames still waiting are lost
+   void close() noexcept;
+
+   [[nodiscard]] Statistics statistics() const;
+
+   ~Outbox();
+
+private:
+   static constexpr std::size_t LENGTH_SIZE = sizeof(std::uint32_t);
+
+   // Length prefixed frames laid out back to back in a fixed buffer, wrapping around its end
+   class Ring
+   {
+   public:
+      void reset(std::size_t capacity);
+      [[nodiscard]] bool push(std::string_view frame);
+      void front(std::string& frame) const;
+      void pop() noexcept;
+
+      [[nodiscard]] inline std::size_t frames() const noexcept
+      {
+         return mFrames;
+      }
+
+   private:
+      std::vector<char> mBuffer;
+      std::size_t mHead = 0;
+      std::size_t mUsed = 0;
+      std::size_t mFrames = 0;
+
+      void copyIn(std::size_t position, const char* data, std::size_t size) noexcept;
+      void copyOut(std::size_t position, char* data, std::size_t size) const noexcept;
+   };
+
+   // Length prefixed frames laid out back to back in a size capped file, wrapping around its end
+   // as the ring does so that the space of the frames read back is reused right away
+   class Spill
+   {
+   public:
+      [[nodiscard]] bool open(const std::filesystem::path& path, std::size_t capacity);
+      void close() noexcept;
+      [[nodiscard]] bool push(std::string_view frame);
+      [[nodiscard]] bool front(std::string& frame);
+      void pop() noexcept;
+
+      [[nodiscard]] inline std::size_t frames() const noexcept
+      {
+         return mFrames;
+      }
+
+      ~Spill();
+
+   private:
+      int mFile = -1;
+      std::size_t mCapacity = 0;
+      std::size_t mRead = 0;
+      std::size_t mUsed = 0;
+      // Size of the frame last read by front, which pop skips
+      std::size_t mFrontSize = 0;
+      std::size_t mFrames = 0;
+
+      [[nodiscard]] bool writeAt(std::size_t position, const char* data, std::size_t size) const;
+      [[nodiscard]] bool readAt(std::size_t position, char* data, std::size_t size) const;
+   };
+
+   Settings mSettings;
+   Sender mSender;
+   mutable std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::unique_ptr<Thread> mThread;
+   bool mRunning = false;
+   Ring mRing;
+   Spill mSpill;
+   // Holds the frame being retried, reused so that draining does not allocate. Only touched by the
+   // retrying thread, which sends it without holding the lock
+   std::string mFrame;
+   Statistics mStatistics;
+
+   [[nodiscard]] inline std::size_t pending() const noexcept
+   {
+      return mRing.frames() + mSpill.frames();
+   }
+
+   void retry();
+   // Sends the queued frames in order until one fails, releasing lock while each is sent
+   [[nodiscard]] bool drain(std::unique_lock<std::mutex>& lock);
+   [[nodiscard]] bool queue(std::string_view frame);
+};
+
+#endif // OUTBOX_HPP
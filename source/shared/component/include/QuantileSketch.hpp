@@ -0,0 +1,71 @@
+#ifndef QUANTILESKETCH_HPP
+#define QUANTILESKETCH_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Estimates quantiles of a stream in bounded memory as a merging t-digest: samples are kept as
+// weighted centroids, small ones towards the tails and large ones around the median, so that
+// extreme quantiles stay accurate. Sketches merge by their centroids, a zone being the merge of
+// the sketches of its sensors. Compression bounds the number of centroids to about half of it
+class QuantileSketch final
+{
+public:
+   struct Centroid
+   {
+      float mean = 0;
+      std::uint64_t weight = 0;
+   };
+
+   static constexpr std::size_t COMPRESSION_DEFAULT = 100;
+
+   explicit QuantileSketch(std::size_t compression = COMPRESSION_DEFAULT);
+
+   void add(float sample);
+
+   // Merges a sketch published elsewhere, given its centroids and the extremes it saw
+   void merge(std::span<const Centroid> centroids, float min, float max);
+   void merge(QuantileSketch& sketch);
+
+   // The value below which the given fraction of the samples lie, NaN without samples
+   [[nodiscard]] float quantile(double fraction);
+
+   // The compressed state, what goes on the wire
+   [[nodiscard]] std::span<const Centroid> centroids();
+
+   void clear() noexcept;
+
+   [[nodiscard]] inline std::uint64_t count() const noexcept
+   {
+      return mCount;
+   }
+
+   [[nodiscard]] inline float min() const noexcept
+   {
+      return mMin;
+   }
+
+   [[nodiscard]] inline float max() const noexcept
+   {
+      return mMax;
+   }
+
+private:
+   // Samples are buffered and compressed in bulk, sorting being the bulk of the cost
+   static constexpr std::size_t BUFFER_FACTOR = 8;
+
+   double mCompression;
+   std::vector<Centroid> mCentroids;
+   // Samples and merged centroids not compressed yet, samples alone being quicker to sort
+   std::vector<float> mSamples;
+   std::vector<Centroid> mMerged;
+   std::vector<Centroid> mScratch;
+   std::uint64_t mCount = 0;
+   float mMin = 0;
+   float mMax = 0;
+
+   void compress();
+};
+
+#endif // QUANTILESKETCH_HPP
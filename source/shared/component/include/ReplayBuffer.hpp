@@ -0,0 +1,104 @@
+#ifndef REPLAYBUFFER_HPP
+#define REPLAYBUFFER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Keeps the last frames a channel published, numbered by sequence, so that they can be sent again
+// to subscribers that missed them. Frames are copied back to back into a fixed buffer, wrapping
+// around its end, the oldest ones going once either the frame or the byte bound is reached. It is
+// not thread safe
+class ReplayBuffer final
+{
+public:
+   using Callback = std::function<void(std::uint64_t sequence, std::string_view frame)>;
+
+   static constexpr std::size_t FRAMES_DEFAULT = 4096;
+   static constexpr std::size_t BYTES_DEFAULT = 4 << 20;
+
+   // Sequenced frames go on the wire as "<marker><epoch><sequence><frame>", both numbers 8 bytes
+   // little endian. No topic starts with the marker, so that frames can be told apart from the
+   // ones without. The epoch tells a publisher that started over from the one before it
+   static constexpr char SEQUENCE_MARKER = '\x03';
+   static constexpr std::size_t EPOCH_BYTES = 8;
+   static constexpr std::size_t SEQUENCE_BYTES = 8;
+
+   struct Settings
+   {
+      std::size_t frames = FRAMES_DEFAULT;
+      std::size_t bytes = BYTES_DEFAULT;
+   };
+
+   struct Stamp
+   {
+      std::uint64_t epoch = 0;
+      std::uint64_t sequence = 0;
+      std::string_view frame;
+   };
+
+   ReplayBuffer() = delete;
+   explicit ReplayBuffer(const Settings& settings);
+
+   // Keeps a copy of the frame, returning the sequence it was given. Sequences start from one
+   std::uint64_t push(std::string_view frame);
+
+   // Hands the frames from first to last (included) still kept to the callback, in order
+   void replay(std::uint64_t first, std::uint64_t last, const Callback& callback) const;
+
+   // Picked at random for every buffer, never zero
+   [[nodiscard]] inline std::uint64_t epoch() const noexcept
+   {
+      return mEpoch;
+   }
+
+   // The oldest sequence still kept, the next one when none is
+   [[nodiscard]] inline std::uint64_t first() const noexcept
+   {
+      return mFirst;
+   }
+
+   [[nodiscard]] inline std::uint64_t next() const noexcept
+   {
+      return mFirst + mSlots.size();
+   }
+
+   static void stamp(std::string& out, std::uint64_t epoch, std::uint64_t sequence,
+                     std::string_view frame);
+
+   // The epoch, the sequence and the frame of a sequenced frame, nothing for the others
+   [[nodiscard]] static std::optional<Stamp> unstamp(std::string_view frame) noexcept;
+
+private:
+   static constexpr unsigned int BYTE_BITS = 8;
+
+   static void appendNumber(std::string& out, std::uint64_t value, std::size_t bytes);
+   [[nodiscard]] static std::uint64_t readNumber(const char* data, std::size_t bytes) noexcept;
+
+   struct Slot
+   {
+      std::size_t offset = 0;
+      std::size_t size = 0;
+   };
+
+   Settings mSettings;
+   std::vector<char> mBuffer;
+   std::deque<Slot> mSlots;
+   std::uint64_t mEpoch = 0;
+   std::uint64_t mFirst = 1;
+   // Where the oldest frame kept starts and how many bytes from there on are taken, counting the
+   // end of the buffer left unused by a frame that went back to its start
+   std::size_t mHead = 0;
+   std::size_t mUsed = 0;
+
+   // Where a frame of size goes next and how many bytes it takes there, skipped ones included
+   [[nodiscard]] std::pair<std::size_t, std::size_t> place(std::size_t size) const noexcept;
+   void evict() noexcept;
+};
+
+#endif // REPLAYBUFFER_HPP
@@ -0,0 +1,72 @@
+#ifndef REPLAYSERVER_HPP
+#define REPLAYSERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "ReplayBuffer.hpp"
+#include "Result.hpp"
+#include "Thread.hpp"
+
+enum class ReplayError
+{
+   UNABLE_TO_LISTEN,
+   UNABLE_TO_CONNECT,
+   INVALID_RESPONSE
+};
+
+// Sends subscribers the frames they missed, out of the replay buffers of a component, one request
+// at a time from a thread of its own. A request is the line "<channel> <epoch> <first> <last>\n",
+// channel being the port the frames went out on. The answer is every frame of that range still
+// kept by the buffer of that epoch, each as its sequence (8 bytes) and length (4 bytes) big endian
+// followed by the frame, closed by an empty frame of sequence zero. Frames missing at the start of
+// the range were evicted already
+class ReplayServer final
+{
+public:
+   // Hands the kept frames of a range of a channel to the callback, none when its buffer is not
+   // the one of epoch anymore
+   using Source =
+       std::function<void(unsigned int channel, std::uint64_t epoch, std::uint64_t first,
+                          std::uint64_t last, const ReplayBuffer::Callback& callback)>;
+
+   // Neither side waits longer than this on the other
+   static constexpr std::chrono::milliseconds TIMEOUT{1000};
+
+   ReplayServer() = default;
+   ReplayServer(const ReplayServer& server) = delete;
+   ReplayServer(ReplayServer&& server) = delete;
+   auto operator=(const ReplayServer& server) = delete;
+   auto operator=(ReplayServer&& server) = delete;
+
+   [[nodiscard]] Result<void, ReplayError> listen(unsigned int port, const Source& source);
+
+   void close() noexcept;
+
+   // Asks the server on port for a range of frames of a channel, handing them to the callback in
+   // order. Returns how many were received
+   [[nodiscard]] static Result<std::size_t, ReplayError>
+   fetch(unsigned int port, unsigned int channel, std::uint64_t epoch, std::uint64_t first,
+         std::uint64_t last, const ReplayBuffer::Callback& callback);
+
+   ~ReplayServer();
+
+private:
+   static constexpr std::size_t LENGTH_BYTES = 4;
+   static constexpr std::size_t MAX_REQUEST_SIZE = 96;
+   static constexpr std::size_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+   // How often the serving thread checks whether it was closed
+   static constexpr std::chrono::milliseconds POLL_PERIOD{100};
+
+   int mListener = -1;
+   std::atomic_bool mRunning = false;
+   std::unique_ptr<Thread> mThread;
+
+   void serve(const Source& source) const;
+   void answer(int socket, const Source& source) const;
+};
+
+#endif // REPLAYSERVER_HPP
@@ -0,0 +1,77 @@
+#ifndef REQUESTCLIENT_HPP
+#define REQUESTCLIENT_HPP
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "RequestProtocol.hpp"
+#include "Result.hpp"
+#include "Thread.hpp"
+
+// Sends requests to the server on a port of this host, connecting along with the first one and
+// again once the connection drops. Replies are received by a thread of the client, which also
+// fails the requests that were not answered in time
+class RequestClient final
+{
+public:
+   using Clock = std::chrono::steady_clock;
+   using Reply = std::future<Result<std::string, RequestError>>;
+
+   RequestClient() = delete;
+   explicit RequestClient(unsigned int port);
+   RequestClient(const RequestClient& client) = delete;
+   RequestClient(RequestClient&& client) = delete;
+   auto operator=(const RequestClient& client) = delete;
+   auto operator=(RequestClient&& client) = delete;
+
+   // Never waits for the reply, the future gets either it or the reason there is none. Can be
+   // called from any thread
+   [[nodiscard]] Reply request(std::string_view method, std::string_view payload,
+                               std::chrono::milliseconds timeout);
+
+   void close() noexcept;
+
+   ~RequestClient();
+
+private:
+   // How long the receiving thread waits at most before looking for expired requests
+   static constexpr std::chrono::milliseconds POLL_PERIOD{100};
+   static constexpr std::chrono::milliseconds SEND_TIMEOUT{1000};
+   static constexpr std::size_t RECEIVE_CHUNK = 64 * 1024;
+
+   struct Pending
+   {
+      std::promise<Result<std::string, RequestError>> promise;
+      Clock::time_point deadline;
+   };
+
+   const unsigned int mPort;
+   std::mutex mMutex;
+   int mSocket = -1;
+   int mWake = -1;
+   std::uint64_t mNextId = 1;
+   std::unordered_map<std::uint64_t, Pending> mPending;
+   // When the receiving thread looks for expired requests next
+   Clock::time_point mWakeAt = Clock::time_point::max();
+   std::string mSending;
+   bool mStopping = false;
+   Thread mReceiver;
+
+   [[nodiscard]] Result<void, RequestError> connect();
+   void receive();
+   // Settles the replies complete in received and drops them from it, false on a malformed one
+   [[nodiscard]] bool settle(std::string& received);
+   // Fails the requests past their deadline, returning the closest deadline of the others
+   [[nodiscard]] Clock::time_point expire(Clock::time_point now);
+   // Closes the connection, failing whatever was waiting on it
+   void disconnect(const Error<RequestError>& error);
+   void wake() const noexcept;
+};
+
+#endif // REQUESTCLIENT_HPP
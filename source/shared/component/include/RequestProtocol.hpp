@@ -0,0 +1,83 @@
+#ifndef REQUESTPROTOCOL_HPP
+#define REQUESTPROTOCOL_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+enum class RequestError
+{
+   NETWORK_CONFIGURATION_MISSING,
+   UNABLE_TO_LISTEN,
+   UNABLE_TO_CONNECT,
+   DISCONNECTED,
+   TIMEOUT,
+   UNKNOWN_METHOD,
+   FAILED
+};
+
+// Requests and replies share a single connection kept open between two components, any number of
+// them in flight at once and told apart by their correlation id. A request goes as its id (8
+// bytes), the length of its method and of its payload (4 bytes each) followed by both, a reply as
+// its id, a status (1 byte) and the length of its payload followed by it, all of them big endian
+struct RequestFormat
+{
+   static constexpr std::size_t ID_SIZE = 8;
+   static constexpr std::size_t LENGTH_SIZE = 4;
+   static constexpr std::size_t REQUEST_HEADER_SIZE = ID_SIZE + 2 * LENGTH_SIZE;
+   static constexpr std::size_t REPLY_HEADER_SIZE = ID_SIZE + 1 + LENGTH_SIZE;
+   static constexpr std::size_t MAX_METHOD_SIZE = 256;
+   static constexpr std::size_t MAX_PAYLOAD_SIZE = 16 * 1024 * 1024;
+
+   enum class Status : std::uint8_t
+   {
+      OK,
+      UNKNOWN_METHOD,
+      FAILED
+   };
+
+   static inline void appendRequest(std::string& out, const std::uint64_t id,
+                                    const std::string_view method, const std::string_view payload)
+   {
+      appendNumber(out, id, ID_SIZE);
+      appendNumber(out, method.size(), LENGTH_SIZE);
+      appendNumber(out, payload.size(), LENGTH_SIZE);
+      out.append(method);
+      out.append(payload);
+   }
+
+   static inline void appendReply(std::string& out, const std::uint64_t id, const Status status,
+                                  const std::string_view payload)
+   {
+      appendNumber(out, id, ID_SIZE);
+      out.push_back(static_cast<char>(status));
+      appendNumber(out, payload.size(), LENGTH_SIZE);
+      out.append(payload);
+   }
+
+   [[nodiscard]] static inline std::uint64_t readNumber(const char* data,
+                                                        const std::size_t size) noexcept
+   {
+      std::uint64_t value = 0;
+      for (std::size_t index = 0; index < size; index++)
+      {
+         value = (value << BYTE_BITS) | static_cast<std::uint8_t>(data[index]);
+      }
+      return value;
+   }
+
+private:
+   static constexpr unsigned int BYTE_BITS = 8;
+   static constexpr std::uint64_t BYTE_MASK = 0xff;
+
+   static inline void appendNumber(std::string& out, const std::uint64_t value,
+                                   const std::size_t size)
+   {
+      for (std::size_t index = 0; index < size; index++)
+      {
+         out.push_back(static_cast<char>((value >> (BYTE_BITS * (size - 1 - index))) & BYTE_MASK));
+      }
+   }
+};
+
+#endif // REQUESTPROTOCOL_HPP
@@ -0,0 +1,72 @@
+#ifndef REQUESTSERVER_HPP
+#define REQUESTSERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "RequestProtocol.hpp"
+#include "Result.hpp"
+#include "Thread.hpp"
+
+// Answers the requests of any number of clients from a thread of its own, handing each to the
+// handler of its method. Handlers run there one at a time and must not block, every other request
+// waits behind them. Whatever they touch is shared with the rest of the component
+class RequestServer final
+{
+public:
+   // Returns the reply payload, or the reason it failed sent back along with it
+   using Handler = std::function<Result<std::string, RequestError>(std::string_view payload)>;
+
+   RequestServer() = default;
+   RequestServer(const RequestServer& server) = delete;
+   RequestServer(RequestServer&& server) = delete;
+   auto operator=(const RequestServer& server) = delete;
+   auto operator=(RequestServer&& server) = delete;
+
+   [[nodiscard]] Result<void, RequestError> listen(unsigned int port);
+
+   // Handlers can come and go at any time, even from a handler. Requests for a method without one
+   // fail as UNKNOWN_METHOD
+   void handle(const std::string& method, Handler handler);
+
+   void close() noexcept;
+
+   ~RequestServer();
+
+private:
+   // How often the serving thread checks whether it was closed
+   static constexpr std::chrono::milliseconds POLL_PERIOD{100};
+   // A client not taking its replies for this long is dropped
+   static constexpr std::chrono::milliseconds SEND_TIMEOUT{1000};
+   static constexpr std::size_t RECEIVE_CHUNK = 64 * 1024;
+
+   struct Connection
+   {
+      int socket = -1;
+      std::string received;
+   };
+
+   std::shared_mutex mHandlersMutex;
+   std::map<std::string, Handler, std::less<>> mHandlers;
+   int mListener = -1;
+   std::atomic_bool mRunning = false;
+   std::unique_ptr<Thread> mThread;
+   std::vector<char> mChunk;
+   std::string mReplies;
+
+   void serve();
+   void accept(std::vector<Connection>& connections) const;
+   // Answers every request complete so far, false once the connection is to be dropped
+   [[nodiscard]] bool answer(Connection& connection);
+   void reply(std::uint64_t id, std::string_view method, std::string_view payload);
+};
+
+#endif // REQUESTSERVER_HPP
@@ -0,0 +1,46 @@
+#ifndef THREAD_HPP
+#define THREAD_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <optional>
+
+#include <pthread.h>
+
+// A thread started with the stack size set through setStackSize(), which std::thread has no say
+// in. Only the threads of the component go through it, the ones of its libraries keep the default.
+// Unlike std::thread it is joined when destroyed
+class Thread final
+{
+public:
+   using Function = std::function<void()>;
+
+   Thread() = default;
+   explicit Thread(Function function);
+   Thread(const Thread& thread) = delete;
+   Thread(Thread&& thread) noexcept;
+   auto operator=(const Thread& thread) = delete;
+   Thread& operator=(Thread&& thread) noexcept;
+
+   // Zero keeps the default of the platform, it applies to the threads started afterwards
+   static void setStackSize(std::size_t stackSize) noexcept;
+   [[nodiscard]] static std::size_t stackSize() noexcept;
+
+   [[nodiscard]] inline bool joinable() const noexcept
+   {
+      return mHandle.has_value();
+   }
+
+   void join() noexcept;
+
+   ~Thread();
+
+private:
+   static std::atomic_size_t mStackSize;
+   std::optional<pthread_t> mHandle;
+
+   static void* run(void* function) noexcept;
+};
+
+#endif // THREAD_HPP
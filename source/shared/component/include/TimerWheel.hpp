@@ -0,0 +1,111 @@
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+
+// Schedules one-shot and periodic timers on a hierarchical wheel: LEVELS wheels of SLOTS slots,
+// each slot of a level spanning a whole turn of the one below. Scheduling and cancelling cost the
+// same however many timers there are, timers are moved down a level as their time gets close and
+// run once advance() goes past their tick. Timers never fire early, but up to a resolution late.
+// It is not thread safe, it is meant to be driven from a single thread such as the component one
+class TimerWheel final
+{
+public:
+   using Clock = std::chrono::steady_clock;
+   using Callback = std::function<void()>;
+   // Stays safe to cancel once its timer is gone, it is never handed out again
+   using TimerId = std::uint64_t;
+
+   static constexpr std::size_t LEVELS = 4;
+   static constexpr std::size_t SLOT_BITS = 6;
+   static constexpr std::size_t SLOTS = std::size_t{1} << SLOT_BITS;
+
+   explicit TimerWheel(Clock::duration resolution = std::chrono::milliseconds(1),
+                       Clock::time_point origin = Clock::now());
+   TimerWheel(const TimerWheel& wheel) = delete;
+   TimerWheel(const TimerWheel&& wheel) = delete;
+   auto operator=(const TimerWheel& wheel) = delete;
+   auto operator=(const TimerWheel&& wheel) = delete;
+
+   // Runs the callback at the given time and then every period, if there is one. Times already
+   // gone fire on the next tick
+   TimerId schedule(Clock::time_point at, Callback callback,
+                    Clock::duration period = Clock::duration::zero());
+
+   // Returns whether the timer was still scheduled. A timer can cancel itself from its callback
+   bool cancel(TimerId id) noexcept;
+
+   // Runs the callbacks of every timer due by now, returning how many ran. Callbacks can schedule
+   // and cancel timers, the ones they schedule never running before the next tick
+   std::size_t advance(Clock::time_point now);
+
+   // When advance() should be called next, which can be before the earliest timer (while timers
+   // are moved down the wheel) but never after it. Nothing when there are no timers
+   [[nodiscard]] std::optional<Clock::time_point> nextExpiry() const noexcept;
+
+   [[nodiscard]] inline std::size_t size() const noexcept
+   {
+      return mSize;
+   }
+
+   [[nodiscard]] inline bool empty() const noexcept
+   {
+      return mSize == 0;
+   }
+
+private:
+   static constexpr std::uint32_t NONE = UINT32_MAX;
+   static constexpr std::uint64_t SLOT_MASK = SLOTS - 1;
+   // The list of timers being expired, past the slots of the wheels
+   static constexpr std::uint32_t EXPIRING = LEVELS * SLOTS;
+
+   enum class State
+   {
+      FREE,
+      SCHEDULED,
+      RUNNING,
+      // Cancelled by its own callback, released once that returns
+      CANCELLED
+   };
+
+   struct Node
+   {
+      Callback callback;
+      std::uint64_t expiry = 0;
+      std::uint64_t period = 0;
+      // Starting from one so that no timer is ever identified by zero
+      std::uint32_t generation = 1;
+      std::uint32_t previous = NONE;
+      std::uint32_t next = NONE;
+      std::uint32_t slot = NONE;
+      State state = State::FREE;
+   };
+
+   Clock::duration mResolution;
+   Clock::time_point mOrigin;
+   // Every tick before it was processed
+   std::uint64_t mNext = 0;
+   std::size_t mSize = 0;
+   // Nodes never move, so that a callback can schedule timers while it runs
+   std::deque<Node> mNodes;
+   std::uint32_t mFree = NONE;
+   std::array<std::uint32_t, LEVELS * SLOTS + 1> mSlots;
+   // Which slots of a level hold timers, to skip the empty ones
+   std::array<std::uint64_t, LEVELS> mOccupied{};
+
+   [[nodiscard]] std::uint64_t tick(Clock::time_point time, bool roundUp) const noexcept;
+   [[nodiscard]] Clock::time_point time(std::uint64_t tick) const noexcept;
+   void insert(std::uint32_t index) noexcept;
+   void unlink(std::uint32_t index) noexcept;
+   void release(std::uint32_t index) noexcept;
+   void cascade(std::size_t level) noexcept;
+   // Runs the timers of a tick, periodic ones missing their next period by now skip it
+   std::size_t expire(std::uint64_t tick, std::uint64_t now);
+};
+
+#endif // TIMERWHEEL_HPP
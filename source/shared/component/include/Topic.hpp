@@ -0,0 +1,364 @@
+#ifndef TOPIC_HPP
+#define TOPIC_HPP
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Schema<T>::FIELDS lists the members of T that go on the wire and, for a topic, Schema<T>::NAME
+// is the topic it is published on. Schemas are declared at global scope through the macros below:
+//
+//    struct TemperatureReading
+//    {
+//       float temperature = 0;
+//    };
+//    GROW_TOPIC(TemperatureReading, "TEMPERATURE", temperature)
+//
+// Fields can be booleans, numbers, strings, other structs with a schema and vectors of those.
+// "version" and "trace" are taken by the frame itself and cannot be field names
+template <class T> struct Schema;
+
+template <class Owner, class Member> struct SchemaField
+{
+   std::string_view name;
+   Member Owner::*member;
+};
+
+template <class Owner, class Member>
+SchemaField(const char*, Member Owner::*) -> SchemaField<Owner, Member>;
+
+template <class T>
+concept HasSchema = requires
+{
+   Schema<T>::FIELDS;
+};
+
+template <class T>
+concept TypedTopic = HasSchema<T> && requires
+{
+   Schema<T>::NAME;
+};
+
+// Expands macro(type, argument) for every argument, separated by commas
+#define GROW_PARENS ()
+#define GROW_EXPAND(...) GROW_EXPAND3(GROW_EXPAND3(GROW_EXPAND3(GROW_EXPAND3(__VA_ARGS__))))
+#define GROW_EXPAND3(...) GROW_EXPAND2(GROW_EXPAND2(GROW_EXPAND2(GROW_EXPAND2(__VA_ARGS__))))
+#define GROW_EXPAND2(...) GROW_EXPAND1(GROW_EXPAND1(GROW_EXPAND1(GROW_EXPAND1(__VA_ARGS__))))
+#define GROW_EXPAND1(...) __VA_ARGS__
+#define GROW_FOR_EACH(macro, type, ...)                                                            \
+   __VA_OPT__(GROW_EXPAND(GROW_FOR_EACH_HELPER(macro, type, __VA_ARGS__)))
+#define GROW_FOR_EACH_HELPER(macro, type, first, ...)                                              \
+   macro(type, first) __VA_OPT__(, GROW_FOR_EACH_AGAIN GROW_PARENS(macro, type, __VA_ARGS__))
+#define GROW_FOR_EACH_AGAIN() GROW_FOR_EACH_HELPER
+
+#define GROW_SCHEMA_FIELD(type, field) SchemaField{#field, &type::field}
+
+#define GROW_SCHEMA(type, ...)                                                                     \
+   template <> struct Schema<type>                                                                 \
+   {                                                                                               \
+      static constexpr auto FIELDS =                                                               \
+          std::make_tuple(GROW_FOR_EACH(GROW_SCHEMA_FIELD, type, __VA_ARGS__));                    \
+   };
+
+#define GROW_TOPIC(type, topic, ...)                                                               \
+   template <> struct Schema<type>                                                                 \
+   {                                                                                               \
+      static constexpr std::string_view NAME = topic;                                              \
+      static constexpr auto FIELDS =                                                               \
+          std::make_tuple(GROW_FOR_EACH(GROW_SCHEMA_FIELD, type, __VA_ARGS__));                    \
+   };
+
+template <class T> struct IsVector : std::false_type
+{
+};
+
+template <class T, class Allocator> struct IsVector<std::vector<T, Allocator>> : std::true_type
+{
+};
+
+// Writes values as json text straight from their schema, without building a json document
+class TopicWriter final
+{
+public:
+   TopicWriter() = delete;
+
+   template <class T> static void write(std::string& out, const T& value)
+   {
+      if constexpr (std::is_same_v<T, bool>)
+      {
+         out.append(value ? "true" : "false");
+      }
+      else if constexpr (std::is_arithmetic_v<T>)
+      {
+         writeNumber(out, value);
+      }
+      else if constexpr (std::is_same_v<T, std::string>)
+      {
+         writeString(out, value);
+      }
+      else if constexpr (HasSchema<T>)
+      {
+         writeOpen(out, value);
+         out.push_back('}');
+      }
+      else if constexpr (IsVector<T>::value)
+      {
+         out.push_back('[');
+         for (std::size_t index = 0; index < value.size(); index++)
+         {
+            if (index > 0)
+            {
+               out.push_back(',');
+            }
+            write(out, value[index]);
+         }
+         out.push_back(']');
+      }
+      else
+      {
+         static_assert(IsVector<T>::value, "Field type is not supported on the wire");
+      }
+   }
+
+   // Writes the fields of an object leaving it open, for the caller to add more or close it
+   template <HasSchema T> static void writeOpen(std::string& out, const T& value)
+   {
+      static_assert(std::tuple_size_v<decltype(Schema<T>::FIELDS)> > 0, "Schema without fields");
+
+      char separator = '{';
+      std::apply(
+          [&out, &value, &separator](const auto&... fields) {
+             ((out.push_back(separator), writeString(out, fields.name), out.push_back(':'),
+               write(out, value.*fields.member), separator = ','),
+              ...);
+          },
+          Schema<T>::FIELDS);
+   }
+
+   static void writeString(std::string& out, std::string_view text);
+
+private:
+   template <class T> static void writeNumber(std::string& out, const T number)
+   {
+      if constexpr (std::is_floating_point_v<T>)
+      {
+         // Json has no representation for these, as nlohmann does they go as null
+         if (!std::isfinite(number))
+         {
+            out.append("null");
+            return;
+         }
+      }
+
+      constexpr std::size_t NUMBER_MAX_CHARS = 32;
+      std::array<char, NUMBER_MAX_CHARS> buffer{};
+      const auto converted = std::to_chars(buffer.begin(), buffer.end(), number);
+      out.append(buffer.data(), converted.ptr);
+   }
+};
+
+// Reads json text straight into values from their schema. Members that are not part of the schema
+// are skipped, missing or null ones keep the value they had
+class TopicReader final
+{
+public:
+   static constexpr unsigned int MAX_DEPTH = 32;
+
+   explicit inline TopicReader(const std::string_view text) noexcept : mText{text}
+   {
+   }
+
+   template <class T> [[nodiscard]] bool read(T& value)
+   {
+      skipWhitespace();
+      if (literal("null"))
+      {
+         return true;
+      }
+
+      if constexpr (std::is_same_v<T, bool>)
+      {
+         if (literal("true"))
+         {
+            value = true;
+            return true;
+         }
+         if (literal("false"))
+         {
+            value = false;
+            return true;
+         }
+         return false;
+      }
+      else if constexpr (std::is_arithmetic_v<T>)
+      {
+         return readNumber(value);
+      }
+      else if constexpr (std::is_same_v<T, std::string>)
+      {
+         return readString(value);
+      }
+      else if constexpr (HasSchema<T>)
+      {
+         return readObject(value, [](std::string_view, TopicReader& reader) {
+            return reader.skip();
+         });
+      }
+      else if constexpr (IsVector<T>::value)
+      {
+         return readArray(value);
+      }
+      else
+      {
+         static_assert(IsVector<T>::value, "Field type is not supported on the wire");
+      }
+   }
+
+   // Reads an object into value, handing the members it has no field for to
+   // other(key, reader), which must consume their value
+   template <HasSchema T, class Other> [[nodiscard]] bool readObject(T& value, Other&& other)
+   {
+      skipWhitespace();
+      if (!consume('{') || !enter())
+      {
+         return false;
+      }
+
+      skipWhitespace();
+      if (consume('}'))
+      {
+         mDepth--;
+         return true;
+      }
+
+      do
+      {
+         skipWhitespace();
+         if (!readString(mKey))
+         {
+            return false;
+         }
+         skipWhitespace();
+         if (!consume(':'))
+         {
+            return false;
+         }
+
+         bool matched = false;
+         bool valid = true;
+         std::apply(
+             [this, &value, &matched, &valid](const auto&... fields) {
+                ((!matched && fields.name == mKey
+                      ? (matched = true, valid = read(value.*fields.member))
+                      : false),
+                 ...);
+             },
+             Schema<T>::FIELDS);
+         if (!matched)
+         {
+            valid = other(std::string_view(mKey), *this);
+         }
+         if (!valid)
+         {
+            return false;
+         }
+         skipWhitespace();
+      } while (consume(','));
+
+      mDepth--;
+      return consume('}');
+   }
+
+   [[nodiscard]] bool readString(std::string& out);
+
+   // Consumes any value
+   [[nodiscard]] bool skip();
+
+   // Whether only whitespace is left
+   [[nodiscard]] bool finished() noexcept;
+
+private:
+   std::string_view mText;
+   std::size_t mPosition = 0;
+   unsigned int mDepth = 0;
+   // Member names, kept across members so that reading them does not allocate
+   std::string mKey;
+
+   void skipWhitespace() noexcept;
+   [[nodiscard]] bool consume(char character) noexcept;
+   [[nodiscard]] bool literal(std::string_view text) noexcept;
+   [[nodiscard]] bool enter() noexcept;
+   [[nodiscard]] std::string_view numberText() noexcept;
+
+   template <class T> [[nodiscard]] bool readNumber(T& value)
+   {
+      const auto text = numberText();
+      if constexpr (std::is_floating_point_v<T>)
+      {
+         const auto parsed = std::from_chars(text.data(), text.data() + text.size(), value);
+         return !text.empty() && parsed.ec == std::errc{} &&
+                parsed.ptr == text.data() + text.size();
+      }
+      else
+      {
+         const auto* end = text.data() + text.size();
+         const auto parsed = std::from_chars(text.data(), end, value);
+         if (!text.empty() && parsed.ec == std::errc{} && parsed.ptr == end)
+         {
+            return true;
+         }
+
+         // Integers written as 21.0 or 2.1e1 by other serializers are still integers
+         double number = 0;
+         const auto fallback = std::from_chars(text.data(), end, number);
+         if (text.empty() || fallback.ec != std::errc{} || fallback.ptr != end ||
+             std::trunc(number) != number ||
+             number < static_cast<double>(std::numeric_limits<T>::lowest()) ||
+             number > static_cast<double>(std::numeric_limits<T>::max()))
+         {
+            return false;
+         }
+         value = static_cast<T>(number);
+         return true;
+      }
+   }
+
+   template <class T> [[nodiscard]] bool readArray(std::vector<T>& values)
+   {
+      skipWhitespace();
+      if (!consume('[') || !enter())
+      {
+         return false;
+      }
+
+      values.clear();
+      skipWhitespace();
+      if (consume(']'))
+      {
+         mDepth--;
+         return true;
+      }
+
+      do
+      {
+         if (!read(values.emplace_back()))
+         {
+            return false;
+         }
+         skipWhitespace();
+      } while (consume(','));
+
+      mDepth--;
+      return consume(']');
+   }
+};
+
+#endif // TOPIC_HPP
@@ -0,0 +1,105 @@
+#include "Aggregator.hpp"
+
+#include <array>
+#include <cmath>
+
+Aggregator::Aggregator(const Window window, const std::size_t size, const std::size_t step)
+    : mSamples(std::max<std::size_t>(size, 1)),
+      mStep{window == Window::TUMBLING || step == 0 ? mSamples.size() : step}
+{
+}
+
+std::optional<Aggregator::Statistics> Aggregator::add(const float sample)
+{
+   mSamples[mNext] = sample;
+   mNext = (mNext + 1) % mSamples.size();
+   mFilled = std::min(mFilled + 1, mSamples.size());
+   mSinceLast++;
+
+   if (mFilled < mSamples.size() || mSinceLast < mStep)
+   {
+      return std::nullopt;
+   }
+
+   mSinceLast = 0;
+   return reduce(mSamples);
+}
+
+Aggregator::Statistics Aggregator::reduce(std::span<const float> samples) noexcept
+{
+   if (samples.empty())
+   {
+      return {};
+   }
+
+   // Independent accumulators per lane let the compiler keep each of them in a SIMD register
+   // without reordering floating point operations. Values are centered on the first sample so
+   // that the variance does not suffer from cancellation
+   constexpr std::size_t LANES = 16;
+   const auto shift = samples.front();
+   std::array<float, LANES> minimum{};
+   std::array<float, LANES> maximum{};
+   std::array<float, LANES> sum{};
+   std::array<float, LANES> squares{};
+   minimum.fill(shift);
+   maximum.fill(shift);
+
+   const auto* data = samples.data();
+   const auto blocks = samples.size() / LANES * LANES;
+   for (std::size_t i = 0; i < blocks; i += LANES)
+   {
+      for (std::size_t lane = 0; lane < LANES; lane++)
+      {
+         const auto value = data[i + lane];
+         const auto centered = value - shift;
+         minimum[lane] = value < minimum[lane] ? value : minimum[lane];
+         maximum[lane] = value > maximum[lane] ? value : maximum[lane];
+         sum[lane] += centered;
+         squares[lane] += centered * centered;
+      }
+   }
+
+   for (std::size_t i = blocks; i < samples.size(); i++)
+   {
+      const auto value = data[i];
+      const auto centered = value - shift;
+      minimum[0] = value < minimum[0] ? value : minimum[0];
+      maximum[0] = value > maximum[0] ? value : maximum[0];
+      sum[0] += centered;
+      squares[0] += centered * centered;
+   }
+
+   Statistics statistics{shift, shift, 0, 0, samples.size()};
+   double totalSum = 0;
+   double totalSquares = 0;
+   for (std::size_t lane = 0; lane < LANES; lane++)
+   {
+      statistics.min = std::min(statistics.min, minimum[lane]);
+      statistics.max = std::max(statistics.max, maximum[lane]);
+      totalSum += sum[lane];
+      totalSquares += squares[lane];
+   }
+
+   const auto count = static_cast<double>(samples.size());
+   const auto centeredMean = totalSum / count;
+   statistics.mean = static_cast<float>(shift + centeredMean);
+   const auto variance = totalSquares / count - centeredMean * centeredMean;
+   statistics.stddev = static_cast<float>(std::sqrt(std::max(variance, 0.0)));
+
+   return statistics;
+}
+
+std::optional<Aggregator::Window> Aggregator::window(const std::string& name) noexcept
+{
+   if (name == "tumbling")
+   {
+      return Window::TUMBLING;
+   }
+
+   if (name == "sliding")
+   {
+      return Window::SLIDING;
+   }
+
+   return std::nullopt;
+}
@@ -3,6 +3,8 @@
 
 #include <csignal>
 
+#include "ProcessStats.hpp"
+
 Component* Component::mInstance = nullptr;
 
 Component::Component()
@@ -21,49 +23,110 @@ bool Component::start()
    {
       logger().info("Starting component");
 
+      if (mTracePath.has_value())
+      {
+         logger().info("Tracing into {}", mTracePath.value().string());
+         Tracer::enable(std::string(name()));
+      }
+
       if (mConfigFilePath.has_value())
       {
+         TraceSpan span("start.configuration");
          logger().info("Loading configuration file from {}", mConfigFilePath.value().string());
-         auto loadError = mConfiguration.loadFromFile(mConfigFilePath.value());
-         if (loadError.has_value())
+         auto loaded = mConfiguration.loadFromFile(mConfigFilePath.value());
+         if (!loaded)
          {
-            logger().err("Error loading configuration file: {}", loadError.value().asString());
-            return false;
+            logger().err("Error loading configuration file: {}", loaded.error().asString());
+            return abortStart();
          }
 
          auto configVersion = mConfiguration.settingValue<std::string>("project_version");
          if (!configVersion.has_value())
          {
             logger().err("Configuration file does not contain project version information");
-            return false;
+            return abortStart();
          }
 
          if (configVersion.value() != version())
          {
             logger().err("Configuration file version does not match project version {} vs {}",
                          configVersion.value(), version());
-            return false;
+            return abortStart();
          }
       }
 
-      if (!onStarted())
+      mLowMemory = mLowMemory || settingValue<bool>(LOW_MEMORY_CFG).value_or(false);
+      if (mLowMemory)
       {
-         return false;
+         applyLowMemoryProfile();
+      }
+      else
+      {
+         Thread::setStackSize(0);
+      }
+
+      mPublishPort = publishPort(std::string(name()));
+      mControlPort = controlPort(std::string(name()));
+      if (mControlPort.has_value())
+      {
+         std::unique_lock lock(mChannelsMutex);
+         mControlPorts.insert(mControlPort.value());
+      }
+      loadControlTopics();
+      loadCompression();
+
+      if (!openOutbox() || !openReplay() || !openResponder())
+      {
+         return abortStart();
+      }
+
+      // Subscriptions kept from a previous run hand frames over again
+      for (const auto& [port, sequencing] : mSequencingMap)
+      {
+         std::lock_guard lock(sequencing->mutex);
+         sequencing->stopping = false;
+      }
+
+      bool started = false;
+      {
+         TraceSpan span("start.onStarted");
+         started = onStarted();
+      }
+      if (!started)
+      {
+         return abortStart();
       }
 
       mFinished = false;
 
+      mTimers.cancel(mSuppressedTimer);
+      mSuppressedTimer = mTimers.schedule(
+          TimerWheel::Clock::now() + SUPPRESSED_REPORT_PERIOD,
+          [this]() { logger().reportSuppressed(); }, SUPPRESSED_REPORT_PERIOD);
+
       mShouldRun = true;
-      mThread = std::make_unique<std::thread>([this]() {
+      mThread = std::make_unique<Thread>([this]() {
          while (mShouldRun)
          {
+            if (!mTimers.empty())
+            {
+               TraceSpan span("timers");
+               mTimers.advance(TimerWheel::Clock::now());
+            }
+
+            TraceSpan span("mainLoop");
             mainLoop();
          }
 
+         joinRecoveries();
          if (mGracefulStop)
          {
             onStopped();
          }
+         closeOutboxes();
+         mReplayServer.close();
+         mRequestServer.close();
+         writeTrace();
 
          {
             std::lock_guard lk(mMutex);
@@ -71,6 +134,8 @@ bool Component::start()
          }
          mConditionVariable.notify_one();
       });
+
+      reportFootprint();
    }
    else
    {
@@ -143,23 +208,31 @@ Component::~Component()
 
 bool Component::parseCmdArguments(int argc, char** argv)
 {
-   cxxopts::Options options{name(), description()};
+   cxxopts::Options options{std::string(name()), std::string(description())};
 
    try
    {
       const std::string LOGLEVEL_STR_L = "loglevel";
       const std::string HELP_STR_L = "help";
       const std::string CONFIGPATH_STR_L = "config";
+      const std::string TRACEPATH_STR_L = "trace";
+      const std::string LOWMEMORY_STR_L = "low-memory";
 
       const std::string LOGLEVEL_STR_S = "l";
       const std::string HELP_STR_S = "h";
       const std::string CONFIGPATH_STR_S = "c";
+      const std::string TRACEPATH_STR_S = "t";
+      const std::string LOWMEMORY_STR_S = "m";
 
       options.add_options()(CONFIGPATH_STR_S + "," + CONFIGPATH_STR_L,
                             "Path of the configuration file", cxxopts::value<std::string>())(
           LOGLEVEL_STR_S + "," + LOGLEVEL_STR_L, "Logging level",
-          cxxopts::value<std::string>()->default_value("info"))(HELP_STR_S + "," + HELP_STR_L,
-                                                                "Print usage");
+          cxxopts::value<std::string>()->default_value("info"))(
+          TRACEPATH_STR_S + "," + TRACEPATH_STR_L,
+          "Path of a Chrome/Perfetto trace to write on exit", cxxopts::value<std::string>())(
+          LOWMEMORY_STR_S + "," + LOWMEMORY_STR_L,
+          "Run with fewer threads and smaller stacks")(
+          HELP_STR_S + "," + HELP_STR_L, "Print usage");
 
       auto result = options.parse(argc, argv);
 
@@ -177,6 +250,17 @@ bool Component::parseCmdArguments(int argc, char** argv)
       {
          mConfigFilePath = result["config"].as<std::string>();
       }
+
+      // Tracing only when asked to
+      if (static_cast<bool>(result.count(TRACEPATH_STR_L)))
+      {
+         mTracePath = result[TRACEPATH_STR_L].as<std::string>();
+      }
+
+      if (static_cast<bool>(result.count(LOWMEMORY_STR_L)))
+      {
+         mLowMemory = true;
+      }
    }
    catch (const cxxopts::OptionException& exp)
    {
@@ -188,174 +272,979 @@ bool Component::parseCmdArguments(int argc, char** argv)
    return true;
 }
 
-std::optional<Error<Component::PublishError>> Component::publish(const unsigned int port,
-                                                                 const std::string& payload)
+tcp_pubsub::Publisher& Component::publisher(const unsigned int port)
 {
-   if (!mPubSubExecutor)
    {
-      mPubSubExecutor = std::make_shared<tcp_pubsub::Executor>(
-          MAXIMUM_PUBSUB_THREADS,
+      // Publishers are only ever added, once there the one of a port stays where it is
+      std::shared_lock lock(mChannelsMutex);
+      if (auto found = mPublisherMap.find(port); found != mPublisherMap.end())
+      {
+         return found->second;
+      }
+   }
+
+   auto portExecutor = executor(port);
+   std::unique_lock lock(mChannelsMutex);
+   return mPublisherMap.try_emplace(port, std::move(portExecutor), port).first->second;
+}
+
+std::shared_ptr<tcp_pubsub::Executor> Component::executor(const unsigned int port)
+{
+   std::unique_lock lock(mChannelsMutex);
+   // Control channels get an executor of their own, so that their sends and receives are never
+   // queued behind the bulk ones
+   const auto control = mControlPorts.contains(port);
+   auto& executor = control ? mControlExecutor : mPubSubExecutor;
+   if (!executor)
+   {
+      const auto bulkThreads = mLowMemory ? LOW_MEMORY_PUBSUB_THREADS : MAXIMUM_PUBSUB_THREADS;
+      executor = std::make_shared<tcp_pubsub::Executor>(
+          control ? CONTROL_PUBSUB_THREADS : bulkThreads,
           [](const tcp_pubsub::logger::LogLevel& logLevel, const std::string& msg) {});
    }
 
-   auto publisher = mPublisherMap.try_emplace(port, mPubSubExecutor, port).first;
-   if (!publisher->second.send(&payload[0], payload.size()))
+   return executor;
+}
+
+unsigned int Component::channelPort(const std::string_view frame) const
+{
+   if (mControlPort.has_value() && !mControlTopics.empty() &&
+       mControlTopics.contains(frame.substr(0, frame.find(FrameFormat::TOPIC_DELIMITER))))
+   {
+      return mControlPort.value();
+   }
+
+   return mPublishPort.value();
+}
+
+void Component::setTopicPriority(const std::string& topic, const Priority priority)
+{
+   if (priority == Priority::CONTROL)
+   {
+      mControlTopics.insert(topic);
+   }
+   else
+   {
+      mControlTopics.erase(topic);
+   }
+}
+
+void Component::waitForTimers()
+{
+   auto wakeUp = TimerWheel::Clock::now() + TIMER_WAIT_MAX;
+   if (const auto next = mTimers.nextExpiry(); next.has_value())
+   {
+      wakeUp = std::min(wakeUp, next.value());
+   }
+
+   std::this_thread::sleep_until(wakeUp);
+}
+
+void Component::applyLowMemoryProfile()
+{
+   logger().info("Running with the low memory profile");
+
+   // Only for the threads started from here on by the component, pub/sub ones are left alone
+   Thread::setStackSize(LOW_MEMORY_STACK_SIZE);
+}
+
+void Component::reportFootprint()
+{
+   constexpr std::size_t KIBIBYTE = 1024;
+   const auto stats = ProcessStats::current();
+   logger().info("Started with {}KiB resident (peak {}KiB) on {} threads",
+                 stats.residentBytes / KIBIBYTE, stats.peakResidentBytes / KIBIBYTE,
+                 stats.threads);
+}
+
+void Component::loadControlTopics()
+{
+   mControlTopics.clear();
+   for (unsigned int index = 0;; index++)
+   {
+      auto topic = settingValue<std::string>(std::string(CONTROL_TOPICS_CFG) + ".[" +
+                                             std::to_string(index) + "]");
+      if (!topic.has_value())
+      {
+         break;
+      }
+
+      mControlTopics.insert(topic.value());
+   }
+
+   if (mControlPort.has_value())
+   {
+      logger().info("Publishing control traffic on port {}", mControlPort.value());
+   }
+   else if (!mControlTopics.empty())
+   {
+      logger().warn("Control topics configured without a control port, they go as bulk traffic");
+   }
+}
+
+void Component::openPublisher(const unsigned int port)
+{
+   publisher(port);
+}
+
+bool Component::send(const tcp_pubsub::Publisher& target, const std::string_view frame)
+{
+   // Sending a single buffer wraps it into a new vector every time, reusing one instead
+   thread_local std::vector<std::pair<const char* const, const std::size_t>> buffers;
+   buffers.clear();
+   buffers.emplace_back(frame.data(), frame.size());
+   return target.send(buffers);
+}
+
+bool Component::openOutbox()
+{
+   // Opted in with outbox = { memory = <bytes>; disk = <bytes>; path = "<spill file>";
+   // backoff = <ms>; max_backoff = <ms>; }, covering the frames this component publishes. Each
+   // channel gets an outbox of its own, so that control frames never wait behind bulk ones
+   const auto path = std::string(OUTBOX_CFG) + ".";
+   auto memory = settingValue<unsigned int>(path + "memory");
+   if (!memory.has_value())
+   {
+      return true;
+   }
+
+   if (!mPublishPort.has_value())
+   {
+      logger().warn("Outbox configured without a publisher port, ignoring it");
+      return true;
+   }
+
+   Outbox::Settings settings;
+   settings.memory = memory.value();
+   settings.disk = settingValue<unsigned int>(path + "disk").value_or(0);
+   settings.path =
+       settingValue<std::string>(path + "path").value_or(std::string(name()) + ".outbox");
+   settings.backoff = std::chrono::milliseconds(
+       settingValue<unsigned int>(path + "backoff").value_or(settings.backoff.count()));
+   settings.maxBackoff = std::chrono::milliseconds(
+       settingValue<unsigned int>(path + "max_backoff").value_or(settings.maxBackoff.count()));
+
+   if (!openOutbox(mPublishPort.value(), settings))
+   {
+      return false;
+   }
+
+   if (mControlPort.has_value())
+   {
+      settings.path += CONTROL_OUTBOX_SUFFIX;
+      if (!openOutbox(mControlPort.value(), settings))
+      {
+         return false;
+      }
+   }
+
+   logger().info("Retrying failed publishes with {} bytes in memory and {} on disk",
+                 settings.memory, settings.disk);
+   return true;
+}
+
+bool Component::openOutbox(const unsigned int port, const Outbox::Settings& settings)
+{
+   // Creating the publisher here so that the retrying thread never touches the publisher map
+   auto& portPublisher = publisher(port);
+   auto& outbox = mOutboxMap.try_emplace(port).first->second;
+   auto opened = outbox.open(settings, [&portPublisher](const std::string_view frame) {
+      return send(portPublisher, frame);
+   });
+   if (!opened)
    {
-      return make_optional_error<PublishError>(PublishError::UNABLE_TO_SEND,
-                                               "Error in sending payload");
+      logger().err("Unable to open outbox on port {}: {}", port,
+                   opened.error().furtherInfo().value_or(opened.error().asString()));
+      return false;
    }
 
-   return make_optional_error<PublishError>();
+   return true;
 }
 
-std::optional<Error<Component::PublishError>>
-Component::publish(const unsigned int port, const std::string& topic, const std::string& payload)
+void Component::loadCompression()
 {
-   if (topic.empty())
+   // Opted in with compression = { algorithm = "lz4" or "zstd"; threshold = <bytes>;
+   // level = <zstd level or lz4 acceleration>; }, covering the frames this component publishes
+   const auto path = std::string(COMPRESSION_CFG) + ".";
+   mCompression = {};
+   auto algorithmName = settingValue<std::string>(path + "algorithm");
+   if (!algorithmName.has_value())
+   {
+      return;
+   }
+
+   auto algorithm = FrameCompressor::algorithm(algorithmName.value());
+   if (!algorithm.has_value())
    {
-      return make_optional_error<PublishError>(PublishError::INVALID_TOPIC,
-                                               "Trying to publish with empty topic");
+      logger().warn("Invalid compression algorithm {}, compression disabled",
+                    algorithmName.value());
+      return;
    }
 
-   if (topic.find(PUBSUB_TOPIC_DELIMITER) != std::string::npos)
+   mCompression.algorithm = algorithm.value();
+   mCompression.threshold =
+       settingValue<unsigned int>(path + "threshold").value_or(mCompression.threshold);
+   mCompression.level = settingValue<int>(path + "level").value_or(mCompression.level);
+   logger().info("Compressing published payloads of at least {} bytes with {}",
+                 mCompression.threshold, algorithmName.value());
+}
+
+void Component::writeTrace()
+{
+   if (!mTracePath.has_value())
    {
-      return make_optional_error<PublishError>(PublishError::INVALID_TOPIC,
-                                               "Topic contains invalid character");
+      return;
    }
 
-   if (payload.empty())
+   Tracer::disable();
+   auto written = Tracer::write(mTracePath.value());
+   if (!written)
    {
-      return make_optional_error<PublishError>(PublishError::INVALID_PAYLOAD,
-                                               "Trying to publish with empty payload");
+      logger().err("Unable to write trace: {}",
+                   written.error().furtherInfo().value_or(written.error().asString()));
+      return;
    }
 
-   return publish(port, topic + PUBSUB_TOPIC_DELIMITER + payload);
+   logger().info("Wrote {} trace events into {} ({} dropped)", Tracer::events(),
+                 mTracePath.value().string(), Tracer::dropped());
 }
 
-std::optional<Error<Component::PublishError>> Component::publish(const std::string& topic,
-                                                                 const std::string& payload)
+bool Component::abortStart()
 {
-   auto port = publishPort(name());
+   // Whatever was opened before the failure goes, as it would once stopped
+   closeOutboxes();
+   mReplayServer.close();
+   mRequestServer.close();
+   Tracer::disable();
+   return false;
+}
+
+void Component::closeOutboxes()
+{
+   // Closed outboxes stay in place since callbacks may still be publishing through them
+   for (auto& [port, outbox] : mOutboxMap)
+   {
+      outbox.close();
+      const auto statistics = outbox.statistics();
+      logger().info("Outbox on port {} retried {} frames, spilled {}, dropped {}, lost {} on stop",
+                    port, statistics.retried, statistics.spilled, statistics.dropped,
+                    statistics.memoryFrames + statistics.diskFrames);
+   }
+}
+
+bool Component::openReplay()
+{
+   // Opted in with replay = { frames = <frames>; bytes = <bytes>; }, keeping the last frames of
+   // every channel of this component. Subscribers get them back through the ReplayPublisher.<name>
+   // port, without it they are only told about what they missed
+   mReplayServer.close();
+   mReplayMap.clear();
+   const auto path = std::string(REPLAY_CFG) + ".";
+   auto frames = settingValue<unsigned int>(path + "frames");
+   auto bytes = settingValue<unsigned int>(path + "bytes");
+   if ((!frames.has_value() && !bytes.has_value()) || !mPublishPort.has_value())
+   {
+      return true;
+   }
+
+   const ReplayBuffer::Settings settings{frames.value_or(ReplayBuffer::FRAMES_DEFAULT),
+                                         bytes.value_or(ReplayBuffer::BYTES_DEFAULT)};
+   for (const auto& port : {mPublishPort, mControlPort})
+   {
+      if (port.has_value())
+      {
+         mReplayMap.try_emplace(port.value(), std::make_unique<ReplayChannel>(settings));
+      }
+   }
+
+   auto port = replayPort(std::string(name()));
    if (!port.has_value())
    {
-      return make_optional_error<PublishError>(
-          PublishError::NETWORK_CONFIGURATION_MISSING,
-          "Network configuration is missing for this component");
+      logger().warn("Replay port is missing, subscribers will only be told what they missed");
+      return true;
    }
 
-   return publish(port.value(), topic, payload);
+   auto listening = mReplayServer.listen(
+       port.value(),
+       [this](const unsigned int channel, const std::uint64_t epoch, const std::uint64_t first,
+              const std::uint64_t last, const ReplayBuffer::Callback& callback) {
+          auto replay = mReplayMap.find(channel);
+          if (replay == mReplayMap.end())
+          {
+             return;
+          }
+
+          // Copied out first, so that publishing never waits on a subscriber
+          std::vector<std::pair<std::uint64_t, std::string>> frames;
+          {
+             std::lock_guard lock(replay->second->mutex);
+             if (replay->second->buffer.epoch() != epoch)
+             {
+                return;
+             }
+             replay->second->buffer.replay(
+                 first, last,
+                 [&frames](const std::uint64_t sequence, const std::string_view frame) {
+                    frames.emplace_back(sequence, frame);
+                 });
+          }
+          for (const auto& [sequence, frame] : frames)
+          {
+             callback(sequence, frame);
+          }
+       });
+   if (!listening)
+   {
+      logger().err("Unable to serve replays: {}",
+                   listening.error().furtherInfo().value_or(listening.error().asString()));
+      return false;
+   }
+
+   logger().info("Keeping the last {} frames ({} bytes) of every channel for replay on port {}",
+                 settings.frames, settings.bytes, port.value());
+   return true;
 }
 
-std::optional<Error<Component::SubscriberError>>
-Component::subscribe(unsigned int port, const SubscriberCallback& callback)
+bool Component::openResponder()
 {
-   if (!mPubSubExecutor)
    {
-      mPubSubExecutor = std::make_shared<tcp_pubsub::Executor>(
-          MAXIMUM_PUBSUB_THREADS,
-          [](const tcp_pubsub::logger::LogLevel& logLevel, const std::string& msg) {});
+      std::lock_guard lock(mRequestMutex);
+      mResponderPorts.clear();
+      for (const auto& component : mConfiguration.settingNames("Responder"))
+      {
+         if (auto port = responderPort(component); port.has_value())
+         {
+            mResponderPorts.insert_or_assign(component, port.value());
+         }
+      }
+   }
+
+   mRequestServer.close();
+   auto port = responderPort(std::string(name()));
+   if (!port.has_value())
+   {
+      return true;
+   }
+
+   auto listening = mRequestServer.listen(port.value());
+   if (!listening)
+   {
+      logger().err("Unable to serve requests: {}",
+                   listening.error().furtherInfo().value_or(listening.error().asString()));
+      return false;
    }
 
-   auto subscriberPair = mSubscriberMap.try_emplace(port, mPubSubExecutor);
+   logger().info("Serving requests on port {}", port.value());
+   return true;
+}
+
+void Component::handle(const std::string& method, RequestServer::Handler handler)
+{
+   mRequestServer.handle(method, std::move(handler));
+}
+
+RequestClient::Reply Component::request(const std::string& componentName,
+                                        const std::string_view method,
+                                        const std::string_view payload,
+                                        const std::chrono::milliseconds timeout)
+{
+   RequestClient* client = nullptr;
+   {
+      std::lock_guard lock(mRequestMutex);
+      auto found = mRequestClients.find(componentName);
+      if (found == mRequestClients.end())
+      {
+         auto port = mResponderPorts.find(componentName);
+         if (port == mResponderPorts.end())
+         {
+            std::promise<Result<std::string, RequestError>> missing;
+            missing.set_value(
+                Error(RequestError::NETWORK_CONFIGURATION_MISSING,
+                      ErrorDetail::compose("No responder port configured for ", componentName)));
+            return missing.get_future();
+         }
+
+         found = mRequestClients
+                     .try_emplace(componentName, std::make_unique<RequestClient>(port->second))
+                     .first;
+      }
+      client = found->second.get();
+   }
+
+   // Clients live as long as the component, the lock is only held to find them
+   return client->request(method, payload, timeout);
+}
+
+Result<void, Component::PublishError> Component::publish(const unsigned int port,
+                                                         const std::string_view frame)
+{
+   auto replay = mReplayMap.find(port);
+   if (replay == mReplayMap.end())
+   {
+      return deliver(port, frame);
+   }
+
+   auto& channel = *replay->second;
+   std::lock_guard lock(channel.mutex);
+   ReplayBuffer::stamp(channel.stamped, channel.buffer.epoch(), channel.buffer.push(frame), frame);
+   return deliver(port, channel.stamped);
+}
+
+Result<void, Component::PublishError> Component::deliver(const unsigned int port,
+                                                         const std::string_view frame)
+{
+   if (auto outbox = mOutboxMap.find(port); outbox != mOutboxMap.end())
+   {
+      if (!outbox->second.send(frame))
+      {
+         return Error(PublishError::UNABLE_TO_SEND, "Outbox is full, frame dropped");
+      }
+      return {};
+   }
+
+   if (!send(publisher(port), frame))
+   {
+      return Error(PublishError::UNABLE_TO_SEND, "Error in sending payload");
+   }
+
+   return {};
+}
+
+Result<void, Component::SubscriberError>
+Component::subscribeFrames(const unsigned int port, const FrameCallback& callback)
+{
+   auto subscriberPair = mSubscriberMap.try_emplace(port, executor(port));
    if (!subscriberPair.second)
    {
-      return make_optional_error<SubscriberError>(
-          SubscriberError::ALREADY_SUBSCRIBED, "Subscribe requested on an already subscribed port");
+      return Error(SubscriberError::ALREADY_SUBSCRIBED,
+                   "Subscribe requested on an already subscribed port");
    }
 
    auto& subscriber = subscriberPair.first->second;
 
-   subscriber.setCallback([this, callback](const tcp_pubsub::CallbackData& callback_data) {
-      const auto receivedMessage =
-          std::string(callback_data.buffer_->data(), callback_data.buffer_->size());
+   subscriber.setCallback([callback](const tcp_pubsub::CallbackData& callback_data) {
+      callback(std::string_view(callback_data.buffer_->data(), callback_data.buffer_->size()));
+   });
+
+   subscriber.addSession("127.0.0.1", port);
+
+   return {};
+}
 
-      const auto delimiterPos = receivedMessage.find(PUBSUB_TOPIC_DELIMITER);
-      if (delimiterPos == std::string::npos || delimiterPos == 0)
+Component::FrameCallback Component::decoding(const SubscriberCallback& callback)
+{
+   return [this, callback](const std::string_view frame) {
+      Result<void, FrameError> decoded;
       {
-         callback(make_optional_error<SubscriberError>(SubscriberError::INVALID_TOPIC,
-                                                       "Message received with empty topic"),
-                  "", "");
-         return;
+         TraceSpan span("subscribe.parse");
+         decoded = decoder().decode(frame, version());
       }
-      if (delimiterPos + 1 == std::string::npos)
+      if (!decoded)
       {
-         callback(make_optional_error<SubscriberError>(SubscriberError::INVALID_PAYLOAD,
-                                                       "Message received with empty payload"),
-                  "", "");
+         callback(subscriberError(decoded.error()), "", "");
          return;
       }
 
-      const auto topic = receivedMessage.substr(0, delimiterPos);
-      const auto message = receivedMessage.substr(delimiterPos + 1, std::string::npos);
+      // Whatever the callback publishes carries on the trace of the message it handles
+      const auto traceId = decoder().traceId();
+      TraceSpan span("subscribe.callback", traceId);
+      Tracer::flow(TraceEvent::Kind::FLOW_END, traceId);
+      Tracer::setCurrent(traceId);
+      callback({}, decoder().topic(), decoder().payload());
+      Tracer::setCurrent(0);
+   };
+}
+
+Result<void, Component::SubscriberError>
+Component::subscribeTopic(const std::string& componentName, const std::string_view topic,
+                          const FrameCallback& callback)
+{
+   auto port = publishPort(componentName);
+   if (!port.has_value())
+   {
+      return Error(SubscriberError::NETWORK_CONFIGURATION_MISSING,
+                   ErrorDetail::compose("Network configuration is missing for the ", componentName,
+                                        " component"));
+   }
 
-      nlohmann::json parsedJson;
-      try
+   auto [dispatch, created] = mTopicDispatchMap.try_emplace(port.value());
+   if (created)
+   {
+      dispatch->second = std::make_shared<TopicDispatch>();
+      auto subscribed = subscribeFrames(
+          componentName, [topics = dispatch->second](const std::string_view frame) {
+             const auto name = frame.substr(0, frame.find(FrameFormat::TOPIC_DELIMITER));
+             std::shared_lock lock(topics->mutex);
+             // Topics nobody subscribed to are of no interest
+             if (auto topicCallback = topics->callbacks.find(name);
+                 topicCallback != topics->callbacks.end())
+             {
+                topicCallback->second(frame);
+             }
+          });
+      if (!subscribed)
       {
-         parsedJson = nlohmann::json::parse(message);
+         mTopicDispatchMap.erase(dispatch);
+         return subscribed;
       }
-      catch (const nlohmann::json::parse_error& ex)
+   }
+
+   auto& topics = *dispatch->second;
+   std::unique_lock lock(topics.mutex);
+   if (!topics.callbacks.try_emplace(std::string(topic), callback).second)
+   {
+      return Error(SubscriberError::ALREADY_SUBSCRIBED,
+                   ErrorDetail::compose("Topic ", topic, " is already subscribed"));
+   }
+
+   return {};
+}
+
+Result<void, Component::SubscriberError>
+Component::subscribe(const std::string& componentName, const SubscriberCallback& callback)
+{
+   return subscribeFrames(componentName, decoding(callback));
+}
+
+Result<void, Component::SubscriberError>
+Component::subscribeFrames(const std::string& componentName, const FrameCallback& callback)
+{
+   auto port = publishPort(componentName);
+   if (!port.has_value())
+   {
+      return Error(SubscriberError::NETWORK_CONFIGURATION_MISSING,
+                   ErrorDetail::compose("Network configuration is missing for the ", componentName,
+                                        " component"));
+   }
+
+   auto subscribed = subscribeSequenced(componentName, Priority::BULK, port.value(), callback);
+   if (!subscribed)
+   {
+      return subscribed;
+   }
+
+   // Whatever the component sends on its control channel comes along with the rest
+   auto control = controlPort(componentName);
+   if (!control.has_value())
+   {
+      return {};
+   }
+
+   {
+      std::unique_lock lock(mChannelsMutex);
+      mControlPorts.insert(control.value());
+   }
+   return subscribeSequenced(componentName, Priority::CONTROL, control.value(), callback);
+}
+
+Result<void, Component::SubscriberError>
+Component::subscribeSequenced(const std::string& componentName, const Priority priority,
+                              const unsigned int port, const FrameCallback& callback)
+{
+   auto sequencing = std::make_shared<Sequencing>();
+   sequencing->component = componentName;
+   sequencing->priority = priority;
+   sequencing->channel = port;
+   sequencing->replayPort = replayPort(componentName);
+
+   auto subscribed =
+       subscribeFrames(port, [this, sequencing, callback](const std::string_view frame) {
+          receiveSequenced(*sequencing, frame, callback);
+       });
+   if (subscribed)
+   {
+      mSequencingMap.insert_or_assign(port, sequencing);
+   }
+
+   return subscribed;
+}
+
+void Component::receiveSequenced(Sequencing& sequencing, const std::string_view frame,
+                                 const FrameCallback& callback)
+{
+   // Publishers without a replay buffer send their frames as they are
+   const auto stamped = ReplayBuffer::unstamp(frame);
+   if (!stamped.has_value())
+   {
+      callback(frame);
+      return;
+   }
+
+   const auto [epoch, sequence, unstamped] = stamped.value();
+   std::unique_lock lock(sequencing.mutex);
+   if (sequencing.stopping)
+   {
+      return;
+   }
+
+   if (epoch != sequencing.epoch)
+   {
+      // Sequences of a publisher that started over have nothing to do with the ones before
+      if (sequencing.epoch != 0)
       {
-         callback(make_optional_error<SubscriberError>(SubscriberError::INVALID_PAYLOAD,
-                                                       "Failed to parse json"),
-                  "", "");
+         logger().info("{} started publishing again on port {}", sequencing.component,
+                       sequencing.channel);
+      }
+      sequencing.epoch = epoch;
+      sequencing.last = 0;
+      sequencing.held.clear();
+   }
+
+   if (sequencing.recovering)
+   {
+      sequencing.held.emplace_back(sequence, unstamped);
+      return;
+   }
+
+   // Already handed over along with the frames fetched again
+   if (sequencing.last != 0 && sequence <= sequencing.last)
+   {
+      return;
+   }
 
+   std::optional<std::pair<std::uint64_t, std::uint64_t>> lost;
+   if (sequencing.last != 0 && sequence > sequencing.last + 1)
+   {
+      if (sequencing.replayPort.has_value())
+      {
+         // Fetching blocks, it is left to a thread of its own instead of the pub/sub one, which
+         // would otherwise hold back every channel it serves
+         sequencing.held.emplace_back(sequence, unstamped);
+         sequencing.recovering = true;
+         if (sequencing.recovery.joinable())
+         {
+            sequencing.recovery.join();
+         }
+         sequencing.recovery =
+             Thread([this, &sequencing, callback]() { recover(sequencing, callback); });
          return;
       }
+      lost.emplace(sequencing.last + 1, sequence - 1);
+   }
+   sequencing.last = sequence;
 
-      if (parsedJson[JSON_COMPONENT_VERSION_FIELD].get<std::string>() != version())
+   // Called without the lock, so that they can ask where the channel is at
+   lock.unlock();
+   if (lost.has_value())
+   {
+      onFramesLost(sequencing.component, lost->first, lost->second);
+   }
+   callback(unstamped);
+}
+
+void Component::recover(Sequencing& sequencing, const FrameCallback& callback)
+{
+   std::vector<Handover> handovers;
+   std::unique_lock lock(sequencing.mutex);
+   while (!sequencing.stopping && !sequencing.held.empty())
+   {
+      handovers.clear();
+      const auto epoch = sequencing.epoch;
+      const auto first = sequencing.last + 1;
+      const auto last = sequencing.held.front().first - 1;
+      if (sequencing.last != 0 && first <= last)
       {
-         callback(make_optional_error<SubscriberError>(
-                      SubscriberError::INVALID_PAYLOAD,
-                      "Sender and receiver were on different software version"),
-                  "", "");
+         lock.unlock();
+         std::vector<std::pair<std::uint64_t, std::string>> frames;
+         auto replayed = ReplayServer::fetch(
+             sequencing.replayPort.value(), sequencing.channel, epoch, first, last,
+             [&frames](const std::uint64_t sequence, const std::string_view frame) {
+                frames.emplace_back(sequence, frame);
+             });
+         if (!replayed)
+         {
+            logger().warn("Unable to replay frames from {}: {}", sequencing.component,
+                          replayed.error().furtherInfo().value_or(replayed.error().asString()));
+         }
+         else
+         {
+            logger().debug("Replayed {} frames from {}", replayed.value(), sequencing.component);
+         }
+         lock.lock();
 
-         return;
+         // Whatever a publisher that started over meanwhile sends is held back already
+         if (sequencing.stopping || sequencing.epoch != epoch)
+         {
+            continue;
+         }
+
+         for (auto& [sequence, frame] : frames)
+         {
+            if (sequence <= sequencing.last || sequence > last)
+            {
+               continue;
+            }
+
+            // The ones before were evicted already
+            auto& handover = handovers.emplace_back();
+            if (sequence > sequencing.last + 1)
+            {
+               handover.lost.emplace(sequencing.last + 1, sequence - 1);
+            }
+            handover.frame = std::move(frame);
+            sequencing.last = sequence;
+         }
+
+         if (sequencing.last < last)
+         {
+            handovers.push_back({std::make_pair(sequencing.last + 1, last), std::nullopt});
+            sequencing.last = last;
+         }
       }
 
-      callback(make_optional_error<SubscriberError>(), topic, parsedJson);
-   });
+      // Then what was held back up to the next gap, which is recovered the same way
+      while (!sequencing.held.empty())
+      {
+         auto& [sequence, frame] = sequencing.held.front();
+         if (sequencing.last != 0 && sequence > sequencing.last + 1)
+         {
+            break;
+         }
 
-   subscriber.addSession("127.0.0.1", port);
+         if (sequencing.last == 0 || sequence > sequencing.last)
+         {
+            handovers.push_back({std::nullopt, std::move(frame)});
+            sequencing.last = sequence;
+         }
+         sequencing.held.pop_front();
+      }
+
+      // Handed over without the lock, frames coming meanwhile are still held back after them
+      lock.unlock();
+      for (const auto& handover : handovers)
+      {
+         if (handover.lost.has_value())
+         {
+            onFramesLost(sequencing.component, handover.lost->first, handover.lost->second);
+         }
+         if (handover.frame.has_value())
+         {
+            callback(handover.frame.value());
+         }
+      }
+      lock.lock();
+   }
 
-   return make_optional_error<SubscriberError>();
+   sequencing.held.clear();
+   sequencing.recovering = false;
 }
 
-std::optional<Error<Component::SubscriberError>>
-Component::subscribe(const std::string& componentName, const SubscriberCallback& callback)
+void Component::joinRecoveries()
 {
-   auto port = publishPort(componentName);
-   if (!port.has_value())
+   for (const auto& [port, sequencing] : mSequencingMap)
    {
-      return make_optional_error<SubscriberError>(SubscriberError::NETWORK_CONFIGURATION_MISSING,
-                                                  "Network configuration is missing for the " +
-                                                      componentName + " component");
+      Thread recovery;
+      {
+         // No recovery starts once this is set, nor does the one running hand anything over
+         std::lock_guard lock(sequencing->mutex);
+         sequencing->stopping = true;
+         recovery = std::move(sequencing->recovery);
+      }
+      if (recovery.joinable())
+      {
+         recovery.join();
+      }
    }
+}
 
-   return subscribe(port.value(), callback);
+std::shared_ptr<Component::Sequencing> Component::sequencing(const std::string& componentName,
+                                                             const Priority priority) const
+{
+   // Looked up by name, subscriptions are kept by port
+   for (const auto& [port, sequencing] : mSequencingMap)
+   {
+      if (sequencing->component == componentName && sequencing->priority == priority)
+      {
+         return sequencing;
+      }
+   }
+
+   return nullptr;
 }
 
-std::optional<Error<Component::PublishError>> Component::publish(const std::string& topic,
-                                                                 const nlohmann::json& payload)
+Component::SequencePosition Component::lastSequence(const std::string& componentName,
+                                                    const Priority priority)
 {
-   if (payload.contains(JSON_COMPONENT_VERSION_FIELD))
+   auto found = sequencing(componentName, priority);
+   if (!found)
    {
-      return make_optional_error<PublishError>(PublishError::INVALID_PAYLOAD,
-                                               "Json payload contains invalid field");
+      return {};
    }
 
-   nlohmann::json modifiedJson = payload;
-   modifiedJson[JSON_COMPONENT_VERSION_FIELD] = version();
+   std::lock_guard lock(found->mutex);
+   return {found->epoch, found->last};
+}
 
-   std::string serializedJson;
-   try
+void Component::resumeFrom(const std::string& componentName, const SequencePosition& position,
+                           const Priority priority)
+{
+   auto found = sequencing(componentName, priority);
+   if (!found)
+   {
+      logger().warn("Unable to resume {}, it is not subscribed", componentName);
+      return;
+   }
+
+   // A first frame of another epoch starts over from it instead
+   std::lock_guard lock(found->mutex);
+   found->epoch = position.epoch;
+   found->last = position.sequence;
+}
+
+void Component::onFramesLost(const std::string& componentName, const std::uint64_t first,
+                             const std::uint64_t last)
+{
+   logger().warn("Lost frames {} to {} from {}, they are gone from its replay buffer",
+                 first, last, componentName);
+}
+
+Result<void, Component::PublishError> Component::publish(const std::string& topic,
+                                                         const nlohmann::json& payload)
+{
+   const auto traceId = outgoingTraceId();
+   std::optional<TraceSpan> serializing;
+   serializing.emplace("publish.serialize", traceId);
+   auto encoded = encoder().encode(topic, payload, version(), traceId);
+   serializing.reset();
+   return publishEncoded(encoded, traceId);
+}
+
+Result<void, Component::PublishError>
+Component::publishEncoded(const Result<std::string_view, FrameError>& encoded,
+                          const std::uint64_t traceId)
+{
+   if (!mPublishPort.has_value())
+   {
+      return Error(PublishError::NETWORK_CONFIGURATION_MISSING,
+                   "Network configuration is missing for this component");
+   }
+
+   if (!encoded)
+   {
+      const auto error = encoded.error().error() == FrameError::INVALID_TOPIC
+                             ? PublishError::INVALID_TOPIC
+                             : PublishError::INVALID_PAYLOAD;
+      return Error(error, ErrorDetail::compose(encoded.error().furtherInfo().value_or("")));
+   }
+
+   auto frame = encoded.value();
+   if (mCompression.algorithm != FrameCompressor::Algorithm::NONE)
+   {
+      TraceSpan span("publish.compress", traceId);
+      frame = compressor().compress(frame, mCompression);
+   }
+
+   TraceSpan span("publish.send", traceId);
+   Tracer::flow(TraceEvent::Kind::FLOW_START, traceId);
+   return publish(channelPort(frame), frame);
+}
+
+FrameEncoder& Component::encoder()
+{
+   thread_local FrameEncoder encoder;
+   return encoder;
+}
+
+FrameDecoder& Component::decoder()
+{
+   thread_local FrameDecoder decoder;
+   return decoder;
+}
+
+FrameCompressor& Component::compressor()
+{
+   thread_local FrameCompressor compressor;
+   return compressor;
+}
+
+std::uint64_t Component::outgoingTraceId()
+{
+   if (!Tracer::enabled())
    {
-      serializedJson = modifiedJson.dump();
+      return 0;
    }
-   catch (const nlohmann::json::type_error& ex)
+
+   return Tracer::current() != 0 ? Tracer::current() : Tracer::newTraceId();
+}
+
+Error<Component::SubscriberError> Component::subscriberError(const Error<FrameError>& error)
+{
+   const auto subscriberError = error.error() == FrameError::INVALID_TOPIC
+                                    ? SubscriberError::INVALID_TOPIC
+                                    : SubscriberError::INVALID_PAYLOAD;
+   return Error(subscriberError, ErrorDetail::compose(error.furtherInfo().value_or("")));
+}
+
+Result<void, Component::PublishError>
+Component::publish(const std::string& topic, const Aggregator::Statistics& statistics)
+{
+   nlohmann::json message;
+   message["min"] = statistics.min;
+   message["max"] = statistics.max;
+   message["mean"] = statistics.mean;
+   message["stddev"] = statistics.stddev;
+   message["count"] = statistics.count;
+
+   return publish(topic, message);
+}
+
+std::optional<float> Component::settingNumber(const std::string& path) const noexcept
+{
+   auto value = settingValue<float>(path);
+   if (value.has_value())
+   {
+      return value;
+   }
+
+   auto integer = settingValue<int>(path);
+   if (integer.has_value())
+   {
+      return static_cast<float>(integer.value());
+   }
+
+   return std::nullopt;
+}
+
+std::optional<Aggregator> Component::makeAggregator(const std::string& path)
+{
+   auto size = settingValue<unsigned int>(path + ".size");
+   if (!size.has_value())
    {
-      return make_optional_error<PublishError>(PublishError::INVALID_PAYLOAD,
-                                               "Failed to serialize json");
+      return std::nullopt;
    }
 
-   return publish(topic, serializedJson);
-}
\ No newline at end of file
+   auto windowName = settingValue<std::string>(path + ".window").value_or("tumbling");
+   auto window = Aggregator::window(windowName);
+   if (!window.has_value())
+   {
+      logger().warn("Invalid aggregation window {} at {}, aggregation disabled", windowName, path);
+      return std::nullopt;
+   }
+
+   auto step = settingValue<unsigned int>(path + ".step").value_or(0);
+   logger().info("Aggregating {} with a {} window of {} samples", path, windowName, size.value());
+
+   return Aggregator(window.value(), size.value(), step);
+}
+
+std::optional<Deadband> Component::makeDeadband(const std::string& path)
+{
+   constexpr float PERCENT = 100;
+
+   auto absolute = settingNumber(path + ".absolute");
+   auto relative = settingNumber(path + ".relative");
+   auto heartbeat = settingValue<unsigned int>(path + ".heartbeat");
+   if (!absolute.has_value() && !relative.has_value() && !heartbeat.has_value())
+   {
+      return std::nullopt;
+   }
+
+   Deadband::Settings settings;
+   settings.absolute = absolute.value_or(0);
+   settings.relative = relative.value_or(0) / PERCENT;
+   settings.heartbeat = std::chrono::milliseconds(heartbeat.value_or(0));
+   logger().info("Reporting {} by exception (absolute {}, relative {}%, heartbeat {}ms)", path,
+                 settings.absolute, relative.value_or(0), heartbeat.value_or(0));
+
+   return Deadband(settings);
+}
@@ -0,0 +1,42 @@
+#include "Deadband.hpp"
+
+#include <cmath>
+
+Deadband::Deadband(const Settings& settings) noexcept : mSettings{settings}
+{
+}
+
+Deadband::Report Deadband::check(const float value, const Clock::time_point timestamp) noexcept
+{
+   auto report = Report::NONE;
+   if (!mReported.has_value())
+   {
+      report = Report::CHANGE;
+   }
+   else
+   {
+      const auto last = mReported.value();
+      const auto delta = std::fabs(value - last);
+      const bool thresholds = mSettings.absolute > 0 || mSettings.relative > 0;
+      if ((mSettings.absolute > 0 && delta > mSettings.absolute) ||
+          (mSettings.relative > 0 && delta > mSettings.relative * std::fabs(last)) ||
+          (!thresholds && value != last) || std::isnan(value) != std::isnan(last))
+      {
+         report = Report::CHANGE;
+      }
+      // A clock stepped back counts as due, rather than keeping quiet until it catches up
+      else if (mSettings.heartbeat > Clock::duration::zero() &&
+               (timestamp - mReportedAt >= mSettings.heartbeat || timestamp < mReportedAt))
+      {
+         report = Report::HEARTBEAT;
+      }
+   }
+
+   if (report != Report::NONE)
+   {
+      mReported = value;
+      mReportedAt = timestamp;
+   }
+
+   return report;
+}
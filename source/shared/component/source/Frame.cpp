@@ -0,0 +1,300 @@
+#include "Frame.hpp"
+
+#include <algorithm>
+#include <lz4.h>
+#include <memory>
+#include <zstd.h>
+
+namespace {
+constexpr unsigned int BITS_PER_BYTE = 8;
+constexpr int ZSTD_DEFAULT_LEVEL = 3;
+constexpr int LZ4_DEFAULT_ACCELERATION = 1;
+} // namespace
+
+// The serializer only takes its output through a shared_ptr: aliasing an empty one to the member
+// adapter hands it over without allocating a control block
+FrameEncoder::FrameEncoder()
+    : mOutput(mBuffer),
+      mSerializer(nlohmann::detail::output_adapter_t<char>(std::shared_ptr<void>(), &mOutput), ' ')
+{
+}
+
+Result<std::string_view, FrameError> FrameEncoder::encode(const std::string_view topic,
+                                                          const nlohmann::json& payload,
+                                                          const std::string_view version,
+                                                          const std::uint64_t traceId)
+{
+   if (topic.empty() || topic.find(FrameFormat::TOPIC_DELIMITER) != std::string_view::npos)
+   {
+      return Error(FrameError::INVALID_TOPIC, "Topic is empty or contains invalid character");
+   }
+
+   if (!payload.is_object() && !payload.is_null())
+   {
+      return Error(FrameError::INVALID_PAYLOAD, "Json payload is not an object");
+   }
+
+   if (payload.contains(FrameFormat::VERSION_FIELD))
+   {
+      return Error(FrameError::INVALID_PAYLOAD, "Json payload contains invalid field");
+   }
+
+   mBuffer.assign(topic);
+   mBuffer.push_back(FrameFormat::TOPIC_DELIMITER);
+
+   // Serializing the payload as it is and adding the version as its last member, instead of
+   // copying the payload to add it
+   if (payload.empty())
+   {
+      mBuffer.push_back('{');
+   }
+   else
+   {
+      try
+      {
+         mSerializer.dump(payload, false, false, 0);
+      }
+      catch (const nlohmann::json::type_error& ex)
+      {
+         return Error(FrameError::INVALID_PAYLOAD, "Failed to serialize json");
+      }
+      mBuffer.back() = ',';
+   }
+
+   close(version, payload.contains(FrameFormat::TRACE_FIELD) ? 0 : traceId);
+
+   return std::string_view(mBuffer);
+}
+
+void FrameEncoder::close(const std::string_view version, const std::uint64_t traceId)
+{
+   TopicWriter::writeString(mBuffer, FrameFormat::VERSION_FIELD);
+   mBuffer.push_back(':');
+   TopicWriter::writeString(mBuffer, version);
+   if (traceId != 0)
+   {
+      mBuffer.push_back(',');
+      TopicWriter::writeString(mBuffer, FrameFormat::TRACE_FIELD);
+      mBuffer.push_back(':');
+      TopicWriter::write(mBuffer, traceId);
+   }
+   mBuffer.push_back('}');
+}
+
+Result<void, FrameError> FrameDecoder::decode(const std::string_view received,
+                                              const std::string_view version)
+{
+   auto decompressed = mCompressor.decompress(received);
+   if (!decompressed)
+   {
+      return decompressed.error();
+   }
+
+   const auto frame = decompressed.value();
+   const auto delimiter = frame.find(FrameFormat::TOPIC_DELIMITER);
+   if (delimiter == std::string_view::npos || delimiter == 0)
+   {
+      return Error(FrameError::INVALID_TOPIC, "Message received with empty topic");
+   }
+   if (delimiter + 1 == frame.size())
+   {
+      return Error(FrameError::INVALID_PAYLOAD, "Message received with empty payload");
+   }
+
+   try
+   {
+      mPayload = nlohmann::json::parse(frame.substr(delimiter + 1));
+   }
+   catch (const nlohmann::json::parse_error& ex)
+   {
+      return Error(FrameError::INVALID_PAYLOAD, "Failed to parse json");
+   }
+
+   const auto sender = mPayload.find(FrameFormat::VERSION_FIELD);
+   if (sender == mPayload.end() || !sender->is_string() ||
+       sender->get_ref<const std::string&>() != version)
+   {
+      return Error(FrameError::VERSION_MISMATCH,
+                   "Sender and receiver were on different software version");
+   }
+
+   mTopic.assign(frame.substr(0, delimiter));
+
+   const auto trace = mPayload.find(FrameFormat::TRACE_FIELD);
+   mTraceId = trace != mPayload.end() && trace->is_number_unsigned() ? trace->get<std::uint64_t>()
+                                                                      : 0;
+
+   return {};
+}
+
+FrameCompressor::FrameCompressor() = default;
+
+FrameCompressor::~FrameCompressor() = default;
+
+void FrameCompressor::ContextDeleter::operator()(ZSTD_CCtx* context) const noexcept
+{
+   ZSTD_freeCCtx(context);
+}
+
+void FrameCompressor::ContextDeleter::operator()(ZSTD_DCtx* context) const noexcept
+{
+   ZSTD_freeDCtx(context);
+}
+
+std::string_view FrameCompressor::compress(const std::string_view frame, const Settings& settings)
+{
+   const auto delimiter = frame.find(FrameFormat::TOPIC_DELIMITER);
+   if (settings.algorithm == Algorithm::NONE || delimiter == std::string_view::npos)
+   {
+      return frame;
+   }
+
+   const auto payload = frame.substr(delimiter + 1);
+   if (payload.size() < settings.threshold || payload.size() > MAX_PAYLOAD || compressed(frame))
+   {
+      return frame;
+   }
+
+   // Topic, marker and size go first, the compressed payload is written right after them
+   const auto header = delimiter + 2 + FrameFormat::SIZE_BYTES;
+   const auto* source = payload.data();
+   const auto sourceSize = payload.size();
+   std::size_t written = 0;
+   if (settings.algorithm == Algorithm::LZ4)
+   {
+      if (mLz4State.empty())
+      {
+         const auto stateSize = static_cast<std::size_t>(LZ4_sizeofState());
+         mLz4State.resize((stateSize + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+      }
+
+      const auto bound = LZ4_compressBound(static_cast<int>(sourceSize));
+      mBuffer.resize(header + static_cast<std::size_t>(bound));
+      const auto result = LZ4_compress_fast_extState(
+          mLz4State.data(), source, mBuffer.data() + header, static_cast<int>(sourceSize),
+          static_cast<int>(mBuffer.size() - header),
+          settings.level > 0 ? settings.level : LZ4_DEFAULT_ACCELERATION);
+      written = result > 0 ? static_cast<std::size_t>(result) : 0;
+      mBuffer[delimiter + 1] = FrameFormat::LZ4_MARKER;
+   }
+   else
+   {
+      if (!mZstdCompression)
+      {
+         mZstdCompression.reset(ZSTD_createCCtx());
+      }
+
+      mBuffer.resize(header + ZSTD_compressBound(sourceSize));
+      const auto result = ZSTD_compressCCtx(mZstdCompression.get(), mBuffer.data() + header,
+                                            mBuffer.size() - header, source, sourceSize,
+                                            settings.level != 0 ? settings.level
+                                                                : ZSTD_DEFAULT_LEVEL);
+      written = ZSTD_isError(result) != 0 ? 0 : result;
+      mBuffer[delimiter + 1] = FrameFormat::ZSTD_MARKER;
+   }
+
+   // Sending it as it is costs nothing on the other side when compressing did not pay off
+   if (written == 0 || header + written >= frame.size())
+   {
+      return frame;
+   }
+
+   std::copy_n(frame.data(), delimiter + 1, mBuffer.begin());
+   for (std::size_t byte = 0; byte < FrameFormat::SIZE_BYTES; byte++)
+   {
+      mBuffer[delimiter + 2 + byte] = static_cast<char>(sourceSize >> (BITS_PER_BYTE * byte));
+   }
+   mBuffer.resize(header + written);
+
+   return mBuffer;
+}
+
+Result<std::string_view, FrameError> FrameCompressor::decompress(const std::string_view frame)
+{
+   if (!compressed(frame))
+   {
+      return frame;
+   }
+
+   const auto delimiter = frame.find(FrameFormat::TOPIC_DELIMITER);
+   const auto header = delimiter + 2 + FrameFormat::SIZE_BYTES;
+   if (frame.size() < header)
+   {
+      return Error(FrameError::INVALID_PAYLOAD, "Compressed message received truncated");
+   }
+
+   std::size_t size = 0;
+   for (std::size_t byte = 0; byte < FrameFormat::SIZE_BYTES; byte++)
+   {
+      size |= static_cast<std::size_t>(static_cast<unsigned char>(frame[delimiter + 2 + byte]))
+              << (BITS_PER_BYTE * byte);
+   }
+   if (size > MAX_PAYLOAD)
+   {
+      return Error(FrameError::INVALID_PAYLOAD, "Compressed message received oversized");
+   }
+
+   mBuffer.resize(delimiter + 1 + size);
+   std::copy_n(frame.data(), delimiter + 1, mBuffer.begin());
+   auto* target = mBuffer.data() + delimiter + 1;
+   const auto source = frame.substr(header);
+   bool valid = false;
+   if (frame[delimiter + 1] == FrameFormat::LZ4_MARKER)
+   {
+      const auto result = LZ4_decompress_safe(source.data(), target,
+                                              static_cast<int>(source.size()),
+                                              static_cast<int>(size));
+      valid = result >= 0 && static_cast<std::size_t>(result) == size;
+   }
+   else
+   {
+      if (!mZstdDecompression)
+      {
+         mZstdDecompression.reset(ZSTD_createDCtx());
+      }
+
+      const auto result =
+          ZSTD_decompressDCtx(mZstdDecompression.get(), target, size, source.data(), source.size());
+      valid = ZSTD_isError(result) == 0 && result == size;
+   }
+
+   if (!valid)
+   {
+      return Error(FrameError::INVALID_PAYLOAD, "Failed to decompress payload");
+   }
+
+   return std::string_view(mBuffer);
+}
+
+bool FrameCompressor::compressed(const std::string_view frame) noexcept
+{
+   const auto delimiter = frame.find(FrameFormat::TOPIC_DELIMITER);
+   if (delimiter == std::string_view::npos || delimiter + 1 >= frame.size())
+   {
+      return false;
+   }
+
+   const auto marker = frame[delimiter + 1];
+   return marker == FrameFormat::LZ4_MARKER || marker == FrameFormat::ZSTD_MARKER;
+}
+
+std::optional<FrameCompressor::Algorithm>
+FrameCompressor::algorithm(const std::string& name) noexcept
+{
+   if (name == "none")
+   {
+      return Algorithm::NONE;
+   }
+
+   if (name == "lz4")
+   {
+      return Algorithm::LZ4;
+   }
+
+   if (name == "zstd")
+   {
+      return Algorithm::ZSTD;
+   }
+
+   return std::nullopt;
+}
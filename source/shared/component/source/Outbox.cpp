@@ -0,0 +1,316 @@
+#include "Outbox.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+void Outbox::Ring::reset(const std::size_t capacity)
+{
+   mBuffer.assign(capacity, 0);
+   mHead = 0;
+   mUsed = 0;
+   mFrames = 0;
+}
+
+void Outbox::Ring::copyIn(const std::size_t position, const char* data,
+                          const std::size_t size) noexcept
+{
+   const auto first = std::min(size, mBuffer.size() - position);
+   std::memcpy(mBuffer.data() + position, data, first);
+   std::memcpy(mBuffer.data(), data + first, size - first);
+}
+
+void Outbox::Ring::copyOut(const std::size_t position, char* data,
+                           const std::size_t size) const noexcept
+{
+   const auto first = std::min(size, mBuffer.size() - position);
+   std::memcpy(data, mBuffer.data() + position, first);
+   std::memcpy(data + first, mBuffer.data(), size - first);
+}
+
+bool Outbox::Ring::push(const std::string_view frame)
+{
+   if (LENGTH_SIZE + frame.size() > mBuffer.size() - mUsed)
+   {
+      return false;
+   }
+
+   const auto length = static_cast<std::uint32_t>(frame.size());
+   const auto tail = (mHead + mUsed) % mBuffer.size();
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+   copyIn(tail, reinterpret_cast<const char*>(&length), LENGTH_SIZE);
+   copyIn((tail + LENGTH_SIZE) % mBuffer.size(), frame.data(), frame.size());
+   mUsed += LENGTH_SIZE + frame.size();
+   mFrames++;
+   return true;
+}
+
+void Outbox::Ring::front(std::string& frame) const
+{
+   std::uint32_t length = 0;
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+   copyOut(mHead, reinterpret_cast<char*>(&length), LENGTH_SIZE);
+   frame.resize(length);
+   copyOut((mHead + LENGTH_SIZE) % mBuffer.size(), frame.data(), length);
+}
+
+void Outbox::Ring::pop() noexcept
+{
+   std::uint32_t length = 0;
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+   copyOut(mHead, reinterpret_cast<char*>(&length), LENGTH_SIZE);
+   mHead = (mHead + LENGTH_SIZE + length) % mBuffer.size();
+   mUsed -= LENGTH_SIZE + length;
+   mFrames--;
+}
+
+bool Outbox::Spill::open(const std::filesystem::path& path, const std::size_t capacity)
+{
+   close();
+
+   // Frames left over by a previous run would be out of order with the ones queued before them
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+   mFile = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+   mCapacity = capacity;
+   return mFile >= 0;
+}
+
+void Outbox::Spill::close() noexcept
+{
+   if (mFile >= 0)
+   {
+      ::close(mFile);
+      mFile = -1;
+   }
+   mRead = 0;
+   mUsed = 0;
+   mFrames = 0;
+}
+
+bool Outbox::Spill::writeAt(const std::size_t position, const char* data,
+                            const std::size_t size) const
+{
+   const auto first = std::min(size, mCapacity - position);
+   return pwrite(mFile, data, first, static_cast<off_t>(position)) ==
+              static_cast<ssize_t>(first) &&
+          pwrite(mFile, data + first, size - first, 0) == static_cast<ssize_t>(size - first);
+}
+
+bool Outbox::Spill::readAt(const std::size_t position, char* data, const std::size_t size) const
+{
+   const auto first = std::min(size, mCapacity - position);
+   return pread(mFile, data, first, static_cast<off_t>(position)) == static_cast<ssize_t>(first) &&
+          pread(mFile, data + first, size - first, 0) == static_cast<ssize_t>(size - first);
+}
+
+bool Outbox::Spill::push(const std::string_view frame)
+{
+   if (mFile < 0 || LENGTH_SIZE + frame.size() > mCapacity - mUsed)
+   {
+      return false;
+   }
+
+   const auto length = static_cast<std::uint32_t>(frame.size());
+   const auto tail = (mRead + mUsed) % mCapacity;
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+   if (!writeAt(tail, reinterpret_cast<const char*>(&length), LENGTH_SIZE) ||
+       !writeAt((tail + LENGTH_SIZE) % mCapacity, frame.data(), frame.size()))
+   {
+      return false;
+   }
+
+   mUsed += LENGTH_SIZE + frame.size();
+   mFrames++;
+   return true;
+}
+
+bool Outbox::Spill::front(std::string& frame)
+{
+   std::uint32_t length = 0;
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+   if (!readAt(mRead, reinterpret_cast<char*>(&length), LENGTH_SIZE) ||
+       LENGTH_SIZE + length > mUsed)
+   {
+      return false;
+   }
+
+   frame.resize(length);
+   if (!readAt((mRead + LENGTH_SIZE) % mCapacity, frame.data(), length))
+   {
+      return false;
+   }
+
+   mFrontSize = length;
+   return true;
+}
+
+void Outbox::Spill::pop() noexcept
+{
+   mRead = (mRead + LENGTH_SIZE + mFrontSize) % mCapacity;
+   mUsed -= LENGTH_SIZE + mFrontSize;
+   mFrames--;
+
+   if (mFrames == 0)
+   {
+      // Everything was read back, the file does not need to hold on to it
+      mRead = 0;
+      mUsed = 0;
+      [[maybe_unused]] const auto truncated = ftruncate(mFile, 0);
+   }
+}
+
+Outbox::Spill::~Spill()
+{
+   close();
+}
+
+Result<void, OutboxError> Outbox::open(const Settings& settings, const Sender& sender)
+{
+   close();
+
+   std::lock_guard lock(mMutex);
+   mSettings = settings;
+   mSender = sender;
+   mStatistics = {};
+   mRing.reset(settings.memory);
+   if (settings.disk > 0 && !mSpill.open(settings.path, settings.disk))
+   {
+      return Error(OutboxError::UNABLE_TO_OPEN,
+                   ErrorDetail::compose("Unable to open spill file ", settings.path.native()));
+   }
+
+   mRunning = true;
+   mThread = std::make_unique<Thread>([this]() { retry(); });
+
+   return {};
+}
+
+Result<void, OutboxError> Outbox::send(const std::string_view frame)
+{
+   std::lock_guard lock(mMutex);
+   if (pending() == 0 && mSender(frame))
+   {
+      return {};
+   }
+
+   if (!queue(frame))
+   {
+      mStatistics.dropped++;
+      return Error(OutboxError::FULL, "Outbox is full, frame dropped");
+   }
+
+   mCondition.notify_one();
+   return {};
+}
+
+bool Outbox::queue(const std::string_view frame)
+{
+   // Once frames are spilled new ones follow them to the file, so that they all drain in order
+   if (mSpill.frames() == 0 && mRing.push(frame))
+   {
+      return true;
+   }
+
+   if (mSpill.push(frame))
+   {
+      mStatistics.spilled++;
+      return true;
+   }
+
+   return false;
+}
+
+void Outbox::retry()
+{
+   auto backoff = mSettings.backoff;
+
+   std::unique_lock lock(mMutex);
+   while (mRunning)
+   {
+      mCondition.wait(lock, [this]() { return !mRunning || pending() > 0; });
+
+      // Waiting before the first attempt too, since the frame on top has just failed
+      mCondition.wait_for(lock, backoff, [this]() { return !mRunning; });
+      if (!mRunning)
+      {
+         break;
+      }
+
+      backoff = drain(lock) ? mSettings.backoff : std::min(backoff * 2, mSettings.maxBackoff);
+   }
+}
+
+bool Outbox::drain(std::unique_lock<std::mutex>& lock)
+{
+   while (mRunning && pending() > 0)
+   {
+      const bool fromRing = mRing.frames() > 0;
+      if (fromRing)
+      {
+         mRing.front(mFrame);
+      }
+      else if (!mSpill.front(mFrame))
+      {
+         // An unreadable spill file cannot be drained any further
+         mStatistics.dropped += mSpill.frames();
+         [[maybe_unused]] const auto reopened = mSpill.open(mSettings.path, mSettings.disk);
+         continue;
+      }
+
+      // Sending without the lock, so that publishing is never held back by a slow retry. Frames
+      // published meanwhile are queued behind this one, which is only popped once it went out
+      lock.unlock();
+      const bool sent = mSender(mFrame);
+      lock.lock();
+      if (!sent)
+      {
+         return false;
+      }
+
+      if (fromRing)
+      {
+         mRing.pop();
+      }
+      else
+      {
+         mSpill.pop();
+      }
+      mStatistics.retried++;
+   }
+
+   return true;
+}
+
+Outbox::Statistics Outbox::statistics() const
+{
+   std::lock_guard lock(mMutex);
+   auto statistics = mStatistics;
+   statistics.memoryFrames = mRing.frames();
+   statistics.diskFrames = mSpill.frames();
+   return statistics;
+}
+
+void Outbox::close() noexcept
+{
+   {
+      std::lock_guard lock(mMutex);
+      mRunning = false;
+   }
+   mCondition.notify_one();
+
+   if (mThread)
+   {
+      mThread->join();
+      mThread.reset();
+   }
+
+   mSpill.close();
+}
+
+Outbox::~Outbox()
+{
+   close();
+}
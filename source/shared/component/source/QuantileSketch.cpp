@@ -0,0 +1,191 @@
+#include "QuantileSketch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+
+namespace {
+// The largest fraction of the samples a centroid starting at fraction can reach. Following the
+// arcsine scale, centroids hold few samples near the tails and many around the median
+double fractionLimit(const double fraction, const double compression) noexcept
+{
+   const auto angle = std::asin(std::clamp(2 * fraction - 1, -1.0, 1.0));
+   const auto next = std::min(angle + 2 * std::numbers::pi / compression, std::numbers::pi / 2);
+   return (std::sin(next) + 1) / 2;
+}
+
+float interpolate(const float from, const float to, const double position) noexcept
+{
+   return from + static_cast<float>(std::clamp(position, 0.0, 1.0) * (to - from));
+}
+} // namespace
+
+QuantileSketch::QuantileSketch(const std::size_t compression)
+    : mCompression{static_cast<double>(std::max<std::size_t>(compression, 1))}
+{
+   mSamples.reserve(BUFFER_FACTOR * std::max<std::size_t>(compression, 1));
+}
+
+void QuantileSketch::add(const float sample)
+{
+   if (std::isnan(sample))
+   {
+      return;
+   }
+
+   mMin = mCount == 0 ? sample : std::min(mMin, sample);
+   mMax = mCount == 0 ? sample : std::max(mMax, sample);
+   mCount++;
+   mSamples.push_back(sample);
+   if (mSamples.size() >= BUFFER_FACTOR * static_cast<std::size_t>(mCompression))
+   {
+      compress();
+   }
+}
+
+void QuantileSketch::merge(std::span<const Centroid> centroids, const float min, const float max)
+{
+   for (const auto& centroid : centroids)
+   {
+      if (centroid.weight == 0 || std::isnan(centroid.mean))
+      {
+         continue;
+      }
+
+      mMin = mCount == 0 ? min : std::min(mMin, min);
+      mMax = mCount == 0 ? max : std::max(mMax, max);
+      mCount += centroid.weight;
+      mMerged.push_back(centroid);
+   }
+
+   if (mMerged.size() >= BUFFER_FACTOR * static_cast<std::size_t>(mCompression))
+   {
+      compress();
+   }
+}
+
+void QuantileSketch::merge(QuantileSketch& sketch)
+{
+   merge(sketch.centroids(), sketch.min(), sketch.max());
+}
+
+float QuantileSketch::quantile(const double fraction)
+{
+   compress();
+   if (mCentroids.empty())
+   {
+      return std::numeric_limits<float>::quiet_NaN();
+   }
+
+   if (fraction <= 0)
+   {
+      return mMin;
+   }
+
+   if (fraction >= 1)
+   {
+      return mMax;
+   }
+
+   // Each centroid is taken to sit at the middle of its samples, the ones before the first and
+   // after the last spreading towards the extremes
+   const auto rank = fraction * static_cast<double>(mCount);
+   auto seen = static_cast<double>(mCentroids.front().weight) / 2;
+   if (rank < seen)
+   {
+      return interpolate(mMin, mCentroids.front().mean, rank / seen);
+   }
+
+   for (std::size_t index = 0; index + 1 < mCentroids.size(); index++)
+   {
+      const auto& left = mCentroids[index];
+      const auto& right = mCentroids[index + 1];
+      const auto span = static_cast<double>(left.weight + right.weight) / 2;
+      if (rank < seen + span)
+      {
+         return interpolate(left.mean, right.mean, (rank - seen) / span);
+      }
+      seen += span;
+   }
+
+   const auto& last = mCentroids.back();
+   return interpolate(last.mean, mMax, (rank - seen) / (static_cast<double>(last.weight) / 2));
+}
+
+std::span<const QuantileSketch::Centroid> QuantileSketch::centroids()
+{
+   compress();
+   return mCentroids;
+}
+
+void QuantileSketch::clear() noexcept
+{
+   mCentroids.clear();
+   mSamples.clear();
+   mMerged.clear();
+   mCount = 0;
+   mMin = 0;
+   mMax = 0;
+}
+
+void QuantileSketch::compress()
+{
+   if (mSamples.empty() && mMerged.empty())
+   {
+      return;
+   }
+
+   // The centroids are sorted already, only what came since needs sorting before merging it in
+   const auto byMean = [](const Centroid& left, const Centroid& right) {
+      return left.mean < right.mean;
+   };
+   std::sort(mSamples.begin(), mSamples.end());
+   mScratch.clear();
+   auto centroid = mCentroids.begin();
+   for (const auto sample : mSamples)
+   {
+      for (; centroid != mCentroids.end() && centroid->mean < sample; centroid++)
+      {
+         mScratch.push_back(*centroid);
+      }
+      mScratch.push_back({sample, 1});
+   }
+   mScratch.insert(mScratch.end(), centroid, mCentroids.end());
+   mSamples.clear();
+
+   if (!mMerged.empty())
+   {
+      const auto middle = static_cast<std::ptrdiff_t>(mScratch.size());
+      std::sort(mMerged.begin(), mMerged.end(), byMean);
+      mScratch.insert(mScratch.end(), mMerged.begin(), mMerged.end());
+      std::inplace_merge(mScratch.begin(), mScratch.begin() + middle, mScratch.end(), byMean);
+      mMerged.clear();
+   }
+
+   // A single pass merging neighbours for as long as the scale allows it
+   mCentroids.clear();
+   const auto total = static_cast<double>(mCount);
+   double merged = 0;
+   auto limit = fractionLimit(0, mCompression) * total;
+   double mean = mScratch.front().mean;
+   auto weight = mScratch.front().weight;
+   for (std::size_t index = 1; index < mScratch.size(); index++)
+   {
+      const auto& next = mScratch[index];
+      if (merged + static_cast<double>(weight + next.weight) <= limit)
+      {
+         weight += next.weight;
+         mean += (next.mean - mean) * static_cast<double>(next.weight) /
+                 static_cast<double>(weight);
+         continue;
+      }
+
+      mCentroids.push_back({static_cast<float>(mean), weight});
+      merged += static_cast<double>(weight);
+      limit = fractionLimit(merged / total, mCompression) * total;
+      mean = next.mean;
+      weight = next.weight;
+   }
+   mCentroids.push_back({static_cast<float>(mean), weight});
+}
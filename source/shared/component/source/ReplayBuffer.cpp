@@ -0,0 +1,130 @@
+#include "ReplayBuffer.hpp"
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+
+ReplayBuffer::ReplayBuffer(const Settings& settings)
+    : mSettings{std::max<std::size_t>(settings.frames, 1), settings.bytes},
+      mBuffer(settings.bytes)
+{
+   // Subscribers only compare it, it just has to differ from the one of the buffer before
+   std::random_device device;
+   std::uniform_int_distribution<std::uint64_t> epochs(1);
+   mEpoch = epochs(device);
+}
+
+std::uint64_t ReplayBuffer::push(const std::string_view frame)
+{
+   const auto sequence = next();
+
+   // A frame larger than the whole buffer is never kept, taking everything before with it
+   if (frame.size() > mBuffer.size())
+   {
+      mFirst = sequence + 1;
+      mSlots.clear();
+      mHead = 0;
+      mUsed = 0;
+      return sequence;
+   }
+
+   // Only the oldest frames go, until every byte the new one takes is free. Those kept are
+   // contiguous from the head, whether they wrapped around the end already or not
+   auto [offset, size] = place(frame.size());
+   while (!mSlots.empty() &&
+          (mSlots.size() >= mSettings.frames || mUsed + size > mBuffer.size()))
+   {
+      evict();
+      std::tie(offset, size) = place(frame.size());
+   }
+
+   std::copy(frame.begin(), frame.end(), mBuffer.begin() + static_cast<std::ptrdiff_t>(offset));
+   mSlots.push_back({offset, frame.size()});
+   mUsed += size;
+   return sequence;
+}
+
+std::pair<std::size_t, std::size_t> ReplayBuffer::place(const std::size_t size) const noexcept
+{
+   const auto end = mHead + mUsed;
+   const auto tail = end > mBuffer.size() ? end - mBuffer.size() : end;
+
+   // Frames never wrap themselves, one not fitting before the end goes back to the start
+   if (tail + size > mBuffer.size())
+   {
+      return {0, mBuffer.size() - tail + size};
+   }
+
+   return {tail, size};
+}
+
+void ReplayBuffer::evict() noexcept
+{
+   mSlots.pop_front();
+   mFirst++;
+   if (mSlots.empty())
+   {
+      mHead = 0;
+      mUsed = 0;
+      return;
+   }
+
+   // Whatever was skipped at the end goes along with the last frame before it
+   const auto head = mSlots.front().offset;
+   mUsed -= head >= mHead ? head - mHead : mBuffer.size() - mHead + head;
+   mHead = head;
+}
+
+void ReplayBuffer::replay(const std::uint64_t first, const std::uint64_t last,
+                          const Callback& callback) const
+{
+   const auto end = std::min(last + 1, next());
+   for (auto sequence = std::max(first, mFirst); sequence < end; sequence++)
+   {
+      const auto& slot = mSlots[sequence - mFirst];
+      callback(sequence, std::string_view(mBuffer.data() + slot.offset, slot.size));
+   }
+}
+
+void ReplayBuffer::appendNumber(std::string& out, const std::uint64_t value,
+                                const std::size_t bytes)
+{
+   for (std::size_t index = 0; index < bytes; index++)
+   {
+      out.push_back(static_cast<char>((value >> (BYTE_BITS * index)) & 0xff));
+   }
+}
+
+std::uint64_t ReplayBuffer::readNumber(const char* data, const std::size_t bytes) noexcept
+{
+   std::uint64_t value = 0;
+   for (std::size_t index = 0; index < bytes; index++)
+   {
+      value |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(data[index]))
+               << (BYTE_BITS * index);
+   }
+   return value;
+}
+
+void ReplayBuffer::stamp(std::string& out, const std::uint64_t epoch, const std::uint64_t sequence,
+                         const std::string_view frame)
+{
+   out.clear();
+   out.push_back(SEQUENCE_MARKER);
+   appendNumber(out, epoch, EPOCH_BYTES);
+   appendNumber(out, sequence, SEQUENCE_BYTES);
+   out.append(frame);
+}
+
+std::optional<ReplayBuffer::Stamp> ReplayBuffer::unstamp(const std::string_view frame) noexcept
+{
+   constexpr auto HEADER_SIZE = 1 + EPOCH_BYTES + SEQUENCE_BYTES;
+   if (frame.size() < HEADER_SIZE || frame.front() != SEQUENCE_MARKER)
+   {
+      return std::nullopt;
+   }
+
+   return Stamp{readNumber(frame.data() + 1, EPOCH_BYTES),
+                readNumber(frame.data() + 1 + EPOCH_BYTES, SEQUENCE_BYTES),
+                frame.substr(HEADER_SIZE)};
+}
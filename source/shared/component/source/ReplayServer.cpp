@@ -0,0 +1,264 @@
+#include "ReplayServer.hpp"
+
+#include <arpa/inet.h>
+#include <array>
+#include <charconv>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+constexpr unsigned int BYTE_BITS = 8;
+constexpr std::uint64_t BYTE_MASK = 0xff;
+
+void appendBigEndian(std::string& out, const std::uint64_t value, const std::size_t bytes)
+{
+   for (std::size_t index = 0; index < bytes; index++)
+   {
+      out.push_back(static_cast<char>((value >> (BYTE_BITS * (bytes - 1 - index))) & BYTE_MASK));
+   }
+}
+
+std::uint64_t readBigEndian(const char* data, const std::size_t bytes) noexcept
+{
+   std::uint64_t value = 0;
+   for (std::size_t index = 0; index < bytes; index++)
+   {
+      value = (value << BYTE_BITS) | static_cast<std::uint8_t>(data[index]);
+   }
+   return value;
+}
+
+void setTimeouts(const int socket, const std::chrono::milliseconds timeout) noexcept
+{
+   const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+   timeval value{};
+   value.tv_sec = seconds.count();
+   value.tv_usec =
+       std::chrono::duration_cast<std::chrono::microseconds>(timeout - seconds).count();
+   setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &value, sizeof(value));
+   setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &value, sizeof(value));
+}
+
+bool sendAll(const int socket, std::string_view data) noexcept
+{
+   while (!data.empty())
+   {
+      const auto sent = send(socket, data.data(), data.size(), MSG_NOSIGNAL);
+      if (sent <= 0)
+      {
+         return false;
+      }
+      data.remove_prefix(static_cast<std::size_t>(sent));
+   }
+   return true;
+}
+
+bool receiveAll(const int socket, char* buffer, std::size_t size) noexcept
+{
+   while (size > 0)
+   {
+      const auto received = recv(socket, buffer, size, 0);
+      if (received <= 0)
+      {
+         return false;
+      }
+      buffer += received;
+      size -= static_cast<std::size_t>(received);
+   }
+   return true;
+}
+
+sockaddr_in loopback(const unsigned int port) noexcept
+{
+   sockaddr_in address{};
+   address.sin_family = AF_INET;
+   address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   address.sin_port = htons(static_cast<std::uint16_t>(port));
+   return address;
+}
+} // namespace
+
+Result<void, ReplayError> ReplayServer::listen(const unsigned int port, const Source& source)
+{
+   close();
+
+   mListener = socket(AF_INET, SOCK_STREAM, 0);
+   if (mListener < 0)
+   {
+      return Error(ReplayError::UNABLE_TO_LISTEN, "Unable to create the listening socket");
+   }
+
+   const int reuse = 1;
+   setsockopt(mListener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+   // Subscribers are on the same host, as for the publishers themselves
+   const auto address = loopback(port);
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+   if (bind(mListener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+       ::listen(mListener, SOMAXCONN) != 0)
+   {
+      close();
+      return Error(ReplayError::UNABLE_TO_LISTEN,
+                   ErrorDetail::compose("Unable to listen on port ", port));
+   }
+
+   mRunning = true;
+   mThread = std::make_unique<Thread>([this, source]() { serve(source); });
+
+   return {};
+}
+
+void ReplayServer::serve(const Source& source) const
+{
+   while (mRunning)
+   {
+      pollfd descriptor{mListener, POLLIN, 0};
+      if (::poll(&descriptor, 1, static_cast<int>(POLL_PERIOD.count())) <= 0)
+      {
+         continue;
+      }
+
+      const int socket = ::accept(mListener, nullptr, nullptr);
+      if (socket < 0)
+      {
+         continue;
+      }
+
+      setTimeouts(socket, TIMEOUT);
+      answer(socket, source);
+      ::close(socket);
+   }
+}
+
+void ReplayServer::answer(const int socket, const Source& source) const
+{
+   std::string request;
+   char character = 0;
+   while (request.size() < MAX_REQUEST_SIZE && recv(socket, &character, 1, 0) == 1 &&
+          character != '\n')
+   {
+      request.push_back(character);
+   }
+
+   unsigned int channel = 0;
+   std::uint64_t epoch = 0;
+   std::uint64_t first = 0;
+   std::uint64_t last = 0;
+   const auto* end = request.data() + request.size();
+   auto parsed = std::from_chars(request.data(), end, channel);
+   if (parsed.ec == std::errc() && parsed.ptr != end)
+   {
+      parsed = std::from_chars(parsed.ptr + 1, end, epoch);
+   }
+   if (parsed.ec == std::errc() && parsed.ptr != end)
+   {
+      parsed = std::from_chars(parsed.ptr + 1, end, first);
+   }
+   if (parsed.ec == std::errc() && parsed.ptr != end)
+   {
+      parsed = std::from_chars(parsed.ptr + 1, end, last);
+   }
+   if (parsed.ec != std::errc() || parsed.ptr != end || first == 0)
+   {
+      return;
+   }
+
+   std::string response;
+   source(channel, epoch, first, last,
+          [&response](const std::uint64_t sequence, const std::string_view frame) {
+             appendBigEndian(response, sequence, ReplayBuffer::SEQUENCE_BYTES);
+             appendBigEndian(response, frame.size(), LENGTH_BYTES);
+             response.append(frame);
+          });
+   appendBigEndian(response, 0, ReplayBuffer::SEQUENCE_BYTES);
+   appendBigEndian(response, 0, LENGTH_BYTES);
+   [[maybe_unused]] const auto sent = sendAll(socket, response);
+}
+
+Result<std::size_t, ReplayError>
+ReplayServer::fetch(const unsigned int port, const unsigned int channel, const std::uint64_t epoch,
+                    const std::uint64_t first, const std::uint64_t last,
+                    const ReplayBuffer::Callback& callback)
+{
+   const int server = socket(AF_INET, SOCK_STREAM, 0);
+   if (server < 0)
+   {
+      return Error(ReplayError::UNABLE_TO_CONNECT, "Unable to create the socket");
+   }
+
+   setTimeouts(server, TIMEOUT);
+   const auto address = loopback(port);
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+   if (connect(server, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+   {
+      ::close(server);
+      return Error(ReplayError::UNABLE_TO_CONNECT,
+                   ErrorDetail::compose("Unable to connect to the replay server on port ", port));
+   }
+
+   const auto request = std::to_string(channel) + " " + std::to_string(epoch) + " " +
+                        std::to_string(first) + " " + std::to_string(last) + "\n";
+   if (!sendAll(server, request))
+   {
+      ::close(server);
+      return Error(ReplayError::UNABLE_TO_CONNECT, "Unable to send the replay request");
+   }
+
+   std::size_t received = 0;
+   std::array<char, ReplayBuffer::SEQUENCE_BYTES + LENGTH_BYTES> header{};
+   std::string frame;
+   while (receiveAll(server, header.data(), header.size()))
+   {
+      const auto sequence = readBigEndian(header.data(), ReplayBuffer::SEQUENCE_BYTES);
+      const auto size =
+          readBigEndian(header.data() + ReplayBuffer::SEQUENCE_BYTES, LENGTH_BYTES);
+      if (sequence == 0)
+      {
+         ::close(server);
+         return received;
+      }
+
+      if (size > MAX_FRAME_SIZE)
+      {
+         break;
+      }
+
+      frame.resize(size);
+      if (!receiveAll(server, frame.data(), frame.size()))
+      {
+         break;
+      }
+
+      callback(sequence, frame);
+      received++;
+   }
+
+   ::close(server);
+   return Error(ReplayError::INVALID_RESPONSE,
+                ErrorDetail::compose("Replay interrupted after ", received, " frames"));
+}
+
+void ReplayServer::close() noexcept
+{
+   mRunning = false;
+   if (mThread)
+   {
+      mThread->join();
+      mThread.reset();
+   }
+
+   if (mListener >= 0)
+   {
+      ::close(mListener);
+      mListener = -1;
+   }
+}
+
+ReplayServer::~ReplayServer()
+{
+   close();
+}
@@ -0,0 +1,282 @@
+#include "RequestClient.hpp"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <array>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+bool sendAll(const int socket, std::string_view data) noexcept
+{
+   while (!data.empty())
+   {
+      const auto sent = send(socket, data.data(), data.size(), MSG_NOSIGNAL);
+      if (sent <= 0)
+      {
+         return false;
+      }
+      data.remove_prefix(static_cast<std::size_t>(sent));
+   }
+   return true;
+}
+} // namespace
+
+RequestClient::RequestClient(const unsigned int port)
+    : mPort{port}, mWake{eventfd(0, EFD_NONBLOCK)}, mReceiver([this]() { receive(); })
+{
+}
+
+RequestClient::Reply RequestClient::request(const std::string_view method,
+                                            const std::string_view payload,
+                                            const std::chrono::milliseconds timeout)
+{
+   std::promise<Result<std::string, RequestError>> promise;
+   auto reply = promise.get_future();
+   if (method.size() > RequestFormat::MAX_METHOD_SIZE ||
+       payload.size() > RequestFormat::MAX_PAYLOAD_SIZE)
+   {
+      promise.set_value(Error(RequestError::FAILED, "The request is too large to be sent"));
+      return reply;
+   }
+
+   std::lock_guard lock(mMutex);
+   if (auto connected = connect(); !connected)
+   {
+      promise.set_value(connected.error());
+      return reply;
+   }
+
+   // Waited for before it is even sent, a reply never comes ahead of its request
+   const auto id = mNextId++;
+   const auto deadline = Clock::now() + timeout;
+   mPending.try_emplace(id, Pending{std::move(promise), deadline});
+   if (deadline < mWakeAt)
+   {
+      wake();
+   }
+
+   mSending.clear();
+   RequestFormat::appendRequest(mSending, id, method, payload);
+   if (!sendAll(mSocket, mSending))
+   {
+      // The receiving thread finds out as well, failing it along with the rest
+      ::shutdown(mSocket, SHUT_RDWR);
+   }
+
+   return reply;
+}
+
+Result<void, RequestError> RequestClient::connect()
+{
+   if (mSocket >= 0)
+   {
+      return {};
+   }
+
+   if (mStopping || mWake < 0)
+   {
+      return Error(RequestError::UNABLE_TO_CONNECT, "The client is closed");
+   }
+
+   const int server = socket(AF_INET, SOCK_STREAM, 0);
+   if (server < 0)
+   {
+      return Error(RequestError::UNABLE_TO_CONNECT, "Unable to create the socket");
+   }
+
+   sockaddr_in address{};
+   address.sin_family = AF_INET;
+   address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   address.sin_port = htons(static_cast<std::uint16_t>(mPort));
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+   if (::connect(server, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+   {
+      ::close(server);
+      return Error(RequestError::UNABLE_TO_CONNECT,
+                   ErrorDetail::compose("Unable to connect to the request server on port ", mPort));
+   }
+
+   // Requests are small and waited for, they go out as soon as they are written
+   const int noDelay = 1;
+   setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+   const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(SEND_TIMEOUT);
+   timeval sendTimeout{};
+   sendTimeout.tv_sec = seconds.count();
+   sendTimeout.tv_usec =
+       std::chrono::duration_cast<std::chrono::microseconds>(SEND_TIMEOUT - seconds).count();
+   setsockopt(server, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+
+   mSocket = server;
+   wake();
+   return {};
+}
+
+void RequestClient::receive()
+{
+   std::vector<char> chunk(RECEIVE_CHUNK);
+   std::string received;
+   std::unique_lock lock(mMutex);
+   while (!mStopping)
+   {
+      const auto now = Clock::now();
+      mWakeAt = std::min(expire(now), now + POLL_PERIOD);
+      const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(mWakeAt - now);
+      // Only ever closed from this thread, it can be waited on without the lock
+      const auto socket = mSocket;
+      lock.unlock();
+
+      std::array<pollfd, 2> descriptors{{{mWake, POLLIN, 0}, {socket, POLLIN, 0}}};
+      const auto ready =
+          ::poll(descriptors.data(), descriptors.size(), static_cast<int>(timeout.count()));
+      if (ready > 0 && descriptors.front().revents != 0)
+      {
+         std::uint64_t counter = 0;
+         [[maybe_unused]] const auto read = ::read(mWake, &counter, sizeof(counter));
+      }
+
+      ssize_t size = 0;
+      if (ready > 0 && descriptors.back().revents != 0)
+      {
+         size = recv(socket, chunk.data(), chunk.size(), 0);
+         if (size > 0)
+         {
+            received.append(chunk.data(), static_cast<std::size_t>(size));
+         }
+      }
+
+      lock.lock();
+      if (size < 0 || (size == 0 && descriptors.back().revents != 0) || !settle(received))
+      {
+         received.clear();
+         disconnect(Error(RequestError::DISCONNECTED, "The connection to the server dropped"));
+      }
+   }
+}
+
+bool RequestClient::settle(std::string& received)
+{
+   std::size_t offset = 0;
+   while (received.size() - offset >= RequestFormat::REPLY_HEADER_SIZE)
+   {
+      const auto* header = received.data() + offset;
+      const auto id = RequestFormat::readNumber(header, RequestFormat::ID_SIZE);
+      const auto status = static_cast<RequestFormat::Status>(header[RequestFormat::ID_SIZE]);
+      const auto size = RequestFormat::readNumber(header + RequestFormat::ID_SIZE + 1,
+                                                  RequestFormat::LENGTH_SIZE);
+      if (size > RequestFormat::MAX_PAYLOAD_SIZE)
+      {
+         return false;
+      }
+
+      if (received.size() - offset < RequestFormat::REPLY_HEADER_SIZE + size)
+      {
+         break;
+      }
+
+      const std::string_view payload(header + RequestFormat::REPLY_HEADER_SIZE, size);
+      offset += RequestFormat::REPLY_HEADER_SIZE + size;
+
+      // Requests that timed out are gone already, so are their late replies
+      auto pending = mPending.find(id);
+      if (pending == mPending.end())
+      {
+         continue;
+      }
+
+      auto& promise = pending->second.promise;
+      switch (status)
+      {
+         case RequestFormat::Status::OK:
+            promise.set_value(std::string(payload));
+            break;
+         case RequestFormat::Status::UNKNOWN_METHOD:
+            promise.set_value(
+                Error(RequestError::UNKNOWN_METHOD, "The server has no handler for the method"));
+            break;
+         default:
+            promise.set_value(Error(RequestError::FAILED, ErrorDetail::compose(payload)));
+            break;
+      }
+      mPending.erase(pending);
+   }
+
+   received.erase(0, offset);
+   return true;
+}
+
+RequestClient::Clock::time_point RequestClient::expire(const Clock::time_point now)
+{
+   auto next = Clock::time_point::max();
+   for (auto pending = mPending.begin(); pending != mPending.end();)
+   {
+      if (pending->second.deadline > now)
+      {
+         next = std::min(next, pending->second.deadline);
+         pending++;
+         continue;
+      }
+
+      pending->second.promise.set_value(
+          Error(RequestError::TIMEOUT, "No reply came in time from the server"));
+      pending = mPending.erase(pending);
+   }
+
+   return next;
+}
+
+void RequestClient::disconnect(const Error<RequestError>& error)
+{
+   if (mSocket >= 0)
+   {
+      ::close(mSocket);
+      mSocket = -1;
+   }
+
+   for (auto& [id, pending] : mPending)
+   {
+      pending.promise.set_value(error);
+   }
+   mPending.clear();
+}
+
+void RequestClient::wake() const noexcept
+{
+   if (mWake >= 0)
+   {
+      const std::uint64_t counter = 1;
+      [[maybe_unused]] const auto written = ::write(mWake, &counter, sizeof(counter));
+   }
+}
+
+void RequestClient::close() noexcept
+{
+   {
+      std::lock_guard lock(mMutex);
+      mStopping = true;
+      wake();
+   }
+
+   if (mReceiver.joinable())
+   {
+      mReceiver.join();
+   }
+
+   std::lock_guard lock(mMutex);
+   disconnect(Error(RequestError::DISCONNECTED, "The client was closed"));
+   if (mWake >= 0)
+   {
+      ::close(mWake);
+      mWake = -1;
+   }
+}
+
+RequestClient::~RequestClient()
+{
+   close();
+}
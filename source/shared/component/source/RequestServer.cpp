@@ -0,0 +1,233 @@
+#include "RequestServer.hpp"
+
+#include <arpa/inet.h>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace {
+bool sendAll(const int socket, std::string_view data) noexcept
+{
+   while (!data.empty())
+   {
+      const auto sent = send(socket, data.data(), data.size(), MSG_NOSIGNAL);
+      if (sent <= 0)
+      {
+         return false;
+      }
+      data.remove_prefix(static_cast<std::size_t>(sent));
+   }
+   return true;
+}
+} // namespace
+
+Result<void, RequestError> RequestServer::listen(const unsigned int port)
+{
+   close();
+
+   mListener = socket(AF_INET, SOCK_STREAM, 0);
+   if (mListener < 0)
+   {
+      return Error(RequestError::UNABLE_TO_LISTEN, "Unable to create the listening socket");
+   }
+
+   const int reuse = 1;
+   setsockopt(mListener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+   // Requests come from components on the same host, as for the pub/sub channels
+   sockaddr_in address{};
+   address.sin_family = AF_INET;
+   address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   address.sin_port = htons(static_cast<std::uint16_t>(port));
+
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+   if (bind(mListener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+       ::listen(mListener, SOMAXCONN) != 0)
+   {
+      close();
+      return Error(RequestError::UNABLE_TO_LISTEN,
+                   ErrorDetail::compose("Unable to listen on port ", port));
+   }
+
+   mChunk.resize(RECEIVE_CHUNK);
+   mRunning = true;
+   mThread = std::make_unique<Thread>([this]() { serve(); });
+
+   return {};
+}
+
+void RequestServer::handle(const std::string& method, Handler handler)
+{
+   std::unique_lock lock(mHandlersMutex);
+   if (handler)
+   {
+      mHandlers.insert_or_assign(method, std::move(handler));
+   }
+   else
+   {
+      mHandlers.erase(method);
+   }
+}
+
+void RequestServer::serve()
+{
+   std::vector<Connection> connections;
+   std::vector<pollfd> descriptors;
+   while (mRunning)
+   {
+      descriptors.clear();
+      descriptors.push_back({mListener, POLLIN, 0});
+      for (const auto& connection : connections)
+      {
+         descriptors.push_back({connection.socket, POLLIN, 0});
+      }
+
+      const auto ready =
+          ::poll(descriptors.data(), descriptors.size(), static_cast<int>(POLL_PERIOD.count()));
+      if (ready <= 0)
+      {
+         continue;
+      }
+
+      for (std::size_t index = 1; index < descriptors.size(); index++)
+      {
+         auto& connection = connections[index - 1];
+         if (descriptors[index].revents != 0 && !answer(connection))
+         {
+            ::close(connection.socket);
+            connection.socket = -1;
+         }
+      }
+      std::erase_if(connections,
+                    [](const Connection& connection) { return connection.socket < 0; });
+
+      if ((descriptors.front().revents & POLLIN) != 0)
+      {
+         accept(connections);
+      }
+   }
+
+   for (const auto& connection : connections)
+   {
+      ::close(connection.socket);
+   }
+}
+
+void RequestServer::accept(std::vector<Connection>& connections) const
+{
+   const int socket = ::accept(mListener, nullptr, nullptr);
+   if (socket < 0)
+   {
+      return;
+   }
+
+   // Replies are small and waited for, they go out as soon as they are written
+   const int noDelay = 1;
+   setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+   const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(SEND_TIMEOUT);
+   timeval timeout{};
+   timeout.tv_sec = seconds.count();
+   timeout.tv_usec =
+       std::chrono::duration_cast<std::chrono::microseconds>(SEND_TIMEOUT - seconds).count();
+   setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+   connections.push_back({socket, {}});
+}
+
+bool RequestServer::answer(Connection& connection)
+{
+   const auto received = recv(connection.socket, mChunk.data(), mChunk.size(), 0);
+   if (received <= 0)
+   {
+      return false;
+   }
+   connection.received.append(mChunk.data(), static_cast<std::size_t>(received));
+
+   // Requests sent back to back are answered together
+   mReplies.clear();
+   std::size_t offset = 0;
+   while (connection.received.size() - offset >= RequestFormat::REQUEST_HEADER_SIZE)
+   {
+      const auto* header = connection.received.data() + offset;
+      const auto id = RequestFormat::readNumber(header, RequestFormat::ID_SIZE);
+      const auto methodSize =
+          RequestFormat::readNumber(header + RequestFormat::ID_SIZE, RequestFormat::LENGTH_SIZE);
+      const auto payloadSize = RequestFormat::readNumber(
+          header + RequestFormat::ID_SIZE + RequestFormat::LENGTH_SIZE, RequestFormat::LENGTH_SIZE);
+      if (methodSize > RequestFormat::MAX_METHOD_SIZE ||
+          payloadSize > RequestFormat::MAX_PAYLOAD_SIZE)
+      {
+         return false;
+      }
+
+      const auto size = RequestFormat::REQUEST_HEADER_SIZE + methodSize + payloadSize;
+      if (connection.received.size() - offset < size)
+      {
+         break;
+      }
+
+      const auto* method = header + RequestFormat::REQUEST_HEADER_SIZE;
+      reply(id, std::string_view(method, methodSize),
+            std::string_view(method + methodSize, payloadSize));
+      offset += size;
+   }
+   connection.received.erase(0, offset);
+
+   return mReplies.empty() || sendAll(connection.socket, mReplies);
+}
+
+void RequestServer::reply(const std::uint64_t id, const std::string_view method,
+                          const std::string_view payload)
+{
+   // Called without the lock, so that handlers can add or remove handlers themselves
+   Handler handler;
+   {
+      std::shared_lock lock(mHandlersMutex);
+      auto found = mHandlers.find(method);
+      if (found != mHandlers.end())
+      {
+         handler = found->second;
+      }
+   }
+   if (!handler)
+   {
+      RequestFormat::appendReply(mReplies, id, RequestFormat::Status::UNKNOWN_METHOD, {});
+      return;
+   }
+
+   auto handled = handler(payload);
+   if (!handled)
+   {
+      const auto& error = handled.error();
+      RequestFormat::appendReply(mReplies, id, RequestFormat::Status::FAILED,
+                                 error.furtherInfo().value_or(error.asString()));
+      return;
+   }
+
+   RequestFormat::appendReply(mReplies, id, RequestFormat::Status::OK, handled.value());
+}
+
+void RequestServer::close() noexcept
+{
+   mRunning = false;
+   if (mThread)
+   {
+      mThread->join();
+      mThread.reset();
+   }
+
+   if (mListener >= 0)
+   {
+      ::close(mListener);
+      mListener = -1;
+   }
+}
+
+RequestServer::~RequestServer()
+{
+   close();
+}
@@ -0,0 +1,84 @@
+#include "Thread.hpp"
+
+#include <memory>
+#include <system_error>
+#include <tuple>
+#include <utility>
+
+std::atomic_size_t Thread::mStackSize = 0;
+
+Thread::Thread(Function function)
+{
+   auto owned = std::make_unique<Function>(std::move(function));
+   pthread_attr_t attributes;
+   int error = pthread_attr_init(&attributes);
+   if (error != 0)
+   {
+      throw std::system_error(error, std::generic_category(), "Unable to start thread");
+   }
+
+   // A stack size the platform does not take leaves the default in place
+   const auto stackSize = mStackSize.load();
+   if (stackSize != 0)
+   {
+      std::ignore = pthread_attr_setstacksize(&attributes, stackSize);
+   }
+
+   pthread_t handle{};
+   error = pthread_create(&handle, &attributes, &Thread::run, owned.get());
+   pthread_attr_destroy(&attributes);
+   if (error != 0)
+   {
+      throw std::system_error(error, std::generic_category(), "Unable to start thread");
+   }
+
+   // Owned by the thread from now on
+   std::ignore = owned.release();
+   mHandle = handle;
+}
+
+Thread::Thread(Thread&& thread) noexcept : mHandle{std::exchange(thread.mHandle, std::nullopt)}
+{
+}
+
+Thread& Thread::operator=(Thread&& thread) noexcept
+{
+   if (this != &thread)
+   {
+      join();
+      mHandle = std::exchange(thread.mHandle, std::nullopt);
+   }
+
+   return *this;
+}
+
+void Thread::setStackSize(const std::size_t stackSize) noexcept
+{
+   mStackSize = stackSize;
+}
+
+std::size_t Thread::stackSize() noexcept
+{
+   return mStackSize;
+}
+
+void Thread::join() noexcept
+{
+   if (mHandle.has_value())
+   {
+      pthread_join(mHandle.value(), nullptr);
+      mHandle.reset();
+   }
+}
+
+Thread::~Thread()
+{
+   join();
+}
+
+void* Thread::run(void* function) noexcept
+{
+   const std::unique_ptr<Function> owned(static_cast<Function*>(function));
+   (*owned)();
+   return nullptr;
+}
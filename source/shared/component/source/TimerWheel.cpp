@@ -0,0 +1,322 @@
+#include "TimerWheel.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+constexpr unsigned int GENERATION_SHIFT = 32;
+constexpr std::uint64_t INDEX_MASK = 0xFFFFFFFF;
+} // namespace
+
+TimerWheel::TimerWheel(const Clock::duration resolution, const Clock::time_point origin)
+    : mResolution{std::max(resolution, Clock::duration(1))}, mOrigin{origin}
+{
+   mSlots.fill(NONE);
+}
+
+TimerWheel::TimerId TimerWheel::schedule(const Clock::time_point at, Callback callback,
+                                         const Clock::duration period)
+{
+   std::uint32_t index = mFree;
+   if (index != NONE)
+   {
+      mFree = mNodes[index].next;
+   }
+   else
+   {
+      index = static_cast<std::uint32_t>(mNodes.size());
+      mNodes.emplace_back();
+   }
+
+   auto& node = mNodes[index];
+   node.callback = std::move(callback);
+   node.expiry = std::max(tick(at, true), mNext);
+   node.period = 0;
+   if (period > Clock::duration::zero())
+   {
+      node.period = std::max<std::uint64_t>(tick(mOrigin + period, true), 1);
+   }
+   node.previous = NONE;
+   node.next = NONE;
+   node.state = State::SCHEDULED;
+   insert(index);
+   mSize++;
+
+   return (static_cast<TimerId>(node.generation) << GENERATION_SHIFT) | index;
+}
+
+bool TimerWheel::cancel(const TimerId id) noexcept
+{
+   const auto index = static_cast<std::uint32_t>(id & INDEX_MASK);
+   if (index >= mNodes.size())
+   {
+      return false;
+   }
+
+   auto& node = mNodes[index];
+   if (node.generation != static_cast<std::uint32_t>(id >> GENERATION_SHIFT))
+   {
+      return false;
+   }
+
+   switch (node.state)
+   {
+   case State::SCHEDULED:
+      unlink(index);
+      release(index);
+      return true;
+   case State::RUNNING:
+      // Its callback is running right now, it goes once that returns
+      node.state = State::CANCELLED;
+      return node.period != 0;
+   default:
+      return false;
+   }
+}
+
+std::size_t TimerWheel::advance(const Clock::time_point now)
+{
+   // Called once a tick or so, which is told apart without dividing
+   if (now < time(mNext))
+   {
+      return 0;
+   }
+
+   const auto target = now < time(mNext + 1) ? mNext : tick(now, false);
+   if (mSize == 0)
+   {
+      mNext = std::max(mNext, target + 1);
+      return 0;
+   }
+
+   std::size_t expired = 0;
+   while (mNext <= target)
+   {
+      // A turn of the lowest wheel is over, bringing down the timers of the next one
+      if ((mNext & SLOT_MASK) == 0)
+      {
+         for (std::size_t level = 1; level < LEVELS; level++)
+         {
+            cascade(level);
+            if (((mNext >> (SLOT_BITS * level)) & SLOT_MASK) != 0)
+            {
+               break;
+            }
+         }
+      }
+
+      const auto occupied = mOccupied[0] & (~std::uint64_t{0} << (mNext & SLOT_MASK));
+      if (occupied == 0)
+      {
+         mNext = std::min((mNext | SLOT_MASK) + 1, target + 1);
+         continue;
+      }
+
+      const auto due =
+          (mNext & ~SLOT_MASK) + static_cast<std::uint64_t>(std::countr_zero(occupied));
+      if (due > target)
+      {
+         mNext = target + 1;
+         break;
+      }
+
+      mNext = due + 1;
+      expired += expire(due, target);
+   }
+
+   return expired;
+}
+
+std::optional<TimerWheel::Clock::time_point> TimerWheel::nextExpiry() const noexcept
+{
+   if (mSize == 0)
+   {
+      return std::nullopt;
+   }
+
+   // Timers of the upper wheels brought down on this tick might be due right away
+   if ((mNext & SLOT_MASK) == 0)
+   {
+      for (std::size_t level = 1; level < LEVELS; level++)
+      {
+         const auto slot = (mNext >> (SLOT_BITS * level)) & SLOT_MASK;
+         if ((mOccupied[level] & (std::uint64_t{1} << slot)) != 0)
+         {
+            return time(mNext);
+         }
+         if (slot != 0)
+         {
+            break;
+         }
+      }
+   }
+
+   // Otherwise the earliest timer of this turn of the lowest wheel, or the end of the turn
+   const auto occupied = mOccupied[0] & (~std::uint64_t{0} << (mNext & SLOT_MASK));
+   if (occupied == 0)
+   {
+      return time((mNext | SLOT_MASK) + 1);
+   }
+
+   return time((mNext & ~SLOT_MASK) + static_cast<std::uint64_t>(std::countr_zero(occupied)));
+}
+
+std::uint64_t TimerWheel::tick(const Clock::time_point time, const bool roundUp) const noexcept
+{
+   if (time <= mOrigin)
+   {
+      return 0;
+   }
+
+   const auto elapsed = time - mOrigin;
+   auto ticks = static_cast<std::uint64_t>(elapsed / mResolution);
+   if (roundUp && elapsed % mResolution != Clock::duration::zero())
+   {
+      ticks++;
+   }
+
+   return ticks;
+}
+
+TimerWheel::Clock::time_point TimerWheel::time(const std::uint64_t tick) const noexcept
+{
+   return mOrigin + mResolution * static_cast<Clock::rep>(tick);
+}
+
+void TimerWheel::insert(const std::uint32_t index) noexcept
+{
+   auto& node = mNodes[index];
+   const auto delta = node.expiry - mNext;
+
+   // The level whose turn covers the delay, the ones beyond the top level wait in its last slot
+   // and are placed again when it comes down
+   std::size_t level = 0;
+   while (level < LEVELS && (delta >> (SLOT_BITS * (level + 1))) != 0)
+   {
+      level++;
+   }
+
+   std::uint64_t slot = 0;
+   if (level == LEVELS)
+   {
+      level = LEVELS - 1;
+      slot = ((mNext >> (SLOT_BITS * level)) + SLOTS - 1) & SLOT_MASK;
+   }
+   else
+   {
+      slot = (node.expiry >> (SLOT_BITS * level)) & SLOT_MASK;
+   }
+
+   const auto position = static_cast<std::uint32_t>(level * SLOTS + slot);
+   node.slot = position;
+   node.previous = NONE;
+   node.next = mSlots[position];
+   if (node.next != NONE)
+   {
+      mNodes[node.next].previous = index;
+   }
+   mSlots[position] = index;
+   mOccupied[level] |= std::uint64_t{1} << slot;
+}
+
+void TimerWheel::unlink(const std::uint32_t index) noexcept
+{
+   auto& node = mNodes[index];
+   if (node.previous != NONE)
+   {
+      mNodes[node.previous].next = node.next;
+   }
+   else
+   {
+      mSlots[node.slot] = node.next;
+   }
+
+   if (node.next != NONE)
+   {
+      // Only the head of a list is sure to know which one it is in (see expire())
+      mNodes[node.next].previous = node.previous;
+      if (node.previous == NONE)
+      {
+         mNodes[node.next].slot = node.slot;
+      }
+   }
+
+   if (mSlots[node.slot] == NONE && node.slot < LEVELS * SLOTS)
+   {
+      mOccupied[node.slot / SLOTS] &= ~(std::uint64_t{1} << (node.slot % SLOTS));
+   }
+
+   node.slot = NONE;
+   node.previous = NONE;
+   node.next = NONE;
+}
+
+void TimerWheel::release(const std::uint32_t index) noexcept
+{
+   auto& node = mNodes[index];
+   node.callback = nullptr;
+   node.generation++;
+   node.state = State::FREE;
+   node.next = mFree;
+   mFree = index;
+   mSize--;
+}
+
+void TimerWheel::cascade(const std::size_t level) noexcept
+{
+   const auto slot = (mNext >> (SLOT_BITS * level)) & SLOT_MASK;
+   const auto position = level * SLOTS + slot;
+   auto index = mSlots[position];
+   mSlots[position] = NONE;
+   mOccupied[level] &= ~(std::uint64_t{1} << slot);
+
+   while (index != NONE)
+   {
+      const auto next = mNodes[index].next;
+      insert(index);
+      index = next;
+   }
+}
+
+std::size_t TimerWheel::expire(const std::uint64_t tick, const std::uint64_t now)
+{
+   // Moving the slot aside first, so that timers scheduled by the callbacks for a whole turn from
+   // now land in it without running on this tick. Only its head is told, walking it would cost a
+   // cache miss per timer
+   const auto slot = tick & SLOT_MASK;
+   auto index = mSlots[slot];
+   mSlots[slot] = NONE;
+   mOccupied[0] &= ~(std::uint64_t{1} << slot);
+   if (index != NONE)
+   {
+      mNodes[index].slot = EXPIRING;
+   }
+   mSlots[EXPIRING] = index;
+
+   std::size_t expired = 0;
+   while ((index = mSlots[EXPIRING]) != NONE)
+   {
+      unlink(index);
+      auto& node = mNodes[index];
+      node.state = State::RUNNING;
+      node.callback();
+      expired++;
+
+      if (node.state == State::CANCELLED || node.period == 0)
+      {
+         release(index);
+         continue;
+      }
+
+      // Periods missed while falling behind are skipped rather than run in a burst
+      node.state = State::SCHEDULED;
+      node.expiry += node.period;
+      if (node.expiry <= now)
+      {
+         node.expiry = now + node.period;
+      }
+      insert(index);
+   }
+
+   return expired;
+}
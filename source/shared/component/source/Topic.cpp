@@ -0,0 +1,309 @@
+#include "Topic.hpp"
+
+namespace {
+constexpr int HEX_BASE = 16;
+constexpr char32_t SURROGATE_FIRST = 0xD800;
+constexpr char32_t SURROGATE_SECOND = 0xDC00;
+constexpr char32_t SURROGATE_END = 0xE000;
+constexpr unsigned int SURROGATE_BITS = 10;
+constexpr char32_t SUPPLEMENTARY_FIRST = 0x10000;
+constexpr unsigned char CONTROL_END = 0x20;
+
+void appendUtf8(std::string& out, const char32_t codePoint)
+{
+   constexpr char32_t ONE_BYTE_END = 0x80;
+   constexpr char32_t TWO_BYTES_END = 0x800;
+   constexpr char32_t THREE_BYTES_END = 0x10000;
+   constexpr unsigned int CONTINUATION_BITS = 6;
+   constexpr char32_t CONTINUATION_MASK = 0x3F;
+   constexpr unsigned char CONTINUATION = 0x80;
+
+   const auto continuation = [](const char32_t bits) {
+      return static_cast<char>(CONTINUATION | (bits & CONTINUATION_MASK));
+   };
+
+   if (codePoint < ONE_BYTE_END)
+   {
+      out.push_back(static_cast<char>(codePoint));
+   }
+   else if (codePoint < TWO_BYTES_END)
+   {
+      out.push_back(static_cast<char>(0xC0 | (codePoint >> CONTINUATION_BITS)));
+      out.push_back(continuation(codePoint));
+   }
+   else if (codePoint < THREE_BYTES_END)
+   {
+      out.push_back(static_cast<char>(0xE0 | (codePoint >> (2 * CONTINUATION_BITS))));
+      out.push_back(continuation(codePoint >> CONTINUATION_BITS));
+      out.push_back(continuation(codePoint));
+   }
+   else
+   {
+      out.push_back(static_cast<char>(0xF0 | (codePoint >> (3 * CONTINUATION_BITS))));
+      out.push_back(continuation(codePoint >> (2 * CONTINUATION_BITS)));
+      out.push_back(continuation(codePoint >> CONTINUATION_BITS));
+      out.push_back(continuation(codePoint));
+   }
+}
+} // namespace
+
+void TopicWriter::writeString(std::string& out, const std::string_view text)
+{
+   static constexpr std::string_view HEX = "0123456789abcdef";
+
+   out.push_back('"');
+   for (const auto character : text)
+   {
+      switch (character)
+      {
+      case '"':
+         out.append("\\\"");
+         break;
+      case '\\':
+         out.append("\\\\");
+         break;
+      case '\n':
+         out.append("\\n");
+         break;
+      case '\r':
+         out.append("\\r");
+         break;
+      case '\t':
+         out.append("\\t");
+         break;
+      default:
+         if (static_cast<unsigned char>(character) < CONTROL_END)
+         {
+            out.append("\\u00");
+            out.push_back(HEX[static_cast<unsigned char>(character) / HEX_BASE]);
+            out.push_back(HEX[static_cast<unsigned char>(character) % HEX_BASE]);
+         }
+         else
+         {
+            out.push_back(character);
+         }
+      }
+   }
+   out.push_back('"');
+}
+
+void TopicReader::skipWhitespace() noexcept
+{
+   while (mPosition < mText.size() && (mText[mPosition] == ' ' || mText[mPosition] == '\n' ||
+                                       mText[mPosition] == '\r' || mText[mPosition] == '\t'))
+   {
+      mPosition++;
+   }
+}
+
+bool TopicReader::consume(const char character) noexcept
+{
+   if (mPosition < mText.size() && mText[mPosition] == character)
+   {
+      mPosition++;
+      return true;
+   }
+   return false;
+}
+
+bool TopicReader::literal(const std::string_view text) noexcept
+{
+   if (mText.substr(mPosition, text.size()) == text)
+   {
+      mPosition += text.size();
+      return true;
+   }
+   return false;
+}
+
+bool TopicReader::enter() noexcept
+{
+   return ++mDepth <= MAX_DEPTH;
+}
+
+std::string_view TopicReader::numberText() noexcept
+{
+   const auto start = mPosition;
+   while (mPosition < mText.size())
+   {
+      const auto character = mText[mPosition];
+      if ((character < '0' || character > '9') && character != '-' && character != '+' &&
+          character != '.' && character != 'e' && character != 'E')
+      {
+         break;
+      }
+      mPosition++;
+   }
+   return mText.substr(start, mPosition - start);
+}
+
+bool TopicReader::readString(std::string& out)
+{
+   skipWhitespace();
+   if (!consume('"'))
+   {
+      return false;
+   }
+
+   out.clear();
+   while (mPosition < mText.size())
+   {
+      // Copying unescaped runs at once, they are most of any string
+      const auto end = mText.find_first_of("\"\\", mPosition);
+      if (end == std::string_view::npos)
+      {
+         return false;
+      }
+      out.append(mText.substr(mPosition, end - mPosition));
+      mPosition = end + 1;
+
+      if (mText[end] == '"')
+      {
+         return true;
+      }
+
+      if (mPosition >= mText.size())
+      {
+         return false;
+      }
+      const auto escaped = mText[mPosition++];
+      switch (escaped)
+      {
+      case '"':
+      case '\\':
+      case '/':
+         out.push_back(escaped);
+         break;
+      case 'b':
+         out.push_back('\b');
+         break;
+      case 'f':
+         out.push_back('\f');
+         break;
+      case 'n':
+         out.push_back('\n');
+         break;
+      case 'r':
+         out.push_back('\r');
+         break;
+      case 't':
+         out.push_back('\t');
+         break;
+      case 'u':
+      {
+         const auto hex = [this](char32_t& value) {
+            const auto digits = mText.substr(mPosition, 4);
+            std::uint32_t number = 0;
+            const auto parsed =
+                std::from_chars(digits.data(), digits.data() + digits.size(), number, HEX_BASE);
+            value = number;
+            mPosition += digits.size();
+            return digits.size() == 4 && parsed.ptr == digits.data() + digits.size();
+         };
+
+         char32_t codePoint = 0;
+         if (!hex(codePoint))
+         {
+            return false;
+         }
+         if (codePoint >= SURROGATE_FIRST && codePoint < SURROGATE_SECOND)
+         {
+            char32_t second = 0;
+            if (!literal("\\u") || !hex(second) || second < SURROGATE_SECOND ||
+                second >= SURROGATE_END)
+            {
+               return false;
+            }
+            codePoint = SUPPLEMENTARY_FIRST + ((codePoint - SURROGATE_FIRST) << SURROGATE_BITS) +
+                        (second - SURROGATE_SECOND);
+         }
+         appendUtf8(out, codePoint);
+         break;
+      }
+      default:
+         return false;
+      }
+   }
+
+   return false;
+}
+
+bool TopicReader::skip()
+{
+   skipWhitespace();
+   if (mPosition >= mText.size())
+   {
+      return false;
+   }
+
+   switch (mText[mPosition])
+   {
+   case '"':
+   {
+      mPosition++;
+      while (mPosition < mText.size())
+      {
+         const auto character = mText[mPosition++];
+         if (character == '\\')
+         {
+            mPosition++;
+         }
+         else if (character == '"')
+         {
+            return true;
+         }
+      }
+      return false;
+   }
+   case '{':
+   case '[':
+   {
+      const auto close = mText[mPosition] == '{' ? '}' : ']';
+      const bool object = close == '}';
+      mPosition++;
+      if (!enter())
+      {
+         return false;
+      }
+
+      skipWhitespace();
+      if (!consume(close))
+      {
+         do
+         {
+            if (object && !(skip() && (skipWhitespace(), consume(':'))))
+            {
+               return false;
+            }
+            if (!skip())
+            {
+               return false;
+            }
+            skipWhitespace();
+         } while (consume(','));
+
+         if (!consume(close))
+         {
+            return false;
+         }
+      }
+
+      mDepth--;
+      return true;
+   }
+   case 't':
+      return literal("true");
+   case 'f':
+      return literal("false");
+   case 'n':
+      return literal("null");
+   default:
+      return !numberText().empty();
+   }
+}
+
+bool TopicReader::finished() noexcept
+{
+   skipWhitespace();
+   return mPosition == mText.size();
+}
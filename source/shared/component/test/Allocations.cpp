@@ -0,0 +1,147 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "gtest/gtest.h"
+
+#include "Frame.hpp"
+#include "Test.hpp"
+
+// Counts every allocation made by this test binary, so that the hot paths of a component can be
+// checked to stay allocation free once warmed up
+struct AllocationTopic
+{
+   double temperature = 0;
+   std::int64_t timestamp = 0;
+};
+GROW_TOPIC(AllocationTopic, "TEMPERATURE", temperature, timestamp)
+
+namespace {
+std::atomic<std::size_t> allocations = 0;
+
+constexpr unsigned int MESSAGES = 1000;
+
+template <class Function> std::size_t allocationsOf(Function function)
+{
+   const auto before = allocations.load();
+   for (unsigned int i = 0; i < MESSAGES; i++)
+   {
+      function();
+   }
+   return allocations.load() - before;
+}
+
+const nlohmann::json& payload()
+{
+   static const nlohmann::json PAYLOAD = {
+       {"temperature", 21.5}, {"sensor", "greenhouse-north-01"}, {"samples", {20.5, 21, 22.5}}};
+   return PAYLOAD;
+}
+} // namespace
+
+void* operator new(std::size_t size)
+{
+   allocations.fetch_add(1, std::memory_order_relaxed);
+   if (auto* pointer = std::malloc(size))
+   {
+      return pointer;
+   }
+   throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+   std::free(pointer);
+}
+
+void operator delete(void* pointer, [[maybe_unused]] std::size_t size) noexcept
+{
+   std::free(pointer);
+}
+
+TEST(Allocations, Metadata)
+{
+   TestComponent c;
+   const Component& component = c;
+   const auto count = allocationsOf([&component]() {
+      ASSERT_FALSE(component.name().empty());
+      ASSERT_FALSE(component.description().empty());
+      ASSERT_FALSE(component.version().empty());
+      ASSERT_FALSE(component.signature().empty());
+   });
+   ASSERT_EQ(count, 0);
+}
+
+TEST(Allocations, Publish)
+{
+   FrameEncoder encoder;
+   ASSERT_TRUE(encoder.encode("TEMPERATURE", payload(), "1.0.0"));
+
+   const auto count = allocationsOf([&encoder]() {
+      ASSERT_TRUE(encoder.encode("TEMPERATURE", payload(), "1.0.0"));
+   });
+   ASSERT_EQ(count, 0) << "Encoding a frame allocated in steady state";
+}
+
+TEST(Allocations, Dispatch)
+{
+   FrameEncoder encoder;
+   const auto encoded = encoder.encode("TEMPERATURE", payload(), "1.0.0");
+   ASSERT_TRUE(encoded);
+   const std::string frame(encoded.value());
+   const auto json = std::string_view(frame).substr(frame.find('#') + 1);
+
+   FrameDecoder decoder;
+   ASSERT_TRUE(decoder.decode(frame, "1.0.0"));
+
+   // Building the json is the only allocation a subscriber cannot avoid, everything else must not
+   nlohmann::json parsed = nlohmann::json::parse(json);
+   const auto parsing = allocationsOf([&parsed, &json]() { parsed = nlohmann::json::parse(json); });
+   const auto dispatching =
+       allocationsOf([&decoder, &frame]() { ASSERT_TRUE(decoder.decode(frame, "1.0.0")); });
+   ASSERT_EQ(dispatching, parsing) << "Dispatching a frame allocated beyond parsing its payload";
+}
+
+TEST(Allocations, TypedTopic)
+{
+   FrameEncoder encoder;
+   const AllocationTopic sent{21.5, 1700000000000};
+   const std::string frame(encoder.encode(sent, "1.0.0", 1).value());
+
+   const auto encoding =
+       allocationsOf([&encoder, &sent]() { ASSERT_TRUE(encoder.encode(sent, "1.0.0", 1)); });
+   ASSERT_EQ(encoding, 0) << "Encoding a typed topic allocated in steady state";
+
+   FrameDecoder decoder;
+   AllocationTopic received;
+   ASSERT_TRUE(decoder.decode(frame, "1.0.0", received));
+   const auto decoding = allocationsOf([&decoder, &frame, &received]() {
+      ASSERT_TRUE(decoder.decode(frame, "1.0.0", received));
+   });
+   ASSERT_EQ(decoding, 0) << "Decoding a typed topic allocated in steady state";
+}
+
+TEST(Allocations, Compression)
+{
+   FrameEncoder encoder;
+   nlohmann::json samples = nlohmann::json::array();
+   for (int i = 0; i < 100; i++)
+   {
+      samples.push_back({{"timestamp", i}, {"temperature", 20 + i % 5}});
+   }
+   const std::string frame(encoder.encode("BATCH", {{"samples", samples}}, "1.0.0").value());
+
+   for (const auto algorithm : {FrameCompressor::Algorithm::LZ4, FrameCompressor::Algorithm::ZSTD})
+   {
+      FrameCompressor compressor;
+      const FrameCompressor::Settings settings{algorithm, 0, 0};
+      const std::string compressed(compressor.compress(frame, settings));
+      ASSERT_TRUE(compressor.decompress(compressed));
+
+      const auto count = allocationsOf([&compressor, &frame, &compressed, &settings]() {
+         ASSERT_EQ(compressor.compress(frame, settings).size(), compressed.size());
+         ASSERT_TRUE(compressor.decompress(compressed));
+      });
+      ASSERT_EQ(count, 0) << "Compressing a frame allocated in steady state";
+   }
+}
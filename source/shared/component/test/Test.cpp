@@ -1,8 +1,39 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
 #include <fstream>
+#include <future>
+#include <mutex>
+#include <pthread.h>
+#include <random>
+#include <thread>
 
 #include "gtest/gtest.h"
 
+#include "QuantileSketch.hpp"
+#include "ReplayServer.hpp"
+#include "RequestClient.hpp"
+#include "RequestServer.hpp"
 #include "Test.hpp"
+#include "Thread.hpp"
+#include "TimerWheel.hpp"
+
+struct TestSample
+{
+   std::int64_t timestamp = 0;
+   double value = 0;
+   bool valid = false;
+};
+GROW_SCHEMA(TestSample, timestamp, value, valid)
+
+struct TestTopic
+{
+   std::string sensor;
+   unsigned int count = 0;
+   std::vector<TestSample> samples;
+};
+GROW_TOPIC(TestTopic, "TEST_TOPIC", sensor, count, samples)
 
 TEST(Component, Lifecycle)
 {
@@ -102,3 +133,1220 @@ TEST(Component, UnexistingValue)
    auto configValue = c.settingValue<std::string>("nonexistant");
    ASSERT_FALSE(configValue.has_value());
 }
+
+TEST(Component, LowMemory)
+{
+   const std::string filePath = "/tmp/grow_component_test.cfg";
+   const std::string field = "Game";
+
+   TestComponent c;
+
+   std::ofstream stream(filePath);
+   stream << "project_version = \"" << c.version() << "\";\n"
+          << "Publisher = { " << c.name() << " = 7452; };\n"
+          << c.name() << " = { " << field << " = \"Metal Gear Solid\" };";
+   stream.close();
+   ASSERT_TRUE(stream) << "Unable to write test file to " << filePath;
+
+   c.infinite = true;
+   c.setLogLevel(Logger::Level::off);
+   c.setConfigurationPath(filePath);
+   c.setLowMemory(true);
+   ASSERT_TRUE(c.start()) << "Unable to start component";
+
+   // Settings and ports are still looked up once started
+   EXPECT_EQ(c.settingValue<std::string>(field).value_or(""), "Metal Gear Solid")
+       << "Configuration is gone in the low memory profile";
+   auto subscribed =
+       c.subscribeFrames(std::string(c.name()), [](const std::string_view /*frame*/) {});
+   EXPECT_TRUE(subscribed) << "Unable to subscribe once started in the low memory profile";
+   EXPECT_TRUE(c.stop()) << "Unable to stop component";
+}
+
+class SequencedComponent : public TestComponent
+{
+public:
+   using Component::lastSequence;
+   using Component::makeDeadband;
+};
+
+TEST(Component, IntegerDeadband)
+{
+   const std::string filePath = "/tmp/grow_component_test.cfg";
+
+   SequencedComponent c;
+
+   // Written without a decimal point, libconfig reads these as integers
+   std::ofstream stream(filePath);
+   stream << "project_version = \"" << c.version() << "\";\n"
+          << c.name() << " = { deadband = { absolute = 2; relative = 10; heartbeat = 1000; }; };";
+   stream.close();
+   ASSERT_TRUE(stream) << "Unable to write test file to " << filePath;
+
+   c.setLogLevel(Logger::Level::off);
+   c.setConfigurationPath(filePath);
+   ASSERT_TRUE(c.startBlocking()) << "Unable to start component";
+
+   EXPECT_FLOAT_EQ(c.settingNumber("deadband.absolute").value_or(0), 2);
+   auto deadband = c.makeDeadband("deadband");
+   ASSERT_TRUE(deadband.has_value()) << "Integer deadband settings were not read";
+   EXPECT_FLOAT_EQ(deadband->settings().absolute, 2);
+   EXPECT_FLOAT_EQ(deadband->settings().relative, 0.1F);
+   EXPECT_EQ(deadband->settings().heartbeat, std::chrono::milliseconds(1000));
+}
+
+TEST(Component, SequenceFromCallback)
+{
+   const std::string filePath = "/tmp/grow_component_test.cfg";
+
+   SequencedComponent c;
+
+   std::ofstream stream(filePath);
+   stream << "project_version = \"" << c.version() << "\";\n"
+          << "Publisher = { " << c.name() << " = 7451; };\n"
+          << c.name() << " = { replay = { frames = 16; }; };";
+   stream.close();
+   ASSERT_TRUE(stream) << "Unable to write test file to " << filePath;
+
+   c.infinite = true;
+   c.setLogLevel(Logger::Level::off);
+   c.setConfigurationPath(filePath);
+   ASSERT_TRUE(c.start()) << "Unable to start component";
+
+   // Asking where the channel is at from the callback used to wait on the lock held around it
+   std::promise<std::uint64_t> sequence;
+   auto received = sequence.get_future();
+   std::atomic_bool asked = false;
+   auto subscribed = c.subscribeFrames(std::string(c.name()), [&](const std::string_view) {
+      if (!asked.exchange(true))
+      {
+         sequence.set_value(c.lastSequence(std::string(c.name())).sequence);
+      }
+   });
+   ASSERT_TRUE(subscribed) << "Unable to subscribe";
+
+   const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+   while (received.wait_for(std::chrono::milliseconds(50)) != std::future_status::ready &&
+          std::chrono::steady_clock::now() < deadline)
+   {
+      std::ignore = c.publish(TestComponent::TOPIC, TestComponent::PAYLOAD);
+   }
+   ASSERT_EQ(received.wait_for(std::chrono::seconds(0)), std::future_status::ready)
+       << "No frame was handed over";
+   EXPECT_GT(received.get(), 0) << "Sequence of the frame handed over is missing";
+   EXPECT_TRUE(c.stop()) << "Unable to stop component";
+}
+
+TEST(Aggregator, Reduce)
+{
+   std::vector<float> samples;
+   for (unsigned int i = 1; i <= 100; i++)
+   {
+      samples.push_back(static_cast<float>(i));
+   }
+
+   auto statistics = Aggregator::reduce(samples);
+   ASSERT_EQ(statistics.count, samples.size());
+   ASSERT_FLOAT_EQ(statistics.min, 1);
+   ASSERT_FLOAT_EQ(statistics.max, 100);
+   ASSERT_FLOAT_EQ(statistics.mean, 50.5);
+   ASSERT_NEAR(statistics.stddev, 28.866, 0.001);
+}
+
+TEST(Aggregator, TumblingWindow)
+{
+   constexpr std::size_t size = 4;
+   Aggregator aggregator(Aggregator::Window::TUMBLING, size);
+
+   unsigned int emitted = 0;
+   for (unsigned int i = 0; i < size * 3; i++)
+   {
+      auto statistics = aggregator.add(static_cast<float>(i));
+      if (statistics.has_value())
+      {
+         ASSERT_FLOAT_EQ(statistics->min, static_cast<float>(i + 1 - size))
+             << "Tumbling windows are overlapping";
+         emitted++;
+      }
+   }
+   ASSERT_EQ(emitted, 3);
+}
+
+TEST(Aggregator, SlidingWindow)
+{
+   constexpr std::size_t size = 4;
+   constexpr std::size_t step = 2;
+   Aggregator aggregator(Aggregator::Window::SLIDING, size, step);
+
+   std::vector<float> maximums;
+   for (unsigned int i = 0; i < 10; i++)
+   {
+      auto statistics = aggregator.add(static_cast<float>(i));
+      if (statistics.has_value())
+      {
+         ASSERT_EQ(statistics->count, size);
+         maximums.push_back(statistics->max);
+      }
+   }
+   ASSERT_EQ(maximums, (std::vector<float>{3, 5, 7, 9}));
+}
+
+TEST(Deadband, Thresholds)
+{
+   using Report = Deadband::Report;
+   const auto now = Deadband::Clock::now();
+
+   Deadband absolute({.absolute = 0.5});
+   ASSERT_EQ(absolute.check(20, now), Report::CHANGE) << "The first value is always reported";
+   ASSERT_EQ(absolute.check(20.4F, now), Report::NONE);
+   ASSERT_EQ(absolute.check(20.6F, now), Report::CHANGE);
+   ASSERT_EQ(absolute.check(20.2F, now), Report::NONE) << "Compared to the last value reported";
+   ASSERT_EQ(absolute.check(20, now), Report::CHANGE);
+
+   Deadband relative({.relative = 0.1F});
+   ASSERT_EQ(relative.check(100, now), Report::CHANGE);
+   ASSERT_EQ(relative.check(109, now), Report::NONE);
+   ASSERT_EQ(relative.check(89, now), Report::CHANGE);
+
+   Deadband any(Deadband::Settings{});
+   ASSERT_EQ(any.check(1, now), Report::CHANGE);
+   ASSERT_EQ(any.check(1, now), Report::NONE);
+   ASSERT_EQ(any.check(1.01F, now), Report::CHANGE);
+}
+
+TEST(Deadband, Heartbeat)
+{
+   using Report = Deadband::Report;
+   using std::chrono::seconds;
+   const auto start = Deadband::Clock::now();
+
+   Deadband deadband({.absolute = 1, .heartbeat = seconds(60)});
+   ASSERT_EQ(deadband.check(20, start), Report::CHANGE);
+   ASSERT_EQ(deadband.check(20, start + seconds(59)), Report::NONE);
+   ASSERT_EQ(deadband.check(20.5F, start + seconds(60)), Report::HEARTBEAT);
+   ASSERT_EQ(deadband.check(20, start + seconds(90)), Report::NONE);
+   ASSERT_EQ(deadband.check(22, start + seconds(100)), Report::CHANGE);
+   ASSERT_EQ(deadband.check(22, start + seconds(159)), Report::NONE)
+       << "A change postpones the next heartbeat";
+   ASSERT_EQ(deadband.check(22, start + seconds(160)), Report::HEARTBEAT);
+   ASSERT_EQ(deadband.check(22, start), Report::HEARTBEAT) << "The clock stepped back";
+}
+
+namespace {
+// Where a value falls among the sorted samples, as a fraction of them
+double rankOf(const std::vector<float>& sorted, const float value)
+{
+   const auto below = std::lower_bound(sorted.begin(), sorted.end(), value) - sorted.begin();
+   const auto upTo = std::upper_bound(sorted.begin(), sorted.end(), value) - sorted.begin();
+   return static_cast<double>(below + upTo) / 2 / static_cast<double>(sorted.size());
+}
+} // namespace
+
+TEST(QuantileSketch, Accuracy)
+{
+   constexpr std::size_t count = 100000;
+   std::mt19937 rng(42);
+   std::normal_distribution<float> dist(20, 2);
+
+   QuantileSketch sketch;
+   std::vector<float> samples(count);
+   for (auto& sample : samples)
+   {
+      sample = dist(rng);
+      sketch.add(sample);
+   }
+   std::sort(samples.begin(), samples.end());
+
+   ASSERT_EQ(sketch.count(), count);
+   ASSERT_FLOAT_EQ(sketch.quantile(0), samples.front());
+   ASSERT_FLOAT_EQ(sketch.quantile(1), samples.back());
+   ASSERT_LE(sketch.centroids().size(), QuantileSketch::COMPRESSION_DEFAULT);
+   for (const double fraction : {0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99})
+   {
+      ASSERT_NEAR(rankOf(samples, sketch.quantile(fraction)), fraction, 0.002)
+          << "Estimating quantile " << fraction;
+   }
+}
+
+TEST(QuantileSketch, Merge)
+{
+   constexpr std::size_t sensors = 16;
+   constexpr std::size_t count = 5000;
+   std::mt19937 rng(42);
+
+   // Every sensor of the zone seeing a different part of the range
+   QuantileSketch zone;
+   std::vector<float> samples;
+   for (std::size_t sensor = 0; sensor < sensors; sensor++)
+   {
+      std::normal_distribution<float> dist(15 + static_cast<float>(sensor), 1);
+      QuantileSketch sketch;
+      for (std::size_t i = 0; i < count; i++)
+      {
+         samples.push_back(dist(rng));
+         sketch.add(samples.back());
+      }
+      zone.merge(sketch.centroids(), sketch.min(), sketch.max());
+   }
+   std::sort(samples.begin(), samples.end());
+
+   ASSERT_EQ(zone.count(), sensors * count);
+   ASSERT_FLOAT_EQ(zone.min(), samples.front());
+   ASSERT_FLOAT_EQ(zone.max(), samples.back());
+   for (const double fraction : {0.05, 0.5, 0.95})
+   {
+      ASSERT_NEAR(rankOf(samples, zone.quantile(fraction)), fraction, 0.005)
+          << "Estimating quantile " << fraction;
+   }
+
+   QuantileSketch empty;
+   ASSERT_TRUE(std::isnan(empty.quantile(0.5)));
+   zone.clear();
+   ASSERT_EQ(zone.count(), 0);
+   ASSERT_TRUE(zone.centroids().empty());
+}
+
+TEST(ReplayBuffer, Eviction)
+{
+   std::vector<std::pair<std::uint64_t, std::string>> replayed;
+   const auto collect = [&replayed](const std::uint64_t sequence, const std::string_view frame) {
+      replayed.emplace_back(sequence, frame);
+   };
+
+   ReplayBuffer byFrames(ReplayBuffer::Settings{3, 1024});
+   for (const auto* frame : {"a", "b", "c", "d", "e"})
+   {
+      byFrames.push(frame);
+   }
+   ASSERT_EQ(byFrames.first(), 3);
+   ASSERT_EQ(byFrames.next(), 6);
+   byFrames.replay(1, 4, collect);
+   ASSERT_EQ(replayed.size(), 2);
+   ASSERT_EQ(replayed.front(), std::make_pair(std::uint64_t{3}, std::string("c")));
+   ASSERT_EQ(replayed.back(), std::make_pair(std::uint64_t{4}, std::string("d")));
+
+   // Ten bytes hold two frames of four, the third wraps over the first
+   ReplayBuffer byBytes(ReplayBuffer::Settings{100, 10});
+   ASSERT_EQ(byBytes.push("aaaa"), 1);
+   ASSERT_EQ(byBytes.push("bbbb"), 2);
+   ASSERT_EQ(byBytes.push("cccc"), 3);
+   ASSERT_EQ(byBytes.first(), 2);
+   replayed.clear();
+   byBytes.replay(1, 10, collect);
+   ASSERT_EQ(replayed.size(), 2);
+   ASSERT_EQ(replayed.front().second, "bbbb");
+   ASSERT_EQ(replayed.back().second, "cccc");
+
+   // Too large to be kept at all
+   ASSERT_EQ(byBytes.push("ddddddddddd"), 4);
+   ASSERT_EQ(byBytes.first(), byBytes.next());
+}
+
+TEST(ReplayBuffer, WrapsOverOnlyEvicted)
+{
+   // A frame going back to the start must not overwrite the newer ones already there
+   ReplayBuffer buffer(ReplayBuffer::Settings{3, 22});
+   for (const std::size_t size : {7, 1, 7, 6, 11, 12})
+   {
+      buffer.push(std::string(size, static_cast<char>('a' + buffer.next())));
+   }
+
+   std::vector<std::pair<std::uint64_t, std::string>> replayed;
+   buffer.replay(1, buffer.next(), [&replayed](const std::uint64_t sequence, auto frame) {
+      replayed.emplace_back(sequence, frame);
+   });
+   ASSERT_EQ(replayed.size(), 1);
+   ASSERT_EQ(replayed.front(), std::make_pair(std::uint64_t{6}, std::string(12, 'g')));
+}
+
+TEST(ReplayBuffer, MatchesReference)
+{
+   constexpr std::size_t FRAMES = 16;
+   constexpr std::size_t BYTES = 256;
+   std::mt19937 generator(42);
+   std::uniform_int_distribution<std::size_t> sizes(0, BYTES / 4);
+   std::uniform_int_distribution<std::size_t> large(0, 20);
+
+   // Everything ever pushed, what is replayed has to be a suffix of it within the bounds
+   std::vector<std::string> pushed;
+   ReplayBuffer buffer(ReplayBuffer::Settings{FRAMES, BYTES});
+   for (unsigned int round = 0; round < 20000; round++)
+   {
+      const auto size = large(generator) == 0 ? BYTES + 1 - large(generator) : sizes(generator);
+      std::string frame(size, static_cast<char>('a' + round % 26));
+      if (!frame.empty())
+      {
+         frame.front() = static_cast<char>(round);
+      }
+      ASSERT_EQ(buffer.push(frame), pushed.size() + 1);
+      pushed.push_back(frame);
+
+      std::uint64_t expected = buffer.first();
+      std::size_t bytes = 0;
+      buffer.replay(0, buffer.next(), [&](const std::uint64_t sequence, auto replayed) {
+         ASSERT_EQ(sequence, expected++);
+         ASSERT_EQ(replayed, pushed[sequence - 1]) << "Frame " << sequence << " was overwritten";
+         bytes += replayed.size();
+      });
+      ASSERT_EQ(expected, buffer.next());
+      ASSERT_EQ(buffer.next(), pushed.size() + 1);
+      ASSERT_LE(buffer.next() - buffer.first(), FRAMES);
+      ASSERT_LE(bytes, BYTES);
+      // The newest frame is always kept when it fits at all
+      ASSERT_EQ(buffer.first() < buffer.next(), frame.size() <= BYTES);
+   }
+}
+
+TEST(ReplayBuffer, Stamp)
+{
+   std::string stamped;
+   ReplayBuffer::stamp(stamped, 0x1112131415161718, 0x0102030405060708, "TOPIC");
+   auto unstamped = ReplayBuffer::unstamp(stamped);
+   ASSERT_TRUE(unstamped.has_value());
+   ASSERT_EQ(unstamped->epoch, 0x1112131415161718);
+   ASSERT_EQ(unstamped->sequence, 0x0102030405060708);
+   ASSERT_EQ(unstamped->frame, "TOPIC");
+
+   // Every buffer is an epoch of its own
+   const ReplayBuffer first(ReplayBuffer::Settings{});
+   const ReplayBuffer second(ReplayBuffer::Settings{});
+   ASSERT_NE(first.epoch(), 0);
+   ASSERT_NE(first.epoch(), second.epoch());
+
+   ASSERT_FALSE(ReplayBuffer::unstamp("TOPIC").has_value());
+   ASSERT_FALSE(ReplayBuffer::unstamp(std::string(1, ReplayBuffer::SEQUENCE_MARKER)).has_value());
+}
+
+TEST(ReplayServer, Fetch)
+{
+   ReplayBuffer buffer(ReplayBuffer::Settings{4, 1024});
+   for (unsigned int i = 1; i <= 6; i++)
+   {
+      buffer.push("frame" + std::to_string(i));
+   }
+
+   constexpr unsigned int PORT = 7350;
+   constexpr unsigned int CHANNEL = 7000;
+   ReplayServer server;
+   auto listening = server.listen(PORT, [&buffer](const unsigned int channel,
+                                                  const std::uint64_t epoch,
+                                                  const std::uint64_t first,
+                                                  const std::uint64_t last,
+                                                  const ReplayBuffer::Callback& callback) {
+      if (channel == CHANNEL && epoch == buffer.epoch())
+      {
+         buffer.replay(first, last, callback);
+      }
+   });
+   ASSERT_TRUE(listening);
+
+   // The first two were evicted, they are missing from the answer
+   std::vector<std::pair<std::uint64_t, std::string>> replayed;
+   auto fetched = ReplayServer::fetch(
+       PORT, CHANNEL, buffer.epoch(), 1, 4,
+       [&replayed](const std::uint64_t sequence, const std::string_view frame) {
+          replayed.emplace_back(sequence, frame);
+       });
+   ASSERT_TRUE(fetched);
+   ASSERT_EQ(fetched.value(), 2);
+   ASSERT_EQ(replayed.front(), std::make_pair(std::uint64_t{3}, std::string("frame3")));
+   ASSERT_EQ(replayed.back(), std::make_pair(std::uint64_t{4}, std::string("frame4")));
+
+   fetched = ReplayServer::fetch(PORT, CHANNEL + 1, buffer.epoch(), 1, 4, [](auto, auto) {});
+   ASSERT_TRUE(fetched);
+   ASSERT_EQ(fetched.value(), 0);
+
+   // Frames of another epoch are not these, whatever their sequence
+   fetched = ReplayServer::fetch(PORT, CHANNEL, buffer.epoch() + 1, 1, 4, [](auto, auto) {});
+   ASSERT_TRUE(fetched);
+   ASSERT_EQ(fetched.value(), 0);
+
+   server.close();
+   ASSERT_FALSE(ReplayServer::fetch(PORT, CHANNEL, buffer.epoch(), 1, 4, [](auto, auto) {}));
+}
+
+TEST(Request, RoundTrip)
+{
+   constexpr unsigned int PORT = 7351;
+   RequestServer server;
+   ASSERT_TRUE(server.listen(PORT));
+   server.handle("echo", [](const std::string_view payload) -> Result<std::string, RequestError> {
+      return std::string(payload);
+   });
+   server.handle("fail", [](std::string_view) -> Result<std::string, RequestError> {
+      return Error(RequestError::FAILED, "Sensor unavailable");
+   });
+
+   using namespace std::chrono_literals;
+   RequestClient client(PORT);
+   // Many in flight over the one connection, each reply reaching its own request
+   std::vector<RequestClient::Reply> replies;
+   for (unsigned int i = 0; i < 100; i++)
+   {
+      replies.push_back(client.request("echo", "payload" + std::to_string(i), 1s));
+   }
+   for (unsigned int i = 0; i < replies.size(); i++)
+   {
+      auto reply = replies[i].get();
+      ASSERT_TRUE(reply);
+      ASSERT_EQ(reply.value(), "payload" + std::to_string(i));
+   }
+
+   auto failed = client.request("fail", "", 1s).get();
+   ASSERT_FALSE(failed);
+   ASSERT_EQ(failed.error(), RequestError::FAILED);
+   ASSERT_EQ(failed.error().furtherInfo(), "Sensor unavailable");
+
+   auto unknown = client.request("unknown", "", 1s).get();
+   ASSERT_FALSE(unknown);
+   ASSERT_EQ(unknown.error(), RequestError::UNKNOWN_METHOD);
+
+   // Gone handlers are no longer called
+   server.handle("echo", nullptr);
+   auto removed = client.request("echo", "", 1s).get();
+   ASSERT_FALSE(removed);
+   ASSERT_EQ(removed.error(), RequestError::UNKNOWN_METHOD);
+}
+
+TEST(Request, HandlerChangingHandlers)
+{
+   using namespace std::chrono_literals;
+   constexpr unsigned int PORT = 7353;
+   RequestServer server;
+   ASSERT_TRUE(server.listen(PORT));
+
+   // Handlers run without the handlers lock, so they can swap themselves out
+   server.handle("once", [&server](std::string_view) -> Result<std::string, RequestError> {
+      server.handle("once", nullptr);
+      return std::string("done");
+   });
+
+   RequestClient client(PORT);
+   auto first = client.request("once", "", 1s).get();
+   ASSERT_TRUE(first);
+   ASSERT_EQ(first.value(), "done");
+   auto second = client.request("once", "", 1s).get();
+   ASSERT_FALSE(second);
+   ASSERT_EQ(second.error(), RequestError::UNKNOWN_METHOD);
+}
+
+TEST(Request, Failures)
+{
+   using namespace std::chrono_literals;
+   constexpr unsigned int PORT = 7352;
+   RequestClient client(PORT);
+   auto unreachable = client.request("echo", "", 1s).get();
+   ASSERT_FALSE(unreachable);
+   ASSERT_EQ(unreachable.error(), RequestError::UNABLE_TO_CONNECT);
+
+   RequestServer server;
+   ASSERT_TRUE(server.listen(PORT));
+   server.handle("slow", [](const std::string_view payload) -> Result<std::string, RequestError> {
+      std::this_thread::sleep_for(200ms);
+      return std::string(payload);
+   });
+
+   // Timed out on the client, the late reply is then dropped
+   auto slow = client.request("slow", "", 50ms);
+   ASSERT_EQ(slow.wait_for(150ms), std::future_status::ready);
+   auto timedOut = slow.get();
+   ASSERT_FALSE(timedOut);
+   ASSERT_EQ(timedOut.error(), RequestError::TIMEOUT);
+   auto answered = client.request("slow", "late", 1s).get();
+   ASSERT_TRUE(answered);
+   ASSERT_EQ(answered.value(), "late");
+
+   // Requests still waiting when the server goes fail right away, the next ones connect again
+   auto answering = client.request("slow", "", 10s);
+   std::this_thread::sleep_for(50ms);
+   auto pending = client.request("slow", "", 10s);
+   server.close();
+   ASSERT_TRUE(answering.get());
+   ASSERT_EQ(pending.wait_for(1s), std::future_status::ready);
+   auto dropped = pending.get();
+   ASSERT_FALSE(dropped);
+   ASSERT_EQ(dropped.error(), RequestError::DISCONNECTED);
+
+   ASSERT_TRUE(server.listen(PORT));
+   server.handle("echo", [](const std::string_view payload) -> Result<std::string, RequestError> {
+      return std::string(payload);
+   });
+   auto reconnected = client.request("echo", "again", 1s).get();
+   ASSERT_TRUE(reconnected);
+   ASSERT_EQ(reconnected.value(), "again");
+}
+
+namespace {
+// Delivers frames only while up, recording them in the order they went out
+struct FlakySender
+{
+   std::mutex mutex;
+   bool up = false;
+   // Frames delivered before going down again, no limit when zero
+   std::size_t budget = 0;
+   std::vector<std::string> delivered;
+
+   bool send(const std::string_view frame)
+   {
+      std::lock_guard lock(mutex);
+      if (!up)
+      {
+         return false;
+      }
+
+      delivered.emplace_back(frame);
+      if (budget > 0 && --budget == 0)
+      {
+         up = false;
+      }
+      return true;
+   }
+
+   void setUp(const bool value, const std::size_t frames = 0)
+   {
+      std::lock_guard lock(mutex);
+      up = value;
+      budget = frames;
+   }
+
+   std::size_t size()
+   {
+      std::lock_guard lock(mutex);
+      return delivered.size();
+   }
+};
+
+void waitForDelivery(FlakySender& sender, const std::size_t frames)
+{
+   using namespace std::chrono_literals;
+   for (unsigned int i = 0; i < 500 && sender.size() < frames; i++)
+   {
+      std::this_thread::sleep_for(10ms);
+   }
+}
+} // namespace
+
+TEST(Outbox, RetriesInOrder)
+{
+   using namespace std::chrono_literals;
+   FlakySender sender;
+   Outbox outbox;
+   ASSERT_TRUE(outbox.open({.memory = 1 << 16, .backoff = 1ms, .maxBackoff = 10ms},
+                           [&sender](auto frame) { return sender.send(frame); }));
+
+   for (unsigned int i = 0; i < 100; i++)
+   {
+      ASSERT_TRUE(outbox.send("TOPIC#" + std::to_string(i)));
+      // Frames published after the outage ends must still wait for the ones queued before them
+      sender.setUp(i >= 50);
+   }
+
+   waitForDelivery(sender, 100);
+   ASSERT_EQ(sender.delivered.size(), 100);
+   for (unsigned int i = 0; i < 100; i++)
+   {
+      ASSERT_EQ(sender.delivered[i], "TOPIC#" + std::to_string(i));
+   }
+
+   const auto statistics = outbox.statistics();
+   ASSERT_EQ(statistics.memoryFrames, 0);
+   ASSERT_GT(statistics.retried, 0);
+   ASSERT_EQ(statistics.dropped, 0);
+}
+
+TEST(Outbox, DropsWhenFull)
+{
+   using namespace std::chrono_literals;
+   FlakySender sender;
+   Outbox outbox;
+   // Room for exactly ten frames of 4 bytes and their lengths
+   ASSERT_TRUE(outbox.open({.memory = 80, .backoff = 1h},
+                           [&sender](auto frame) { return sender.send(frame); }));
+
+   for (unsigned int i = 0; i < 15; i++)
+   {
+      auto sent = outbox.send("T#" + std::to_string(10 + i));
+      ASSERT_EQ(static_cast<bool>(sent), i < 10);
+   }
+
+   const auto statistics = outbox.statistics();
+   ASSERT_EQ(statistics.memoryFrames, 10);
+   ASSERT_EQ(statistics.dropped, 5);
+}
+
+TEST(Outbox, SpillsToDisk)
+{
+   using namespace std::chrono_literals;
+   const auto path = std::filesystem::temp_directory_path() / "SpillsToDisk.outbox";
+   FlakySender sender;
+   Outbox outbox;
+   ASSERT_TRUE(outbox.open(
+       {.memory = 1024, .disk = 1 << 16, .path = path, .backoff = 50ms, .maxBackoff = 50ms},
+       [&sender](auto frame) { return sender.send(frame); }));
+
+   constexpr unsigned int FRAMES = 1000;
+   for (unsigned int i = 0; i < FRAMES; i++)
+   {
+      ASSERT_TRUE(outbox.send("TOPIC#" + std::to_string(i)));
+   }
+   auto statistics = outbox.statistics();
+   ASSERT_GT(statistics.diskFrames, 0);
+   ASSERT_EQ(statistics.memoryFrames + statistics.diskFrames, FRAMES);
+
+   sender.setUp(true);
+   waitForDelivery(sender, FRAMES);
+   ASSERT_EQ(sender.delivered.size(), FRAMES);
+   for (unsigned int i = 0; i < FRAMES; i++)
+   {
+      ASSERT_EQ(sender.delivered[i], "TOPIC#" + std::to_string(i));
+   }
+
+   statistics = outbox.statistics();
+   ASSERT_EQ(statistics.diskFrames, 0);
+   ASSERT_EQ(statistics.dropped, 0);
+   ASSERT_EQ(std::filesystem::file_size(path), 0) << "Drained spill file was not emptied";
+
+   outbox.close();
+   std::filesystem::remove(path);
+}
+
+TEST(Outbox, SpillWrapsAround)
+{
+   using namespace std::chrono_literals;
+   const auto path = std::filesystem::temp_directory_path() / "SpillWrapsAround.outbox";
+   FlakySender sender;
+   Outbox outbox;
+   // Room for ten frames of 4 bytes and their lengths, plus a length that has to wrap around
+   ASSERT_TRUE(outbox.open({.disk = 84, .path = path, .backoff = 1ms, .maxBackoff = 1ms},
+                           [&sender](auto frame) { return sender.send(frame); }));
+
+   for (unsigned int i = 0; i < 10; i++)
+   {
+      ASSERT_TRUE(outbox.send("T#" + std::to_string(10 + i)));
+   }
+   ASSERT_FALSE(outbox.send("T#99")) << "Full spill file accepted a frame";
+
+   sender.setUp(true, 5);
+   for (unsigned int i = 0; i < 500 && outbox.statistics().diskFrames > 5; i++)
+   {
+      std::this_thread::sleep_for(10ms);
+   }
+   ASSERT_EQ(outbox.statistics().diskFrames, 5);
+
+   // The spill is not empty yet, the room of what was read back has to be reused anyway
+   for (unsigned int i = 0; i < 5; i++)
+   {
+      ASSERT_TRUE(outbox.send("T#" + std::to_string(20 + i))) << "Spill file did not wrap";
+   }
+
+   sender.setUp(true);
+   waitForDelivery(sender, 15);
+   ASSERT_EQ(sender.delivered.size(), 15);
+   for (unsigned int i = 0; i < 15; i++)
+   {
+      ASSERT_EQ(sender.delivered[i], "T#" + std::to_string(10 + i));
+   }
+
+   outbox.close();
+   std::filesystem::remove(path);
+}
+
+TEST(Outbox, SendsWhileRetrying)
+{
+   using namespace std::chrono_literals;
+   std::promise<void> release;
+   auto released = release.get_future().share();
+   std::atomic<unsigned int> attempts = 0;
+   FlakySender sender;
+   Outbox outbox;
+   ASSERT_TRUE(outbox.open({.memory = 1024, .backoff = 1ms, .maxBackoff = 1ms},
+                           [&](auto frame) {
+                              if (attempts++ > 0)
+                              {
+                                 // Retries are stuck on a slow transport until released
+                                 released.wait();
+                              }
+                              return sender.send(frame);
+                           }));
+
+   sender.setUp(false);
+   ASSERT_TRUE(outbox.send("T#1"));
+   for (unsigned int i = 0; i < 500 && attempts < 2; i++)
+   {
+      std::this_thread::sleep_for(10ms);
+   }
+
+   // Queued behind the frame being retried, without waiting for it
+   sender.setUp(true);
+   auto queued = std::async(std::launch::async, [&outbox]() { return outbox.send("T#2"); });
+   ASSERT_EQ(queued.wait_for(1s), std::future_status::ready) << "Sending waited for a retry";
+   ASSERT_TRUE(queued.get());
+
+   release.set_value();
+   waitForDelivery(sender, 2);
+   ASSERT_EQ(sender.delivered.size(), 2);
+   ASSERT_EQ(sender.delivered[0], "T#1");
+   ASSERT_EQ(sender.delivered[1], "T#2");
+}
+
+TEST(Frame, RoundTrip)
+{
+   FrameEncoder encoder;
+   FrameDecoder decoder;
+   const nlohmann::json payload = {{"temperature", 21.5}, {"sensor", "north"}};
+
+   auto encoded = encoder.encode("TEMPERATURE", payload, "1.0.0");
+   ASSERT_TRUE(encoded);
+   ASSERT_TRUE(decoder.decode(encoded.value(), "1.0.0"));
+   ASSERT_EQ(decoder.topic(), "TEMPERATURE");
+   ASSERT_EQ(decoder.payload()["version"], "1.0.0");
+   ASSERT_EQ(decoder.payload()["temperature"], 21.5);
+   ASSERT_EQ(decoder.payload()["sensor"], "north");
+
+   encoded = encoder.encode("EMPTY", nlohmann::json::object(), "1.0.0");
+   ASSERT_TRUE(encoded);
+   ASSERT_EQ(encoded.value(), "EMPTY#{\"version\":\"1.0.0\"}");
+
+   ASSERT_TRUE(decoder.decode(encoded.value(), "1.0.0"));
+   ASSERT_EQ(decoder.traceId(), 0);
+   encoded = encoder.encode("TRACED", payload, "1.0.0", 1ULL << 60);
+   ASSERT_TRUE(encoded);
+   ASSERT_TRUE(decoder.decode(encoded.value(), "1.0.0"));
+   ASSERT_EQ(decoder.traceId(), 1ULL << 60);
+
+   auto decoded = decoder.decode(encoded.value(), "2.0.0");
+   ASSERT_FALSE(decoded);
+   ASSERT_EQ(decoded.error(), FrameError::VERSION_MISMATCH);
+}
+
+TEST(Frame, InvalidFrames)
+{
+   FrameEncoder encoder;
+   FrameDecoder decoder;
+
+   ASSERT_EQ(encoder.encode("", {}, "1").error(), FrameError::INVALID_TOPIC);
+   ASSERT_EQ(encoder.encode("A#B", {}, "1").error(), FrameError::INVALID_TOPIC);
+   ASSERT_EQ(encoder.encode("A", nlohmann::json::array({1, 2}), "1").error(),
+             FrameError::INVALID_PAYLOAD);
+   ASSERT_EQ(encoder.encode("A", {{"version", "1"}}, "1").error(), FrameError::INVALID_PAYLOAD);
+
+   ASSERT_EQ(decoder.decode("#{}", "1").error(), FrameError::INVALID_TOPIC);
+   ASSERT_EQ(decoder.decode("A#", "1").error(), FrameError::INVALID_PAYLOAD);
+   ASSERT_EQ(decoder.decode("A#{", "1").error(), FrameError::INVALID_PAYLOAD);
+   ASSERT_EQ(decoder.decode("A#{}", "1").error(), FrameError::VERSION_MISMATCH);
+}
+
+TEST(Topic, RoundTrip)
+{
+   FrameEncoder encoder;
+   FrameDecoder decoder;
+   const TestTopic sent{"north \"01\"\n\u00e8", 2, {{1, 20.5, true}, {2, -0.25, false}}};
+
+   auto encoded = encoder.encode(sent, "1.0.0", 42);
+   ASSERT_TRUE(encoded);
+   TestTopic received;
+   ASSERT_TRUE(decoder.decode(encoded.value(), "1.0.0", received));
+   ASSERT_EQ(decoder.topic(), "TEST_TOPIC");
+   ASSERT_EQ(decoder.traceId(), 42);
+   ASSERT_EQ(received.sensor, sent.sensor);
+   ASSERT_EQ(received.count, 2);
+   ASSERT_EQ(received.samples.size(), 2);
+   ASSERT_EQ(received.samples[1].timestamp, 2);
+   ASSERT_EQ(received.samples[1].value, -0.25);
+   ASSERT_TRUE(received.samples[0].valid);
+
+   // Members it knows nothing about are skipped, escapes are resolved
+   const std::string frame = "TEST_TOPIC# { \"extra\": [1, {\"a\": null}], \"count\": 7.0, "
+                             "\"sensor\": \"\\u00e8\\ud83c\\udf31\", \"version\": \"1\" }";
+   ASSERT_TRUE(decoder.decode(frame, "1", received));
+   ASSERT_EQ(received.count, 7);
+   ASSERT_EQ(received.sensor, "\u00e8\U0001F331");
+}
+
+TEST(Topic, JsonCompatibility)
+{
+   FrameEncoder encoder;
+   FrameDecoder decoder;
+
+   // Typed frames are plain json frames to whoever subscribes without the type
+   const TestTopic sent{"north", 1, {{1, 20.5, true}}};
+   const std::string typed(encoder.encode(sent, "1.0.0").value());
+   ASSERT_TRUE(decoder.decode(typed, "1.0.0"));
+   ASSERT_EQ(decoder.topic(), "TEST_TOPIC");
+   ASSERT_EQ(decoder.payload()["sensor"], "north");
+   ASSERT_EQ(decoder.payload()["samples"][0]["value"], 20.5);
+
+   // And json frames decode into the type
+   const nlohmann::json payload = {{"sensor", "south"}, {"samples", {{{"timestamp", 3}}}}};
+   const std::string json(encoder.encode("TEST_TOPIC", payload, "1.0.0").value());
+   TestTopic received;
+   ASSERT_TRUE(decoder.decode(json, "1.0.0", received));
+   ASSERT_EQ(received.sensor, "south");
+   ASSERT_EQ(received.count, 0);
+   ASSERT_EQ(received.samples.size(), 1);
+   ASSERT_EQ(received.samples[0].timestamp, 3);
+}
+
+TEST(Topic, InvalidFrames)
+{
+   FrameDecoder decoder;
+   TestTopic value;
+
+   ASSERT_EQ(decoder.decode("OTHER#{\"version\":\"1\"}", "1", value).error(),
+             FrameError::INVALID_TOPIC);
+   ASSERT_EQ(decoder.decode("TEST_TOPIC#{\"version\":\"1\"", "1", value).error(),
+             FrameError::INVALID_PAYLOAD);
+   ASSERT_EQ(decoder.decode("TEST_TOPIC#{\"count\":-1,\"version\":\"1\"}", "1", value).error(),
+             FrameError::INVALID_PAYLOAD);
+   ASSERT_EQ(decoder.decode("TEST_TOPIC#{\"count\":1.5,\"version\":\"1\"}", "1", value).error(),
+             FrameError::INVALID_PAYLOAD);
+   ASSERT_EQ(decoder.decode("TEST_TOPIC#{\"sensor\":1,\"version\":\"1\"}", "1", value).error(),
+             FrameError::INVALID_PAYLOAD);
+   ASSERT_EQ(decoder.decode("TEST_TOPIC#{\"version\":\"1\"} 1", "1", value).error(),
+             FrameError::INVALID_PAYLOAD);
+   ASSERT_EQ(decoder.decode("TEST_TOPIC#{}", "1", value).error(), FrameError::VERSION_MISMATCH);
+
+   const std::string deep = "TEST_TOPIC#{\"extra\":" + std::string(TopicReader::MAX_DEPTH, '[') +
+                            std::string(TopicReader::MAX_DEPTH, ']') + ",\"version\":\"1\"}";
+   ASSERT_EQ(decoder.decode(deep, "1", value).error(), FrameError::INVALID_PAYLOAD);
+}
+
+TEST(FrameCompressor, RoundTrip)
+{
+   FrameEncoder encoder;
+   FrameDecoder decoder;
+   FrameCompressor compressor;
+   nlohmann::json samples = nlohmann::json::array();
+   for (int i = 0; i < 100; i++)
+   {
+      samples.push_back({{"timestamp", i}, {"temperature", 20 + i % 5}});
+   }
+   const std::string frame(encoder.encode("BATCH", {{"samples", samples}}, "1.0.0").value());
+
+   for (const auto algorithm : {FrameCompressor::Algorithm::LZ4, FrameCompressor::Algorithm::ZSTD})
+   {
+      const std::string compressed(compressor.compress(frame, {algorithm, 0, 0}));
+      ASSERT_TRUE(FrameCompressor::compressed(compressed));
+      ASSERT_LT(compressed.size(), frame.size());
+      ASSERT_TRUE(compressed.starts_with("BATCH#"));
+
+      auto decompressed = compressor.decompress(compressed);
+      ASSERT_TRUE(decompressed);
+      ASSERT_EQ(decompressed.value(), frame);
+
+      // Subscribers never notice
+      ASSERT_TRUE(decoder.decode(compressed, "1.0.0"));
+      ASSERT_EQ(decoder.topic(), "BATCH");
+      ASSERT_EQ(decoder.payload()["samples"], samples);
+   }
+}
+
+TEST(FrameCompressor, SkipsWhatDoesNotPayOff)
+{
+   FrameEncoder encoder;
+   FrameCompressor compressor;
+   const std::string frame(encoder.encode("SMALL", {{"temperature", 21.5}}, "1.0.0").value());
+
+   ASSERT_EQ(compressor.compress(frame, {}), frame);
+   ASSERT_EQ(compressor.compress(frame, {FrameCompressor::Algorithm::ZSTD}), frame);
+
+   // Below the threshold or too short to shrink it goes as it is
+   ASSERT_EQ(compressor.compress(frame, {FrameCompressor::Algorithm::LZ4, 0, 0}), frame);
+   ASSERT_FALSE(FrameCompressor::compressed(frame));
+   ASSERT_EQ(compressor.decompress(frame).value(), frame);
+
+   ASSERT_EQ(FrameCompressor::algorithm("zstd"), FrameCompressor::Algorithm::ZSTD);
+   ASSERT_FALSE(FrameCompressor::algorithm("gzip").has_value());
+}
+
+TEST(FrameCompressor, InvalidFrames)
+{
+   FrameEncoder encoder;
+   FrameDecoder decoder;
+   FrameCompressor compressor;
+   const std::string frame(
+       encoder.encode("STATE", {{"sensor", std::string(4096, 'a')}}, "1.0.0").value());
+
+   for (const auto algorithm : {FrameCompressor::Algorithm::LZ4, FrameCompressor::Algorithm::ZSTD})
+   {
+      const std::string compressed(compressor.compress(frame, {algorithm, 0, 0}));
+      ASSERT_TRUE(FrameCompressor::compressed(compressed));
+
+      ASSERT_EQ(decoder.decode(compressed.substr(0, 8), "1.0.0").error(),
+                FrameError::INVALID_PAYLOAD);
+      ASSERT_EQ(decoder.decode(compressed.substr(0, compressed.size() - 2), "1.0.0").error(),
+                FrameError::INVALID_PAYLOAD);
+
+      // Claiming a size other than the one it decompresses to
+      auto resized = compressed;
+      resized[8]++;
+      ASSERT_EQ(decoder.decode(resized, "1.0.0").error(), FrameError::INVALID_PAYLOAD);
+
+      auto oversized = compressed;
+      oversized[10] = '\x7f';
+      ASSERT_EQ(decoder.decode(oversized, "1.0.0").error(), FrameError::INVALID_PAYLOAD);
+   }
+}
+
+TEST(TimerWheel, OneShot)
+{
+   using namespace std::chrono_literals;
+   const auto origin = TimerWheel::Clock::now();
+   TimerWheel wheel(1ms, origin);
+
+   unsigned int fired = 0;
+   const auto id = wheel.schedule(origin + 5ms, [&fired]() { fired++; });
+   ASSERT_EQ(wheel.size(), 1);
+   ASSERT_EQ(wheel.nextExpiry(), origin + 5ms);
+
+   ASSERT_EQ(wheel.advance(origin + 4ms), 0);
+   ASSERT_EQ(wheel.advance(origin + 5ms), 1);
+   ASSERT_EQ(fired, 1);
+   ASSERT_TRUE(wheel.empty());
+   ASSERT_FALSE(wheel.nextExpiry().has_value());
+   ASSERT_FALSE(wheel.cancel(id)) << "Cancelled a timer that already fired";
+
+   // Never early: a time between two ticks waits for the following one
+   wheel.schedule(origin + 10ms + 1us, [&fired]() { fired++; });
+   ASSERT_EQ(wheel.advance(origin + 10ms), 0);
+   ASSERT_EQ(wheel.advance(origin + 11ms), 1);
+
+   // Times already gone fire on the next tick
+   wheel.schedule(origin, [&fired]() { fired++; });
+   ASSERT_EQ(wheel.advance(origin + 11ms), 0);
+   ASSERT_EQ(wheel.advance(origin + 12ms), 1);
+   ASSERT_EQ(fired, 3);
+}
+
+TEST(TimerWheel, Periodic)
+{
+   using namespace std::chrono_literals;
+   const auto origin = TimerWheel::Clock::now();
+   TimerWheel wheel(1ms, origin);
+
+   std::vector<TimerWheel::Clock::duration> fired;
+   auto now = origin;
+   wheel.schedule(origin + 10ms, [&]() { fired.push_back(now - origin); }, 10ms);
+   for (; now <= origin + 100ms; now += 1ms)
+   {
+      wheel.advance(now);
+   }
+
+   ASSERT_EQ(fired.size(), 10);
+   for (std::size_t i = 0; i < fired.size(); i++)
+   {
+      ASSERT_EQ(fired[i], 10ms * (i + 1));
+   }
+
+   // Periods missed while not advancing are skipped
+   fired.clear();
+   now = origin + 1000ms;
+   ASSERT_EQ(wheel.advance(now), 1);
+   now = origin + 1009ms;
+   ASSERT_EQ(wheel.advance(now), 0);
+   now = origin + 1010ms;
+   ASSERT_EQ(wheel.advance(now), 1);
+   ASSERT_EQ(wheel.size(), 1);
+}
+
+TEST(TimerWheel, Cancel)
+{
+   using namespace std::chrono_literals;
+   const auto origin = TimerWheel::Clock::now();
+   TimerWheel wheel(1ms, origin);
+
+   constexpr unsigned int TIMERS = 10000;
+   std::mt19937 rng(42);
+   std::uniform_int_distribution<unsigned int> delay(0, 100000);
+   std::vector<TimerWheel::TimerId> ids;
+   std::vector<bool> fired(TIMERS, false);
+   for (unsigned int timer = 0; timer < TIMERS; timer++)
+   {
+      ids.push_back(wheel.schedule(origin + std::chrono::milliseconds(delay(rng)),
+                                   [&fired, timer]() { fired[timer] = true; }));
+   }
+
+   for (unsigned int timer = 0; timer < TIMERS; timer += 2)
+   {
+      ASSERT_TRUE(wheel.cancel(ids[timer]));
+      ASSERT_FALSE(wheel.cancel(ids[timer])) << "Timer cancelled twice";
+   }
+   ASSERT_EQ(wheel.size(), TIMERS / 2);
+
+   ASSERT_EQ(wheel.advance(origin + 100s), TIMERS / 2);
+   for (unsigned int timer = 0; timer < TIMERS; timer++)
+   {
+      ASSERT_EQ(fired[timer], timer % 2 == 1) << "Wrong outcome for timer " << timer;
+   }
+
+   // Released nodes are reused, the identifiers of the timers they held staying dead
+   const auto reused = wheel.schedule(origin + 200s, []() {});
+   for (const auto id : ids)
+   {
+      ASSERT_NE(id, reused);
+   }
+
+   // A periodic timer cancelling itself from its callback
+   unsigned int runs = 0;
+   TimerWheel::TimerId self = 0;
+   self = wheel.schedule(
+       origin + 101s,
+       [&]() {
+          if (++runs == 3)
+          {
+             ASSERT_TRUE(wheel.cancel(self));
+          }
+       },
+       1ms);
+   for (auto now = origin + 101s; now < origin + 102s; now += 1ms)
+   {
+      wheel.advance(now);
+   }
+   ASSERT_EQ(runs, 3);
+   ASSERT_EQ(wheel.size(), 1);
+}
+
+TEST(TimerWheel, LongDelays)
+{
+   using namespace std::chrono_literals;
+   const auto origin = TimerWheel::Clock::now();
+   TimerWheel wheel(1ms, origin);
+
+   // Delays around the turns of every wheel and past the last one
+   const std::vector<std::uint64_t> delays{1,      63,     64,       65,       4095,     4096,
+                                           4097,   262143, 262144,   262145,   16777215, 16777216,
+                                           16777217, 40000000};
+   std::vector<TimerWheel::Clock::time_point> fired(delays.size());
+   auto now = origin;
+   for (std::size_t timer = 0; timer < delays.size(); timer++)
+   {
+      wheel.schedule(origin + std::chrono::milliseconds(delays[timer]),
+                     [&fired, &now, timer]() { fired[timer] = now; });
+   }
+
+   // Advancing only as far as the wheel asks to, so that every timer fires right on its tick
+   while (auto next = wheel.nextExpiry())
+   {
+      ASSERT_GT(next.value(), now) << "The wheel is not moving forward";
+      now = next.value();
+      wheel.advance(now);
+   }
+
+   for (std::size_t timer = 0; timer < delays.size(); timer++)
+   {
+      ASSERT_EQ(fired[timer], origin + std::chrono::milliseconds(delays[timer]))
+          << "Timer " << delays[timer] << "ms fired at the wrong time";
+   }
+}
+
+TEST(TimerWheel, ScheduleFromCallbacks)
+{
+   using namespace std::chrono_literals;
+   const auto origin = TimerWheel::Clock::now();
+   TimerWheel wheel(1ms, origin);
+
+   // Rescheduling a whole turn of the lowest wheel ahead lands in the slot being expired
+   unsigned int fired = 0;
+   std::function<void()> reschedule = [&]() {
+      if (++fired < 3)
+      {
+         wheel.schedule(origin + 64ms * (fired + 1), reschedule);
+      }
+   };
+   wheel.schedule(origin + 64ms, reschedule);
+
+   ASSERT_EQ(wheel.advance(origin + 64ms), 1);
+   ASSERT_EQ(wheel.advance(origin + 127ms), 0);
+   ASSERT_EQ(wheel.advance(origin + 128ms), 1);
+   ASSERT_EQ(wheel.advance(origin + 1s), 1);
+   ASSERT_EQ(fired, 3);
+   ASSERT_TRUE(wheel.empty());
+}
+
+namespace {
+std::size_t currentStackSize()
+{
+   pthread_attr_t attributes;
+   std::size_t size = 0;
+   if (pthread_getattr_np(pthread_self(), &attributes) == 0)
+   {
+      pthread_attr_getstacksize(&attributes, &size);
+      pthread_attr_destroy(&attributes);
+   }
+   return size;
+}
+} // namespace
+
+TEST(Thread, StackSize)
+{
+   constexpr std::size_t stackSize = 256 * 1024;
+
+   std::size_t defaultSize = 0;
+   std::thread([&defaultSize]() { defaultSize = currentStackSize(); }).join();
+   ASSERT_NE(defaultSize, stackSize) << "Default stack size is already the one tested";
+
+   Thread::setStackSize(stackSize);
+   std::size_t size = 0;
+   Thread([&size]() { size = currentStackSize(); }).join();
+   EXPECT_EQ(size, stackSize) << "Stack size was not applied to the thread";
+
+   // Threads started by anyone else keep the default
+   std::size_t otherSize = 0;
+   std::thread([&otherSize]() { otherSize = currentStackSize(); }).join();
+   EXPECT_EQ(otherSize, defaultSize) << "Stack size leaked to the rest of the process";
+
+   Thread::setStackSize(0);
+   Thread([&size]() { size = currentStackSize(); }).join();
+   EXPECT_EQ(size, defaultSize) << "Default stack size was not restored";
+}
+
+TEST(Thread, Move)
+{
+   std::atomic_bool ran = false;
+   Thread thread([&ran]() { ran = true; });
+   Thread moved = std::move(thread);
+   ASSERT_TRUE(moved.joinable()) << "Thread was lost in the move";
+   moved.join();
+   EXPECT_TRUE(ran) << "Thread did not run";
+   EXPECT_FALSE(moved.joinable()) << "Joined thread is still joinable";
+}
+
+class StackComponent : public Component
+{
+public:
+   std::atomic_size_t mStackSize = 0;
+
+private:
+   inline bool onStarted() override
+   {
+      return true;
+   }
+
+   inline void onStopped() override
+   {
+   }
+
+   inline void mainLoop() override
+   {
+      mStackSize = currentStackSize();
+      stop();
+   }
+};
+
+TEST(Component, LowMemoryStack)
+{
+   std::size_t defaultSize = 0;
+   std::thread([&defaultSize]() { defaultSize = currentStackSize(); }).join();
+
+   StackComponent c;
+   c.setLogLevel(Logger::Level::off);
+   c.setLowMemory(true);
+   ASSERT_TRUE(c.startBlocking()) << "Unable to start component";
+   EXPECT_GT(c.mStackSize, 0) << "Stack size of the component thread is unknown";
+   EXPECT_LT(c.mStackSize, defaultSize) << "Component thread kept the default stack size";
+
+   // Started by someone else while the profile is on, it keeps the default
+   std::size_t otherSize = 0;
+   std::thread([&otherSize]() { otherSize = currentStackSize(); }).join();
+   EXPECT_EQ(otherSize, defaultSize) << "Low memory profile leaked to the rest of the process";
+}
@@ -2,11 +2,12 @@
 #define CONFIGURATION_HPP
 
 #include <filesystem>
-#include <sstream>
+#include <string>
+#include <vector>
 
 #include "libconfig.h++"
 
-#include "Error.hpp"
+#include "Result.hpp"
 
 class Configuration
 {
@@ -32,15 +33,15 @@ public:
       return mConfiguration.exists(path);
    }
 
-   [[nodiscard]] std::optional<Error<ConfigurationError>>
+   [[nodiscard]] Result<void, ConfigurationError>
    loadFromFile(const std::filesystem::path& filePath) noexcept;
 
-   [[nodiscard]] std::optional<Error<ConfigurationError>>
+   [[nodiscard]] Result<void, ConfigurationError>
    writeToFile(const std::filesystem::path& filePath) noexcept;
 
    template <class T>[[nodiscard]] inline auto settingValue(const std::string& path) const noexcept
    {
-      static_assert(std::is_integral_v<T> || std::is_same_v<T, std::string>,
+      static_assert(std::is_arithmetic_v<T> || std::is_same_v<T, std::string>,
                     "Invalid template type for retrieving a setting value");
 
       T result;
@@ -51,10 +52,20 @@ public:
       return std::optional<T>{result};
    }
 
+   // Names of the settings of the group at path, none when there is no such group
+   [[nodiscard]] std::vector<std::string> settingNames(const std::string& path) const;
+
+   // Frees the parsed tree, every setting being gone afterwards as if nothing was ever loaded
+   inline void release()
+   {
+      mConfiguration.clear();
+   }
+
    template <class T>
-   [[nodiscard]] inline auto setValue(const std::string& path, const T& value) noexcept
+   [[nodiscard]] inline Result<void, ConfigurationError> setValue(const std::string& path,
+                                                                 const T& value) noexcept
    {
-      static_assert(std::is_integral_v<T> || std::is_same_v<T, std::string>,
+      static_assert(std::is_arithmetic_v<T> || std::is_same_v<T, std::string>,
                     "Invalid template type for retrieving a setting value");
       try
       {
@@ -63,16 +74,16 @@ public:
       }
       catch (const libconfig::SettingNotFoundException& sex)
       {
-         return make_optional_error<ConfigurationError>(ConfigurationError::SETTING_NOT_FOUND,
-                                                        "Setting not found at " + path);
+         return Error(ConfigurationError::SETTING_NOT_FOUND,
+                      ErrorDetail::compose("Setting not found at ", path));
       }
       catch (const libconfig::SettingTypeException& sex)
       {
-         return make_optional_error<ConfigurationError>(ConfigurationError::SETTING_TYPE_MISMATCH,
-                                                        "Setting type mismatch at " + path);
+         return Error(ConfigurationError::SETTING_TYPE_MISMATCH,
+                      ErrorDetail::compose("Setting type mismatch at ", path));
       }
 
-      return make_optional_error<ConfigurationError>();
+      return {};
    }
 
    ~Configuration() = default;
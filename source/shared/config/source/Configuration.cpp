@@ -1,6 +1,6 @@
 #include "Configuration.hpp"
 
-std::optional<Error<Configuration::ConfigurationError>>
+Result<void, Configuration::ConfigurationError>
 Configuration::loadFromFile(const std::filesystem::path& filePath) noexcept
 {
    try
@@ -11,26 +11,21 @@ Configuration::loadFromFile(const std::filesystem::path& filePath) noexcept
 
    catch (const libconfig::FileIOException& fioex)
    {
-      std::ostringstream errorText;
-      errorText << "Unable to load file at " << filePath << " (" << fioex.what() << ")";
-
-      return make_optional_error<ConfigurationError>(ConfigurationError::UNABLE_TO_LOAD_FILE,
-                                                     errorText.str());
+      return Error(ConfigurationError::UNABLE_TO_LOAD_FILE,
+                   ErrorDetail::compose("Unable to load file at ", filePath.native(), " (",
+                                        fioex.what(), ")"));
    }
    catch (const libconfig::ParseException& pex)
    {
-      std::ostringstream errorText;
-      errorText << "Unable to parse file at " << filePath << "(Line: " << pex.getLine()
-                << " Error: " << pex.getError() << ")";
-
-      return make_optional_error<ConfigurationError>(ConfigurationError::UNABLE_TO_PARSE_FILE,
-                                                     errorText.str());
+      return Error(ConfigurationError::UNABLE_TO_PARSE_FILE,
+                   ErrorDetail::compose("Unable to parse file at ", filePath.native(),
+                                        "(Line: ", pex.getLine(), " Error: ", pex.getError(), ")"));
    }
 
-   return make_optional_error<ConfigurationError>();
+   return {};
 }
 
-std::optional<Error<Configuration::ConfigurationError>>
+Result<void, Configuration::ConfigurationError>
 Configuration::writeToFile(const std::filesystem::path& filePath) noexcept
 {
    try
@@ -40,12 +35,31 @@ Configuration::writeToFile(const std::filesystem::path& filePath) noexcept
 
    catch (const libconfig::FileIOException& fioex)
    {
-      std::ostringstream errorText;
-      errorText << "Unable to write file at " << filePath << " (" << fioex.what() << ")";
+      return Error(ConfigurationError::UNABLE_TO_WRITE_FILE,
+                   ErrorDetail::compose("Unable to write file at ", filePath.native(), " (",
+                                        fioex.what(), ")"));
+   }
+
+   return {};
+}
+
+std::vector<std::string> Configuration::settingNames(const std::string& path) const
+{
+   std::vector<std::string> names;
+   if (!mConfiguration.exists(path))
+   {
+      return names;
+   }
 
-      return make_optional_error<ConfigurationError>(ConfigurationError::UNABLE_TO_WRITE_FILE,
-                                                     errorText.str());
+   const auto& group = mConfiguration.lookup(path);
+   if (!group.isGroup())
+   {
+      return names;
    }
 
-   return make_optional_error<ConfigurationError>();
+   for (int index = 0; index < group.getLength(); index++)
+   {
+      names.emplace_back(group[index].getName());
+   }
+   return names;
 }
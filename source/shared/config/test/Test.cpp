@@ -8,8 +8,8 @@ TEST(Configuration, MissingFile)
 {
    Configuration cfg;
    auto loadResult = cfg.loadFromFile("/tmp/missing_conf.cfg");
-   ASSERT_TRUE(loadResult.has_value()) << "No error thrown when the configuration file is missing";
-   ASSERT_EQ(loadResult.value(), Configuration::ConfigurationError::UNABLE_TO_LOAD_FILE)
+   ASSERT_TRUE(loadResult.hasError()) << "No error thrown when the configuration file is missing";
+   ASSERT_EQ(loadResult.error(), Configuration::ConfigurationError::UNABLE_TO_LOAD_FILE)
        << "Erroneous error reported for a missing configuration file";
 }
 
@@ -24,9 +24,9 @@ TEST(Configuration, UnparsableFile)
 
    Configuration cfg;
    auto loadResult = cfg.loadFromFile(filePath);
-   ASSERT_TRUE(loadResult.has_value())
+   ASSERT_TRUE(loadResult.hasError())
        << "No error thrown when the configuration file is unparsable";
-   ASSERT_EQ(loadResult.value(), Configuration::ConfigurationError::UNABLE_TO_PARSE_FILE)
+   ASSERT_EQ(loadResult.error(), Configuration::ConfigurationError::UNABLE_TO_PARSE_FILE)
        << "Erroneous error reported for an unparsable file";
 }
 
@@ -43,7 +43,7 @@ TEST(Configuration, ReadFromFile)
 
    Configuration cfg;
    auto loadResult = cfg.loadFromFile(filePath);
-   ASSERT_FALSE(loadResult.has_value()) << "Unable to read test file from " << filePath;
+   ASSERT_FALSE(loadResult.hasError()) << "Unable to read test file from " << filePath;
 
    auto confValue = cfg.settingValue<std::string>(field);
 
@@ -51,6 +51,44 @@ TEST(Configuration, ReadFromFile)
    ASSERT_EQ(confValue.value(), value);
 }
 
+TEST(Configuration, Release)
+{
+   const std::string filePath = "/tmp/grow_config_test.cfg";
+   const std::string field = "Game";
+
+   std::ofstream stream(filePath);
+   stream << field << " = \"Metal Gear Solid\"";
+   stream.close();
+   ASSERT_TRUE(stream) << "Unable to write test file to " << filePath;
+
+   Configuration cfg;
+   auto loadResult = cfg.loadFromFile(filePath);
+   ASSERT_FALSE(loadResult.hasError()) << "Unable to read test file from " << filePath;
+   ASSERT_TRUE(cfg.contains(field));
+
+   cfg.release();
+   EXPECT_FALSE(cfg.contains(field)) << "Setting still available after releasing the tree";
+   EXPECT_FALSE(cfg.settingValue<std::string>(field).has_value());
+}
+
+TEST(Configuration, SettingNames)
+{
+   const std::string filePath = "/tmp/grow_config_test.cfg";
+
+   std::ofstream stream(filePath);
+   stream << "Responder = { Temperature = 7003; Storage = 7004; };\nGame = \"Metal Gear Solid\";";
+   stream.close();
+   ASSERT_TRUE(stream) << "Unable to write test file to " << filePath;
+
+   Configuration cfg;
+   auto loadResult = cfg.loadFromFile(filePath);
+   ASSERT_FALSE(loadResult.hasError()) << "Unable to read test file from " << filePath;
+
+   ASSERT_EQ(cfg.settingNames("Responder"), std::vector<std::string>({"Temperature", "Storage"}));
+   EXPECT_TRUE(cfg.settingNames("Game").empty()) << "A plain setting has no settings of its own";
+   EXPECT_TRUE(cfg.settingNames("Missing").empty());
+}
+
 TEST(Configuration, SetValue)
 {
    const std::string filePath = "/tmp/grow_config_test.cfg";
@@ -65,9 +103,9 @@ TEST(Configuration, SetValue)
 
    Configuration cfg;
    auto loadResult = cfg.loadFromFile(filePath);
-   ASSERT_FALSE(loadResult.has_value()) << "Unable to read test file from " << filePath;
+   ASSERT_FALSE(loadResult.hasError()) << "Unable to read test file from " << filePath;
 
-   ASSERT_FALSE(cfg.setValue(field, newValue).has_value())
+   ASSERT_FALSE(cfg.setValue(field, newValue).hasError())
        << "Setting value in configuration failed";
    ASSERT_EQ(cfg.settingValue<std::string>(field), newValue)
        << "New value has not been set correctly";
@@ -87,14 +125,35 @@ TEST(Configuration, WriteToFile)
 
    Configuration cfg;
    auto loadResult = cfg.loadFromFile(filePath);
-   ASSERT_FALSE(loadResult.has_value()) << "Unable to read test file from " << filePath;
+   ASSERT_FALSE(loadResult.hasError()) << "Unable to read test file from " << filePath;
 
-   ASSERT_FALSE(cfg.setValue(field, newValue).has_value())
+   ASSERT_FALSE(cfg.setValue(field, newValue).hasError())
        << "Setting value in configuration failed";
 
-   ASSERT_FALSE(cfg.writeToFile(filePath).has_value())
+   ASSERT_FALSE(cfg.writeToFile(filePath).hasError())
        << "Unable to write new configuration to file " << filePath;
-   ASSERT_FALSE(cfg.loadFromFile(filePath).has_value()) << "Unable to reload from " << filePath;
+   ASSERT_FALSE(cfg.loadFromFile(filePath).hasError()) << "Unable to reload from " << filePath;
    ASSERT_EQ(cfg.settingValue<std::string>(field), newValue)
        << "New configuration has not been wrote correctly";
 }
+
+TEST(Configuration, ReadFloatingPoint)
+{
+   const std::string filePath = "/tmp/grow_config_test.cfg";
+   const std::string field = "Threshold";
+   const double value = 28.5;
+
+   std::ofstream stream(filePath);
+   stream << field << " = " << value << ";";
+   stream.close();
+   ASSERT_TRUE(stream) << "Unable to write test file to " << filePath;
+
+   Configuration cfg;
+   auto loadResult = cfg.loadFromFile(filePath);
+   ASSERT_FALSE(loadResult.hasError()) << "Unable to read test file from " << filePath;
+
+   auto confValue = cfg.settingValue<float>(field);
+
+   ASSERT_TRUE(confValue.has_value()) << "Unable to retrieve configuration value";
+   ASSERT_FLOAT_EQ(confValue.value(), value);
+}
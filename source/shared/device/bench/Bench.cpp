@@ -0,0 +1,84 @@
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "SimulatedFleet.hpp"
+#include "SimulatedThermometer.hpp"
+
+// One virtual call per reading, as the unbuffered path does
+static void BM_SingleSample(benchmark::State& state)
+{
+   SimulatedThermometer thermometer;
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(thermometer.temperature());
+   }
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SingleSample);
+
+// Draining a simulated FIFO acquiring at state.range(0) Hz into batches of state.range(1) samples
+static void BM_BatchSamples(benchmark::State& state)
+{
+   SimulatedThermometer thermometer(static_cast<unsigned int>(state.range(0)));
+   std::vector<Thermometer::TemperatureSample> samples(static_cast<std::size_t>(state.range(1)));
+
+   std::size_t drained = 0;
+   for (auto _ : state)
+   {
+      drained += thermometer.temperatures(samples);
+      benchmark::DoNotOptimize(samples.data());
+   }
+   state.SetItemsProcessed(static_cast<int64_t>(drained));
+}
+BENCHMARK(BM_BatchSamples)
+    ->ArgsProduct({{1000, 100000, 10000000}, {16, 256}})
+    ->ArgNames({"rate", "batch"});
+
+// Round trip of a read through the device thread, with state.range(0) milliseconds of latency
+static void BM_AsyncRead(benchmark::State& state)
+{
+   SimulatedThermometer thermometer;
+   thermometer.setLatency(std::chrono::milliseconds(state.range(0)));
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(thermometer.readTemperature(std::chrono::seconds(1)).get());
+   }
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AsyncRead)->Arg(0)->Arg(1)->UseRealTime();
+
+// Advancing state.range(0) independent SimulatedThermometer instances by one reading
+static void BM_ThermometerFleet(benchmark::State& state)
+{
+   std::vector<std::unique_ptr<SimulatedThermometer>> fleet;
+   for (int64_t i = 0; i < state.range(0); i++)
+   {
+      fleet.push_back(std::make_unique<SimulatedThermometer>());
+   }
+
+   for (auto _ : state)
+   {
+      for (auto& thermometer : fleet)
+      {
+         benchmark::DoNotOptimize(thermometer->temperature());
+      }
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ThermometerFleet)->Arg(1000)->Arg(10000);
+
+// Advancing a SimulatedFleet of state.range(0) thermometers by one reading
+static void BM_SimulatedFleet(benchmark::State& state)
+{
+   constexpr std::uint32_t seed = 42;
+   SimulatedFleet fleet(static_cast<std::size_t>(state.range(0)), seed);
+   for (auto _ : state)
+   {
+      fleet.step();
+      benchmark::DoNotOptimize(fleet.temperatures().data());
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SimulatedFleet)->Arg(1000)->Arg(10000)->Arg(100000);
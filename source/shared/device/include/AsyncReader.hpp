@@ -0,0 +1,112 @@
+#ifndef ASYNCREADER_HPP
+#define ASYNCREADER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Result.hpp"
+
+enum class DeviceError
+{
+   READ_FAILED,
+   TIMEOUT,
+   BUSY,
+   CANCELLED
+};
+
+// Runs blocking device reads on a dedicated thread, one at a time, handing the outcome back through
+// a future. A watchdog thread completes the future with a TIMEOUT error once the read deadline
+// passes, the device stays busy until the blocked read actually returns
+class AsyncReader final
+{
+public:
+   using Clock = std::chrono::steady_clock;
+   template <class T> using Read = std::future<Result<T, DeviceError>>;
+
+   AsyncReader();
+   AsyncReader(const AsyncReader& reader) = delete;
+   AsyncReader(const AsyncReader&& reader) = delete;
+   auto operator=(const AsyncReader& reader) = delete;
+   auto operator=(const AsyncReader&& reader) = delete;
+
+   // Job is invoked on the reader thread and must return a Result<T, DeviceError>. If another read
+   // is still in flight the returned future is immediately ready with a BUSY error
+   template <class T, class Job>
+   [[nodiscard]] inline Read<T> start(Job&& job, const std::chrono::milliseconds& timeout)
+   {
+      auto settlement = std::make_shared<Settlement<T>>();
+      auto read = settlement->future();
+
+      // The device is released before the read completes, so that the caller can start the next one
+      // as soon as it gets this one
+      auto run = [this, settlement, job = std::forward<Job>(job)]() mutable {
+         auto result = job();
+         release();
+         settlement->settle(std::move(result));
+      };
+      auto expire = [settlement](const Error<DeviceError>& error) { settlement->settle(error); };
+
+      if (!submit(std::move(run), std::move(expire), timeout))
+      {
+         settlement->settle(
+             Error(DeviceError::BUSY, "A read is already in progress on this device"));
+      }
+
+      return read;
+   }
+
+   // Cancels a read that did not start yet and waits for the one in progress, if any
+   void stop() noexcept;
+
+   ~AsyncReader();
+
+private:
+   // Completes a read exactly once, whoever between the reader and the watchdog comes first
+   template <class T> class Settlement
+   {
+   public:
+      [[nodiscard]] inline Read<T> future()
+      {
+         return mPromise.get_future();
+      }
+
+      inline void settle(Result<T, DeviceError>&& result)
+      {
+         if (!mSettled.test_and_set())
+         {
+            mPromise.set_value(std::move(result));
+         }
+      }
+
+   private:
+      std::promise<Result<T, DeviceError>> mPromise;
+      std::atomic_flag mSettled = ATOMIC_FLAG_INIT;
+   };
+
+   using Expiration = std::function<void(const Error<DeviceError>&)>;
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::function<void()> mRun;
+   Expiration mExpire;
+   Clock::time_point mDeadline;
+   unsigned long mGeneration = 0;
+   bool mBusy = false;
+   bool mStopping = false;
+   std::thread mWorker;
+   std::thread mWatchdog;
+
+   [[nodiscard]] bool submit(std::function<void()>&& run, Expiration&& expire,
+                             const std::chrono::milliseconds& timeout);
+   void release();
+   void work();
+   void watch();
+};
+
+#endif // ASYNCREADER_HPP
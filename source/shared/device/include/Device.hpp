@@ -1,11 +1,17 @@
 #ifndef DEVICE_HPP
 #define DEVICE_HPP
 
+#include <chrono>
+#include <memory>
 #include <string>
 
+#include "AsyncReader.hpp"
+
 class Device
 {
 public:
+   using Clock = std::chrono::system_clock;
+
    Device() = default;
    Device(const Device& device) = delete;
    Device(const Device&& device) = delete;
@@ -14,7 +20,45 @@ public:
 
    [[nodiscard]] virtual std::string name() const noexcept = 0;
 
-   virtual ~Device() = default;
+   virtual inline ~Device()
+   {
+      stopReads();
+   }
+
+protected:
+   // Starts a blocking read on the device thread (created on first use) without blocking the
+   // caller. Reads must be started from a single thread
+   template <class T, class Job>
+   [[nodiscard]] inline AsyncReader::Read<T> startRead(Job&& job,
+                                                       const std::chrono::milliseconds& timeout)
+   {
+      if (!mReader)
+      {
+         mReader = std::make_unique<AsyncReader>();
+      }
+
+      return mReader->template start<T>(std::forward<Job>(job), timeout);
+   }
+
+   // Devices whose reads use their own state must call this from their destructor, so that no read
+   // outlives it
+   inline void stopReads() noexcept
+   {
+      if (mReader)
+      {
+         mReader->stop();
+      }
+   }
+
+private:
+   std::unique_ptr<AsyncReader> mReader;
+};
+
+// A single reading together with the time the device acquired it
+template <class T> struct Sample
+{
+   Device::Clock::time_point timestamp;
+   T value;
 };
 
 #endif // DEVICE_HPP
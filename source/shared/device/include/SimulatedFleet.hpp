@@ -0,0 +1,39 @@
+#ifndef SIMULATEDFLEET_HPP
+#define SIMULATEDFLEET_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Many simulated thermometers behaving as SimulatedThermometer, kept as a structure of arrays so
+// that a whole fleet advances in one pass. Randomness comes from a counter based hash of (seed,
+// reading, thermometer) instead of a stateful generator: every lane is independent, the update loop
+// auto-vectorizes and the same seed always reproduces the same fleet
+class SimulatedFleet final
+{
+public:
+   SimulatedFleet(std::size_t size, std::uint32_t seed);
+
+   // Takes one more reading from every thermometer of the fleet
+   void step() noexcept;
+
+   [[nodiscard]] inline std::span<const float> temperatures() const noexcept
+   {
+      return mTemperatures;
+   }
+
+   [[nodiscard]] inline std::size_t size() const noexcept
+   {
+      return mTemperatures.size();
+   }
+
+private:
+   std::uint32_t mSeed;
+   std::uint32_t mReading = 0;
+   std::vector<float> mTemperatures;
+
+   // Adds to every temperature a uniform random value in [offset, offset + scale)
+   void perturb(std::uint32_t key, float offset, float scale) noexcept;
+};
+
+#endif // SIMULATEDFLEET_HPP
@@ -11,9 +11,39 @@ private:
    unsigned int mCalled = 0;
    float mStartingPoint;
    std::mt19937 rng;
+   unsigned int mSampleRate;
+   std::size_t mFifoCapacity;
+   Clock::duration mSamplePeriod{};
+   Clock::time_point mLastSample;
+   std::chrono::milliseconds mLatency{0};
+   float mFailureRate = 0;
+
+   [[nodiscard]] float nextValue();
 
 public:
-   SimulatedThermometer();
+   static constexpr std::size_t FIFO_CAPACITY_DEFAULT = 1024;
+
+   // A sample rate (in Hz) different from zero simulates a device acquiring on its own into a FIFO
+   // of fifoCapacity readings, dropping the oldest ones when it is full
+   explicit SimulatedThermometer(unsigned int sampleRate = 0,
+                                 std::size_t fifoCapacity = FIFO_CAPACITY_DEFAULT);
+
+   SimulatedThermometer(const SimulatedThermometer& thermometer) = delete;
+   SimulatedThermometer(const SimulatedThermometer&& thermometer) = delete;
+   auto operator=(const SimulatedThermometer& thermometer) = delete;
+   auto operator=(const SimulatedThermometer&& thermometer) = delete;
+
+   // Every reading takes latency to complete and fails with probability failureRate (from 0 to 1),
+   // so that slow or unreliable hardware can be simulated. Set them before reading
+   inline void setLatency(const std::chrono::milliseconds& latency) noexcept
+   {
+      mLatency = latency;
+   }
+
+   inline void setFailureRate(const float failureRate) noexcept
+   {
+      mFailureRate = failureRate;
+   }
 
    [[nodiscard]] inline std::string name() const noexcept override
    {
@@ -21,6 +51,13 @@ public:
    }
 
    [[nodiscard]] std::optional<float> temperature() override;
+
+   [[nodiscard]] std::size_t temperatures(std::span<TemperatureSample> samples) override;
+
+   inline ~SimulatedThermometer() override
+   {
+      stopReads();
+   }
 };
 
 #endif // SIMULATEDTHERMOMETER_HPP
@@ -1,14 +1,73 @@
 #ifndef THERMOMETER_HPP
 #define THERMOMETER_HPP
 
+#include <memory>
 #include <optional>
+#include <span>
+#include <vector>
 
 #include "Device.hpp"
 
 class Thermometer : public Device
 {
 public:
+   using TemperatureSample = Sample<float>;
+   using TemperatureRead = AsyncReader::Read<TemperatureSample>;
+   using TemperatureBuffer = std::vector<TemperatureSample>;
+   using TemperaturesRead = AsyncReader::Read<std::size_t>;
+
    [[nodiscard]] virtual std::optional<float> temperature() = 0;
+
+   // Fills samples with the readings buffered by the device, oldest first, and returns how many
+   // were written. Devices without a FIFO just provide a single reading taken now
+   [[nodiscard]] virtual inline std::size_t temperatures(std::span<TemperatureSample> samples)
+   {
+      if (samples.empty())
+      {
+         return 0;
+      }
+
+      auto measured = temperature();
+      if (!measured.has_value())
+      {
+         return 0;
+      }
+
+      samples.front() = {Clock::now(), measured.value()};
+      return 1;
+   }
+
+   // Starts a reading without blocking the caller. The future becomes ready with the sample, or
+   // with a TIMEOUT error if the device did not answer in time. By default the blocking
+   // temperature() runs on the device thread, devices with a native asynchronous interface should
+   // override it
+   [[nodiscard]] virtual inline TemperatureRead
+   readTemperature(const std::chrono::milliseconds& timeout)
+   {
+      return startRead<TemperatureSample>(
+          [this]() -> Result<TemperatureSample, DeviceError> {
+             auto measured = temperature();
+             if (!measured.has_value())
+             {
+                return Error(DeviceError::READ_FAILED, "Device returned no reading");
+             }
+
+             return TemperatureSample{Clock::now(), measured.value()};
+          },
+          timeout);
+   }
+
+   // As readTemperature() for temperatures(), the future becoming ready with how many samples were
+   // written. The buffer is shared with the device thread, which might still be filling it after
+   // the read timed out: it is only to be looked at once the future has a value
+   [[nodiscard]] virtual inline TemperaturesRead
+   readTemperatures(const std::shared_ptr<TemperatureBuffer>& samples,
+                    const std::chrono::milliseconds& timeout)
+   {
+      return startRead<std::size_t>(
+          [this, samples]() -> Result<std::size_t, DeviceError> { return temperatures(*samples); },
+          timeout);
+   }
 };
 
 #endif // THERMOMETER_HPP
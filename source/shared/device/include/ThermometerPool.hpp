@@ -0,0 +1,108 @@
+#ifndef THERMOMETERPOOL_HPP
+#define THERMOMETERPOOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Thermometer.hpp"
+
+// Polls many thermometers, each on its own period, on a fixed number of worker threads. Reads are
+// blocking calls to temperature() made by the workers, so that a sensor costs no thread of its own
+// as it would reading through its device thread
+class ThermometerPool final
+{
+public:
+   using Clock = std::chrono::steady_clock;
+   using TemperatureSample = Thermometer::TemperatureSample;
+
+   // The outcome of polling a sensor: the sample, READ_FAILED, TIMEOUT when it did not answer
+   // before the deadline or BUSY when it is still stuck on a read that timed out earlier
+   struct Reading
+   {
+      std::size_t sensor;
+      Result<TemperatureSample, DeviceError> sample;
+   };
+
+   explicit ThermometerPool(std::size_t workers);
+   ThermometerPool(const ThermometerPool& pool) = delete;
+   ThermometerPool(const ThermometerPool&& pool) = delete;
+   auto operator=(const ThermometerPool& pool) = delete;
+   auto operator=(const ThermometerPool&& pool) = delete;
+
+   // Sensors are added before polling starts, their index being the order they were added in
+   void add(std::string id, std::unique_ptr<Thermometer> thermometer,
+            std::chrono::milliseconds period);
+
+   // Reads every sensor due at now in parallel, waiting for them until timeout. The readings are
+   // valid until the next call
+   [[nodiscard]] std::span<const Reading> poll(Clock::time_point now,
+                                               std::chrono::milliseconds timeout);
+
+   // When the next sensor is due
+   [[nodiscard]] Clock::time_point nextDue() const noexcept;
+
+   [[nodiscard]] inline const std::string& id(const std::size_t sensor) const noexcept
+   {
+      return mSensors[sensor].id;
+   }
+
+   [[nodiscard]] inline const Thermometer& thermometer(const std::size_t sensor) const noexcept
+   {
+      return *mSensors[sensor].thermometer;
+   }
+
+   [[nodiscard]] inline std::size_t size() const noexcept
+   {
+      return mSensors.size();
+   }
+
+   [[nodiscard]] inline std::size_t workers() const noexcept
+   {
+      return mWorkers.size();
+   }
+
+   ~ThermometerPool();
+
+private:
+   enum class State
+   {
+      IDLE,
+      READING,
+      DONE,
+      // Its read timed out, whatever it returns is thrown away
+      ABANDONED
+   };
+
+   struct Sensor
+   {
+      std::string id;
+      std::unique_ptr<Thermometer> thermometer;
+      Clock::duration period{};
+      // Due on the first poll, its schedule starting from there
+      Clock::time_point due;
+      State state = State::IDLE;
+      std::optional<Result<TemperatureSample, DeviceError>> sample;
+   };
+
+   // Every member below but the workers is guarded by mMutex
+   std::mutex mMutex;
+   std::condition_variable mQueued;
+   std::condition_variable mDone;
+   std::vector<Sensor> mSensors;
+   std::deque<std::size_t> mQueue;
+   std::vector<std::size_t> mPolled;
+   std::vector<Reading> mReadings;
+   bool mStopping = false;
+   std::vector<std::thread> mWorkers;
+
+   void work();
+};
+
+#endif // THERMOMETERPOOL_HPP
@@ -0,0 +1,108 @@
+#include "AsyncReader.hpp"
+
+AsyncReader::AsyncReader() : mWorker([this]() { work(); }), mWatchdog([this]() { watch(); })
+{
+}
+
+bool AsyncReader::submit(std::function<void()>&& run, Expiration&& expire,
+                         const std::chrono::milliseconds& timeout)
+{
+   {
+      std::lock_guard lk(mMutex);
+      if (mBusy || mStopping)
+      {
+         return false;
+      }
+
+      mBusy = true;
+      mRun = std::move(run);
+      mExpire = std::move(expire);
+      mDeadline = Clock::now() + timeout;
+      mGeneration++;
+   }
+   mCondition.notify_all();
+
+   return true;
+}
+
+void AsyncReader::work()
+{
+   std::unique_lock lk(mMutex);
+   while (true)
+   {
+      mCondition.wait(lk, [this] { return mStopping || mRun; });
+      if (mStopping)
+      {
+         return;
+      }
+
+      auto run = std::move(mRun);
+      mRun = nullptr;
+
+      lk.unlock();
+      run();
+      lk.lock();
+   }
+}
+
+void AsyncReader::release()
+{
+   {
+      std::lock_guard lk(mMutex);
+      mBusy = false;
+      mExpire = nullptr;
+   }
+   mCondition.notify_all();
+}
+
+void AsyncReader::watch()
+{
+   std::unique_lock lk(mMutex);
+   while (true)
+   {
+      mCondition.wait(lk, [this] { return mStopping || mExpire; });
+      if (mStopping)
+      {
+         return;
+      }
+
+      // A new read may be submitted while we wait, in that case we start over with its deadline
+      const auto generation = mGeneration;
+      const auto deadline = mDeadline;
+      if (!mCondition.wait_until(lk, deadline, [this, generation] {
+             return mStopping || !mExpire || mGeneration != generation;
+          }))
+      {
+         auto expire = std::move(mExpire);
+         mExpire = nullptr;
+         expire(Error(DeviceError::TIMEOUT, "Device did not answer in time"));
+      }
+   }
+}
+
+void AsyncReader::stop() noexcept
+{
+   {
+      std::lock_guard lk(mMutex);
+      if (mStopping)
+      {
+         return;
+      }
+
+      mStopping = true;
+      if (mExpire)
+      {
+         mExpire(Error(DeviceError::CANCELLED, "Device reads were stopped"));
+         mExpire = nullptr;
+      }
+   }
+   mCondition.notify_all();
+
+   mWorker.join();
+   mWatchdog.join();
+}
+
+AsyncReader::~AsyncReader()
+{
+   stop();
+}
@@ -0,0 +1,59 @@
+#include "SimulatedFleet.hpp"
+
+namespace {
+// Integer hash by Chris Wellons (lowbias32), 32 bit multiplications keep it vectorizable
+[[nodiscard]] constexpr inline std::uint32_t hash(std::uint32_t value) noexcept
+{
+   constexpr std::uint32_t FIRST_MULTIPLIER = 0x7feb352dU;
+   constexpr std::uint32_t SECOND_MULTIPLIER = 0x846ca68bU;
+   constexpr unsigned int FIRST_SHIFT = 16;
+   constexpr unsigned int SECOND_SHIFT = 15;
+
+   value ^= value >> FIRST_SHIFT;
+   value *= FIRST_MULTIPLIER;
+   value ^= value >> SECOND_SHIFT;
+   value *= SECOND_MULTIPLIER;
+   value ^= value >> FIRST_SHIFT;
+   return value;
+}
+
+constexpr std::uint32_t GOLDEN_RATIO = 0x9e3779b9U;
+} // namespace
+
+SimulatedFleet::SimulatedFleet(const std::size_t size, const std::uint32_t seed)
+    : mSeed{seed}, mTemperatures(size, 0)
+{
+   constexpr float RANDOM_CENTER = 15;
+   constexpr float RADIUS = 5;
+   perturb(hash(mSeed), RANDOM_CENTER - RADIUS, 2 * RADIUS);
+}
+
+void SimulatedFleet::step() noexcept
+{
+   // As SimulatedThermometer the temperature only moves every few readings
+   constexpr unsigned int APPLY_RANDOM = 5;
+   mReading++;
+
+   if ((mReading % APPLY_RANDOM) == 0)
+   {
+      constexpr float LO = -1.0;
+      constexpr float HI = 1.0;
+      perturb(hash(mSeed ^ hash(mReading)), LO, HI - LO);
+   }
+}
+
+void SimulatedFleet::perturb(const std::uint32_t key, const float offset,
+                             const float scale) noexcept
+{
+   // Keeping the 24 most significant bits, exactly representable as a float in [0, 1)
+   constexpr unsigned int MANTISSA_SHIFT = 8;
+   constexpr float NORMALIZATION = 1.0F / static_cast<float>(1U << (32 - MANTISSA_SHIFT));
+
+   auto* temperatures = mTemperatures.data();
+   const auto size = static_cast<std::uint32_t>(mTemperatures.size());
+   for (std::uint32_t i = 0; i < size; i++)
+   {
+      const auto random = hash(key + i * GOLDEN_RATIO) >> MANTISSA_SHIFT;
+      temperatures[i] += offset + scale * static_cast<float>(random) * NORMALIZATION;
+   }
+}
@@ -1,15 +1,26 @@
 #include "SimulatedThermometer.hpp"
 
-SimulatedThermometer::SimulatedThermometer() : rng(std::random_device{}())
+#include <thread>
+
+SimulatedThermometer::SimulatedThermometer(const unsigned int sampleRate,
+                                           const std::size_t fifoCapacity)
+    : rng(std::random_device{}()), mSampleRate{sampleRate}, mFifoCapacity{fifoCapacity},
+      mLastSample{Clock::now()}
 {
    constexpr float RANDOM_CENTER = 15;
    constexpr float RADIUS = 5;
    std::uniform_real_distribution<float> dist(RANDOM_CENTER - RADIUS, RANDOM_CENTER + RADIUS);
 
    mStartingPoint = dist(rng);
+
+   if (mSampleRate != 0)
+   {
+      mSamplePeriod = std::chrono::duration_cast<Clock::duration>(
+          std::chrono::duration<double>(1.0 / mSampleRate));
+   }
 }
 
-std::optional<float> SimulatedThermometer::temperature()
+float SimulatedThermometer::nextValue()
 {
    constexpr unsigned int APPLY_RANDOM = 5;
    mCalled++;
@@ -28,3 +39,44 @@ std::optional<float> SimulatedThermometer::temperature()
 
    return mStartingPoint;
 }
+
+std::optional<float> SimulatedThermometer::temperature()
+{
+   if (mLatency != std::chrono::milliseconds::zero())
+   {
+      std::this_thread::sleep_for(mLatency);
+   }
+
+   if (mFailureRate > 0 && std::bernoulli_distribution(mFailureRate)(rng))
+   {
+      return std::nullopt;
+   }
+
+   return nextValue();
+}
+
+std::size_t SimulatedThermometer::temperatures(std::span<TemperatureSample> samples)
+{
+   if (mSampleRate == 0 || mSamplePeriod == Clock::duration::zero())
+   {
+      return Thermometer::temperatures(samples);
+   }
+
+   // Readings the simulated hardware acquired since the last one we handed out, if they overflowed
+   // the FIFO the oldest ones are lost
+   auto available = static_cast<std::size_t>((Clock::now() - mLastSample) / mSamplePeriod);
+   if (available > mFifoCapacity)
+   {
+      mLastSample += mSamplePeriod * (available - mFifoCapacity);
+      available = mFifoCapacity;
+   }
+
+   const auto count = std::min(available, samples.size());
+   for (std::size_t i = 0; i < count; i++)
+   {
+      mLastSample += mSamplePeriod;
+      samples[i] = {mLastSample, nextValue()};
+   }
+
+   return count;
+}
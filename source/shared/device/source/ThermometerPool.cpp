@@ -0,0 +1,150 @@
+#include "ThermometerPool.hpp"
+
+#include <algorithm>
+
+ThermometerPool::ThermometerPool(const std::size_t workers)
+{
+   const auto count = std::max<std::size_t>(workers, 1);
+   mWorkers.reserve(count);
+   for (std::size_t worker = 0; worker < count; worker++)
+   {
+      mWorkers.emplace_back([this]() { work(); });
+   }
+}
+
+void ThermometerPool::add(std::string id, std::unique_ptr<Thermometer> thermometer,
+                          const std::chrono::milliseconds period)
+{
+   std::lock_guard lock(mMutex);
+   auto& sensor = mSensors.emplace_back();
+   sensor.id = std::move(id);
+   sensor.thermometer = std::move(thermometer);
+   sensor.period = period;
+}
+
+std::span<const ThermometerPool::Reading>
+ThermometerPool::poll(const Clock::time_point now, const std::chrono::milliseconds timeout)
+{
+   std::unique_lock lock(mMutex);
+   mReadings.clear();
+   mPolled.clear();
+   for (std::size_t index = 0; index < mSensors.size(); index++)
+   {
+      auto& sensor = mSensors[index];
+      if (sensor.due > now)
+      {
+         continue;
+      }
+
+      // Periods missed while falling behind are skipped rather than read in a burst
+      sensor.due += sensor.period;
+      if (sensor.due <= now)
+      {
+         sensor.due = now + sensor.period;
+      }
+
+      if (sensor.state != State::IDLE)
+      {
+         mReadings.push_back(
+             {index, Error(DeviceError::BUSY, "Still waiting for a read that timed out")});
+         continue;
+      }
+
+      sensor.state = State::READING;
+      mQueue.push_back(index);
+      mPolled.push_back(index);
+   }
+   mQueued.notify_all();
+
+   const auto deadline = now + timeout;
+   mDone.wait_until(lock, deadline, [this]() {
+      return std::all_of(mPolled.begin(), mPolled.end(), [this](const std::size_t index) {
+         return mSensors[index].state == State::DONE;
+      });
+   });
+
+   for (const auto index : mPolled)
+   {
+      auto& sensor = mSensors[index];
+      if (sensor.state == State::DONE)
+      {
+         mReadings.push_back({index, std::move(sensor.sample).value()});
+         sensor.sample.reset();
+         sensor.state = State::IDLE;
+      }
+      else
+      {
+         mReadings.push_back(
+             {index, Error(DeviceError::TIMEOUT, "Device did not answer in time")});
+         sensor.state = State::ABANDONED;
+      }
+   }
+
+   return mReadings;
+}
+
+ThermometerPool::Clock::time_point ThermometerPool::nextDue() const noexcept
+{
+   auto next = Clock::time_point::max();
+   for (const auto& sensor : mSensors)
+   {
+      next = std::min(next, sensor.due);
+   }
+
+   return next;
+}
+
+void ThermometerPool::work()
+{
+   std::unique_lock lock(mMutex);
+   while (true)
+   {
+      mQueued.wait(lock, [this]() { return mStopping || !mQueue.empty(); });
+      if (mStopping)
+      {
+         return;
+      }
+
+      const auto index = mQueue.front();
+      mQueue.pop_front();
+      auto& thermometer = *mSensors[index].thermometer;
+
+      // A sensor is only ever read by one worker at a time, nothing else touches its device
+      lock.unlock();
+      auto measured = thermometer.temperature();
+      const auto now = Device::Clock::now();
+      lock.lock();
+
+      auto& sensor = mSensors[index];
+      if (sensor.state == State::ABANDONED)
+      {
+         sensor.state = State::IDLE;
+         continue;
+      }
+
+      if (measured.has_value())
+      {
+         sensor.sample.emplace(TemperatureSample{now, measured.value()});
+      }
+      else
+      {
+         sensor.sample.emplace(Error(DeviceError::READ_FAILED, "Device returned no reading"));
+      }
+      sensor.state = State::DONE;
+      mDone.notify_one();
+   }
+}
+
+ThermometerPool::~ThermometerPool()
+{
+   {
+      std::lock_guard lock(mMutex);
+      mStopping = true;
+   }
+   mQueued.notify_all();
+
+   for (auto& worker : mWorkers)
+   {
+      worker.join();
+   }
+}
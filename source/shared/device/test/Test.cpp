@@ -0,0 +1,168 @@
+#include "gtest/gtest.h"
+
+#include "SimulatedFleet.hpp"
+#include "SimulatedThermometer.hpp"
+#include "ThermometerPool.hpp"
+
+TEST(Device, AsyncRead)
+{
+   SimulatedThermometer thermometer;
+   auto read = thermometer.readTemperature(std::chrono::seconds(1));
+   auto result = read.get();
+   ASSERT_TRUE(result.hasValue()) << "Asynchronous read failed";
+}
+
+TEST(Device, AsyncReadTimeout)
+{
+   SimulatedThermometer thermometer;
+   thermometer.setLatency(std::chrono::milliseconds(200));
+
+   auto read = thermometer.readTemperature(std::chrono::milliseconds(20));
+   ASSERT_EQ(read.wait_for(std::chrono::milliseconds(100)), std::future_status::ready)
+       << "Slow read did not time out";
+   auto result = read.get();
+   ASSERT_TRUE(result.hasError());
+   ASSERT_EQ(result.error(), DeviceError::TIMEOUT);
+}
+
+TEST(Device, AsyncReadOverlap)
+{
+   SimulatedThermometer thermometer;
+   thermometer.setLatency(std::chrono::milliseconds(100));
+
+   auto first = thermometer.readTemperature(std::chrono::milliseconds(10));
+   ASSERT_EQ(first.get().error(), DeviceError::TIMEOUT);
+
+   // The device is still stuck on the first read even if it already timed out
+   auto second = thermometer.readTemperature(std::chrono::seconds(1));
+   auto result = second.get();
+   ASSERT_TRUE(result.hasError());
+   ASSERT_EQ(result.error(), DeviceError::BUSY) << "Overlapping read was accepted";
+
+   std::this_thread::sleep_for(std::chrono::milliseconds(150));
+   auto third = thermometer.readTemperature(std::chrono::seconds(1));
+   ASSERT_TRUE(third.get().hasValue()) << "Device did not recover after a timed out read";
+}
+
+TEST(Device, AsyncReadFailure)
+{
+   SimulatedThermometer thermometer;
+   thermometer.setFailureRate(1);
+
+   auto result = thermometer.readTemperature(std::chrono::seconds(1)).get();
+   ASSERT_TRUE(result.hasError());
+   ASSERT_EQ(result.error(), DeviceError::READ_FAILED);
+}
+
+TEST(Device, BatchSamples)
+{
+   constexpr unsigned int sampleRate = 1000;
+   SimulatedThermometer thermometer(sampleRate);
+   std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+   std::vector<Thermometer::TemperatureSample> samples(sampleRate);
+   auto count = thermometer.temperatures(samples);
+   ASSERT_GT(count, 0) << "No sample was buffered";
+   for (std::size_t i = 1; i < count; i++)
+   {
+      ASSERT_LT(samples[i - 1].timestamp, samples[i].timestamp) << "Samples are not ordered";
+   }
+}
+
+TEST(Device, AsyncBatchRead)
+{
+   constexpr unsigned int sampleRate = 1000;
+   SimulatedThermometer thermometer(sampleRate);
+   std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+   auto samples = std::make_shared<Thermometer::TemperatureBuffer>(sampleRate);
+   auto result = thermometer.readTemperatures(samples, std::chrono::seconds(1)).get();
+   ASSERT_TRUE(result.hasValue()) << "Asynchronous batch read failed";
+   ASSERT_GT(result.value(), 0) << "No sample was buffered";
+}
+
+TEST(Device, SimulatedFleetDeterminism)
+{
+   constexpr std::size_t size = 1000;
+   constexpr std::uint32_t seed = 42;
+   SimulatedFleet first(size, seed);
+   SimulatedFleet second(size, seed);
+   SimulatedFleet other(size, seed + 1);
+
+   for (unsigned int i = 0; i < 10; i++)
+   {
+      first.step();
+      second.step();
+      other.step();
+   }
+
+   ASSERT_TRUE(std::equal(first.temperatures().begin(), first.temperatures().end(),
+                          second.temperatures().begin()))
+       << "Same seed generated different fleets";
+   ASSERT_FALSE(std::equal(first.temperatures().begin(), first.temperatures().end(),
+                           other.temperatures().begin()))
+       << "Different seeds generated the same fleet";
+   for (auto temperature : first.temperatures())
+   {
+      ASSERT_GT(temperature, 0);
+      ASSERT_LT(temperature, 30);
+   }
+}
+
+TEST(Device, ThermometerPool)
+{
+   constexpr std::size_t SENSORS = 8;
+   ThermometerPool pool(4);
+   for (std::size_t i = 0; i < SENSORS; i++)
+   {
+      auto thermometer = std::make_unique<SimulatedThermometer>();
+      thermometer->setLatency(std::chrono::milliseconds(50));
+      pool.add("probe" + std::to_string(i), std::move(thermometer),
+               std::chrono::milliseconds(i % 2 == 0 ? 100 : 1000));
+   }
+   ASSERT_EQ(pool.size(), SENSORS);
+
+   // Eight reads of 50ms each on four workers take two rounds
+   const auto start = ThermometerPool::Clock::now();
+   auto readings = pool.poll(start, std::chrono::seconds(1));
+   ASSERT_LT(ThermometerPool::Clock::now() - start, std::chrono::milliseconds(150))
+       << "Sensors were not read in parallel";
+   ASSERT_EQ(readings.size(), SENSORS);
+   for (const auto& reading : readings)
+   {
+      ASSERT_TRUE(reading.sample.hasValue());
+   }
+   ASSERT_EQ(pool.id(readings.front().sensor), "probe0");
+
+   // Only the sensors with the shorter period are due again
+   ASSERT_EQ(pool.nextDue(), start + std::chrono::milliseconds(100));
+   readings = pool.poll(start + std::chrono::milliseconds(100), std::chrono::seconds(1));
+   ASSERT_EQ(readings.size(), SENSORS / 2);
+}
+
+TEST(Device, ThermometerPoolTimeout)
+{
+   ThermometerPool pool(2);
+   auto slow = std::make_unique<SimulatedThermometer>();
+   slow->setLatency(std::chrono::milliseconds(200));
+   pool.add("slow", std::move(slow), std::chrono::milliseconds(10));
+   auto failing = std::make_unique<SimulatedThermometer>();
+   failing->setFailureRate(1);
+   pool.add("failing", std::move(failing), std::chrono::milliseconds(10));
+
+   auto now = ThermometerPool::Clock::now();
+   auto readings = pool.poll(now, std::chrono::milliseconds(20));
+   ASSERT_EQ(readings.size(), 2);
+   ASSERT_EQ(readings[0].sample.error(), DeviceError::TIMEOUT);
+   ASSERT_EQ(readings[1].sample.error(), DeviceError::READ_FAILED);
+
+   // Still stuck on the read that timed out
+   now += std::chrono::milliseconds(20);
+   readings = pool.poll(now, std::chrono::milliseconds(20));
+   ASSERT_EQ(readings[0].sample.error(), DeviceError::BUSY);
+
+   std::this_thread::sleep_for(std::chrono::milliseconds(250));
+   now += std::chrono::milliseconds(20);
+   readings = pool.poll(now, std::chrono::seconds(1));
+   ASSERT_TRUE(readings[0].sample.hasValue()) << "Sensor did not recover after a timed out read";
+}
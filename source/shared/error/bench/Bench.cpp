@@ -0,0 +1,109 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "Result.hpp"
+
+namespace {
+std::atomic<std::size_t> allocations = 0;
+
+enum class BenchError
+{
+   UNABLE_TO_SEND
+};
+
+// The error paths this library replaced, kept as a reference point
+using LegacyError = std::pair<BenchError, std::optional<std::string>>;
+
+std::optional<LegacyError> legacyError(const std::string& name)
+{
+   return std::make_pair(BenchError::UNABLE_TO_SEND,
+                         std::optional<std::string>("Network configuration is missing for the " +
+                                                    name + " component"));
+}
+
+Result<void, BenchError> staticError()
+{
+   return Error(BenchError::UNABLE_TO_SEND, "Error in sending payload");
+}
+
+Result<void, BenchError> composedError(const std::string& name)
+{
+   return Error(BenchError::UNABLE_TO_SEND,
+                ErrorDetail::compose("Network configuration is missing for the ", name,
+                                     " component"));
+}
+
+// Reports how many allocations every iteration made, failing if a path that should not allocate did
+template <class Function>
+void allocationsPerIteration(benchmark::State& state, bool allocationFree, Function function)
+{
+   const auto before = allocations.load();
+   for (auto _ : state)
+   {
+      function();
+   }
+   const auto perIteration =
+       static_cast<double>(allocations.load() - before) / static_cast<double>(state.iterations());
+   state.counters["allocations"] = perIteration;
+   if (allocationFree && perIteration > 0)
+   {
+      state.SkipWithError("Error path allocated");
+   }
+}
+} // namespace
+
+void* operator new(std::size_t size)
+{
+   allocations.fetch_add(1, std::memory_order_relaxed);
+   if (auto* pointer = std::malloc(size))
+   {
+      return pointer;
+   }
+   throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+   std::free(pointer);
+}
+
+void operator delete(void* pointer, [[maybe_unused]] std::size_t size) noexcept
+{
+   std::free(pointer);
+}
+
+static void BM_LegacyError(benchmark::State& state)
+{
+   const std::string name = "Temperature";
+   allocationsPerIteration(state, false,
+                           [&name]() { benchmark::DoNotOptimize(legacyError(name)); });
+}
+BENCHMARK(BM_LegacyError);
+
+static void BM_StaticError(benchmark::State& state)
+{
+   allocationsPerIteration(state, true, []() { benchmark::DoNotOptimize(staticError()); });
+}
+BENCHMARK(BM_StaticError);
+
+static void BM_ComposedError(benchmark::State& state)
+{
+   const std::string name = "Temperature";
+   allocationsPerIteration(state, true,
+                           [&name]() { benchmark::DoNotOptimize(composedError(name)); });
+}
+BENCHMARK(BM_ComposedError);
+
+static void BM_MovedError(benchmark::State& state)
+{
+   allocationsPerIteration(state, true, []() {
+      auto result = staticError();
+      auto moved = std::move(result);
+      benchmark::DoNotOptimize(moved.error().furtherInfo());
+   });
+}
+BENCHMARK(BM_MovedError);
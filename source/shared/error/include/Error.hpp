@@ -1,11 +1,82 @@
 #ifndef ERROR_HPP
 #define ERROR_HPP
 
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <optional>
-#include <string>
+#include <string_view>
+#include <type_traits>
 
 #include "magic_enum.hpp"
 
+// Further information attached to an error. It never allocates: it either references a string with
+// static storage duration (e.g. a literal) or composes a short message into an inline buffer,
+// truncating it if it does not fit
+class ErrorDetail final
+{
+public:
+   static constexpr std::size_t INLINE_CAPACITY = 120;
+
+   constexpr ErrorDetail() noexcept = default;
+
+   // NOLINTNEXTLINE(google-explicit-constructor, hicpp-explicit-conversions)
+   constexpr inline ErrorDetail(const char* staticText) noexcept : mStatic{staticText}
+   {
+   }
+
+   template <class... Parts>
+   [[nodiscard]] static inline ErrorDetail compose(const Parts&... parts) noexcept
+   {
+      ErrorDetail detail;
+      (detail.append(parts), ...);
+      return detail;
+   }
+
+   [[nodiscard]] constexpr inline bool empty() const noexcept
+   {
+      return mStatic == nullptr && mSize == 0;
+   }
+
+   [[nodiscard]] constexpr inline std::string_view view() const noexcept
+   {
+      if (mStatic != nullptr)
+      {
+         return mStatic;
+      }
+
+      return {mInline.data(), mSize};
+   }
+
+private:
+   const char* mStatic = nullptr;
+   std::size_t mSize = 0;
+   // Only the first mSize characters are ever read, zeroing it would dominate the cost of an error
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init, hicpp-member-init)
+   std::array<char, INLINE_CAPACITY> mInline;
+
+   inline void append(const std::string_view& text) noexcept
+   {
+      const auto length = std::min(text.size(), INLINE_CAPACITY - mSize);
+      std::copy_n(text.data(), length, mInline.begin() + static_cast<std::ptrdiff_t>(mSize));
+      mSize += length;
+   }
+
+   template <class Number>
+   requires std::is_arithmetic_v<Number>
+   inline void append(const Number& number) noexcept
+   {
+      constexpr std::size_t NUMBER_MAX_CHARS = 32;
+      std::array<char, NUMBER_MAX_CHARS> buffer{};
+      const auto converted = std::to_chars(buffer.begin(), buffer.end(), number);
+      if (converted.ec == std::errc{})
+      {
+         append(std::string_view(buffer.data(),
+                                 static_cast<std::size_t>(converted.ptr - buffer.data())));
+      }
+   }
+};
+
 template <class T> class Error
 {
 public:
@@ -17,7 +88,7 @@ public:
                     "Error instance should be constructed from an enum type");
    }
 
-   inline Error(const T& error, const std::string& furtherInfo)
+   inline Error(const T& error, const ErrorDetail& furtherInfo)
        : mError{error}, mFurtherInfo{furtherInfo}
    {
       static_assert(std::is_enum<T>::value,
@@ -29,9 +100,14 @@ public:
       return mError;
    }
 
-   [[nodiscard]] inline auto furtherInfo() const noexcept
+   [[nodiscard]] inline std::optional<std::string_view> furtherInfo() const noexcept
    {
-      return mFurtherInfo;
+      if (mFurtherInfo.empty())
+      {
+         return std::nullopt;
+      }
+
+      return mFurtherInfo.view();
    }
 
    [[nodiscard]] inline auto asString() const
@@ -47,13 +123,13 @@ public:
 
 private:
    T mError;
-   std::optional<std::string> mFurtherInfo;
+   ErrorDetail mFurtherInfo;
 };
 
 template <class T, class... Types>
-[[nodiscard]] static inline auto make_optional_error(Types... args)
+[[nodiscard]] static inline auto make_optional_error(Types&&... args)
 {
-   return std::make_optional<Error<T>>(args...);
+   return std::make_optional<Error<T>>(std::forward<Types>(args)...);
 }
 
 template <class T>[[nodiscard]] static inline auto make_optional_error()
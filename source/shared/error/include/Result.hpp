@@ -0,0 +1,131 @@
+#ifndef RESULT_HPP
+#define RESULT_HPP
+
+#include <utility>
+#include <variant>
+
+#include "Error.hpp"
+
+// Holds either a value or an Error<E>, like std::expected. It is move-only so that error paths
+// never copy, and since Error<E> keeps its details inline it never allocates on its own
+template <class T, class E> class [[nodiscard]] Result final
+{
+public:
+   using ValueType = T;
+   using ErrorType = Error<E>;
+
+   // NOLINTNEXTLINE(google-explicit-constructor, hicpp-explicit-conversions)
+   inline Result(T value) : mStorage{std::in_place_index<VALUE_INDEX>, std::move(value)}
+   {
+   }
+
+   // NOLINTNEXTLINE(google-explicit-constructor, hicpp-explicit-conversions)
+   inline Result(Error<E> error) : mStorage{std::in_place_index<ERROR_INDEX>, std::move(error)}
+   {
+   }
+
+   Result(const Result& result) = delete;
+   Result(Result&& result) noexcept = default;
+   auto operator=(const Result& result) = delete;
+   Result& operator=(Result&& result) noexcept = default;
+
+   [[nodiscard]] inline bool hasValue() const noexcept
+   {
+      return mStorage.index() == VALUE_INDEX;
+   }
+
+   [[nodiscard]] inline bool hasError() const noexcept
+   {
+      return !hasValue();
+   }
+
+   [[nodiscard]] explicit inline operator bool() const noexcept
+   {
+      return hasValue();
+   }
+
+   [[nodiscard]] inline T& value() &
+   {
+      return std::get<VALUE_INDEX>(mStorage);
+   }
+
+   [[nodiscard]] inline const T& value() const&
+   {
+      return std::get<VALUE_INDEX>(mStorage);
+   }
+
+   [[nodiscard]] inline T&& value() &&
+   {
+      return std::get<VALUE_INDEX>(std::move(mStorage));
+   }
+
+   template <class U>[[nodiscard]] inline T valueOr(U&& fallback) &&
+   {
+      if (hasValue())
+      {
+         return std::move(value());
+      }
+
+      return static_cast<T>(std::forward<U>(fallback));
+   }
+
+   [[nodiscard]] inline const Error<E>& error() const
+   {
+      return std::get<ERROR_INDEX>(mStorage);
+   }
+
+   ~Result() = default;
+
+private:
+   static constexpr std::size_t VALUE_INDEX = 0;
+   static constexpr std::size_t ERROR_INDEX = 1;
+
+   std::variant<T, Error<E>> mStorage;
+};
+
+// Result of an operation that produces nothing but may fail, a default constructed one is a success
+template <class E> class [[nodiscard]] Result<void, E> final
+{
+public:
+   using ValueType = void;
+   using ErrorType = Error<E>;
+
+   Result() noexcept = default;
+
+   // NOLINTNEXTLINE(google-explicit-constructor, hicpp-explicit-conversions)
+   inline Result(Error<E> error) : mError{std::move(error)}
+   {
+   }
+
+   Result(const Result& result) = delete;
+   Result(Result&& result) noexcept = default;
+   auto operator=(const Result& result) = delete;
+   Result& operator=(Result&& result) noexcept = default;
+
+   [[nodiscard]] inline bool hasValue() const noexcept
+   {
+      return !mError.has_value();
+   }
+
+   [[nodiscard]] inline bool hasError() const noexcept
+   {
+      return mError.has_value();
+   }
+
+   [[nodiscard]] explicit inline operator bool() const noexcept
+   {
+      return hasValue();
+   }
+
+   [[nodiscard]] inline const Error<E>& error() const
+   {
+      return mError.value();
+   }
+
+   ~Result() = default;
+
+private:
+   std::optional<Error<E>> mError;
+};
+
+#endif // RESULT_HPP
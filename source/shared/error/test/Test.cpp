@@ -0,0 +1,75 @@
+#include "gtest/gtest.h"
+
+#include "Result.hpp"
+
+enum class TestError
+{
+   FIRST,
+   SECOND
+};
+
+TEST(Error, StaticDetail)
+{
+   Error error(TestError::FIRST, "Static detail");
+   ASSERT_EQ(error, TestError::FIRST);
+   ASSERT_TRUE(error.furtherInfo().has_value()) << "Error detail was lost";
+   ASSERT_EQ(error.furtherInfo().value(), "Static detail");
+}
+
+TEST(Error, ComposedDetail)
+{
+   const std::string path = "/tmp/file";
+   Error error(TestError::SECOND, ErrorDetail::compose("Unable to open ", path, " (", 42, ")"));
+   ASSERT_EQ(error.furtherInfo().value(), "Unable to open /tmp/file (42)");
+}
+
+TEST(Error, TruncatedDetail)
+{
+   const std::string longText(ErrorDetail::INLINE_CAPACITY * 2, 'x');
+   Error error(TestError::FIRST, ErrorDetail::compose(longText));
+   ASSERT_EQ(error.furtherInfo().value().size(), ErrorDetail::INLINE_CAPACITY)
+       << "Error detail was not truncated to the inline capacity";
+}
+
+TEST(Error, MissingDetail)
+{
+   Error error(TestError::FIRST);
+   ASSERT_FALSE(error.furtherInfo().has_value());
+}
+
+TEST(Result, Value)
+{
+   Result<int, TestError> result(3);
+   ASSERT_TRUE(result.hasValue());
+   ASSERT_FALSE(result.hasError());
+   ASSERT_EQ(result.value(), 3);
+}
+
+TEST(Result, Error)
+{
+   Result<int, TestError> result = Error(TestError::SECOND, "Failure");
+   ASSERT_TRUE(result.hasError());
+   ASSERT_EQ(result.error(), TestError::SECOND);
+   ASSERT_EQ(std::move(result).valueOr(7), 7);
+}
+
+TEST(Result, Void)
+{
+   Result<void, TestError> success;
+   ASSERT_TRUE(success.hasValue());
+
+   Result<void, TestError> failure = Error(TestError::FIRST, "Failure");
+   ASSERT_TRUE(failure.hasError());
+   ASSERT_EQ(failure.error(), TestError::FIRST);
+}
+
+TEST(Result, MoveOnly)
+{
+   static_assert(!std::is_copy_constructible_v<Result<void, TestError>>);
+   static_assert(std::is_nothrow_move_constructible_v<Result<void, TestError>>);
+
+   auto value = std::make_unique<int>(5);
+   Result<std::unique_ptr<int>, TestError> result(std::move(value));
+   auto moved = std::move(result);
+   ASSERT_EQ(*moved.value(), 5);
+}
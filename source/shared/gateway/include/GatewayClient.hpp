@@ -0,0 +1,48 @@
+#ifndef GATEWAYCLIENT_HPP
+#define GATEWAYCLIENT_HPP
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "GatewayProtocol.hpp"
+#include "Result.hpp"
+
+// Receives the frames of every component a client is interested in from a gateway, over a single
+// connection. The callback is called from a thread of the client
+class GatewayClient final
+{
+public:
+   using Callback = std::function<void(std::string_view component, std::string_view topic,
+                                       std::string_view payload)>;
+
+   GatewayClient() = default;
+   GatewayClient(const GatewayClient& client) = delete;
+   GatewayClient(GatewayClient&& client) = delete;
+   auto operator=(const GatewayClient& client) = delete;
+   auto operator=(GatewayClient&& client) = delete;
+
+   [[nodiscard]] Result<void, GatewayError> connect(const std::string& host, unsigned int port,
+                                                    const std::vector<GatewayFilter>& filters,
+                                                    const Callback& callback);
+
+   void close() noexcept;
+
+   [[nodiscard]] inline bool connected() const noexcept
+   {
+      return mSocket >= 0;
+   }
+
+   ~GatewayClient();
+
+private:
+   int mSocket = -1;
+   std::unique_ptr<std::thread> mThread;
+
+   void receive(const Callback& callback) const;
+};
+
+#endif // GATEWAYCLIENT_HPP
@@ -0,0 +1,91 @@
+#ifndef GATEWAYPROTOCOL_HPP
+#define GATEWAYPROTOCOL_HPP
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+enum class GatewayError
+{
+   UNABLE_TO_LISTEN,
+   UNABLE_TO_CONNECT,
+   UNABLE_TO_SEND
+};
+
+// Clients send newline terminated filters as "<component> <topic>", where either can be "*"
+struct GatewayFilter
+{
+   static constexpr char SEPARATOR = ' ';
+   static constexpr char END = '\n';
+   static constexpr std::string_view WILDCARD = "*";
+
+   std::string component;
+   std::string topic;
+
+   [[nodiscard]] inline bool matches(const std::string_view frameComponent,
+                                     const std::string_view frameTopic) const noexcept
+   {
+      return (component == WILDCARD || component == frameComponent) &&
+             (topic == WILDCARD || topic == frameTopic);
+   }
+
+   [[nodiscard]] inline std::string line() const
+   {
+      return component + SEPARATOR + topic + END;
+   }
+
+   // Parses a line without its terminator
+   [[nodiscard]] static inline std::optional<GatewayFilter> parse(const std::string_view line)
+   {
+      const auto separator = line.find(SEPARATOR);
+      if (separator == std::string_view::npos || separator == 0 || separator + 1 == line.size())
+      {
+         return std::nullopt;
+      }
+
+      return GatewayFilter{std::string(line.substr(0, separator)),
+                           std::string(line.substr(separator + 1))};
+   }
+};
+
+// The gateway sends the frames matching any filter of a session as a 4 bytes big endian length
+// followed by "<component>/<topic>#<payload>"
+struct GatewayFrame
+{
+   static constexpr char COMPONENT_SEPARATOR = '/';
+   static constexpr char TOPIC_DELIMITER = '#';
+   static constexpr std::size_t LENGTH_SIZE = 4;
+   // Longer frames are never sent, a client reading a larger length is not talking to a gateway
+   static constexpr std::size_t MAX_SIZE = 4 << 20;
+
+   using Length = std::array<char, LENGTH_SIZE>;
+
+   [[nodiscard]] static inline Length encodeLength(const std::uint32_t length) noexcept
+   {
+      Length encoded{};
+      for (std::size_t index = 0; index < LENGTH_SIZE; index++)
+      {
+         encoded[index] = static_cast<char>((length >> (BYTE_BITS * (LENGTH_SIZE - 1 - index))) &
+                                            BYTE_MASK);
+      }
+      return encoded;
+   }
+
+   [[nodiscard]] static inline std::uint32_t decodeLength(const Length& encoded) noexcept
+   {
+      std::uint32_t length = 0;
+      for (const auto byte : encoded)
+      {
+         length = (length << BYTE_BITS) | static_cast<std::uint8_t>(byte);
+      }
+      return length;
+   }
+
+private:
+   static constexpr unsigned int BYTE_BITS = 8;
+   static constexpr std::uint32_t BYTE_MASK = 0xff;
+};
+
+#endif // GATEWAYPROTOCOL_HPP
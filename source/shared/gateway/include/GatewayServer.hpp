@@ -0,0 +1,95 @@
+#ifndef GATEWAYSERVER_HPP
+#define GATEWAYSERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GatewayProtocol.hpp"
+#include "Result.hpp"
+
+// Serves the frames of many components to many clients over one connection per client, each
+// client only getting what its filters match. Frames are routed by looking up who wants a
+// component and topic once, and queued per session so that a slow client only drops its own
+// frames instead of holding everyone back
+class GatewayServer final
+{
+public:
+   // Frames queued for a session beyond this are dropped until it catches up
+   static constexpr std::size_t MAX_PENDING_BYTES = 4 << 20;
+
+   GatewayServer() = default;
+   GatewayServer(const GatewayServer& server) = delete;
+   GatewayServer(GatewayServer&& server) = delete;
+   auto operator=(const GatewayServer& server) = delete;
+   auto operator=(GatewayServer&& server) = delete;
+
+   [[nodiscard]] Result<void, GatewayError> listen(unsigned int port);
+
+   // Queues a frame ("<topic>#<payload>") of component for the sessions it matches. Thread safe
+   void dispatch(const std::string& component, std::string_view frame);
+
+   // Accepts clients, reads their filters and sends their frames, waiting at most timeout for
+   // something to happen. Meant to be called in a loop from a single thread
+   void poll(std::chrono::milliseconds timeout);
+
+   void close() noexcept;
+
+   [[nodiscard]] std::size_t sessions() const;
+
+   // The port actually listened on, the one picked by the system when listening on port 0
+   [[nodiscard]] unsigned int port() const noexcept;
+
+   [[nodiscard]] inline std::uint64_t dropped() const noexcept
+   {
+      return mDropped;
+   }
+
+   ~GatewayServer();
+
+private:
+   static constexpr std::size_t READ_SIZE = 4096;
+   // Filter lines longer than this are not filters
+   static constexpr std::size_t MAX_FILTER_SIZE = 1024;
+
+   struct Session
+   {
+      std::string input;
+      std::vector<GatewayFilter> filters;
+      // What was not sent yet, the part that was is dropped after every write
+      std::string output;
+   };
+
+   // Allows looking topics up by string_view, without building a string for every frame
+   struct StringHash
+   {
+      using is_transparent = void;
+
+      [[nodiscard]] inline std::size_t operator()(const std::string_view text) const noexcept
+      {
+         return std::hash<std::string_view>{}(text);
+      }
+   };
+
+   using Routes = std::unordered_map<std::string, std::vector<int>, StringHash, std::equal_to<>>;
+
+   int mListener = -1;
+   int mWake = -1;
+   mutable std::mutex mMutex;
+   std::map<int, Session> mSessions;
+   // component -> topic -> sessions, filled as frames come and cleared when filters change
+   std::unordered_map<std::string, Routes, StringHash, std::equal_to<>> mRoutes;
+   std::atomic<std::uint64_t> mDropped = 0;
+
+   void accept();
+   [[nodiscard]] bool read(int socket, Session& session);
+   [[nodiscard]] bool write(int socket, Session& session);
+   void wake() const noexcept;
+};
+
+#endif // GATEWAYSERVER_HPP
@@ -0,0 +1,136 @@
+#include "GatewayClient.hpp"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+bool receiveAll(const int socket, char* buffer, std::size_t size) noexcept
+{
+   while (size > 0)
+   {
+      const auto received = recv(socket, buffer, size, 0);
+      if (received <= 0)
+      {
+         return false;
+      }
+      buffer += received;
+      size -= static_cast<std::size_t>(received);
+   }
+   return true;
+}
+} // namespace
+
+Result<void, GatewayError> GatewayClient::connect(const std::string& host, const unsigned int port,
+                                                  const std::vector<GatewayFilter>& filters,
+                                                  const Callback& callback)
+{
+   close();
+
+   addrinfo hints{};
+   hints.ai_family = AF_INET;
+   hints.ai_socktype = SOCK_STREAM;
+   addrinfo* addresses = nullptr;
+   if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &addresses) != 0)
+   {
+      return Error(GatewayError::UNABLE_TO_CONNECT, "Unable to resolve the gateway address");
+   }
+
+   for (auto* address = addresses; address != nullptr && mSocket < 0; address = address->ai_next)
+   {
+      mSocket = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+      if (mSocket >= 0 && ::connect(mSocket, address->ai_addr, address->ai_addrlen) != 0)
+      {
+         ::close(mSocket);
+         mSocket = -1;
+      }
+   }
+   freeaddrinfo(addresses);
+
+   if (mSocket < 0)
+   {
+      return Error(GatewayError::UNABLE_TO_CONNECT,
+                   ErrorDetail::compose("Unable to connect to ", host, ":", port));
+   }
+
+   std::string request;
+   for (const auto& filter : filters)
+   {
+      request += filter.line();
+   }
+
+   std::size_t sent = 0;
+   while (sent < request.size())
+   {
+      const auto written =
+          send(mSocket, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+      if (written <= 0)
+      {
+         close();
+         return Error(GatewayError::UNABLE_TO_SEND, "Unable to send the filters to the gateway");
+      }
+      sent += static_cast<std::size_t>(written);
+   }
+
+   mThread = std::make_unique<std::thread>([this, callback]() { receive(callback); });
+
+   return {};
+}
+
+void GatewayClient::receive(const Callback& callback) const
+{
+   std::string frame;
+   GatewayFrame::Length length{};
+   while (receiveAll(mSocket, length.data(), length.size()))
+   {
+      const auto size = GatewayFrame::decodeLength(length);
+      if (size > GatewayFrame::MAX_SIZE)
+      {
+         return;
+      }
+
+      frame.resize(size);
+      if (!receiveAll(mSocket, frame.data(), frame.size()))
+      {
+         return;
+      }
+
+      const std::string_view view = frame;
+      const auto separator = view.find(GatewayFrame::COMPONENT_SEPARATOR);
+      const auto delimiter = view.find(GatewayFrame::TOPIC_DELIMITER, separator);
+      if (separator == std::string_view::npos || delimiter == std::string_view::npos)
+      {
+         continue;
+      }
+
+      callback(view.substr(0, separator), view.substr(separator + 1, delimiter - separator - 1),
+               view.substr(delimiter + 1));
+   }
+}
+
+void GatewayClient::close() noexcept
+{
+   if (mSocket >= 0)
+   {
+      // Unblocks the receiving thread before joining it
+      shutdown(mSocket, SHUT_RDWR);
+   }
+
+   if (mThread)
+   {
+      mThread->join();
+      mThread.reset();
+   }
+
+   if (mSocket >= 0)
+   {
+      ::close(mSocket);
+      mSocket = -1;
+   }
+}
+
+GatewayClient::~GatewayClient()
+{
+   close();
+}
@@ -0,0 +1,308 @@
+#include "GatewayServer.hpp"
+
+#include <arpa/inet.h>
+#include <array>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+bool setNonBlocking(const int socket) noexcept
+{
+   const auto flags = fcntl(socket, F_GETFL, 0);
+   return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+} // namespace
+
+Result<void, GatewayError> GatewayServer::listen(const unsigned int port)
+{
+   close();
+
+   mListener = socket(AF_INET, SOCK_STREAM, 0);
+   if (mListener < 0)
+   {
+      return Error(GatewayError::UNABLE_TO_LISTEN, "Unable to create the listening socket");
+   }
+
+   const int reuse = 1;
+   setsockopt(mListener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+   sockaddr_in address{};
+   address.sin_family = AF_INET;
+   address.sin_addr.s_addr = htonl(INADDR_ANY);
+   address.sin_port = htons(static_cast<std::uint16_t>(port));
+
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+   if (bind(mListener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+       ::listen(mListener, SOMAXCONN) != 0 || !setNonBlocking(mListener))
+   {
+      close();
+      return Error(GatewayError::UNABLE_TO_LISTEN,
+                   ErrorDetail::compose("Unable to listen on port ", port));
+   }
+
+   mWake = eventfd(0, EFD_NONBLOCK);
+   if (mWake < 0)
+   {
+      close();
+      return Error(GatewayError::UNABLE_TO_LISTEN, "Unable to create the wake up event");
+   }
+
+   return {};
+}
+
+void GatewayServer::dispatch(const std::string& component, const std::string_view frame)
+{
+   const auto delimiter = frame.find(GatewayFrame::TOPIC_DELIMITER);
+   if (delimiter == std::string_view::npos || delimiter == 0)
+   {
+      return;
+   }
+   const auto topic = frame.substr(0, delimiter);
+
+   const auto size = component.size() + 1 + frame.size();
+   if (size > GatewayFrame::MAX_SIZE)
+   {
+      mDropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
+   const auto length = GatewayFrame::encodeLength(static_cast<std::uint32_t>(size));
+
+   bool queued = false;
+   {
+      std::lock_guard lock(mMutex);
+
+      auto& routes = mRoutes[component];
+      auto route = routes.find(topic);
+      if (route == routes.end())
+      {
+         std::vector<int> targets;
+         for (const auto& [socket, session] : mSessions)
+         {
+            for (const auto& filter : session.filters)
+            {
+               if (filter.matches(component, topic))
+               {
+                  targets.push_back(socket);
+                  break;
+               }
+            }
+         }
+         route = routes.emplace(std::string(topic), std::move(targets)).first;
+      }
+
+      for (const auto socket : route->second)
+      {
+         auto& session = mSessions.at(socket);
+         if (session.output.size() + GatewayFrame::LENGTH_SIZE + size > MAX_PENDING_BYTES)
+         {
+            mDropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+         }
+
+         session.output.append(length.data(), length.size());
+         session.output.append(component);
+         session.output.push_back(GatewayFrame::COMPONENT_SEPARATOR);
+         session.output.append(frame);
+         queued = true;
+      }
+   }
+
+   if (queued)
+   {
+      wake();
+   }
+}
+
+void GatewayServer::poll(const std::chrono::milliseconds timeout)
+{
+   if (mListener < 0)
+   {
+      return;
+   }
+
+   std::vector<pollfd> descriptors;
+   {
+      std::lock_guard lock(mMutex);
+      descriptors.reserve(mSessions.size() + 2);
+      descriptors.push_back({mListener, POLLIN, 0});
+      descriptors.push_back({mWake, POLLIN, 0});
+      for (const auto& [socket, session] : mSessions)
+      {
+         const short events = session.output.empty() ? POLLIN : POLLIN | POLLOUT;
+         descriptors.push_back({socket, events, 0});
+      }
+   }
+
+   if (::poll(descriptors.data(), descriptors.size(), static_cast<int>(timeout.count())) <= 0)
+   {
+      return;
+   }
+
+   if ((descriptors[1].revents & POLLIN) != 0)
+   {
+      std::uint64_t counter = 0;
+      [[maybe_unused]] const auto drained = ::read(mWake, &counter, sizeof(counter));
+   }
+
+   if ((descriptors[0].revents & POLLIN) != 0)
+   {
+      accept();
+   }
+
+   std::lock_guard lock(mMutex);
+   for (auto descriptor = descriptors.begin() + 2; descriptor != descriptors.end(); descriptor++)
+   {
+      auto session = mSessions.find(descriptor->fd);
+      if (session == mSessions.end())
+      {
+         continue;
+      }
+
+      bool alive = (descriptor->revents & (POLLERR | POLLNVAL)) == 0;
+      if (alive && (descriptor->revents & (POLLIN | POLLHUP)) != 0)
+      {
+         alive = read(descriptor->fd, session->second) &&
+                 session->second.input.size() <= MAX_FILTER_SIZE;
+      }
+      // Frames queued after the poll started are sent right away as well
+      if (alive && !session->second.output.empty())
+      {
+         alive = write(descriptor->fd, session->second);
+      }
+
+      if (!alive)
+      {
+         ::close(descriptor->fd);
+         mSessions.erase(session);
+         mRoutes.clear();
+      }
+   }
+}
+
+void GatewayServer::accept()
+{
+   while (true)
+   {
+      const int socket = ::accept(mListener, nullptr, nullptr);
+      if (socket < 0)
+      {
+         return;
+      }
+
+      if (!setNonBlocking(socket))
+      {
+         ::close(socket);
+         continue;
+      }
+
+      std::lock_guard lock(mMutex);
+      mSessions.try_emplace(socket);
+   }
+}
+
+bool GatewayServer::read(const int socket, Session& session)
+{
+   std::array<char, READ_SIZE> buffer{};
+   ssize_t received = 0;
+   while ((received = recv(socket, buffer.data(), buffer.size(), 0)) > 0)
+   {
+      session.input.append(buffer.data(), static_cast<std::size_t>(received));
+   }
+   if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+   {
+      return false;
+   }
+
+   std::size_t end = 0;
+   while ((end = session.input.find(GatewayFilter::END)) != std::string::npos)
+   {
+      if (auto filter = GatewayFilter::parse(std::string_view(session.input).substr(0, end)))
+      {
+         session.filters.push_back(std::move(filter.value()));
+         mRoutes.clear();
+      }
+      session.input.erase(0, end + 1);
+   }
+
+   return true;
+}
+
+bool GatewayServer::write(const int socket, Session& session)
+{
+   std::size_t written = 0;
+   bool alive = true;
+   while (written < session.output.size())
+   {
+      const auto sent = send(socket, session.output.data() + written,
+                             session.output.size() - written, MSG_NOSIGNAL);
+      if (sent < 0)
+      {
+         alive = errno == EAGAIN || errno == EWOULDBLOCK;
+         break;
+      }
+      written += static_cast<std::size_t>(sent);
+   }
+
+   // A client that keeps up only partially would otherwise have everything it got kept around
+   session.output.erase(0, written);
+   return alive;
+}
+
+void GatewayServer::wake() const noexcept
+{
+   if (mWake >= 0)
+   {
+      const std::uint64_t counter = 1;
+      [[maybe_unused]] const auto written = ::write(mWake, &counter, sizeof(counter));
+   }
+}
+
+std::size_t GatewayServer::sessions() const
+{
+   std::lock_guard lock(mMutex);
+   return mSessions.size();
+}
+
+unsigned int GatewayServer::port() const noexcept
+{
+   sockaddr_in address{};
+   socklen_t size = sizeof(address);
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+   if (mListener < 0 || getsockname(mListener, reinterpret_cast<sockaddr*>(&address), &size) != 0)
+   {
+      return 0;
+   }
+   return ntohs(address.sin_port);
+}
+
+void GatewayServer::close() noexcept
+{
+   std::lock_guard lock(mMutex);
+   for (const auto& [socket, session] : mSessions)
+   {
+      ::close(socket);
+   }
+   mSessions.clear();
+   mRoutes.clear();
+
+   if (mListener >= 0)
+   {
+      ::close(mListener);
+      mListener = -1;
+   }
+   if (mWake >= 0)
+   {
+      ::close(mWake);
+      mWake = -1;
+   }
+}
+
+GatewayServer::~GatewayServer()
+{
+   close();
+}
@@ -0,0 +1,123 @@
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "GatewayClient.hpp"
+#include "GatewayServer.hpp"
+
+namespace {
+struct Received
+{
+   std::mutex mutex;
+   std::vector<std::string> frames;
+
+   void add(const std::string_view component, const std::string_view topic,
+            const std::string_view payload)
+   {
+      std::lock_guard lock(mutex);
+      frames.push_back(std::string(component) + "/" + std::string(topic) + "#" +
+                       std::string(payload));
+   }
+
+   std::size_t size()
+   {
+      std::lock_guard lock(mutex);
+      return frames.size();
+   }
+};
+
+void waitFor(const std::function<bool()>& condition)
+{
+   using namespace std::chrono_literals;
+   for (unsigned int i = 0; i < 500 && !condition(); i++)
+   {
+      std::this_thread::sleep_for(10ms);
+   }
+}
+} // namespace
+
+TEST(Gateway, Protocol)
+{
+   ASSERT_EQ(GatewayFrame::decodeLength(GatewayFrame::encodeLength(0)), 0);
+   ASSERT_EQ(GatewayFrame::decodeLength(GatewayFrame::encodeLength(0x01020304)), 0x01020304);
+
+   auto filter = GatewayFilter::parse("Temperature *");
+   ASSERT_TRUE(filter.has_value());
+   ASSERT_TRUE(filter->matches("Temperature", "TEMPERATURE"));
+   ASSERT_FALSE(filter->matches("Storage", "TEMPERATURE"));
+   ASSERT_EQ(filter->line(), "Temperature *\n");
+
+   ASSERT_FALSE(GatewayFilter::parse("Temperature").has_value());
+   ASSERT_FALSE(GatewayFilter::parse(" TEMPERATURE").has_value());
+   ASSERT_FALSE(GatewayFilter::parse("Temperature ").has_value());
+}
+
+TEST(Gateway, Filtering)
+{
+   using namespace std::chrono_literals;
+
+   GatewayServer server;
+   // Whatever port is free, the one picked is read back
+   ASSERT_TRUE(server.listen(0));
+   const auto port = server.port();
+   ASSERT_NE(port, 0);
+
+   std::atomic<bool> run = true;
+   std::thread poller([&server, &run]() {
+      while (run)
+      {
+         server.poll(10ms);
+      }
+   });
+
+   Received filtered;
+   Received everything;
+   GatewayClient filteredClient;
+   GatewayClient everythingClient;
+   ASSERT_TRUE(filteredClient.connect(
+       "127.0.0.1", port, {{"Temperature", "TEMPERATURE"}},
+       [&filtered](auto component, auto topic, auto payload) {
+          filtered.add(component, topic, payload);
+       }));
+   ASSERT_TRUE(everythingClient.connect(
+       "127.0.0.1", port, {{"*", "*"}}, [&everything](auto component, auto topic, auto payload) {
+          everything.add(component, topic, payload);
+       }));
+
+   waitFor([&server]() { return server.sessions() == 2; });
+   ASSERT_EQ(server.sessions(), 2);
+   // Filters are read by the poller right after the connection
+   std::this_thread::sleep_for(100ms);
+
+   constexpr unsigned int FRAMES = 1000;
+   for (unsigned int i = 0; i < FRAMES; i++)
+   {
+      server.dispatch("Temperature", "TEMPERATURE#" + std::to_string(i));
+      server.dispatch("Temperature", "HUMIDITY#" + std::to_string(i));
+      server.dispatch("Storage", "TEMPERATURE#" + std::to_string(i));
+   }
+
+   waitFor([&filtered, &everything]() {
+      return filtered.size() == FRAMES && everything.size() == 3 * FRAMES;
+   });
+   ASSERT_EQ(filtered.size(), FRAMES);
+   ASSERT_EQ(everything.size(), 3 * FRAMES);
+   ASSERT_EQ(server.dropped(), 0);
+
+   for (unsigned int i = 0; i < FRAMES; i++)
+   {
+      ASSERT_EQ(filtered.frames[i], "Temperature/TEMPERATURE#" + std::to_string(i));
+      ASSERT_EQ(everything.frames[3 * i + 2], "Storage/TEMPERATURE#" + std::to_string(i));
+   }
+
+   filteredClient.close();
+   waitFor([&server]() { return server.sessions() == 1; });
+   ASSERT_EQ(server.sessions(), 1);
+
+   run = false;
+   poller.join();
+}
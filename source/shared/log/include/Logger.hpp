@@ -1,9 +1,16 @@
 #ifndef LOGGER_HPP
 #define LOGGER_HPP
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <mutex>
 #include <spdlog/logger.h>
 #include <spdlog/pattern_formatter.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
+#include <type_traits>
+#include <vector>
 
 class Logger final
 {
@@ -50,6 +57,103 @@ private:
 public:
    using Level = spdlog::level::level_enum;
 
+   // Lets through at most a fixed amount of messages for every time window, counting the ones it
+   // drops. It is meant to be kept per call site (see GROW_LOG_RATE_LIMITED) and never blocks: under
+   // contention the limit is approximate
+   class RateLimiter final
+   {
+   public:
+      using Clock = std::chrono::steady_clock;
+
+      RateLimiter() = delete;
+      explicit inline RateLimiter(const unsigned int maxPerPeriod,
+                                  const Clock::duration& period = std::chrono::seconds(1)) noexcept
+          : mMaxPerPeriod{maxPerPeriod}, mPeriod{period.count()}
+      {
+      }
+
+      [[nodiscard]] inline bool allow(std::uint64_t& suppressed) noexcept
+      {
+         return allow(Clock::now(), suppressed);
+      }
+
+      [[nodiscard]] inline bool allow(const Clock::time_point& now, std::uint64_t& suppressed) noexcept
+      {
+         const auto nowTicks = now.time_since_epoch().count();
+         auto windowStart = mWindowStart.load(std::memory_order_acquire);
+         if (nowTicks - windowStart >= mPeriod &&
+             mWindowStart.compare_exchange_strong(windowStart, nowTicks, std::memory_order_acq_rel))
+         {
+            mCount.store(0, std::memory_order_release);
+         }
+
+         if (mCount.fetch_add(1, std::memory_order_acq_rel) < mMaxPerPeriod)
+         {
+            suppressed = mSuppressed.exchange(0, std::memory_order_acq_rel);
+            return true;
+         }
+
+         mSuppressed.fetch_add(1, std::memory_order_relaxed);
+         return false;
+      }
+
+      // What was dropped in a window that is over by now, so that a burst that stops is reported
+      // without waiting for the next message. Zero while the window lasts
+      [[nodiscard]] inline std::uint64_t expired(const Clock::time_point& now) noexcept
+      {
+         const auto nowTicks = now.time_since_epoch().count();
+         if (nowTicks - mWindowStart.load(std::memory_order_acquire) < mPeriod)
+         {
+            return 0;
+         }
+
+         return mSuppressed.exchange(0, std::memory_order_acq_rel);
+      }
+
+      // True only the first time, for the logger to start tracking it
+      [[nodiscard]] inline bool track() noexcept
+      {
+         return !mTracked.test_and_set(std::memory_order_acq_rel);
+      }
+
+   private:
+      const unsigned int mMaxPerPeriod;
+      const Clock::rep mPeriod;
+      std::atomic<Clock::rep> mWindowStart = std::numeric_limits<Clock::rep>::min() / 2;
+      std::atomic<unsigned int> mCount = 0;
+      std::atomic<std::uint64_t> mSuppressed = 0;
+      std::atomic_flag mTracked = ATOMIC_FLAG_INIT;
+   };
+
+   // Lets through one message every sampleRate, counting the ones it drops. As RateLimiter it is
+   // meant to be kept per call site (see GROW_LOG_SAMPLED)
+   class Sampler final
+   {
+   public:
+      Sampler() = delete;
+      explicit inline Sampler(const unsigned int sampleRate) noexcept
+          : mSampleRate{sampleRate == 0 ? 1 : sampleRate}
+      {
+      }
+
+      [[nodiscard]] inline bool allow(std::uint64_t& suppressed) noexcept
+      {
+         if (mCounter.fetch_add(1, std::memory_order_relaxed) % mSampleRate == 0)
+         {
+            suppressed = mSuppressed.exchange(0, std::memory_order_acq_rel);
+            return true;
+         }
+
+         mSuppressed.fetch_add(1, std::memory_order_relaxed);
+         return false;
+      }
+
+   private:
+      const unsigned int mSampleRate;
+      std::atomic<std::uint64_t> mCounter = 0;
+      std::atomic<std::uint64_t> mSuppressed = 0;
+   };
+
    inline Logger() : Logger("general"){};
    explicit Logger(const std::string& name);
    Logger(const Logger& config) = delete;
@@ -66,6 +170,51 @@ public:
       }
    }
 
+   // Logs through a rate limiter or a sampler, the first message let through after some were
+   // dropped is followed by a summary of how many of them were suppressed
+   template <class Filter, typename... Args>
+   inline void log(Filter& filter, const Level& level, const std::string& msg, Args... args)
+   {
+      if (!mInitialized || !mLogger->should_log(level))
+      {
+         return;
+      }
+
+      if constexpr (std::is_same_v<Filter, RateLimiter>)
+      {
+         if (filter.track())
+         {
+            std::lock_guard lock(mLimitersMutex);
+            mLimiters.push_back({&filter, level, msg});
+         }
+      }
+
+      std::uint64_t suppressed = 0;
+      if (filter.allow(suppressed))
+      {
+         mLogger->log(level, msg, args...);
+         if (suppressed > 0)
+         {
+            mLogger->log(level, "Previous message was suppressed {} times", suppressed);
+         }
+      }
+   }
+
+   // Reports what the rate limiters of this logger dropped in windows that are over by now. Meant
+   // to be called periodically, components do it from their thread
+   inline void reportSuppressed(
+       const RateLimiter::Clock::time_point& now = RateLimiter::Clock::now())
+   {
+      std::lock_guard lock(mLimitersMutex);
+      for (const auto& tracked : mLimiters)
+      {
+         if (const auto suppressed = tracked.limiter->expired(now); suppressed > 0)
+         {
+            log(tracked.level, "Message \"{}\" was suppressed {} times", tracked.msg, suppressed);
+         }
+      }
+   }
+
    template <typename... Args> inline void trace(const std::string& msg, Args... args)
    {
       log(Level::trace, msg, args...);
@@ -125,6 +274,34 @@ public:
    }
 
    ~Logger() = default;
+
+private:
+   // Rate limiters live as long as the program (see GROW_LOG_RATE_LIMITED), they are tracked along
+   // with the message they limit
+   struct TrackedLimiter
+   {
+      RateLimiter* limiter = nullptr;
+      Level level = Level::info;
+      std::string msg;
+   };
+
+   std::mutex mLimitersMutex;
+   std::vector<TrackedLimiter> mLimiters;
 };
 
+// Every expansion owns its own static filter, so suppression is tracked per call site
+#define GROW_LOG_RATE_LIMITED(logger, level, maxPerSecond, ...)                                     \
+   do                                                                                              \
+   {                                                                                               \
+      static Logger::RateLimiter growCallSiteLimiter{maxPerSecond};                                \
+      (logger).log(growCallSiteLimiter, level, __VA_ARGS__);                                       \
+   } while (false)
+
+#define GROW_LOG_SAMPLED(logger, level, sampleRate, ...)                                            \
+   do                                                                                              \
+   {                                                                                               \
+      static Logger::Sampler growCallSiteSampler{sampleRate};                                      \
+      (logger).log(growCallSiteSampler, level, __VA_ARGS__);                                       \
+   } while (false)
+
 #endif // LOGGER_HPP
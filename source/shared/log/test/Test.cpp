@@ -0,0 +1,97 @@
+#include <sstream>
+
+#include <spdlog/sinks/ostream_sink.h>
+#include <spdlog/spdlog.h>
+
+#include "gtest/gtest.h"
+
+#include "Logger.hpp"
+
+TEST(Logger, RateLimiter)
+{
+   constexpr unsigned int maxPerPeriod = 3;
+   constexpr unsigned int attempts = 10;
+   Logger::RateLimiter limiter{maxPerPeriod, std::chrono::seconds(1)};
+   const auto now = Logger::RateLimiter::Clock::now();
+
+   std::uint64_t suppressed = 0;
+   unsigned int allowed = 0;
+   for (unsigned int i = 0; i < attempts; i++)
+   {
+      if (limiter.allow(now, suppressed))
+      {
+         allowed++;
+      }
+   }
+   ASSERT_EQ(allowed, maxPerPeriod) << "Rate limiter let through too many messages";
+
+   ASSERT_TRUE(limiter.allow(now + std::chrono::seconds(1), suppressed))
+       << "Rate limiter did not open a new window";
+   ASSERT_EQ(suppressed, attempts - maxPerPeriod) << "Suppressed messages were not counted";
+}
+
+TEST(Logger, Sampler)
+{
+   constexpr unsigned int sampleRate = 4;
+   Logger::Sampler sampler{sampleRate};
+
+   std::uint64_t suppressed = 0;
+   unsigned int allowed = 0;
+   for (unsigned int i = 0; i < sampleRate * 2; i++)
+   {
+      if (sampler.allow(suppressed))
+      {
+         allowed++;
+      }
+   }
+   ASSERT_EQ(allowed, 2) << "Sampler did not let through one message every " << sampleRate;
+   ASSERT_EQ(suppressed, sampleRate - 1) << "Suppressed messages were not counted";
+}
+
+namespace {
+std::size_t occurrences(const std::string& text, const std::string& pattern)
+{
+   std::size_t count = 0;
+   for (auto found = text.find(pattern); found != std::string::npos;
+        found = text.find(pattern, found + pattern.size()))
+   {
+      count++;
+   }
+   return count;
+}
+} // namespace
+
+TEST(Logger, RateLimitedMacro)
+{
+   const std::string name = "rate_limited_test";
+   Logger logger{name};
+   std::ostringstream output;
+   spdlog::get(name)->sinks() = {std::make_shared<spdlog::sinks::ostream_sink_mt>(output)};
+
+   constexpr unsigned int attempts = 6;
+   for (unsigned int i = 0; i < attempts; i++)
+   {
+      GROW_LOG_RATE_LIMITED(logger, Logger::Level::err, 1, "Limited {}", i);
+      GROW_LOG_SAMPLED(logger, Logger::Level::err, 2, "Sampled {}", i);
+   }
+
+   ASSERT_EQ(occurrences(output.str(), "Limited "), 1) << "Rate limiter let through too many";
+   ASSERT_EQ(occurrences(output.str(), "Limited 0"), 1);
+   ASSERT_EQ(occurrences(output.str(), "Sampled "), attempts / 2);
+   ASSERT_EQ(occurrences(output.str(), "Previous message was suppressed 1 times"), 2)
+       << "Sampler did not report what it dropped in between";
+
+   // The burst stopped, what was dropped is reported once its window is over
+   logger.reportSuppressed();
+   ASSERT_EQ(occurrences(output.str(), "suppressed 5 times"), 0) << "Reported too early";
+   logger.reportSuppressed(Logger::RateLimiter::Clock::now() + std::chrono::seconds(2));
+   ASSERT_EQ(occurrences(output.str(), "Message \"Limited {}\" was suppressed 5 times"), 1);
+   logger.reportSuppressed(Logger::RateLimiter::Clock::now() + std::chrono::seconds(4));
+   ASSERT_EQ(occurrences(output.str(), "suppressed 5 times"), 1) << "Reported twice";
+
+   // Nothing logged at all below the level
+   output.str("");
+   logger.setLevel(Logger::Level::off);
+   GROW_LOG_RATE_LIMITED(logger, Logger::Level::err, 1, "Limited");
+   ASSERT_TRUE(output.str().empty());
+}
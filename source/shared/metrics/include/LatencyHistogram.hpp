@@ -0,0 +1,115 @@
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+
+// Log-linear histogram of durations (every power of two is split in SUB_BUCKETS, so values are kept
+// within ~3% of their real size). Recording is lock-free and it never allocates, so it can be fed
+// straight from pub/sub callbacks
+class LatencyHistogram final
+{
+public:
+   using Duration = std::chrono::nanoseconds;
+
+   LatencyHistogram() = default;
+   LatencyHistogram(const LatencyHistogram& histogram) = delete;
+   LatencyHistogram(const LatencyHistogram&& histogram) = delete;
+   auto operator=(const LatencyHistogram& histogram) = delete;
+   auto operator=(const LatencyHistogram&& histogram) = delete;
+
+   inline void record(const Duration& duration) noexcept
+   {
+      const auto value = static_cast<std::uint64_t>(std::max(duration.count(), Duration::rep{0}));
+      mBuckets[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+      mCount.fetch_add(1, std::memory_order_relaxed);
+
+      auto max = mMax.load(std::memory_order_relaxed);
+      while (value > max && !mMax.compare_exchange_weak(max, value, std::memory_order_relaxed))
+      {
+      }
+   }
+
+   [[nodiscard]] inline std::uint64_t count() const noexcept
+   {
+      return mCount.load(std::memory_order_relaxed);
+   }
+
+   [[nodiscard]] inline Duration max() const noexcept
+   {
+      return Duration(mMax.load(std::memory_order_relaxed));
+   }
+
+   // The duration below which the given fraction (from 0 to 1) of the recorded ones fall
+   [[nodiscard]] inline Duration percentile(const double fraction) const noexcept
+   {
+      const auto total = count();
+      if (total == 0)
+      {
+         return Duration::zero();
+      }
+
+      const auto target = static_cast<std::uint64_t>(fraction * static_cast<double>(total));
+      std::uint64_t seen = 0;
+      for (std::size_t i = 0; i < BUCKETS; i++)
+      {
+         seen += mBuckets[i].load(std::memory_order_relaxed);
+         if (seen > target)
+         {
+            return Duration(static_cast<Duration::rep>(std::min(midpoint(i), mMax.load())));
+         }
+      }
+
+      return max();
+   }
+
+   inline void reset() noexcept
+   {
+      for (auto& bucket : mBuckets)
+      {
+         bucket.store(0, std::memory_order_relaxed);
+      }
+      mCount.store(0, std::memory_order_relaxed);
+      mMax.store(0, std::memory_order_relaxed);
+   }
+
+   ~LatencyHistogram() = default;
+
+private:
+   static constexpr unsigned int SUB_BUCKET_BITS = 5;
+   static constexpr std::uint64_t SUB_BUCKETS = 1U << SUB_BUCKET_BITS;
+   static constexpr std::size_t BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+   std::array<std::atomic<std::uint64_t>, BUCKETS> mBuckets{};
+   std::atomic<std::uint64_t> mCount = 0;
+   std::atomic<std::uint64_t> mMax = 0;
+
+   [[nodiscard]] static constexpr inline std::size_t bucket(const std::uint64_t value) noexcept
+   {
+      if (value < SUB_BUCKETS)
+      {
+         return value;
+      }
+
+      const auto shift = static_cast<unsigned int>(std::bit_width(value)) - 1 - SUB_BUCKET_BITS;
+      return (shift + 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+   }
+
+   [[nodiscard]] static constexpr inline std::uint64_t midpoint(const std::size_t bucket) noexcept
+   {
+      if (bucket < SUB_BUCKETS)
+      {
+         return bucket;
+      }
+
+      const auto shift = bucket / SUB_BUCKETS - 1;
+      const auto lower = (bucket % SUB_BUCKETS + SUB_BUCKETS) << shift;
+      return lower + ((std::uint64_t{1} << shift) >> 1);
+   }
+};
+
+#endif // LATENCYHISTOGRAM_HPP
@@ -0,0 +1,19 @@
+#ifndef PROCESSSTATS_HPP
+#define PROCESSSTATS_HPP
+
+#include <chrono>
+#include <cstddef>
+
+// Resources used by the current process so far, as reported by the kernel
+struct ProcessStats
+{
+   std::chrono::microseconds userCpu{0};
+   std::chrono::microseconds systemCpu{0};
+   std::size_t residentBytes = 0;
+   std::size_t peakResidentBytes = 0;
+   unsigned int threads = 0;
+
+   [[nodiscard]] static ProcessStats current() noexcept;
+};
+
+#endif // PROCESSSTATS_HPP
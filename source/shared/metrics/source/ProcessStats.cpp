@@ -0,0 +1,51 @@
+#include "ProcessStats.hpp"
+
+#include <fstream>
+#include <string>
+#include <sys/resource.h>
+
+ProcessStats ProcessStats::current() noexcept
+{
+   ProcessStats stats;
+
+   rusage usage{};
+   if (getrusage(RUSAGE_SELF, &usage) == 0)
+   {
+      constexpr long MICROSECONDS_PER_SECOND = 1000000;
+      stats.userCpu = std::chrono::microseconds(usage.ru_utime.tv_sec * MICROSECONDS_PER_SECOND +
+                                                usage.ru_utime.tv_usec);
+      stats.systemCpu = std::chrono::microseconds(usage.ru_stime.tv_sec * MICROSECONDS_PER_SECOND +
+                                                  usage.ru_stime.tv_usec);
+   }
+
+   // Memory and threads are only exposed through procfs, values there are in KiB
+   try
+   {
+      constexpr std::size_t KIBIBYTE = 1024;
+      std::ifstream status("/proc/self/status");
+      std::string field;
+      while (status >> field)
+      {
+         if (field == "VmRSS:")
+         {
+            status >> stats.residentBytes;
+            stats.residentBytes *= KIBIBYTE;
+         }
+         else if (field == "VmHWM:")
+         {
+            status >> stats.peakResidentBytes;
+            stats.peakResidentBytes *= KIBIBYTE;
+         }
+         else if (field == "Threads:")
+         {
+            status >> stats.threads;
+         }
+      }
+   }
+   catch (const std::exception& ex)
+   {
+      return stats;
+   }
+
+   return stats;
+}
@@ -0,0 +1,51 @@
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "LatencyHistogram.hpp"
+#include "ProcessStats.hpp"
+
+TEST(LatencyHistogram, Empty)
+{
+   LatencyHistogram histogram;
+   ASSERT_EQ(histogram.count(), 0);
+   ASSERT_EQ(histogram.percentile(0.5), LatencyHistogram::Duration::zero());
+}
+
+TEST(LatencyHistogram, Percentiles)
+{
+   constexpr double tolerance = 0.05;
+   LatencyHistogram histogram;
+   std::vector<std::int64_t> values;
+
+   std::mt19937 rng(42);
+   std::uniform_int_distribution<std::int64_t> dist(1000, 10000000);
+   for (unsigned int i = 0; i < 100000; i++)
+   {
+      values.push_back(dist(rng));
+      histogram.record(std::chrono::nanoseconds(values.back()));
+   }
+   std::sort(values.begin(), values.end());
+
+   ASSERT_EQ(histogram.count(), values.size());
+   ASSERT_EQ(histogram.max().count(), values.back());
+   for (auto fraction : {0.5, 0.95, 0.99})
+   {
+      const auto exact = static_cast<double>(values[static_cast<std::size_t>(
+          fraction * static_cast<double>(values.size()))]);
+      const auto estimated = static_cast<double>(histogram.percentile(fraction).count());
+      ASSERT_NEAR(estimated, exact, exact * tolerance) << "Wrong estimate for " << fraction;
+   }
+
+   histogram.reset();
+   ASSERT_EQ(histogram.count(), 0);
+}
+
+TEST(ProcessStats, Current)
+{
+   auto stats = ProcessStats::current();
+   ASSERT_GT(stats.residentBytes, 0) << "Unable to read resident memory";
+   ASSERT_GE(stats.peakResidentBytes, stats.residentBytes);
+   ASSERT_GE(stats.threads, 1);
+}
@@ -0,0 +1,120 @@
+#ifndef RECORDING_HPP
+#define RECORDING_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Result.hpp"
+
+// A capture of pub/sub traffic: a header naming the recorded components, then one record per frame
+// made of varints (source index, nanoseconds since the previous frame, size) and the raw frame
+enum class RecordingError
+{
+   UNABLE_TO_OPEN,
+   UNABLE_TO_WRITE,
+   UNABLE_TO_MAP,
+   CORRUPTED
+};
+
+struct Frame
+{
+   std::size_t source = 0;
+   // Time elapsed since the beginning of the capture
+   std::chrono::nanoseconds timestamp{};
+   std::string_view data;
+};
+
+// Appends frames to a capture file through a large buffer, so that recording costs one sequential
+// write every few thousand frames. Not thread safe
+class RecordWriter final
+{
+public:
+   using Clock = std::chrono::steady_clock;
+
+   static constexpr std::size_t BUFFER_SIZE = 1 << 20;
+
+   RecordWriter() = default;
+   RecordWriter(const RecordWriter& writer) = delete;
+   RecordWriter(RecordWriter&& writer) = delete;
+   auto operator=(const RecordWriter& writer) = delete;
+   auto operator=(RecordWriter&& writer) = delete;
+
+   // Creates the capture, replacing any previous one at path
+   [[nodiscard]] Result<void, RecordingError> open(const std::filesystem::path& path,
+                                                   const std::vector<std::string>& sources);
+
+   [[nodiscard]] Result<void, RecordingError> append(std::size_t source, Clock::time_point received,
+                                                     std::string_view frame);
+
+   [[nodiscard]] Result<void, RecordingError> flush() noexcept;
+
+   void close() noexcept;
+
+   [[nodiscard]] inline std::uint64_t frames() const noexcept
+   {
+      return mFrames;
+   }
+
+   [[nodiscard]] inline std::uint64_t bytes() const noexcept
+   {
+      return mBytes;
+   }
+
+   ~RecordWriter();
+
+private:
+   int mFile = -1;
+   std::vector<char> mBuffer;
+   std::optional<Clock::time_point> mPrevious;
+   std::uint64_t mFrames = 0;
+   std::uint64_t mBytes = 0;
+
+   void appendVarint(std::uint64_t value);
+   void appendBytes(std::string_view bytes);
+};
+
+// Iterates the frames of a memory mapped capture
+class RecordReader final
+{
+public:
+   RecordReader() = default;
+   RecordReader(const RecordReader& reader) = delete;
+   RecordReader(RecordReader&& reader) = delete;
+   auto operator=(const RecordReader& reader) = delete;
+   auto operator=(RecordReader&& reader) = delete;
+
+   [[nodiscard]] Result<void, RecordingError> open(const std::filesystem::path& path);
+
+   void close() noexcept;
+
+   [[nodiscard]] inline const std::vector<std::string>& sources() const noexcept
+   {
+      return mSources;
+   }
+
+   // Returns false at the end of the capture, or at the first truncated frame if it was cut short
+   [[nodiscard]] bool next(Frame& frame) noexcept;
+
+   // Goes back to the first frame
+   void rewind() noexcept;
+
+   ~RecordReader();
+
+private:
+   int mFile = -1;
+   std::span<const char> mMapping;
+   std::size_t mFirstFrame = 0;
+   std::size_t mPosition = 0;
+   std::chrono::nanoseconds mTimestamp{};
+   std::vector<std::string> mSources;
+
+   [[nodiscard]] bool readVarint(std::uint64_t& value) noexcept;
+};
+
+#endif // RECORDING_HPP
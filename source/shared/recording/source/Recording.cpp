@@ -0,0 +1,267 @@
+#include "Recording.hpp"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr std::string_view MAGIC = "GROWREC1";
+constexpr unsigned int VARINT_BITS = 7;
+constexpr std::uint8_t VARINT_MORE = 0x80;
+constexpr std::uint8_t VARINT_MASK = 0x7f;
+constexpr unsigned int VARINT_MAX_BYTES = 10;
+} // namespace
+
+Result<void, RecordingError> RecordWriter::open(const std::filesystem::path& path,
+                                                const std::vector<std::string>& sources)
+{
+   close();
+
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+   mFile = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                  S_IRUSR | S_IWUSR | S_IRGRP);
+   if (mFile < 0)
+   {
+      return Error(RecordingError::UNABLE_TO_OPEN,
+                   ErrorDetail::compose("Unable to open capture ", path.native()));
+   }
+
+   mBuffer.reserve(BUFFER_SIZE);
+   mBuffer.clear();
+   mPrevious.reset();
+   mFrames = 0;
+   mBytes = 0;
+
+   appendBytes(MAGIC);
+   appendVarint(sources.size());
+   for (const auto& source : sources)
+   {
+      appendVarint(source.size());
+      appendBytes(source);
+   }
+
+   return flush();
+}
+
+Result<void, RecordingError> RecordWriter::append(const std::size_t source,
+                                                  const Clock::time_point received,
+                                                  const std::string_view frame)
+{
+   if (mFile < 0)
+   {
+      return Error(RecordingError::UNABLE_TO_WRITE, "Appending to a capture that is not open");
+   }
+
+   // Frames are appended in the order they are received, a clock going backwards counts as zero
+   const auto elapsed =
+       mPrevious.has_value() ? std::max(received - mPrevious.value(), Clock::duration::zero())
+                             : Clock::duration::zero();
+   mPrevious = std::max(received, mPrevious.value_or(received));
+
+   if (mBuffer.size() + frame.size() + 3 * VARINT_MAX_BYTES > BUFFER_SIZE)
+   {
+      auto flushed = flush();
+      if (!flushed)
+      {
+         return flushed;
+      }
+   }
+
+   appendVarint(source);
+   appendVarint(static_cast<std::uint64_t>(
+       std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+   appendVarint(frame.size());
+   appendBytes(frame);
+   mFrames++;
+
+   // Frames larger than the buffer are written right away instead of growing it
+   if (mBuffer.size() >= BUFFER_SIZE)
+   {
+      return flush();
+   }
+
+   return {};
+}
+
+void RecordWriter::appendVarint(std::uint64_t value)
+{
+   while (value > VARINT_MASK)
+   {
+      mBuffer.push_back(static_cast<char>((value & VARINT_MASK) | VARINT_MORE));
+      value >>= VARINT_BITS;
+   }
+   mBuffer.push_back(static_cast<char>(value));
+}
+
+void RecordWriter::appendBytes(const std::string_view bytes)
+{
+   mBuffer.insert(mBuffer.end(), bytes.begin(), bytes.end());
+}
+
+Result<void, RecordingError> RecordWriter::flush() noexcept
+{
+   std::size_t written = 0;
+   while (written < mBuffer.size())
+   {
+      const auto result = write(mFile, mBuffer.data() + written, mBuffer.size() - written);
+      if (result < 0)
+      {
+         mBuffer.erase(mBuffer.begin(), mBuffer.begin() + static_cast<std::ptrdiff_t>(written));
+         return Error(RecordingError::UNABLE_TO_WRITE, "Unable to write capture");
+      }
+      written += static_cast<std::size_t>(result);
+   }
+
+   mBytes += written;
+   mBuffer.clear();
+   return {};
+}
+
+void RecordWriter::close() noexcept
+{
+   if (mFile >= 0)
+   {
+      [[maybe_unused]] auto flushed = flush();
+      ::close(mFile);
+      mFile = -1;
+   }
+}
+
+RecordWriter::~RecordWriter()
+{
+   close();
+}
+
+Result<void, RecordingError> RecordReader::open(const std::filesystem::path& path)
+{
+   close();
+
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+   mFile = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+   if (mFile < 0)
+   {
+      return Error(RecordingError::UNABLE_TO_OPEN,
+                   ErrorDetail::compose("Unable to open capture ", path.native()));
+   }
+
+   struct stat status
+   {
+   };
+   if (fstat(mFile, &status) != 0 || static_cast<std::size_t>(status.st_size) < MAGIC.size())
+   {
+      close();
+      return Error(RecordingError::CORRUPTED, "Capture is too short");
+   }
+
+   const auto size = static_cast<std::size_t>(status.st_size);
+   auto* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, mFile, 0);
+   if (mapping == MAP_FAILED)
+   {
+      close();
+      return Error(RecordingError::UNABLE_TO_MAP, "Unable to map capture");
+   }
+   mMapping = std::span(static_cast<const char*>(mapping), size);
+   // Frames are read once, in order
+   madvise(mapping, size, MADV_SEQUENTIAL);
+
+   if (std::string_view(mMapping.data(), MAGIC.size()) != MAGIC)
+   {
+      close();
+      return Error(RecordingError::CORRUPTED, "Not a capture file");
+   }
+   mPosition = MAGIC.size();
+
+   std::uint64_t sources = 0;
+   if (!readVarint(sources))
+   {
+      close();
+      return Error(RecordingError::CORRUPTED, "Capture header is truncated");
+   }
+   for (std::uint64_t index = 0; index < sources; index++)
+   {
+      std::uint64_t length = 0;
+      if (!readVarint(length) || length > mMapping.size() - mPosition)
+      {
+         close();
+         return Error(RecordingError::CORRUPTED, "Capture header is truncated");
+      }
+      mSources.emplace_back(mMapping.data() + mPosition, length);
+      mPosition += length;
+   }
+
+   mFirstFrame = mPosition;
+   mTimestamp = {};
+
+   return {};
+}
+
+bool RecordReader::readVarint(std::uint64_t& value) noexcept
+{
+   value = 0;
+   for (unsigned int index = 0; index < VARINT_MAX_BYTES && mPosition < mMapping.size(); index++)
+   {
+      const auto byte = static_cast<std::uint8_t>(mMapping[mPosition++]);
+      value |= static_cast<std::uint64_t>(byte & VARINT_MASK) << (index * VARINT_BITS);
+      if ((byte & VARINT_MORE) == 0)
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+bool RecordReader::next(Frame& frame) noexcept
+{
+   const auto start = mPosition;
+   std::uint64_t source = 0;
+   std::uint64_t elapsed = 0;
+   std::uint64_t size = 0;
+   if (!readVarint(source) || !readVarint(elapsed) || !readVarint(size) ||
+       source >= mSources.size() || size > mMapping.size() - mPosition)
+   {
+      mPosition = start;
+      return false;
+   }
+
+   mTimestamp += std::chrono::nanoseconds(elapsed);
+   frame.source = source;
+   frame.timestamp = mTimestamp;
+   frame.data = std::string_view(mMapping.data() + mPosition, size);
+   mPosition += size;
+
+   return true;
+}
+
+void RecordReader::rewind() noexcept
+{
+   mPosition = mFirstFrame;
+   mTimestamp = {};
+}
+
+void RecordReader::close() noexcept
+{
+   if (!mMapping.empty())
+   {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+      munmap(const_cast<char*>(mMapping.data()), mMapping.size());
+      mMapping = {};
+   }
+   mSources.clear();
+   mPosition = 0;
+   mFirstFrame = 0;
+
+   if (mFile >= 0)
+   {
+      ::close(mFile);
+      mFile = -1;
+   }
+}
+
+RecordReader::~RecordReader()
+{
+   close();
+}
@@ -0,0 +1,97 @@
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "Recording.hpp"
+
+namespace {
+std::filesystem::path capturePath(const std::string& name)
+{
+   auto path = std::filesystem::temp_directory_path() / (name + ".rec");
+   std::filesystem::remove(path);
+   return path;
+}
+} // namespace
+
+TEST(Recording, RoundTrip)
+{
+   using namespace std::chrono_literals;
+   const auto path = capturePath("RoundTrip");
+   const std::vector<std::string> sources = {"Temperature", "Storage"};
+   const auto start = RecordWriter::Clock::now();
+
+   // Enough frames to go through the buffer a few times, including one larger than it
+   std::vector<std::pair<std::size_t, std::string>> frames;
+   for (unsigned int i = 0; i < 100000; i++)
+   {
+      frames.emplace_back(i % 2, "TEMPERATURE#{\"temperature\":" + std::to_string(i) + "}");
+   }
+   frames.emplace_back(1, std::string(RecordWriter::BUFFER_SIZE + 1, 'x'));
+
+   {
+      RecordWriter writer;
+      ASSERT_TRUE(writer.open(path, sources));
+      for (std::size_t i = 0; i < frames.size(); i++)
+      {
+         ASSERT_TRUE(writer.append(frames[i].first, start + i * 1ms, frames[i].second));
+      }
+      ASSERT_EQ(writer.frames(), frames.size());
+   }
+
+   RecordReader reader;
+   ASSERT_TRUE(reader.open(path));
+   ASSERT_EQ(reader.sources(), sources);
+
+   for (unsigned int pass = 0; pass < 2; pass++)
+   {
+      Frame frame;
+      for (std::size_t i = 0; i < frames.size(); i++)
+      {
+         ASSERT_TRUE(reader.next(frame));
+         ASSERT_EQ(frame.source, frames[i].first);
+         ASSERT_EQ(frame.timestamp, i * 1ms);
+         ASSERT_EQ(frame.data, frames[i].second);
+      }
+      ASSERT_FALSE(reader.next(frame));
+      reader.rewind();
+   }
+
+   std::filesystem::remove(path);
+}
+
+TEST(Recording, Truncated)
+{
+   const auto path = capturePath("Truncated");
+   {
+      RecordWriter writer;
+      ASSERT_TRUE(writer.open(path, {"Temperature"}));
+      ASSERT_TRUE(writer.append(0, RecordWriter::Clock::now(), "TEMPERATURE#{}"));
+      ASSERT_TRUE(writer.append(0, RecordWriter::Clock::now(), "TEMPERATURE#{}"));
+   }
+   std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+
+   // Everything before the frame that was cut short is still there
+   RecordReader reader;
+   ASSERT_TRUE(reader.open(path));
+   Frame frame;
+   ASSERT_TRUE(reader.next(frame));
+   ASSERT_FALSE(reader.next(frame));
+
+   std::filesystem::remove(path);
+}
+
+TEST(Recording, Corrupted)
+{
+   const auto path = capturePath("Corrupted");
+   {
+      std::ofstream file(path);
+      file << "definitely not a capture";
+   }
+
+   RecordReader reader;
+   ASSERT_EQ(reader.open(path).error(), RecordingError::CORRUPTED);
+
+   std::filesystem::remove(path);
+}
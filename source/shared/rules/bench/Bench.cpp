@@ -0,0 +1,105 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "RuleEngine.hpp"
+
+namespace {
+constexpr std::size_t TOPICS = 10;
+constexpr std::size_t FIELDS = 4;
+
+// state.range(0) rules spread over a few topics and fields of the same component
+void addRules(RuleEngine& engine, const std::size_t count)
+{
+   std::mt19937 rng(42);
+   std::uniform_real_distribution<float> threshold(15, 35);
+   for (std::size_t index = 0; index < count; index++)
+   {
+      [[maybe_unused]] auto added = engine.add(
+          Rule{.name = "rule" + std::to_string(index),
+               .component = "Greenhouse",
+               .topic = "TOPIC" + std::to_string(index % TOPICS),
+               .field = "field" + std::to_string(index / TOPICS % FIELDS),
+               .condition = index % 2 == 0 ? Rule::Condition::ABOVE : Rule::Condition::BELOW,
+               .threshold = threshold(rng),
+               .hysteresis = 1,
+               .duration = std::chrono::seconds(index % 60),
+               .action = "ACTION" + std::to_string(index)});
+   }
+}
+
+std::vector<std::pair<std::string, nlohmann::json>> makeMessages()
+{
+   std::mt19937 rng(42);
+   std::normal_distribution<float> value(25, 5);
+   std::vector<std::pair<std::string, nlohmann::json>> messages;
+   for (std::size_t index = 0; index < 1024; index++)
+   {
+      nlohmann::json message;
+      for (std::size_t field = 0; field < FIELDS; field++)
+      {
+         message["field" + std::to_string(field)] = value(rng);
+      }
+      message["version"] = "0.0.1";
+      messages.emplace_back("TOPIC" + std::to_string(index % TOPICS), std::move(message));
+   }
+
+   return messages;
+}
+} // namespace
+
+// Messages evaluated per second against the compiled plan
+static void BM_Evaluate(benchmark::State& state)
+{
+   RuleEngine engine;
+   addRules(engine, static_cast<std::size_t>(state.range(0)));
+   engine.compile();
+   auto* plan = engine.plan("Greenhouse");
+   const auto messages = makeMessages();
+
+   std::vector<RuleEngine::Transition> transitions;
+   auto now = RuleEngine::Clock::now();
+   std::size_t index = 0;
+   for (auto _ : state)
+   {
+      const auto& [topic, message] = messages[index++ % messages.size()];
+      now += std::chrono::milliseconds(100);
+      transitions.clear();
+      engine.evaluate(*plan, topic, message, now, transitions);
+      benchmark::DoNotOptimize(transitions.data());
+   }
+   state.SetItemsProcessed(state.iterations());
+   state.counters["rules/s"] = benchmark::Counter(
+       static_cast<double>(state.iterations()) * static_cast<double>(state.range(0)),
+       benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_Evaluate)->Arg(10)->Arg(1000)->Arg(10000);
+
+// The hand written subscribers the engine replaces: every rule filters and parses on its own
+static void BM_PerRuleSubscribers(benchmark::State& state)
+{
+   RuleEngine engine;
+   addRules(engine, static_cast<std::size_t>(state.range(0)));
+   const auto& rules = engine.rules();
+   const auto messages = makeMessages();
+
+   std::size_t index = 0;
+   std::size_t fired = 0;
+   for (auto _ : state)
+   {
+      const auto& [topic, message] = messages[index++ % messages.size()];
+      for (const auto& rule : rules)
+      {
+         if (rule.topic == topic && message.contains(rule.field) &&
+             message[rule.field].get<float>() > rule.threshold)
+         {
+            fired++;
+         }
+      }
+   }
+   benchmark::DoNotOptimize(fired);
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PerRuleSubscribers)->Arg(10)->Arg(1000)->Arg(10000);
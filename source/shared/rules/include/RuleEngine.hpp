@@ -0,0 +1,138 @@
+#ifndef RULEENGINE_HPP
+#define RULEENGINE_HPP
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "Result.hpp"
+
+// A threshold on a numeric field of the messages published by a component on a topic, e.g. "fan on
+// if temperature > 28 for 60s". It becomes active once the condition held for the whole duration
+// and inactive again once the value moves back past the threshold by more than hysteresis. Batches
+// are evaluated sample by sample, optionally only the ones of a sensor
+struct Rule
+{
+   enum class Condition
+   {
+      ABOVE,
+      ABOVE_OR_EQUAL,
+      BELOW,
+      BELOW_OR_EQUAL
+   };
+
+   std::string name;
+   std::string component;
+   std::string topic;
+   std::string field;
+   // Empty for the samples of every sensor
+   std::string sensor;
+   Condition condition = Condition::ABOVE;
+   float threshold = 0;
+   float hysteresis = 0;
+   std::chrono::milliseconds duration{0};
+   std::string action;
+
+   // Parses ">", ">=", "<" and "<="
+   [[nodiscard]] static std::optional<Condition> parseCondition(std::string_view symbol) noexcept;
+};
+
+enum class RuleError
+{
+   INVALID_RULE,
+   ALREADY_COMPILED
+};
+
+// Evaluates many rules incrementally, message by message. Rules are compiled once into a plan
+// indexed by component, topic and field, so that every message is looked up once per field no
+// matter how many rules watch it, and rules are then checked in a tight loop over flat state
+class RuleEngine final
+{
+public:
+   using Clock = std::chrono::steady_clock;
+
+   // A rule changing state
+   struct Transition
+   {
+      const Rule* rule;
+      bool active;
+      float value;
+   };
+
+   class ComponentPlan;
+
+   RuleEngine() = default;
+   RuleEngine(const RuleEngine& engine) = delete;
+   RuleEngine(RuleEngine&& engine) = delete;
+   auto operator=(const RuleEngine& engine) = delete;
+   auto operator=(RuleEngine&& engine) = delete;
+
+   [[nodiscard]] Result<void, RuleError> add(Rule rule);
+
+   void compile();
+
+   [[nodiscard]] inline const std::vector<Rule>& rules() const noexcept
+   {
+      return mRules;
+   }
+
+   // The components whose messages the rules need
+   [[nodiscard]] std::vector<std::string> components() const;
+
+   // Resolved once per subscription, so that messages are only looked up by topic
+   [[nodiscard]] ComponentPlan* plan(const std::string& component) noexcept;
+
+   // Appends the rules changing state because of message to transitions, every sample of a batch
+   // being taken as received at now. Not thread safe
+   void evaluate(ComponentPlan& plan, const std::string& topic, const nlohmann::json& message,
+                 Clock::time_point now, std::vector<Transition>& transitions);
+
+   ~RuleEngine() = default;
+
+private:
+   static constexpr const char* SAMPLES_FIELD = "samples";
+   static constexpr const char* SENSOR_FIELD = "sensor";
+
+   // Every rule is normalized to "sign * value above arm", so that all conditions share a loop
+   struct CompiledRule
+   {
+      float sign;
+      float arm;
+      float release;
+      bool inclusive;
+      bool active;
+      Clock::duration duration;
+      std::optional<Clock::time_point> holdingSince;
+      std::size_t rule;
+   };
+
+   struct FieldPlan
+   {
+      std::string field;
+      std::string sensor;
+      std::vector<CompiledRule> rules;
+   };
+
+public:
+   class ComponentPlan
+   {
+   private:
+      friend class RuleEngine;
+      std::unordered_map<std::string, std::vector<FieldPlan>> mTopics;
+   };
+
+private:
+   bool mCompiled = false;
+   std::vector<Rule> mRules;
+   std::unordered_map<std::string, ComponentPlan> mPlans;
+
+   void evaluate(std::vector<FieldPlan>& fields, const nlohmann::json& sample,
+                 Clock::time_point now, std::vector<Transition>& transitions);
+};
+
+#endif // RULEENGINE_HPP
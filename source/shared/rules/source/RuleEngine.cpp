@@ -0,0 +1,187 @@
+#include "RuleEngine.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+std::optional<Rule::Condition> Rule::parseCondition(const std::string_view symbol) noexcept
+{
+   if (symbol == ">")
+   {
+      return Condition::ABOVE;
+   }
+   if (symbol == ">=")
+   {
+      return Condition::ABOVE_OR_EQUAL;
+   }
+   if (symbol == "<")
+   {
+      return Condition::BELOW;
+   }
+   if (symbol == "<=")
+   {
+      return Condition::BELOW_OR_EQUAL;
+   }
+
+   return std::nullopt;
+}
+
+Result<void, RuleError> RuleEngine::add(Rule rule)
+{
+   if (mCompiled)
+   {
+      return Error(RuleError::ALREADY_COMPILED, "Rules cannot be added after compiling them");
+   }
+
+   if (rule.component.empty() || rule.topic.empty() || rule.field.empty() || rule.action.empty())
+   {
+      return Error(RuleError::INVALID_RULE,
+                   ErrorDetail::compose("Rule ", rule.name,
+                                        " misses component, topic, field or action"));
+   }
+
+   if (!std::isfinite(rule.threshold) || !std::isfinite(rule.hysteresis) || rule.hysteresis < 0 ||
+       rule.duration.count() < 0)
+   {
+      return Error(RuleError::INVALID_RULE,
+                   ErrorDetail::compose("Rule ", rule.name, " has an invalid threshold"));
+   }
+
+   mRules.push_back(std::move(rule));
+   return {};
+}
+
+void RuleEngine::compile()
+{
+   mPlans.clear();
+   for (std::size_t index = 0; index < mRules.size(); index++)
+   {
+      const auto& rule = mRules[index];
+      const auto below = rule.condition == Rule::Condition::BELOW ||
+                         rule.condition == Rule::Condition::BELOW_OR_EQUAL;
+      const auto sign = below ? -1.0F : 1.0F;
+
+      auto& fields = mPlans[rule.component].mTopics[rule.topic];
+      auto field = std::find_if(fields.begin(), fields.end(), [&rule](const FieldPlan& plan) {
+         return plan.field == rule.field && plan.sensor == rule.sensor;
+      });
+      if (field == fields.end())
+      {
+         field = fields.insert(fields.end(),
+                               FieldPlan{.field = rule.field, .sensor = rule.sensor, .rules = {}});
+      }
+
+      field->rules.push_back(
+          CompiledRule{.sign = sign,
+                       .arm = sign * rule.threshold,
+                       .release = sign * rule.threshold - rule.hysteresis,
+                       .inclusive = rule.condition == Rule::Condition::ABOVE_OR_EQUAL ||
+                                    rule.condition == Rule::Condition::BELOW_OR_EQUAL,
+                       .active = false,
+                       .duration = rule.duration,
+                       .holdingSince = std::nullopt,
+                       .rule = index});
+   }
+
+   mCompiled = true;
+}
+
+std::vector<std::string> RuleEngine::components() const
+{
+   std::vector<std::string> components;
+   components.reserve(mPlans.size());
+   for (const auto& [component, plan] : mPlans)
+   {
+      components.push_back(component);
+   }
+
+   return components;
+}
+
+RuleEngine::ComponentPlan* RuleEngine::plan(const std::string& component) noexcept
+{
+   auto plan = mPlans.find(component);
+   return plan == mPlans.end() ? nullptr : &plan->second;
+}
+
+void RuleEngine::evaluate(ComponentPlan& plan, const std::string& topic,
+                          const nlohmann::json& message, const Clock::time_point now,
+                          std::vector<Transition>& transitions)
+{
+   auto fields = plan.mTopics.find(topic);
+   if (fields == plan.mTopics.end())
+   {
+      return;
+   }
+
+   // Batches carry their samples in an array, each evaluated in order as a message of its own
+   const auto samples = message.find(SAMPLES_FIELD);
+   if (samples != message.end() && samples->is_array())
+   {
+      for (const auto& sample : *samples)
+      {
+         evaluate(fields->second, sample, now, transitions);
+      }
+      return;
+   }
+
+   evaluate(fields->second, message, now, transitions);
+}
+
+void RuleEngine::evaluate(std::vector<FieldPlan>& fields, const nlohmann::json& sample,
+                          const Clock::time_point now, std::vector<Transition>& transitions)
+{
+   for (auto& field : fields)
+   {
+      if (!field.sensor.empty())
+      {
+         const auto sensor = sample.find(SENSOR_FIELD);
+         if (sensor == sample.end() || !sensor->is_string() ||
+             sensor->get_ref<const std::string&>() != field.sensor)
+         {
+            continue;
+         }
+      }
+
+      const auto found = sample.find(field.field);
+      if (found == sample.end() || !found->is_number())
+      {
+         continue;
+      }
+
+      const auto value = found->get<float>();
+      for (auto& rule : field.rules)
+      {
+         const auto normalized = rule.sign * value;
+         if (!rule.active)
+         {
+            const auto holds = rule.inclusive ? normalized >= rule.arm : normalized > rule.arm;
+            if (!holds)
+            {
+               rule.holdingSince.reset();
+               continue;
+            }
+
+            if (!rule.holdingSince.has_value())
+            {
+               rule.holdingSince = now;
+            }
+            if (now - rule.holdingSince.value() >= rule.duration)
+            {
+               rule.active = true;
+               transitions.push_back({&mRules[rule.rule], true, value});
+            }
+         }
+         else
+         {
+            const auto released =
+                rule.inclusive ? normalized < rule.release : normalized <= rule.release;
+            if (released)
+            {
+               rule.active = false;
+               rule.holdingSince.reset();
+               transitions.push_back({&mRules[rule.rule], false, value});
+            }
+         }
+      }
+   }
+}
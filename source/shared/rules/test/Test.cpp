@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+
+#include "RuleEngine.hpp"
+
+namespace {
+using namespace std::chrono_literals;
+
+Rule fanRule()
+{
+   return Rule{.name = "fan",
+               .component = "Temperature",
+               .topic = "TEMPERATURE",
+               .field = "temperature",
+               .condition = Rule::Condition::ABOVE,
+               .threshold = 28,
+               .hysteresis = 1,
+               .duration = 60s,
+               .action = "FAN"};
+}
+
+// Feeds a value to the engine and returns the transitions it caused
+std::vector<RuleEngine::Transition> feed(RuleEngine& engine, const float value,
+                                         const RuleEngine::Clock::time_point now,
+                                         const std::string& topic = "TEMPERATURE")
+{
+   std::vector<RuleEngine::Transition> transitions;
+   engine.evaluate(*engine.plan("Temperature"), topic, {{"temperature", value}}, now, transitions);
+   return transitions;
+}
+} // namespace
+
+TEST(Rule, Condition)
+{
+   ASSERT_EQ(Rule::parseCondition(">"), Rule::Condition::ABOVE);
+   ASSERT_EQ(Rule::parseCondition(">="), Rule::Condition::ABOVE_OR_EQUAL);
+   ASSERT_EQ(Rule::parseCondition("<"), Rule::Condition::BELOW);
+   ASSERT_EQ(Rule::parseCondition("<="), Rule::Condition::BELOW_OR_EQUAL);
+   ASSERT_FALSE(Rule::parseCondition("=>").has_value());
+}
+
+TEST(RuleEngine, InvalidRule)
+{
+   RuleEngine engine;
+   auto rule = fanRule();
+   rule.action.clear();
+   ASSERT_EQ(engine.add(rule).error(), RuleError::INVALID_RULE);
+
+   rule = fanRule();
+   rule.hysteresis = -1;
+   ASSERT_EQ(engine.add(rule).error(), RuleError::INVALID_RULE);
+
+   engine.compile();
+   ASSERT_EQ(engine.add(fanRule()).error(), RuleError::ALREADY_COMPILED);
+}
+
+TEST(RuleEngine, Duration)
+{
+   RuleEngine engine;
+   ASSERT_TRUE(engine.add(fanRule()));
+   engine.compile();
+   ASSERT_EQ(engine.components(), std::vector<std::string>{"Temperature"});
+   ASSERT_EQ(engine.plan("Storage"), nullptr);
+
+   const auto start = RuleEngine::Clock::now();
+   ASSERT_TRUE(feed(engine, 29, start).empty());
+   ASSERT_TRUE(feed(engine, 29, start + 30s).empty());
+
+   // Dropping below the threshold restarts the window
+   ASSERT_TRUE(feed(engine, 27, start + 40s).empty());
+   ASSERT_TRUE(feed(engine, 29, start + 50s).empty());
+   ASSERT_TRUE(feed(engine, 29, start + 100s).empty());
+
+   const auto transitions = feed(engine, 29.5F, start + 110s);
+   ASSERT_EQ(transitions.size(), 1);
+   ASSERT_EQ(transitions.front().rule->name, "fan");
+   ASSERT_TRUE(transitions.front().active);
+   ASSERT_EQ(transitions.front().value, 29.5F);
+
+   // Staying active does not fire again
+   ASSERT_TRUE(feed(engine, 30, start + 200s).empty());
+}
+
+TEST(RuleEngine, Hysteresis)
+{
+   RuleEngine engine;
+   auto rule = fanRule();
+   rule.duration = 0s;
+   ASSERT_TRUE(engine.add(rule));
+   rule.name = "heater";
+   rule.condition = Rule::Condition::BELOW_OR_EQUAL;
+   rule.threshold = 15;
+   ASSERT_TRUE(engine.add(rule));
+   engine.compile();
+
+   const auto now = RuleEngine::Clock::now();
+   ASSERT_EQ(feed(engine, 28.5F, now).size(), 1);
+   ASSERT_TRUE(feed(engine, 27.5F, now).empty()) << "Released within the hysteresis band";
+   auto transitions = feed(engine, 27, now);
+   ASSERT_EQ(transitions.size(), 1);
+   ASSERT_FALSE(transitions.front().active);
+
+   transitions = feed(engine, 15, now);
+   ASSERT_EQ(transitions.size(), 1);
+   ASSERT_EQ(transitions.front().rule->name, "heater");
+   ASSERT_TRUE(feed(engine, 15.5F, now).empty());
+   ASSERT_EQ(feed(engine, 16.5F, now).size(), 1);
+}
+
+TEST(RuleEngine, UnrelatedMessages)
+{
+   RuleEngine engine;
+   auto rule = fanRule();
+   rule.duration = 0s;
+   ASSERT_TRUE(engine.add(rule));
+   engine.compile();
+
+   const auto now = RuleEngine::Clock::now();
+   ASSERT_TRUE(feed(engine, 40, now, "TEMPERATURE_AGGREGATE").empty());
+
+   std::vector<RuleEngine::Transition> transitions;
+   engine.evaluate(*engine.plan("Temperature"), "TEMPERATURE", {{"humidity", 40}}, now,
+                   transitions);
+   engine.evaluate(*engine.plan("Temperature"), "TEMPERATURE", {{"temperature", "hot"}}, now,
+                   transitions);
+   ASSERT_TRUE(transitions.empty());
+}
+
+TEST(RuleEngine, Batch)
+{
+   RuleEngine engine;
+   auto rule = fanRule();
+   rule.topic = "TEMPERATURE_BATCH";
+   rule.duration = 0s;
+   ASSERT_TRUE(engine.add(rule));
+   engine.compile();
+
+   // Every sample is evaluated in order, so the rule goes up and back down within one batch
+   const nlohmann::json batch = {
+       {"samples", {{{"temperature", 20}}, {{"temperature", 30}}, {{"temperature", 20}}}}};
+   std::vector<RuleEngine::Transition> transitions;
+   engine.evaluate(*engine.plan("Temperature"), "TEMPERATURE_BATCH", batch,
+                   RuleEngine::Clock::now(), transitions);
+   ASSERT_EQ(transitions.size(), 2);
+   ASSERT_TRUE(transitions[0].active);
+   ASSERT_FLOAT_EQ(transitions[0].value, 30);
+   ASSERT_FALSE(transitions[1].active);
+}
+
+TEST(RuleEngine, Sensor)
+{
+   RuleEngine engine;
+   auto rule = fanRule();
+   rule.topic = "TEMPERATURE_BATCH";
+   rule.sensor = "greenhouse";
+   rule.duration = 0s;
+   ASSERT_TRUE(engine.add(rule));
+   engine.compile();
+
+   const nlohmann::json batch = {{"samples",
+                                  {{{"temperature", 30}, {"sensor", "cellar"}},
+                                   {{"temperature", 20}, {"sensor", "greenhouse"}},
+                                   {{"temperature", 35}}}}};
+   std::vector<RuleEngine::Transition> transitions;
+   engine.evaluate(*engine.plan("Temperature"), "TEMPERATURE_BATCH", batch,
+                   RuleEngine::Clock::now(), transitions);
+   ASSERT_TRUE(transitions.empty()) << "Samples of other sensors were evaluated";
+
+   const nlohmann::json hot = {{"samples", {{{"temperature", 30}, {"sensor", "greenhouse"}}}}};
+   engine.evaluate(*engine.plan("Temperature"), "TEMPERATURE_BATCH", hot, RuleEngine::Clock::now(),
+                   transitions);
+   ASSERT_EQ(transitions.size(), 1);
+}
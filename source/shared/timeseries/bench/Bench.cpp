@@ -0,0 +1,160 @@
+#include <cmath>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Query.hpp"
+#include "Rollup.hpp"
+#include "Series.hpp"
+
+namespace {
+// A thermometer sampled every second, with the resolution a real sensor would have
+std::vector<std::pair<std::int64_t, float>> temperatureSeries(const std::size_t count)
+{
+   constexpr float RESOLUTION = 0.0625F;
+   std::mt19937 rng(42);
+   std::normal_distribution<float> noise(0, 0.05F);
+
+   std::vector<std::pair<std::int64_t, float>> samples;
+   std::int64_t timestamp = 0;
+   auto value = 21.0F;
+   for (std::size_t i = 0; i < count; i++)
+   {
+      timestamp += 1000;
+      value += noise(rng);
+      samples.emplace_back(timestamp, std::round(value / RESOLUTION) * RESOLUTION);
+   }
+
+   return samples;
+}
+
+constexpr std::size_t SERIES_LENGTH = 1 << 20;
+} // namespace
+
+static void BM_Encode(benchmark::State& state)
+{
+   const auto samples = temperatureSeries(SERIES_LENGTH);
+   BlockEncoder encoder;
+   std::size_t index = 0;
+   std::uint64_t blocks = 0;
+   for (auto _ : state)
+   {
+      const auto& [timestamp, value] = samples[index++ % samples.size()];
+      if (index % samples.size() == 0 || !encoder.append(timestamp, value))
+      {
+         encoder.reset();
+         blocks++;
+      }
+   }
+   state.SetItemsProcessed(state.iterations());
+   state.counters["bytes/sample"] = benchmark::Counter(
+       static_cast<double>(blocks * Block::SIZE) / static_cast<double>(state.iterations()));
+}
+BENCHMARK(BM_Encode);
+
+static void BM_Append(benchmark::State& state)
+{
+   const auto path = std::filesystem::temp_directory_path() / "BM_Append.series";
+   const auto samples = temperatureSeries(SERIES_LENGTH);
+   for (auto _ : state)
+   {
+      state.PauseTiming();
+      std::filesystem::remove(path);
+      SeriesWriter writer;
+      [[maybe_unused]] auto opened = writer.open(path);
+      state.ResumeTiming();
+
+      for (const auto& [timestamp, value] : samples)
+      {
+         benchmark::DoNotOptimize(writer.append(timestamp, value));
+      }
+      benchmark::DoNotOptimize(writer.flush());
+   }
+   state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(samples.size()));
+   state.counters["bytes/sample"] = benchmark::Counter(
+       static_cast<double>(std::filesystem::file_size(path)) / static_cast<double>(samples.size()));
+   std::filesystem::remove(path);
+}
+BENCHMARK(BM_Append)->Unit(benchmark::kMillisecond);
+
+// Full and narrow range scans over a mapped series, the latter mostly exercising the block index
+static void BM_Scan(benchmark::State& state)
+{
+   const auto path = std::filesystem::temp_directory_path() / "BM_Scan.series";
+   const auto samples = temperatureSeries(SERIES_LENGTH);
+   {
+      std::filesystem::remove(path);
+      SeriesWriter writer;
+      [[maybe_unused]] auto opened = writer.open(path);
+      for (const auto& [timestamp, value] : samples)
+      {
+         [[maybe_unused]] auto appended = writer.append(timestamp, value);
+      }
+   }
+
+   SeriesReader reader;
+   [[maybe_unused]] auto opened = reader.open(path);
+   const auto span = static_cast<std::size_t>(state.range(0));
+   const auto from = samples[samples.size() / 2].first;
+   const auto to = samples[std::min(samples.size() / 2 + span, samples.size()) - 1].first;
+
+   std::uint64_t visited = 0;
+   for (auto _ : state)
+   {
+      double sum = 0;
+      visited += reader.scan(from, to, [&sum](std::int64_t, float value) { sum += value; });
+      benchmark::DoNotOptimize(sum);
+   }
+   state.SetItemsProcessed(static_cast<std::int64_t>(visited));
+   std::filesystem::remove(path);
+}
+BENCHMARK(BM_Scan)->Arg(100)->Arg(SERIES_LENGTH);
+
+// Hourly buckets over 30 days of 1Hz samples, from raw blocks with state.range(0) threads and then
+// from a per minute rollup tier
+static void BM_Query(benchmark::State& state)
+{
+   constexpr std::int64_t MINUTE = 60000;
+   constexpr std::int64_t HOUR = 60 * MINUTE;
+   constexpr std::size_t MONTH = 30 * 24 * 3600;
+
+   const auto directory = std::filesystem::temp_directory_path();
+   const auto samples = temperatureSeries(MONTH);
+   {
+      SeriesWriter writer;
+      RollupWriter rollup;
+      [[maybe_unused]] auto opened = writer.open(directory / "BM_Query.series");
+      [[maybe_unused]] auto rollupOpened = rollup.open(directory / "BM_Query.rollup", MINUTE);
+      for (const auto& [timestamp, value] : samples)
+      {
+         [[maybe_unused]] auto appended = writer.append(timestamp, value);
+         [[maybe_unused]] auto added = rollup.add(timestamp, value);
+      }
+   }
+
+   SeriesReader series;
+   RollupReader rollup;
+   [[maybe_unused]] auto opened = series.open(directory / "BM_Query.series");
+   [[maybe_unused]] auto rollupOpened = rollup.open(directory / "BM_Query.rollup", MINUTE);
+   const std::array<const RollupReader*, 1> tiers = {&rollup};
+
+   const QueryEngine engine(static_cast<unsigned int>(state.range(0)));
+   const Query query{.from = samples.front().first, .to = samples.back().first, .width = HOUR};
+   for (auto _ : state)
+   {
+      auto buckets = state.range(1) != 0 ? engine.run(query, series, tiers)
+                                         : engine.run(query, series);
+      benchmark::DoNotOptimize(buckets.value().data());
+   }
+   state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(samples.size()));
+
+   std::filesystem::remove(directory / "BM_Query.series");
+   std::filesystem::remove(directory / "BM_Query.rollup");
+}
+BENCHMARK(BM_Query)
+    ->ArgsProduct({{1, 4}, {0, 1}})
+    ->ArgNames({"threads", "rollup"})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
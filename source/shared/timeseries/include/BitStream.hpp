@@ -0,0 +1,93 @@
+#ifndef BITSTREAM_HPP
+#define BITSTREAM_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+
+// Writes values bit by bit, most significant bit first, into a zero initialized buffer
+class BitWriter final
+{
+public:
+   BitWriter() = delete;
+   explicit inline BitWriter(std::span<std::uint8_t> buffer, const std::size_t position = 0)
+       : mBuffer{buffer}, mPosition{position}
+   {
+   }
+
+   [[nodiscard]] inline bool fits(const std::size_t bits) const noexcept
+   {
+      return mPosition + bits <= mBuffer.size() * BITS_PER_BYTE;
+   }
+
+   // Writes the lowest bits of value, the caller must check that they fit
+   inline void write(const std::uint64_t value, unsigned int bits) noexcept
+   {
+      while (bits > 0)
+      {
+         const auto used = static_cast<unsigned int>(mPosition % BITS_PER_BYTE);
+         const auto take = std::min(BITS_PER_BYTE - used, bits);
+         const auto chunk = static_cast<unsigned int>(value >> (bits - take)) & ((1U << take) - 1);
+         mBuffer[mPosition / BITS_PER_BYTE] |=
+             static_cast<std::uint8_t>(chunk << (BITS_PER_BYTE - used - take));
+         mPosition += take;
+         bits -= take;
+      }
+   }
+
+   [[nodiscard]] inline std::size_t position() const noexcept
+   {
+      return mPosition;
+   }
+
+private:
+   static constexpr unsigned int BITS_PER_BYTE = 8;
+
+   std::span<std::uint8_t> mBuffer;
+   std::size_t mPosition;
+};
+
+// Reads values written by BitWriter
+class BitReader final
+{
+public:
+   BitReader() = delete;
+   explicit inline BitReader(std::span<const std::uint8_t> buffer) noexcept : mBuffer{buffer}
+   {
+   }
+
+   [[nodiscard]] inline std::uint64_t read(unsigned int bits) noexcept
+   {
+      std::uint64_t value = 0;
+      while (bits > 0)
+      {
+         const auto used = static_cast<unsigned int>(mPosition % BITS_PER_BYTE);
+         const auto take = std::min(BITS_PER_BYTE - used, bits);
+         const auto byte = static_cast<unsigned int>(mBuffer[mPosition / BITS_PER_BYTE]);
+         const auto chunk = (byte >> (BITS_PER_BYTE - used - take)) & ((1U << take) - 1);
+         value = (value << take) | chunk;
+         mPosition += take;
+         bits -= take;
+      }
+
+      return value;
+   }
+
+   [[nodiscard]] inline bool readBit() noexcept
+   {
+      return read(1) != 0;
+   }
+
+   [[nodiscard]] inline std::size_t position() const noexcept
+   {
+      return mPosition;
+   }
+
+private:
+   static constexpr unsigned int BITS_PER_BYTE = 8;
+
+   std::span<const std::uint8_t> mBuffer;
+   std::size_t mPosition = 0;
+};
+
+#endif // BITSTREAM_HPP
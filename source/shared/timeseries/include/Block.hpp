@@ -0,0 +1,117 @@
+#ifndef BLOCK_HPP
+#define BLOCK_HPP
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include "BitStream.hpp"
+
+// Summary stored at the beginning of every block, it doubles as the sparse time index of a series
+// and lets range queries skip blocks without decoding them. Stored in host byte order
+struct BlockHeader
+{
+   static constexpr std::uint32_t MAGIC = 0x47524f57; // "GROW"
+
+   std::uint32_t magic = MAGIC;
+   std::uint32_t count = 0;
+   std::uint32_t bits = 0;
+   std::uint32_t sealed = 0;
+   std::int64_t firstTimestamp = 0;
+   std::int64_t lastTimestamp = 0;
+   double sum = 0;
+   float min = 0;
+   float max = 0;
+   float last = 0;
+   std::uint32_t reserved = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<BlockHeader>, "Block header must be trivially copyable");
+
+// Blocks have a fixed size, so that the n-th block of a series always lives at n * SIZE
+struct Block
+{
+   static constexpr std::size_t SIZE = 4096;
+   static constexpr std::size_t PAYLOAD_SIZE = SIZE - sizeof(BlockHeader);
+
+   using Bytes = std::array<std::uint8_t, SIZE>;
+
+   [[nodiscard]] static BlockHeader header(std::span<const std::uint8_t> block) noexcept;
+};
+
+// Compresses samples Gorilla style: timestamps (milliseconds) as delta of deltas and values as the
+// XOR with the previous one, so that regular and slowly changing series take a few bits per sample
+class BlockEncoder final
+{
+public:
+   BlockEncoder() = default;
+
+   // Returns false, leaving the block untouched, when the sample does not fit anymore
+   [[nodiscard]] bool append(std::int64_t timestamp, float value) noexcept;
+
+   // Marks the block as complete, no other sample will ever be appended to it
+   void seal() noexcept;
+
+   void reset() noexcept;
+
+   [[nodiscard]] inline const BlockHeader& header() const noexcept
+   {
+      return mHeader;
+   }
+
+   // The whole block, header included, ready to be written to disk
+   [[nodiscard]] std::span<const std::uint8_t> bytes() noexcept;
+
+private:
+   // Worst case of a timestamp (4 control bits and 64 raw bits) plus a value (12 control bits and
+   // 32 meaningful bits)
+   static constexpr std::size_t MAX_SAMPLE_BITS = 4 + 64 + 12 + 32;
+
+   Block::Bytes mBlock{};
+   BlockHeader mHeader;
+   std::int64_t mPreviousDelta = 0;
+   std::uint32_t mPreviousValue = 0;
+   unsigned int mLeading = 0;
+   unsigned int mTrailing = 0;
+   bool mWindowValid = false;
+
+   [[nodiscard]] inline std::span<std::uint8_t> payload() noexcept
+   {
+      return std::span(mBlock).subspan(sizeof(BlockHeader));
+   }
+
+   void appendTimestamp(BitWriter& writer, std::int64_t timestamp) noexcept;
+   void appendValue(BitWriter& writer, std::uint32_t value) noexcept;
+};
+
+// Iterates the samples of an encoded block
+class BlockDecoder final
+{
+public:
+   BlockDecoder() = delete;
+   explicit BlockDecoder(std::span<const std::uint8_t> block) noexcept;
+
+   // Decodes the samples described by header only, which stay valid even while a writer keeps
+   // appending to the block
+   BlockDecoder(std::span<const std::uint8_t> block, const BlockHeader& header) noexcept;
+
+   [[nodiscard]] inline const BlockHeader& header() const noexcept
+   {
+      return mHeader;
+   }
+
+   // Returns false once every sample of the block was read
+   [[nodiscard]] bool next(std::int64_t& timestamp, float& value) noexcept;
+
+private:
+   BlockHeader mHeader;
+   BitReader mReader;
+   std::uint32_t mRead = 0;
+   std::int64_t mTimestamp = 0;
+   std::int64_t mDelta = 0;
+   std::uint32_t mValue = 0;
+   unsigned int mLeading = 0;
+   unsigned int mTrailing = 0;
+};
+
+#endif // BLOCK_HPP
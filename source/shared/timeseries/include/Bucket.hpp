@@ -0,0 +1,61 @@
+#ifndef BUCKET_HPP
+#define BUCKET_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// Summary of the samples falling into a time bucket [start, start + width). It is both what range
+// queries return and the record rollup tiers are stored as
+struct Bucket
+{
+   std::int64_t start = 0;
+   double sum = 0;
+   std::uint64_t count = 0;
+   float min = std::numeric_limits<float>::max();
+   float max = std::numeric_limits<float>::lowest();
+   float last = 0;
+   std::uint32_t reserved = 0;
+
+   // Start of the bucket of the given width containing timestamp, rounding towards the past
+   [[nodiscard]] static constexpr inline std::int64_t align(const std::int64_t timestamp,
+                                                             const std::int64_t width) noexcept
+   {
+      const auto remainder = timestamp % width;
+      return remainder < 0 ? timestamp - remainder - width : timestamp - remainder;
+   }
+
+   inline void add(const float value) noexcept
+   {
+      sum += static_cast<double>(value);
+      count++;
+      min = std::min(min, value);
+      max = std::max(max, value);
+      last = value;
+   }
+
+   // Buckets must be merged in time order, the last value is the one of the latest bucket
+   inline void merge(const Bucket& other) noexcept
+   {
+      if (other.count == 0)
+      {
+         return;
+      }
+
+      sum += other.sum;
+      count += other.count;
+      min = std::min(min, other.min);
+      max = std::max(max, other.max);
+      last = other.last;
+   }
+
+   [[nodiscard]] inline double mean() const noexcept
+   {
+      return count == 0 ? 0 : sum / static_cast<double>(count);
+   }
+};
+
+static_assert(std::is_trivially_copyable_v<Bucket>, "Bucket must be trivially copyable");
+
+#endif // BUCKET_HPP
@@ -0,0 +1,43 @@
+#ifndef QUERY_HPP
+#define QUERY_HPP
+
+#include <thread>
+#include <vector>
+
+#include "Rollup.hpp"
+#include "Series.hpp"
+
+// Downsamples the samples in [from, to] into buckets of width milliseconds aligned to the epoch
+struct Query
+{
+   std::int64_t from = 0;
+   std::int64_t to = 0;
+   std::int64_t width = 0;
+};
+
+// Answers range queries over a series. Whatever it can answers from summaries: the closed buckets
+// of the coarsest rollup tier fitting the query, then the headers of blocks lying within a single
+// bucket. Only the remaining blocks are decoded, spread across a few threads
+class QueryEngine final
+{
+public:
+   static constexpr std::size_t MAX_BUCKETS = 100000;
+
+   explicit QueryEngine(unsigned int threads = std::thread::hardware_concurrency()) noexcept;
+
+   // Returns the non empty buckets in time order. Tiers are optional and can be in any order
+   [[nodiscard]] Result<std::vector<Bucket>, StorageError>
+   run(const Query& query, const SeriesReader& series,
+       std::span<const RollupReader* const> tiers = {}) const;
+
+private:
+   // Below this many blocks to decode, starting threads costs more than it saves
+   static constexpr std::size_t MIN_BLOCKS_PER_THREAD = 4;
+
+   unsigned int mThreads;
+
+   void scan(const Query& query, const SeriesReader& series, std::int64_t from, std::int64_t to,
+             std::vector<Bucket>& buckets) const;
+};
+
+#endif // QUERY_HPP
@@ -0,0 +1,88 @@
+#ifndef ROLLUP_HPP
+#define ROLLUP_HPP
+
+#include <filesystem>
+#include <span>
+
+#include "Bucket.hpp"
+#include "Series.hpp"
+
+// Keeps a precomputed tier of fixed width buckets next to a series, one record per bucket with at
+// least a sample. The bucket being filled is rewritten in place on flush, like series blocks
+class RollupWriter final
+{
+public:
+   RollupWriter() = default;
+   RollupWriter(const RollupWriter& writer) = delete;
+   RollupWriter(RollupWriter&& writer) = delete;
+   auto operator=(const RollupWriter& writer) = delete;
+   auto operator=(RollupWriter&& writer) = delete;
+
+   [[nodiscard]] Result<void, StorageError> open(const std::filesystem::path& path,
+                                                 std::int64_t width) noexcept;
+
+   [[nodiscard]] Result<void, StorageError> add(std::int64_t timestamp, float value) noexcept;
+
+   [[nodiscard]] Result<void, StorageError> flush() noexcept;
+
+   void close() noexcept;
+
+   [[nodiscard]] inline bool isOpen() const noexcept
+   {
+      return mFile >= 0;
+   }
+
+   [[nodiscard]] inline std::int64_t width() const noexcept
+   {
+      return mWidth;
+   }
+
+   ~RollupWriter();
+
+private:
+   int mFile = -1;
+   std::int64_t mWidth = 1;
+   std::size_t mIndex = 0;
+   bool mDirty = false;
+   Bucket mCurrent;
+
+   [[nodiscard]] Result<void, StorageError> writeCurrent() noexcept;
+};
+
+// Memory mapped view of a rollup tier
+class RollupReader final
+{
+public:
+   RollupReader() = default;
+   RollupReader(const RollupReader& reader) = delete;
+   RollupReader(RollupReader&& reader) = delete;
+   auto operator=(const RollupReader& reader) = delete;
+   auto operator=(RollupReader&& reader) = delete;
+
+   [[nodiscard]] Result<void, StorageError> open(const std::filesystem::path& path,
+                                                 std::int64_t width) noexcept;
+
+   void close() noexcept;
+
+   [[nodiscard]] inline std::int64_t width() const noexcept
+   {
+      return mWidth;
+   }
+
+   [[nodiscard]] inline std::span<const Bucket> buckets() const noexcept
+   {
+      return mBuckets;
+   }
+
+   // The buckets starting in [from, to]
+   [[nodiscard]] std::span<const Bucket> buckets(std::int64_t from, std::int64_t to) const noexcept;
+
+   ~RollupReader();
+
+private:
+   int mFile = -1;
+   std::int64_t mWidth = 1;
+   std::span<const Bucket> mBuckets;
+};
+
+#endif // ROLLUP_HPP
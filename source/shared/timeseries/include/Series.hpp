@@ -0,0 +1,104 @@
+#ifndef SERIES_HPP
+#define SERIES_HPP
+
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+#include "Block.hpp"
+#include "Result.hpp"
+
+enum class StorageError
+{
+   UNABLE_TO_OPEN,
+   UNABLE_TO_READ,
+   UNABLE_TO_WRITE,
+   UNABLE_TO_MAP,
+   OUT_OF_ORDER,
+   CORRUPTED,
+   INVALID_QUERY
+};
+
+// Appends samples to a series file, a sequence of fixed size compressed blocks. Only the block
+// being filled is kept in memory and it is rewritten in place on flush, so reopening a series
+// resumes exactly where it was left
+class SeriesWriter final
+{
+public:
+   SeriesWriter() = default;
+   SeriesWriter(const SeriesWriter& writer) = delete;
+   SeriesWriter(SeriesWriter&& writer) = delete;
+   auto operator=(const SeriesWriter& writer) = delete;
+   auto operator=(SeriesWriter&& writer) = delete;
+
+   [[nodiscard]] Result<void, StorageError> open(const std::filesystem::path& path) noexcept;
+
+   // Timestamps are in milliseconds and must never go backwards within a series
+   [[nodiscard]] Result<void, StorageError> append(std::int64_t timestamp, float value) noexcept;
+
+   [[nodiscard]] Result<void, StorageError> flush() noexcept;
+
+   void close() noexcept;
+
+   [[nodiscard]] inline bool isOpen() const noexcept
+   {
+      return mFile >= 0;
+   }
+
+   [[nodiscard]] inline std::uint64_t count() const noexcept
+   {
+      return mCount;
+   }
+
+   ~SeriesWriter();
+
+private:
+   int mFile = -1;
+   std::size_t mBlockIndex = 0;
+   std::uint64_t mCount = 0;
+   bool mDirty = false;
+   BlockEncoder mEncoder;
+
+   [[nodiscard]] Result<void, StorageError> writeBlock() noexcept;
+};
+
+// Read-only view of a series file. The file is memory mapped and only the block headers are read
+// on open, they form a sparse time index used to locate the blocks of a range
+class SeriesReader final
+{
+public:
+   using Visitor = std::function<void(std::int64_t timestamp, float value)>;
+
+   SeriesReader() = default;
+   SeriesReader(const SeriesReader& reader) = delete;
+   SeriesReader(SeriesReader&& reader) = delete;
+   auto operator=(const SeriesReader& reader) = delete;
+   auto operator=(SeriesReader&& reader) = delete;
+
+   [[nodiscard]] Result<void, StorageError> open(const std::filesystem::path& path) noexcept;
+
+   void close() noexcept;
+
+   [[nodiscard]] inline const std::vector<BlockHeader>& blocks() const noexcept
+   {
+      return mIndex;
+   }
+
+   [[nodiscard]] std::span<const std::uint8_t> block(std::size_t index) const noexcept;
+
+   // Indexes of the blocks overlapping [from, to] as a half open range
+   [[nodiscard]] std::pair<std::size_t, std::size_t> overlapping(std::int64_t from,
+                                                                 std::int64_t to) const noexcept;
+
+   // Calls visitor for every sample in [from, to], returning how many there were
+   std::uint64_t scan(std::int64_t from, std::int64_t to, const Visitor& visitor) const;
+
+   ~SeriesReader();
+
+private:
+   int mFile = -1;
+   std::span<const std::uint8_t> mMapping;
+   std::vector<BlockHeader> mIndex;
+};
+
+#endif // SERIES_HPP
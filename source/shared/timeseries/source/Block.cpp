@@ -0,0 +1,226 @@
+#include "Block.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+constexpr unsigned int TIMESTAMP_BITS = 64;
+constexpr unsigned int VALUE_BITS = 32;
+constexpr unsigned int WINDOW_FIELD_BITS = 5;
+constexpr unsigned int MAX_LEADING = (1U << WINDOW_FIELD_BITS) - 1;
+
+// Delta of delta buckets as {control bits, control length, value length}, the last one is raw
+struct TimestampBucket
+{
+   std::uint64_t control;
+   unsigned int controlBits;
+   unsigned int valueBits;
+};
+
+constexpr std::array<TimestampBucket, 4> TIMESTAMP_BUCKETS = {
+    {{0b10, 2, 7}, {0b110, 3, 9}, {0b1110, 4, 12}, {0b1111, 4, TIMESTAMP_BITS}}};
+
+// A bucket of n bits holds delta of deltas in [-(2^(n-1) - 1), 2^(n-1)]
+constexpr bool fitsBucket(const std::int64_t value, const unsigned int bits) noexcept
+{
+   const auto half = std::int64_t{1} << (bits - 1);
+   return value > -half && value <= half;
+}
+} // namespace
+
+BlockHeader Block::header(std::span<const std::uint8_t> block) noexcept
+{
+   BlockHeader header;
+   std::memcpy(&header, block.data(), sizeof(BlockHeader));
+   return header;
+}
+
+bool BlockEncoder::append(const std::int64_t timestamp, const float value) noexcept
+{
+   BitWriter writer(payload(), mHeader.bits);
+   const auto bits = std::bit_cast<std::uint32_t>(value);
+
+   if (mHeader.count == 0)
+   {
+      writer.write(static_cast<std::uint64_t>(timestamp), TIMESTAMP_BITS);
+      writer.write(bits, VALUE_BITS);
+      mHeader.firstTimestamp = timestamp;
+      mHeader.min = value;
+      mHeader.max = value;
+      mPreviousDelta = 0;
+   }
+   else
+   {
+      if (mHeader.sealed != 0 || !writer.fits(MAX_SAMPLE_BITS))
+      {
+         return false;
+      }
+
+      appendTimestamp(writer, timestamp);
+      appendValue(writer, bits);
+      mHeader.min = std::min(mHeader.min, value);
+      mHeader.max = std::max(mHeader.max, value);
+   }
+
+   mPreviousValue = bits;
+   mHeader.lastTimestamp = timestamp;
+   mHeader.last = value;
+   mHeader.sum += static_cast<double>(value);
+   mHeader.count++;
+   mHeader.bits = static_cast<std::uint32_t>(writer.position());
+
+   return true;
+}
+
+void BlockEncoder::appendTimestamp(BitWriter& writer, const std::int64_t timestamp) noexcept
+{
+   const auto delta = timestamp - mHeader.lastTimestamp;
+   const auto deltaOfDelta = delta - mPreviousDelta;
+   mPreviousDelta = delta;
+
+   if (deltaOfDelta == 0)
+   {
+      writer.write(0, 1);
+      return;
+   }
+
+   for (const auto& bucket : TIMESTAMP_BUCKETS)
+   {
+      if (bucket.valueBits == TIMESTAMP_BITS || fitsBucket(deltaOfDelta, bucket.valueBits))
+      {
+         const auto offset = (std::int64_t{1} << (bucket.valueBits - 1)) - 1;
+         writer.write(bucket.control, bucket.controlBits);
+         writer.write(bucket.valueBits == TIMESTAMP_BITS
+                          ? static_cast<std::uint64_t>(deltaOfDelta)
+                          : static_cast<std::uint64_t>(deltaOfDelta + offset),
+                      bucket.valueBits);
+         return;
+      }
+   }
+}
+
+void BlockEncoder::appendValue(BitWriter& writer, const std::uint32_t value) noexcept
+{
+   const auto xored = value ^ mPreviousValue;
+   if (xored == 0)
+   {
+      writer.write(0, 1);
+      return;
+   }
+   writer.write(1, 1);
+
+   const auto leading = std::min(static_cast<unsigned int>(std::countl_zero(xored)), MAX_LEADING);
+   const auto trailing = static_cast<unsigned int>(std::countr_zero(xored));
+
+   // Reusing the previous meaningful window saves its description when the new value fits in it
+   if (mWindowValid && leading >= mLeading && trailing >= mTrailing)
+   {
+      writer.write(0, 1);
+      writer.write(xored >> mTrailing, VALUE_BITS - mLeading - mTrailing);
+      return;
+   }
+
+   const auto meaningful = VALUE_BITS - leading - trailing;
+   writer.write(1, 1);
+   writer.write(leading, WINDOW_FIELD_BITS);
+   writer.write(meaningful - 1, WINDOW_FIELD_BITS);
+   writer.write(xored >> trailing, meaningful);
+
+   mLeading = leading;
+   mTrailing = trailing;
+   mWindowValid = true;
+}
+
+void BlockEncoder::seal() noexcept
+{
+   mHeader.sealed = 1;
+}
+
+void BlockEncoder::reset() noexcept
+{
+   mBlock.fill(0);
+   mHeader = BlockHeader();
+   mPreviousDelta = 0;
+   mPreviousValue = 0;
+   mLeading = 0;
+   mTrailing = 0;
+   mWindowValid = false;
+}
+
+std::span<const std::uint8_t> BlockEncoder::bytes() noexcept
+{
+   std::memcpy(mBlock.data(), &mHeader, sizeof(BlockHeader));
+   return mBlock;
+}
+
+BlockDecoder::BlockDecoder(std::span<const std::uint8_t> block) noexcept
+    : BlockDecoder(block, Block::header(block))
+{
+}
+
+BlockDecoder::BlockDecoder(std::span<const std::uint8_t> block, const BlockHeader& header) noexcept
+    : mHeader{header}, mReader{block.subspan(sizeof(BlockHeader))}
+{
+}
+
+bool BlockDecoder::next(std::int64_t& timestamp, float& value) noexcept
+{
+   if (mRead == mHeader.count || mReader.position() >= mHeader.bits)
+   {
+      return false;
+   }
+
+   if (mRead == 0)
+   {
+      mTimestamp = static_cast<std::int64_t>(mReader.read(TIMESTAMP_BITS));
+      mValue = static_cast<std::uint32_t>(mReader.read(VALUE_BITS));
+   }
+   else
+   {
+      if (mReader.readBit())
+      {
+         auto bucket = TIMESTAMP_BUCKETS.begin();
+         while (bucket->controlBits < TIMESTAMP_BUCKETS.back().controlBits && mReader.readBit())
+         {
+            bucket++;
+         }
+         // The last two buckets share the control length and differ by their last bit
+         if (bucket->controlBits == TIMESTAMP_BUCKETS.back().controlBits && mReader.readBit())
+         {
+            bucket++;
+         }
+
+         const auto raw = mReader.read(bucket->valueBits);
+         mDelta += bucket->valueBits == TIMESTAMP_BITS
+                       ? static_cast<std::int64_t>(raw)
+                       : static_cast<std::int64_t>(raw) -
+                             ((std::int64_t{1} << (bucket->valueBits - 1)) - 1);
+      }
+      mTimestamp += mDelta;
+
+      if (mReader.readBit())
+      {
+         if (mReader.readBit())
+         {
+            mLeading = static_cast<unsigned int>(mReader.read(WINDOW_FIELD_BITS));
+            const auto meaningful = static_cast<unsigned int>(mReader.read(WINDOW_FIELD_BITS)) + 1;
+            if (mLeading + meaningful > VALUE_BITS)
+            {
+               // Only a corrupted block can describe a window wider than a value
+               mRead = mHeader.count;
+               return false;
+            }
+            mTrailing = VALUE_BITS - mLeading - meaningful;
+         }
+         const auto meaningful = VALUE_BITS - mLeading - mTrailing;
+         mValue ^= static_cast<std::uint32_t>(mReader.read(meaningful)) << mTrailing;
+      }
+   }
+
+   timestamp = mTimestamp;
+   value = std::bit_cast<float>(mValue);
+   mRead++;
+
+   return true;
+}
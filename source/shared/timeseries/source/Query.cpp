@@ -0,0 +1,194 @@
+#include "Query.hpp"
+
+#include <algorithm>
+#include <future>
+#include <limits>
+
+namespace {
+// What a block contributes to the buckets of a query, in time order
+using Contribution = std::vector<Bucket>;
+
+void decode(const SeriesReader& series, const std::size_t index, const Query& query,
+            const std::int64_t from, const std::int64_t to, Contribution& contribution)
+{
+   BlockDecoder decoder(series.block(index), series.blocks()[index]);
+   std::int64_t timestamp = 0;
+   float value = 0;
+   while (decoder.next(timestamp, value) && timestamp <= to)
+   {
+      if (timestamp < from)
+      {
+         continue;
+      }
+
+      const auto start = Bucket::align(timestamp, query.width);
+      if (contribution.empty() || contribution.back().start != start)
+      {
+         contribution.push_back(Bucket{.start = start});
+      }
+      contribution.back().add(value);
+   }
+}
+} // namespace
+
+QueryEngine::QueryEngine(const unsigned int threads) noexcept : mThreads{std::max(threads, 1U)}
+{
+}
+
+Result<std::vector<Bucket>, StorageError>
+QueryEngine::run(const Query& query, const SeriesReader& series,
+                 std::span<const RollupReader* const> tiers) const
+{
+   if (query.width <= 0 || query.from > query.to)
+   {
+      return Error(StorageError::INVALID_QUERY, "Query range or bucket width is invalid");
+   }
+
+   const auto first = Bucket::align(query.from, query.width);
+   const auto last = Bucket::align(query.to, query.width);
+   const auto count = (static_cast<std::uint64_t>(last) - static_cast<std::uint64_t>(first)) /
+                          static_cast<std::uint64_t>(query.width) +
+                      1;
+   if (count > MAX_BUCKETS)
+   {
+      return Error(StorageError::INVALID_QUERY,
+                   ErrorDetail::compose("Query would return more than ", MAX_BUCKETS, " buckets"));
+   }
+
+   std::vector<Bucket> buckets(count);
+   for (std::size_t index = 0; index < buckets.size(); index++)
+   {
+      buckets[index].start = first + static_cast<std::int64_t>(index) * query.width;
+   }
+
+   // The coarsest tier whose buckets nest into the requested ones
+   const RollupReader* tier = nullptr;
+   for (const auto* candidate : tiers)
+   {
+      if (candidate != nullptr && !candidate->buckets().empty() &&
+          query.width % candidate->width() == 0 &&
+          (tier == nullptr || candidate->width() > tier->width()))
+      {
+         tier = candidate;
+      }
+   }
+
+   // Only the tier buckets lying entirely within the range are used, and never the last one
+   // which is still being filled. Samples around them come from the raw series
+   constexpr auto LIMIT = std::numeric_limits<std::int64_t>::max();
+   bool summarized = false;
+   if (tier != nullptr && query.from < LIMIT - tier->width() && query.to < LIMIT)
+   {
+      const auto width = tier->width();
+      const auto coveredFrom = std::max(Bucket::align(query.from + width - 1, width),
+                                        tier->buckets().front().start);
+      const auto coveredTo =
+          std::min(Bucket::align(query.to + 1, width), tier->buckets().back().start) - 1;
+
+      if (coveredFrom <= coveredTo)
+      {
+         // Going through time in order, so that every bucket ends up with its latest value
+         if (query.from < coveredFrom)
+         {
+            scan(query, series, query.from, coveredFrom - 1, buckets);
+         }
+         for (const auto& bucket : tier->buckets(coveredFrom, coveredTo))
+         {
+            buckets[static_cast<std::size_t>((Bucket::align(bucket.start, query.width) - first) /
+                                             query.width)]
+                .merge(bucket);
+         }
+         if (coveredTo < query.to)
+         {
+            scan(query, series, coveredTo + 1, query.to, buckets);
+         }
+         summarized = true;
+      }
+   }
+
+   if (!summarized)
+   {
+      scan(query, series, query.from, query.to, buckets);
+   }
+
+   buckets.erase(std::remove_if(buckets.begin(), buckets.end(),
+                                [](const Bucket& bucket) { return bucket.count == 0; }),
+                 buckets.end());
+
+   return buckets;
+}
+
+void QueryEngine::scan(const Query& query, const SeriesReader& series, const std::int64_t from,
+                       const std::int64_t to, std::vector<Bucket>& buckets) const
+{
+   const auto [firstBlock, lastBlock] = series.overlapping(from, to);
+   if (firstBlock == lastBlock)
+   {
+      return;
+   }
+
+   std::vector<Contribution> contributions(lastBlock - firstBlock);
+   std::vector<std::size_t> toDecode;
+   for (auto index = firstBlock; index < lastBlock; index++)
+   {
+      // A block within the range and a single bucket is summarized by its header alone
+      const auto& header = series.blocks()[index];
+      if (header.firstTimestamp >= from && header.lastTimestamp <= to &&
+          Bucket::align(header.firstTimestamp, query.width) ==
+              Bucket::align(header.lastTimestamp, query.width))
+      {
+         contributions[index - firstBlock].push_back(
+             Bucket{.start = Bucket::align(header.firstTimestamp, query.width),
+                    .sum = header.sum,
+                    .count = header.count,
+                    .min = header.min,
+                    .max = header.max,
+                    .last = header.last});
+      }
+      else
+      {
+         toDecode.push_back(index);
+      }
+   }
+
+   const auto threads = std::min<std::size_t>(
+       mThreads, std::max<std::size_t>(toDecode.size() / MIN_BLOCKS_PER_THREAD, 1));
+   const auto decodeRange = [&](const std::size_t begin, const std::size_t end) {
+      for (auto position = begin; position < end; position++)
+      {
+         const auto index = toDecode[position];
+         decode(series, index, query, from, to, contributions[index - firstBlock]);
+      }
+   };
+
+   if (threads <= 1)
+   {
+      decodeRange(0, toDecode.size());
+   }
+   else
+   {
+      // Every thread decodes a contiguous slice, the calling one included
+      std::vector<std::future<void>> workers;
+      const auto slice = (toDecode.size() + threads - 1) / threads;
+      for (std::size_t begin = slice; begin < toDecode.size(); begin += slice)
+      {
+         workers.push_back(std::async(std::launch::async, decodeRange, begin,
+                                      std::min(begin + slice, toDecode.size())));
+      }
+      decodeRange(0, slice);
+      for (auto& worker : workers)
+      {
+         worker.get();
+      }
+   }
+
+   // Merging in block order keeps the last value of every bucket right
+   const auto first = buckets.front().start;
+   for (const auto& contribution : contributions)
+   {
+      for (const auto& bucket : contribution)
+      {
+         buckets[static_cast<std::size_t>((bucket.start - first) / query.width)].merge(bucket);
+      }
+   }
+}
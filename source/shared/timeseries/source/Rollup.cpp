@@ -0,0 +1,205 @@
+#include "Rollup.hpp"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+Result<void, StorageError> RollupWriter::open(const std::filesystem::path& path,
+                                              const std::int64_t width) noexcept
+{
+   close();
+
+   if (width <= 0)
+   {
+      return Error(StorageError::UNABLE_TO_OPEN, "Rollup width must be positive");
+   }
+
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+   mFile = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP);
+   if (mFile < 0)
+   {
+      return Error(StorageError::UNABLE_TO_OPEN,
+                   ErrorDetail::compose("Unable to open rollup ", path.native()));
+   }
+
+   struct stat status
+   {
+   };
+   if (fstat(mFile, &status) != 0)
+   {
+      close();
+      return Error(StorageError::UNABLE_TO_OPEN, "Unable to stat rollup file");
+   }
+
+   mWidth = width;
+   mDirty = false;
+   mCurrent = Bucket();
+   mIndex = static_cast<std::size_t>(status.st_size) / sizeof(Bucket);
+
+   // Resuming the last bucket, it may still receive samples
+   if (mIndex > 0)
+   {
+      mIndex--;
+      if (pread(mFile, &mCurrent, sizeof(Bucket), static_cast<off_t>(mIndex * sizeof(Bucket))) !=
+          sizeof(Bucket))
+      {
+         close();
+         return Error(StorageError::UNABLE_TO_READ, "Unable to read last rollup bucket");
+      }
+      if (mCurrent.count == 0 || mCurrent.start != Bucket::align(mCurrent.start, mWidth))
+      {
+         close();
+         return Error(StorageError::CORRUPTED, "Rollup does not match its width");
+      }
+   }
+
+   return {};
+}
+
+Result<void, StorageError> RollupWriter::add(const std::int64_t timestamp,
+                                             const float value) noexcept
+{
+   if (!isOpen())
+   {
+      return Error(StorageError::UNABLE_TO_WRITE, "Adding to a rollup that is not open");
+   }
+
+   const auto start = Bucket::align(timestamp, mWidth);
+   if (mCurrent.count > 0 && start != mCurrent.start)
+   {
+      if (start < mCurrent.start)
+      {
+         return Error(StorageError::OUT_OF_ORDER,
+                      ErrorDetail::compose("Sample at ", timestamp, " is older than the last one"));
+      }
+
+      auto written = writeCurrent();
+      if (!written)
+      {
+         return written;
+      }
+      mIndex++;
+      mCurrent = Bucket();
+   }
+
+   mCurrent.start = start;
+   mCurrent.add(value);
+   mDirty = true;
+
+   return {};
+}
+
+Result<void, StorageError> RollupWriter::flush() noexcept
+{
+   if (!isOpen() || !mDirty)
+   {
+      return {};
+   }
+
+   return writeCurrent();
+}
+
+Result<void, StorageError> RollupWriter::writeCurrent() noexcept
+{
+   if (pwrite(mFile, &mCurrent, sizeof(Bucket), static_cast<off_t>(mIndex * sizeof(Bucket))) !=
+       sizeof(Bucket))
+   {
+      return Error(StorageError::UNABLE_TO_WRITE,
+                   ErrorDetail::compose("Unable to write rollup bucket ", mIndex));
+   }
+
+   mDirty = false;
+   return {};
+}
+
+void RollupWriter::close() noexcept
+{
+   if (isOpen())
+   {
+      [[maybe_unused]] auto flushed = flush();
+      ::close(mFile);
+      mFile = -1;
+   }
+}
+
+RollupWriter::~RollupWriter()
+{
+   close();
+}
+
+Result<void, StorageError> RollupReader::open(const std::filesystem::path& path,
+                                              const std::int64_t width) noexcept
+{
+   close();
+
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+   mFile = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+   if (mFile < 0)
+   {
+      return Error(StorageError::UNABLE_TO_OPEN,
+                   ErrorDetail::compose("Unable to open rollup ", path.native()));
+   }
+
+   struct stat status
+   {
+   };
+   if (fstat(mFile, &status) != 0)
+   {
+      close();
+      return Error(StorageError::UNABLE_TO_OPEN, "Unable to stat rollup file");
+   }
+
+   mWidth = width;
+   const auto count = static_cast<std::size_t>(status.st_size) / sizeof(Bucket);
+   if (count == 0)
+   {
+      return {};
+   }
+
+   auto* mapping = mmap(nullptr, count * sizeof(Bucket), PROT_READ, MAP_SHARED, mFile, 0);
+   if (mapping == MAP_FAILED)
+   {
+      close();
+      return Error(StorageError::UNABLE_TO_MAP, "Unable to map rollup file");
+   }
+   mBuckets = std::span(static_cast<const Bucket*>(mapping), count);
+
+   return {};
+}
+
+std::span<const Bucket> RollupReader::buckets(const std::int64_t from,
+                                              const std::int64_t to) const noexcept
+{
+   const auto first = std::partition_point(mBuckets.begin(), mBuckets.end(),
+                                           [from](const Bucket& bucket) {
+                                              return bucket.start < from;
+                                           });
+   const auto last = std::partition_point(
+       first, mBuckets.end(), [to](const Bucket& bucket) { return bucket.start <= to; });
+
+   return {first, last};
+}
+
+void RollupReader::close() noexcept
+{
+   if (!mBuckets.empty())
+   {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+      munmap(const_cast<Bucket*>(mBuckets.data()), mBuckets.size_bytes());
+      mBuckets = {};
+   }
+
+   if (mFile >= 0)
+   {
+      ::close(mFile);
+      mFile = -1;
+   }
+}
+
+RollupReader::~RollupReader()
+{
+   close();
+}
@@ -0,0 +1,284 @@
+#include "Series.hpp"
+
+#include <algorithm>
+#include <climits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+[[nodiscard]] bool validHeader(const BlockHeader& header) noexcept
+{
+   return header.magic == BlockHeader::MAGIC && header.count > 0 &&
+          header.bits <= Block::PAYLOAD_SIZE * CHAR_BIT &&
+          header.firstTimestamp <= header.lastTimestamp;
+}
+} // namespace
+
+Result<void, StorageError> SeriesWriter::open(const std::filesystem::path& path) noexcept
+{
+   close();
+
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+   mFile = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR | S_IRGRP);
+   if (mFile < 0)
+   {
+      return Error(StorageError::UNABLE_TO_OPEN,
+                   ErrorDetail::compose("Unable to open series ", path.native()));
+   }
+
+   struct stat status
+   {
+   };
+   if (fstat(mFile, &status) != 0)
+   {
+      close();
+      return Error(StorageError::UNABLE_TO_OPEN, "Unable to stat series file");
+   }
+
+   // A torn trailing block can only come from a crash in the middle of a write, dropping it
+   const auto blocks = static_cast<std::size_t>(status.st_size) / Block::SIZE;
+   mBlockIndex = blocks;
+   mCount = 0;
+   mDirty = false;
+   mEncoder.reset();
+
+   Block::Bytes bytes{};
+   for (std::size_t index = 0; index < blocks; index++)
+   {
+      if (pread(mFile, bytes.data(), sizeof(BlockHeader),
+                static_cast<off_t>(index * Block::SIZE)) != sizeof(BlockHeader))
+      {
+         close();
+         return Error(StorageError::UNABLE_TO_READ, "Unable to read series block header");
+      }
+      const auto header = Block::header(bytes);
+      if (!validHeader(header))
+      {
+         close();
+         return Error(StorageError::CORRUPTED,
+                      ErrorDetail::compose("Invalid header for block ", index));
+      }
+      mCount += header.count;
+   }
+
+   if (blocks > 0)
+   {
+      const auto last = blocks - 1;
+      if (pread(mFile, bytes.data(), Block::SIZE, static_cast<off_t>(last * Block::SIZE)) !=
+          Block::SIZE)
+      {
+         close();
+         return Error(StorageError::UNABLE_TO_READ, "Unable to read last series block");
+      }
+
+      // Resuming the last block if it was not full yet: encoding is deterministic so replaying its
+      // samples rebuilds the very same bytes along with the encoder state
+      BlockDecoder decoder(bytes);
+      if (decoder.header().sealed == 0)
+      {
+         mBlockIndex = last;
+         mCount -= decoder.header().count;
+         std::int64_t timestamp = 0;
+         float value = 0;
+         while (decoder.next(timestamp, value))
+         {
+            [[maybe_unused]] const auto appended = mEncoder.append(timestamp, value);
+            mCount++;
+         }
+      }
+   }
+
+   return {};
+}
+
+Result<void, StorageError> SeriesWriter::append(const std::int64_t timestamp,
+                                               const float value) noexcept
+{
+   if (!isOpen())
+   {
+      return Error(StorageError::UNABLE_TO_WRITE, "Appending to a series that is not open");
+   }
+
+   if (mEncoder.header().count > 0 && timestamp < mEncoder.header().lastTimestamp)
+   {
+      return Error(StorageError::OUT_OF_ORDER,
+                   ErrorDetail::compose("Sample at ", timestamp, " is older than the last one"));
+   }
+
+   if (!mEncoder.append(timestamp, value))
+   {
+      mEncoder.seal();
+      auto written = writeBlock();
+      if (!written)
+      {
+         return written;
+      }
+
+      mBlockIndex++;
+      mEncoder.reset();
+      [[maybe_unused]] const auto appended = mEncoder.append(timestamp, value);
+   }
+
+   mCount++;
+   mDirty = true;
+
+   return {};
+}
+
+Result<void, StorageError> SeriesWriter::flush() noexcept
+{
+   if (!isOpen() || !mDirty)
+   {
+      return {};
+   }
+
+   return writeBlock();
+}
+
+Result<void, StorageError> SeriesWriter::writeBlock() noexcept
+{
+   const auto bytes = mEncoder.bytes();
+   if (pwrite(mFile, bytes.data(), bytes.size(), static_cast<off_t>(mBlockIndex * Block::SIZE)) !=
+       static_cast<ssize_t>(bytes.size()))
+   {
+      return Error(StorageError::UNABLE_TO_WRITE,
+                   ErrorDetail::compose("Unable to write series block ", mBlockIndex));
+   }
+
+   mDirty = false;
+   return {};
+}
+
+void SeriesWriter::close() noexcept
+{
+   if (isOpen())
+   {
+      [[maybe_unused]] auto flushed = flush();
+      ::close(mFile);
+      mFile = -1;
+   }
+}
+
+SeriesWriter::~SeriesWriter()
+{
+   close();
+}
+
+Result<void, StorageError> SeriesReader::open(const std::filesystem::path& path) noexcept
+{
+   close();
+
+   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+   mFile = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+   if (mFile < 0)
+   {
+      return Error(StorageError::UNABLE_TO_OPEN,
+                   ErrorDetail::compose("Unable to open series ", path.native()));
+   }
+
+   struct stat status
+   {
+   };
+   if (fstat(mFile, &status) != 0)
+   {
+      close();
+      return Error(StorageError::UNABLE_TO_OPEN, "Unable to stat series file");
+   }
+
+   const auto blocks = static_cast<std::size_t>(status.st_size) / Block::SIZE;
+   if (blocks == 0)
+   {
+      return {};
+   }
+
+   auto* mapping = mmap(nullptr, blocks * Block::SIZE, PROT_READ, MAP_SHARED, mFile, 0);
+   if (mapping == MAP_FAILED)
+   {
+      close();
+      return Error(StorageError::UNABLE_TO_MAP, "Unable to map series file");
+   }
+   mMapping = std::span(static_cast<const std::uint8_t*>(mapping), blocks * Block::SIZE);
+
+   mIndex.reserve(blocks);
+   for (std::size_t index = 0; index < blocks; index++)
+   {
+      const auto header = Block::header(block(index));
+      if (!validHeader(header))
+      {
+         close();
+         return Error(StorageError::CORRUPTED,
+                      ErrorDetail::compose("Invalid header for block ", index));
+      }
+      mIndex.push_back(header);
+   }
+
+   return {};
+}
+
+std::span<const std::uint8_t> SeriesReader::block(const std::size_t index) const noexcept
+{
+   return mMapping.subspan(index * Block::SIZE, Block::SIZE);
+}
+
+std::pair<std::size_t, std::size_t> SeriesReader::overlapping(const std::int64_t from,
+                                                              const std::int64_t to) const noexcept
+{
+   // Blocks are in time order, so both ends can be found by binary search over the headers
+   const auto first = std::partition_point(
+       mIndex.begin(), mIndex.end(),
+       [from](const BlockHeader& header) { return header.lastTimestamp < from; });
+   const auto last = std::partition_point(first, mIndex.end(), [to](const BlockHeader& header) {
+      return header.firstTimestamp <= to;
+   });
+
+   return {static_cast<std::size_t>(first - mIndex.begin()),
+           static_cast<std::size_t>(last - mIndex.begin())};
+}
+
+std::uint64_t SeriesReader::scan(const std::int64_t from, const std::int64_t to,
+                                 const Visitor& visitor) const
+{
+   std::uint64_t visited = 0;
+   const auto [first, last] = overlapping(from, to);
+   for (auto index = first; index < last; index++)
+   {
+      BlockDecoder decoder(block(index), mIndex[index]);
+      std::int64_t timestamp = 0;
+      float value = 0;
+      while (decoder.next(timestamp, value) && timestamp <= to)
+      {
+         if (timestamp >= from)
+         {
+            visitor(timestamp, value);
+            visited++;
+         }
+      }
+   }
+
+   return visited;
+}
+
+void SeriesReader::close() noexcept
+{
+   if (!mMapping.empty())
+   {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+      munmap(const_cast<std::uint8_t*>(mMapping.data()), mMapping.size());
+      mMapping = {};
+   }
+   mIndex.clear();
+
+   if (mFile >= 0)
+   {
+      ::close(mFile);
+      mFile = -1;
+   }
+}
+
+SeriesReader::~SeriesReader()
+{
+   close();
+}
@@ -0,0 +1,387 @@
+#include <bit>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "Query.hpp"
+#include "Rollup.hpp"
+#include "Series.hpp"
+
+namespace {
+struct Sample
+{
+   std::int64_t timestamp;
+   float value;
+};
+
+std::vector<Sample> makeSamples(const std::size_t count, const std::int64_t start = 1000000)
+{
+   std::mt19937 rng(42);
+   std::uniform_int_distribution<std::int64_t> jitter(-3, 3);
+   std::normal_distribution<float> noise(0, 0.1F);
+
+   std::vector<Sample> samples;
+   auto timestamp = start;
+   auto value = 21.0F;
+   for (std::size_t i = 0; i < count; i++)
+   {
+      // Mostly regular timestamps with the occasional gap
+      timestamp += (i % 100 == 99) ? 60000 : 1000 + jitter(rng);
+      value += noise(rng);
+      samples.push_back({timestamp, i % 7 == 0 ? std::round(value) : value});
+   }
+
+   return samples;
+}
+
+std::filesystem::path seriesPath(const std::string& name)
+{
+   auto path = std::filesystem::temp_directory_path() / (name + ".series");
+   std::filesystem::remove(path);
+   return path;
+}
+} // namespace
+
+TEST(Block, RoundTrip)
+{
+   const auto samples = makeSamples(100);
+   BlockEncoder encoder;
+   for (const auto& sample : samples)
+   {
+      ASSERT_TRUE(encoder.append(sample.timestamp, sample.value));
+   }
+   ASSERT_EQ(encoder.header().count, samples.size());
+   ASSERT_EQ(encoder.header().firstTimestamp, samples.front().timestamp);
+   ASSERT_EQ(encoder.header().lastTimestamp, samples.back().timestamp);
+
+   BlockDecoder decoder(encoder.bytes());
+   std::int64_t timestamp = 0;
+   float value = 0;
+   for (const auto& sample : samples)
+   {
+      ASSERT_TRUE(decoder.next(timestamp, value));
+      ASSERT_EQ(timestamp, sample.timestamp);
+      ASSERT_EQ(value, sample.value);
+   }
+   ASSERT_FALSE(decoder.next(timestamp, value));
+}
+
+TEST(Block, ExtremeValues)
+{
+   const std::vector<Sample> samples = {{-5, 0.0F},
+                                        {0, -0.0F},
+                                        {std::numeric_limits<std::int32_t>::max(), 1e30F},
+                                        {std::numeric_limits<std::int64_t>::max() / 2, -1e-30F},
+                                        {std::numeric_limits<std::int64_t>::max(), INFINITY}};
+   BlockEncoder encoder;
+   for (const auto& sample : samples)
+   {
+      ASSERT_TRUE(encoder.append(sample.timestamp, sample.value));
+   }
+
+   BlockDecoder decoder(encoder.bytes());
+   std::int64_t timestamp = 0;
+   float value = 0;
+   for (const auto& sample : samples)
+   {
+      ASSERT_TRUE(decoder.next(timestamp, value));
+      ASSERT_EQ(timestamp, sample.timestamp);
+      ASSERT_EQ(std::bit_cast<std::uint32_t>(value), std::bit_cast<std::uint32_t>(sample.value));
+   }
+}
+
+TEST(Block, Full)
+{
+   BlockEncoder encoder;
+   std::size_t appended = 0;
+   for (const auto& sample : makeSamples(10000))
+   {
+      if (!encoder.append(sample.timestamp, sample.value))
+      {
+         break;
+      }
+      appended++;
+   }
+   ASSERT_LT(appended, 10000) << "Block never filled up";
+   ASSERT_LE(encoder.header().bits, Block::PAYLOAD_SIZE * 8);
+   // Regular series should take way less than the 96 bits of their raw representation
+   ASSERT_GT(appended, Block::PAYLOAD_SIZE * 8 / 40);
+}
+
+TEST(Series, WriteAndScan)
+{
+   const auto path = seriesPath("WriteAndScan");
+   const auto samples = makeSamples(5000);
+   {
+      SeriesWriter writer;
+      ASSERT_TRUE(writer.open(path));
+      for (const auto& sample : samples)
+      {
+         ASSERT_TRUE(writer.append(sample.timestamp, sample.value));
+      }
+      ASSERT_EQ(writer.count(), samples.size());
+   }
+
+   SeriesReader reader;
+   ASSERT_TRUE(reader.open(path));
+   ASSERT_GT(reader.blocks().size(), 1);
+
+   std::vector<Sample> scanned;
+   const auto visited = reader.scan(std::numeric_limits<std::int64_t>::min(),
+                                    std::numeric_limits<std::int64_t>::max(),
+                                    [&scanned](std::int64_t timestamp, float value) {
+                                       scanned.push_back({timestamp, value});
+                                    });
+   ASSERT_EQ(visited, samples.size());
+   for (std::size_t i = 0; i < samples.size(); i++)
+   {
+      ASSERT_EQ(scanned[i].timestamp, samples[i].timestamp);
+      ASSERT_EQ(scanned[i].value, samples[i].value);
+   }
+
+   // A range in the middle of the series only visits its own samples
+   const auto from = samples[1234].timestamp;
+   const auto to = samples[3456].timestamp;
+   ASSERT_EQ(reader.scan(from, to, [](std::int64_t, float) {}), 3456 - 1234 + 1);
+   ASSERT_EQ(reader.scan(samples.back().timestamp + 1, std::numeric_limits<std::int64_t>::max(),
+                         [](std::int64_t, float) {}),
+             0);
+
+   std::filesystem::remove(path);
+}
+
+TEST(Series, Resume)
+{
+   const auto path = seriesPath("Resume");
+   const auto samples = makeSamples(3000);
+   const auto half = samples.size() / 2;
+   {
+      SeriesWriter writer;
+      ASSERT_TRUE(writer.open(path));
+      for (std::size_t i = 0; i < half; i++)
+      {
+         ASSERT_TRUE(writer.append(samples[i].timestamp, samples[i].value));
+      }
+   }
+   {
+      SeriesWriter writer;
+      ASSERT_TRUE(writer.open(path));
+      ASSERT_EQ(writer.count(), half);
+      ASSERT_EQ(writer.append(0, 0).error(), StorageError::OUT_OF_ORDER);
+      for (std::size_t i = half; i < samples.size(); i++)
+      {
+         ASSERT_TRUE(writer.append(samples[i].timestamp, samples[i].value));
+      }
+   }
+
+   SeriesReader reader;
+   ASSERT_TRUE(reader.open(path));
+   std::size_t index = 0;
+   reader.scan(std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max(),
+               [&](std::int64_t timestamp, float value) {
+                  ASSERT_EQ(timestamp, samples[index].timestamp);
+                  ASSERT_EQ(value, samples[index].value);
+                  index++;
+               });
+   ASSERT_EQ(index, samples.size());
+
+   std::filesystem::remove(path);
+}
+
+TEST(Series, Corrupted)
+{
+   const auto path = seriesPath("Corrupted");
+   {
+      std::ofstream file(path, std::ios::binary);
+      const std::vector<char> garbage(Block::SIZE, 'x');
+      file.write(garbage.data(), static_cast<std::streamsize>(garbage.size()));
+   }
+
+   SeriesReader reader;
+   auto opened = reader.open(path);
+   ASSERT_TRUE(opened.hasError());
+   ASSERT_EQ(opened.error(), StorageError::CORRUPTED);
+
+   SeriesWriter writer;
+   ASSERT_EQ(writer.open(path).error(), StorageError::CORRUPTED);
+
+   std::filesystem::remove(path);
+}
+
+namespace {
+std::vector<Bucket> bruteForce(const std::vector<Sample>& samples, const Query& query)
+{
+   std::vector<Bucket> buckets;
+   for (const auto& sample : samples)
+   {
+      if (sample.timestamp < query.from || sample.timestamp > query.to)
+      {
+         continue;
+      }
+
+      const auto start = Bucket::align(sample.timestamp, query.width);
+      if (buckets.empty() || buckets.back().start != start)
+      {
+         buckets.push_back(Bucket{.start = start});
+      }
+      buckets.back().add(sample.value);
+   }
+
+   return buckets;
+}
+
+void expectSameBuckets(const std::vector<Bucket>& actual, const std::vector<Bucket>& expected)
+{
+   ASSERT_EQ(actual.size(), expected.size());
+   for (std::size_t i = 0; i < expected.size(); i++)
+   {
+      ASSERT_EQ(actual[i].start, expected[i].start);
+      ASSERT_EQ(actual[i].count, expected[i].count);
+      ASSERT_EQ(actual[i].min, expected[i].min);
+      ASSERT_EQ(actual[i].max, expected[i].max);
+      ASSERT_EQ(actual[i].last, expected[i].last);
+      ASSERT_NEAR(actual[i].mean(), expected[i].mean(), 1e-4);
+   }
+}
+} // namespace
+
+TEST(Bucket, Align)
+{
+   ASSERT_EQ(Bucket::align(0, 1000), 0);
+   ASSERT_EQ(Bucket::align(999, 1000), 0);
+   ASSERT_EQ(Bucket::align(1000, 1000), 1000);
+   ASSERT_EQ(Bucket::align(-1, 1000), -1000);
+   ASSERT_EQ(Bucket::align(-1000, 1000), -1000);
+}
+
+TEST(Rollup, WriteAndResume)
+{
+   constexpr std::int64_t width = 60000;
+   const auto path = seriesPath("Rollup");
+   const auto samples = makeSamples(2000);
+   const auto half = samples.size() / 2;
+   {
+      RollupWriter writer;
+      ASSERT_TRUE(writer.open(path, width));
+      for (std::size_t i = 0; i < half; i++)
+      {
+         ASSERT_TRUE(writer.add(samples[i].timestamp, samples[i].value));
+      }
+   }
+   {
+      RollupWriter writer;
+      ASSERT_TRUE(writer.open(path, width));
+      for (std::size_t i = half; i < samples.size(); i++)
+      {
+         ASSERT_TRUE(writer.add(samples[i].timestamp, samples[i].value));
+      }
+   }
+
+   RollupReader reader;
+   ASSERT_TRUE(reader.open(path, width));
+   const auto everything = Query{.from = std::numeric_limits<std::int64_t>::min() / 2,
+                                 .to = std::numeric_limits<std::int64_t>::max() / 2,
+                                 .width = width};
+   const auto buckets = reader.buckets();
+   expectSameBuckets({buckets.begin(), buckets.end()}, bruteForce(samples, everything));
+
+   std::filesystem::remove(path);
+}
+
+class QueryEngineTest : public ::testing::Test
+{
+protected:
+   static constexpr std::array<std::int64_t, 2> TIERS = {60000, 3600000};
+
+   std::vector<Sample> mSamples = makeSamples(50000);
+   SeriesReader mSeries;
+   std::array<RollupReader, TIERS.size()> mRollups;
+   std::array<const RollupReader*, TIERS.size()> mTiers{};
+
+   void SetUp() override
+   {
+      {
+         SeriesWriter writer;
+         ASSERT_TRUE(writer.open(seriesPath("Query")));
+         std::array<RollupWriter, TIERS.size()> rollups;
+         for (std::size_t tier = 0; tier < TIERS.size(); tier++)
+         {
+            ASSERT_TRUE(
+                rollups[tier].open(seriesPath("Query" + std::to_string(tier)), TIERS[tier]));
+         }
+
+         for (const auto& sample : mSamples)
+         {
+            ASSERT_TRUE(writer.append(sample.timestamp, sample.value));
+            for (auto& rollup : rollups)
+            {
+               ASSERT_TRUE(rollup.add(sample.timestamp, sample.value));
+            }
+         }
+      }
+
+      ASSERT_TRUE(mSeries.open(std::filesystem::temp_directory_path() / "Query.series"));
+      for (std::size_t tier = 0; tier < TIERS.size(); tier++)
+      {
+         ASSERT_TRUE(mRollups[tier].open(std::filesystem::temp_directory_path() /
+                                             ("Query" + std::to_string(tier) + ".series"),
+                                         TIERS[tier]));
+         mTiers[tier] = &mRollups[tier];
+      }
+   }
+
+   void TearDown() override
+   {
+      std::filesystem::remove(std::filesystem::temp_directory_path() / "Query.series");
+      for (std::size_t tier = 0; tier < TIERS.size(); tier++)
+      {
+         std::filesystem::remove(std::filesystem::temp_directory_path() /
+                                 ("Query" + std::to_string(tier) + ".series"));
+      }
+   }
+};
+
+TEST_F(QueryEngineTest, MatchesBruteForce)
+{
+   const std::vector<Query> queries = {
+       {.from = mSamples.front().timestamp, .to = mSamples.back().timestamp, .width = 3600000},
+       {.from = mSamples[123].timestamp + 1, .to = mSamples[45678].timestamp - 1, .width = 7200000},
+       {.from = mSamples[1000].timestamp, .to = mSamples[1100].timestamp, .width = 10000},
+       {.from = mSamples[20000].timestamp, .to = mSamples[40000].timestamp, .width = 60000},
+       {.from = 0, .to = mSamples.front().timestamp - 1, .width = 60000}};
+
+   for (const unsigned int threads : {1U, 4U})
+   {
+      const QueryEngine engine(threads);
+      for (const auto& query : queries)
+      {
+         const auto expected = bruteForce(mSamples, query);
+
+         auto raw = engine.run(query, mSeries);
+         ASSERT_TRUE(raw);
+         expectSameBuckets(raw.value(), expected);
+
+         auto summarized = engine.run(query, mSeries, mTiers);
+         ASSERT_TRUE(summarized);
+         expectSameBuckets(summarized.value(), expected);
+      }
+   }
+}
+
+TEST_F(QueryEngineTest, InvalidQuery)
+{
+   const QueryEngine engine;
+   ASSERT_EQ(engine.run({.from = 10, .to = 0, .width = 1}, mSeries).error(),
+             StorageError::INVALID_QUERY);
+   ASSERT_EQ(engine.run({.from = 0, .to = 10, .width = 0}, mSeries).error(),
+             StorageError::INVALID_QUERY);
+   ASSERT_EQ(engine.run({.from = 0, .to = std::numeric_limits<std::int64_t>::max(), .width = 1},
+                        mSeries)
+                 .error(),
+             StorageError::INVALID_QUERY);
+}
@@ -0,0 +1,157 @@
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "Frame.hpp"
+#include "TemperatureTopics.hpp"
+
+namespace {
+constexpr const char* VERSION = "1.0.0";
+
+TemperatureBatch batch(const std::size_t size)
+{
+   TemperatureBatch result;
+   for (std::size_t i = 0; i < size; i++)
+   {
+      result.samples.push_back({1700000000000 + static_cast<std::int64_t>(i) * 100,
+                                21.5F + static_cast<float>(i % 10) / 10});
+   }
+   return result;
+}
+
+nlohmann::json toJson(const TemperatureBatch& value)
+{
+   nlohmann::json message;
+   auto& samples = message["samples"] = nlohmann::json::array();
+   for (const auto& sample : value.samples)
+   {
+      samples.push_back({{"timestamp", sample.timestamp}, {"temperature", sample.temperature}});
+   }
+   return message;
+}
+
+void fromJson(const nlohmann::json& message, TemperatureBatch& value)
+{
+   value.samples.clear();
+   for (const auto& sample : message.at("samples"))
+   {
+      value.samples.push_back(
+          {sample.at("timestamp").get<std::int64_t>(), sample.at("temperature").get<float>()});
+   }
+}
+} // namespace
+
+// What publishing a reading takes going through a json document
+static void BM_JsonEncodeReading(benchmark::State& state)
+{
+   FrameEncoder encoder;
+   const TemperatureReading reading{21.5F};
+   for (auto _ : state)
+   {
+      nlohmann::json message;
+      message["temperature"] = reading.temperature;
+      benchmark::DoNotOptimize(encoder.encode("TEMPERATURE", message, VERSION));
+   }
+}
+BENCHMARK(BM_JsonEncodeReading);
+
+static void BM_TypedEncodeReading(benchmark::State& state)
+{
+   FrameEncoder encoder;
+   const TemperatureReading reading{21.5F};
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(encoder.encode(reading, VERSION));
+   }
+}
+BENCHMARK(BM_TypedEncodeReading);
+
+static void BM_JsonDecodeReading(benchmark::State& state)
+{
+   FrameEncoder encoder;
+   const std::string frame(encoder.encode(TemperatureReading{21.5F}, VERSION).value());
+   FrameDecoder decoder;
+   for (auto _ : state)
+   {
+      TemperatureReading reading;
+      if (decoder.decode(frame, VERSION))
+      {
+         reading.temperature = decoder.payload().at("temperature").get<float>();
+      }
+      benchmark::DoNotOptimize(reading);
+   }
+}
+BENCHMARK(BM_JsonDecodeReading);
+
+static void BM_TypedDecodeReading(benchmark::State& state)
+{
+   FrameEncoder encoder;
+   const std::string frame(encoder.encode(TemperatureReading{21.5F}, VERSION).value());
+   FrameDecoder decoder;
+   for (auto _ : state)
+   {
+      TemperatureReading reading;
+      benchmark::DoNotOptimize(decoder.decode(frame, VERSION, reading));
+      benchmark::DoNotOptimize(reading);
+   }
+}
+BENCHMARK(BM_TypedDecodeReading);
+
+static void BM_JsonEncodeBatch(benchmark::State& state)
+{
+   FrameEncoder encoder;
+   const auto value = batch(static_cast<std::size_t>(state.range(0)));
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(encoder.encode("TEMPERATURE_BATCH", toJson(value), VERSION));
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_JsonEncodeBatch)->Arg(64);
+
+static void BM_TypedEncodeBatch(benchmark::State& state)
+{
+   FrameEncoder encoder;
+   const auto value = batch(static_cast<std::size_t>(state.range(0)));
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(encoder.encode(value, VERSION));
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TypedEncodeBatch)->Arg(64);
+
+static void BM_JsonDecodeBatch(benchmark::State& state)
+{
+   FrameEncoder encoder;
+   const std::string frame(
+       encoder.encode(batch(static_cast<std::size_t>(state.range(0))), VERSION).value());
+   FrameDecoder decoder;
+   TemperatureBatch value;
+   for (auto _ : state)
+   {
+      if (decoder.decode(frame, VERSION))
+      {
+         fromJson(decoder.payload(), value);
+      }
+      benchmark::DoNotOptimize(value.samples.data());
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_JsonDecodeBatch)->Arg(64);
+
+static void BM_TypedDecodeBatch(benchmark::State& state)
+{
+   FrameEncoder encoder;
+   const std::string frame(
+       encoder.encode(batch(static_cast<std::size_t>(state.range(0))), VERSION).value());
+   FrameDecoder decoder;
+   TemperatureBatch value;
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(decoder.decode(frame, VERSION, value));
+      benchmark::DoNotOptimize(value.samples.data());
+   }
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TypedDecodeBatch)->Arg(64);
@@ -0,0 +1,67 @@
+#ifndef TEMPERATURE_TOPICS_HPP
+#define TEMPERATURE_TOPICS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "QuantileSketch.hpp"
+#include "Topic.hpp"
+
+// Topics published by the Temperature component, shared with whoever subscribes to them
+
+struct TemperatureReading
+{
+   float temperature = 0;
+   // Reporting by exception, set on the readings sent only because the value stayed put for long
+   bool heartbeat = false;
+};
+GROW_TOPIC(TemperatureReading, "TEMPERATURE", temperature, heartbeat)
+
+struct TemperatureSampleReading
+{
+   // Milliseconds since the epoch
+   std::int64_t timestamp = 0;
+   float temperature = 0;
+   // The configured id of the sensor it comes from, empty when there is a single one
+   std::string sensor;
+   bool heartbeat = false;
+};
+GROW_SCHEMA(TemperatureSampleReading, timestamp, temperature, sensor, heartbeat)
+
+struct TemperatureBatch
+{
+   std::vector<TemperatureSampleReading> samples;
+};
+GROW_TOPIC(TemperatureBatch, "TEMPERATURE_BATCH", samples)
+
+struct TemperatureAggregate
+{
+   // The configured id of the sensor aggregated, empty when there is a single one
+   std::string sensor;
+   float min = 0;
+   float max = 0;
+   float mean = 0;
+   float stddev = 0;
+   std::uint64_t count = 0;
+};
+GROW_TOPIC(TemperatureAggregate, "TEMPERATURE_AGGREGATE", sensor, min, max, mean, stddev, count)
+
+GROW_SCHEMA(QuantileSketch::Centroid, mean, weight)
+
+// The distribution of the temperatures a sensor saw over a period. Subscribers merge the centroids
+// of many of them into a QuantileSketch for the quantiles of a whole zone
+struct TemperatureSketch
+{
+   // Milliseconds since the epoch
+   std::int64_t start = 0;
+   std::int64_t end = 0;
+   std::string sensor;
+   std::uint64_t count = 0;
+   float min = 0;
+   float max = 0;
+   std::vector<QuantileSketch::Centroid> centroids;
+};
+GROW_TOPIC(TemperatureSketch, "TEMPERATURE_SKETCH", start, end, sensor, count, min, max, centroids)
+
+#endif // TEMPERATURE_TOPICS_HPP
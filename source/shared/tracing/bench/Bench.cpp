@@ -0,0 +1,41 @@
+#include <benchmark/benchmark.h>
+
+#include "Tracer.hpp"
+
+// What a span costs on the hot paths when tracing was not asked for
+static void BM_SpanDisabled(benchmark::State& state)
+{
+   Tracer::disable();
+   for (auto _ : state)
+   {
+      TraceSpan span("span");
+      benchmark::ClobberMemory();
+   }
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SpanDisabled);
+
+static void BM_SpanEnabled(benchmark::State& state)
+{
+   Tracer::enable("Bench");
+   std::size_t recorded = 0;
+   for (auto _ : state)
+   {
+      {
+         TraceSpan span("span");
+         benchmark::ClobberMemory();
+      }
+      // Keeping the buffer from filling up, which would only measure dropping
+      if (++recorded == Tracer::THREAD_CAPACITY)
+      {
+         recorded = 0;
+         state.PauseTiming();
+         Tracer::clear();
+         state.ResumeTiming();
+      }
+   }
+   Tracer::disable();
+   Tracer::clear();
+   state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SpanEnabled);
@@ -0,0 +1,144 @@
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Result.hpp"
+
+enum class TraceError
+{
+   UNABLE_TO_WRITE
+};
+
+struct TraceEvent
+{
+   enum class Kind : std::uint8_t
+   {
+      SPAN,
+      // Binds a message to the span sending it and to the one receiving it, in whichever process
+      FLOW_START,
+      FLOW_END
+   };
+
+   // Names are literals, events never own memory
+   const char* name = nullptr;
+   std::int64_t start = 0;
+   std::int64_t duration = 0;
+   std::uint64_t traceId = 0;
+   Kind kind = Kind::SPAN;
+};
+
+// Records spans into a fixed buffer per thread, which only that thread writes to, and writes them
+// as Chrome trace events (which Perfetto opens as well). Timestamps come from the monotonic clock
+// shared by every process on the machine, so the traces of several components can be merged with
+// jq -s '{traceEvents: map(.traceEvents) | add}' and a message followed from its publisher to its
+// subscribers through its trace id. Nothing is recorded, nor any clock read, unless enabled
+class Tracer final
+{
+public:
+   using Clock = std::chrono::steady_clock;
+
+   // Events beyond this many in a thread are dropped and counted
+   static constexpr std::size_t THREAD_CAPACITY = 1 << 16;
+
+   Tracer() = delete;
+
+   static void enable(const std::string& process);
+   static void disable() noexcept;
+
+   [[nodiscard]] static inline bool enabled() noexcept
+   {
+      return mEnabled.load(std::memory_order_relaxed);
+   }
+
+   [[nodiscard]] static inline std::int64_t now() noexcept
+   {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 Clock::now().time_since_epoch())
+          .count();
+   }
+
+   static void record(const TraceEvent& event) noexcept;
+
+   static inline void flow(const TraceEvent::Kind kind, const std::uint64_t traceId) noexcept
+   {
+      if (enabled() && traceId != 0)
+      {
+         record({.name = "message", .start = now(), .traceId = traceId, .kind = kind});
+      }
+   }
+
+   // Unique across the processes of a machine, since it starts with the process id
+   [[nodiscard]] static std::uint64_t newTraceId() noexcept;
+
+   // The trace id of the message this thread is handling, carried over to what it publishes
+   [[nodiscard]] static std::uint64_t current() noexcept;
+   static void setCurrent(std::uint64_t traceId) noexcept;
+
+   [[nodiscard]] static Result<void, TraceError> write(const std::filesystem::path& path);
+
+   [[nodiscard]] static std::size_t events() noexcept;
+   [[nodiscard]] static std::uint64_t dropped() noexcept;
+
+   // Forgets every recorded event, only meant for when no other thread is tracing
+   static void clear() noexcept;
+
+private:
+   struct ThreadBuffer
+   {
+      std::unique_ptr<TraceEvent[]> events = std::make_unique<TraceEvent[]>(THREAD_CAPACITY);
+      // Published with release once an event is complete, so that write() only reads whole ones
+      std::atomic<std::size_t> size = 0;
+      std::atomic<std::uint64_t> dropped = 0;
+      unsigned int thread = 0;
+   };
+
+   static std::atomic<bool> mEnabled;
+   static std::atomic<std::uint64_t> mNextTraceId;
+   static std::mutex mBuffersMutex;
+   // Buffers outlive their threads, so that what they recorded is still written
+   static std::vector<std::unique_ptr<ThreadBuffer>> mBuffers;
+   static std::string mProcess;
+
+   [[nodiscard]] static ThreadBuffer& buffer();
+};
+
+// Records the time spent in a scope
+class TraceSpan final
+{
+public:
+   explicit inline TraceSpan(const char* name, const std::uint64_t traceId = 0) noexcept
+       : mName{name}, mTraceId{traceId}, mStart{Tracer::enabled() ? Tracer::now() : 0}
+   {
+   }
+
+   TraceSpan(const TraceSpan& span) = delete;
+   TraceSpan(TraceSpan&& span) = delete;
+   auto operator=(const TraceSpan& span) = delete;
+   auto operator=(TraceSpan&& span) = delete;
+
+   inline ~TraceSpan()
+   {
+      if (mStart != 0 && Tracer::enabled())
+      {
+         Tracer::record({.name = mName,
+                         .start = mStart,
+                         .duration = Tracer::now() - mStart,
+                         .traceId = mTraceId});
+      }
+   }
+
+private:
+   const char* mName;
+   std::uint64_t mTraceId;
+   std::int64_t mStart;
+};
+
+#endif // TRACER_HPP
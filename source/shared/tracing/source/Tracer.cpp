@@ -0,0 +1,184 @@
+#include "Tracer.hpp"
+
+#include <fstream>
+#include <iomanip>
+
+#include <unistd.h>
+
+std::atomic<bool> Tracer::mEnabled = false;
+std::atomic<std::uint64_t> Tracer::mNextTraceId = 0;
+std::mutex Tracer::mBuffersMutex;
+std::vector<std::unique_ptr<Tracer::ThreadBuffer>> Tracer::mBuffers;
+std::string Tracer::mProcess;
+
+namespace {
+thread_local std::uint64_t currentTraceId = 0;
+
+constexpr std::int64_t NANOSECONDS_PER_MICROSECOND = 1000;
+
+// Chrome trace timestamps are in microseconds, keeping the nanoseconds as decimals
+void writeMicroseconds(std::ostream& stream, const std::int64_t nanoseconds)
+{
+   stream << nanoseconds / NANOSECONDS_PER_MICROSECOND << '.' << std::setw(3) << std::setfill('0')
+          << nanoseconds % NANOSECONDS_PER_MICROSECOND;
+}
+} // namespace
+
+void Tracer::enable(const std::string& process)
+{
+   {
+      std::lock_guard lock(mBuffersMutex);
+      mProcess = process;
+   }
+   mEnabled.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::disable() noexcept
+{
+   mEnabled.store(false, std::memory_order_relaxed);
+}
+
+Tracer::ThreadBuffer& Tracer::buffer()
+{
+   thread_local ThreadBuffer* local = nullptr;
+   if (local == nullptr)
+   {
+      std::lock_guard lock(mBuffersMutex);
+      mBuffers.push_back(std::make_unique<ThreadBuffer>());
+      local = mBuffers.back().get();
+      local->thread = static_cast<unsigned int>(mBuffers.size());
+   }
+
+   return *local;
+}
+
+void Tracer::record(const TraceEvent& event) noexcept
+{
+   ThreadBuffer* target = nullptr;
+   try
+   {
+      target = &buffer();
+   }
+   catch (const std::exception& exception)
+   {
+      return;
+   }
+
+   // Only this thread writes its buffer, so reading the size back needs no ordering
+   const auto size = target->size.load(std::memory_order_relaxed);
+   if (size == THREAD_CAPACITY)
+   {
+      target->dropped.fetch_add(1, std::memory_order_relaxed);
+      return;
+   }
+
+   target->events[size] = event;
+   target->size.store(size + 1, std::memory_order_release);
+}
+
+std::uint64_t Tracer::newTraceId() noexcept
+{
+   constexpr unsigned int PROCESS_SHIFT = 40;
+   static const auto PROCESS = static_cast<std::uint64_t>(getpid()) << PROCESS_SHIFT;
+   return PROCESS | (mNextTraceId.fetch_add(1, std::memory_order_relaxed) + 1);
+}
+
+std::uint64_t Tracer::current() noexcept
+{
+   return currentTraceId;
+}
+
+void Tracer::setCurrent(const std::uint64_t traceId) noexcept
+{
+   currentTraceId = traceId;
+}
+
+Result<void, TraceError> Tracer::write(const std::filesystem::path& path)
+{
+   std::ofstream stream(path);
+   if (!stream)
+   {
+      return Error(TraceError::UNABLE_TO_WRITE,
+                   ErrorDetail::compose("Unable to create trace ", path.native()));
+   }
+
+   std::lock_guard lock(mBuffersMutex);
+   const auto process = getpid();
+
+   stream << "{\"traceEvents\":[\n";
+   stream << R"({"name":"process_name","ph":"M","pid":)" << process
+          << R"(,"tid":0,"args":{"name":")" << mProcess << "\"}}";
+
+   for (const auto& threadBuffer : mBuffers)
+   {
+      const auto size = threadBuffer->size.load(std::memory_order_acquire);
+      for (std::size_t index = 0; index < size; index++)
+      {
+         const auto& event = threadBuffer->events[index];
+         stream << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << mProcess << "\",\"ts\":";
+         writeMicroseconds(stream, event.start);
+         stream << ",\"pid\":" << process << ",\"tid\":" << threadBuffer->thread;
+
+         switch (event.kind)
+         {
+         case TraceEvent::Kind::SPAN:
+            stream << ",\"ph\":\"X\",\"dur\":";
+            writeMicroseconds(stream, event.duration);
+            if (event.traceId != 0)
+            {
+               stream << ",\"args\":{\"trace_id\":" << event.traceId << "}";
+            }
+            break;
+         case TraceEvent::Kind::FLOW_START:
+            stream << ",\"ph\":\"s\",\"id\":" << event.traceId;
+            break;
+         case TraceEvent::Kind::FLOW_END:
+            stream << ",\"ph\":\"f\",\"bp\":\"e\",\"id\":" << event.traceId;
+            break;
+         }
+         stream << "}";
+      }
+   }
+
+   stream << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+   if (!stream)
+   {
+      return Error(TraceError::UNABLE_TO_WRITE,
+                   ErrorDetail::compose("Unable to write trace ", path.native()));
+   }
+
+   return {};
+}
+
+std::size_t Tracer::events() noexcept
+{
+   std::lock_guard lock(mBuffersMutex);
+   std::size_t total = 0;
+   for (const auto& threadBuffer : mBuffers)
+   {
+      total += threadBuffer->size.load(std::memory_order_acquire);
+   }
+   return total;
+}
+
+std::uint64_t Tracer::dropped() noexcept
+{
+   std::lock_guard lock(mBuffersMutex);
+   std::uint64_t total = 0;
+   for (const auto& threadBuffer : mBuffers)
+   {
+      total += threadBuffer->dropped.load(std::memory_order_relaxed);
+   }
+   return total;
+}
+
+void Tracer::clear() noexcept
+{
+   std::lock_guard lock(mBuffersMutex);
+   for (const auto& threadBuffer : mBuffers)
+   {
+      threadBuffer->size.store(0, std::memory_order_release);
+      threadBuffer->dropped.store(0, std::memory_order_relaxed);
+   }
+}
@@ -0,0 +1,95 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "Tracer.hpp"
+
+namespace {
+std::size_t occurrences(const std::string& text, const std::string& pattern)
+{
+   std::size_t count = 0;
+   for (auto position = text.find(pattern); position != std::string::npos;
+        position = text.find(pattern, position + pattern.size()))
+   {
+      count++;
+   }
+   return count;
+}
+
+std::string read(const std::filesystem::path& path)
+{
+   std::ifstream stream(path);
+   std::stringstream content;
+   content << stream.rdbuf();
+   return content.str();
+}
+} // namespace
+
+TEST(Tracer, Disabled)
+{
+   Tracer::disable();
+   Tracer::clear();
+   {
+      TraceSpan span("disabled");
+   }
+   Tracer::flow(TraceEvent::Kind::FLOW_START, 1);
+   ASSERT_EQ(Tracer::events(), 0);
+}
+
+TEST(Tracer, SpansAndFlows)
+{
+   const auto path = std::filesystem::temp_directory_path() / "SpansAndFlows.json";
+   Tracer::clear();
+   Tracer::enable("Test");
+
+   const auto traceId = Tracer::newTraceId();
+   ASSERT_NE(traceId, Tracer::newTraceId()) << "Trace ids are not unique";
+   {
+      TraceSpan span("publish", traceId);
+      Tracer::flow(TraceEvent::Kind::FLOW_START, traceId);
+   }
+
+   std::thread subscriber([traceId]() {
+      TraceSpan span("callback", traceId);
+      Tracer::flow(TraceEvent::Kind::FLOW_END, traceId);
+      Tracer::setCurrent(traceId);
+      ASSERT_EQ(Tracer::current(), traceId);
+   });
+   subscriber.join();
+   ASSERT_EQ(Tracer::current(), 0) << "Current trace leaked across threads";
+
+   Tracer::disable();
+   ASSERT_EQ(Tracer::events(), 4);
+   ASSERT_TRUE(Tracer::write(path));
+
+   const auto trace = read(path);
+   const auto id = std::to_string(traceId);
+   ASSERT_EQ(occurrences(trace, "\"ph\":\"X\""), 2);
+   ASSERT_EQ(occurrences(trace, "\"ph\":\"s\",\"id\":" + id), 1);
+   ASSERT_EQ(occurrences(trace, "\"ph\":\"f\",\"bp\":\"e\",\"id\":" + id), 1);
+   ASSERT_EQ(occurrences(trace, "\"trace_id\":" + id), 2);
+   ASSERT_EQ(occurrences(trace, "\"name\":\"Test\""), 1);
+   ASSERT_NE(trace.find("\"tid\":1"), std::string::npos);
+   ASSERT_NE(trace.find("\"tid\":2"), std::string::npos);
+
+   std::filesystem::remove(path);
+}
+
+TEST(Tracer, DropsWhenFull)
+{
+   Tracer::clear();
+   Tracer::enable("Test");
+   for (std::size_t i = 0; i < Tracer::THREAD_CAPACITY + 10; i++)
+   {
+      TraceSpan span("span");
+   }
+   Tracer::disable();
+
+   ASSERT_EQ(Tracer::events(), Tracer::THREAD_CAPACITY);
+   ASSERT_EQ(Tracer::dropped(), 10);
+   Tracer::clear();
+}